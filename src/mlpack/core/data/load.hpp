@@ -32,6 +32,10 @@ namespace data /** Functions to load and save matrices. */ {
  *  - Armadillo binary (arma_binary), denoted by .bin
  *  - HDF5, denoted by .hdf, .hdf5, .h5, or .he5
  *
+ * Armadillo binary data saved with a different element type than the matrix
+ * (for instance, double-precision data loaded into an arma::fmat) is converted
+ * to the element type of the matrix.
+ *
  * If the file extension is not one of those types, an error will be given.
  * This is preferable to Armadillo's default behavior of loading an unknown
  * filetype as raw_binary, which can have very confusing effects.
@@ -16,6 +16,45 @@
 namespace mlpack {
 namespace data {
 
+/**
+ * Load Armadillo binary data which was saved with a different element type
+ * than the given matrix (for instance, double-precision data into an
+ * arma::fmat), by loading it with the element type it was saved with and then
+ * converting it.  Only float and double data are converted; for any other
+ * stored type, Armadillo's load (and its error) is used.
+ *
+ * @param stream Stream positioned at the start of the data.
+ * @param header Header of the data (for instance, "ARMA_MAT_BIN_FN008").
+ * @param matrix Matrix to load the converted data into.
+ * @return Boolean value indicating success or failure of load.
+ */
+template<typename eT>
+bool LoadConvertedBinary(std::istream& stream,
+                         const std::string& header,
+                         arma::Mat<eT>& matrix)
+{
+  if (header == arma::diskio::gen_bin_header(arma::mat()))
+  {
+    arma::mat stored;
+    if (!stored.load(stream, arma::arma_binary))
+      return false;
+
+    matrix = arma::conv_to<arma::Mat<eT> >::from(stored);
+    return true;
+  }
+  else if (header == arma::diskio::gen_bin_header(arma::fmat()))
+  {
+    arma::fmat stored;
+    if (!stored.load(stream, arma::arma_binary))
+      return false;
+
+    matrix = arma::conv_to<arma::Mat<eT> >::from(stored);
+    return true;
+  }
+
+  return matrix.load(stream, arma::arma_binary);
+}
+
 template<typename eT>
 bool Load(const std::string& filename,
           arma::Mat<eT>& matrix,
@@ -63,6 +102,7 @@ bool Load(const std::string& filename,
   bool unknownType = false;
   arma::file_type loadType;
   std::string stringType;
+  std::string binaryHeader; // Only used for Armadillo binary data.
 
   if (extension == "csv")
   {
@@ -122,6 +162,11 @@ bool Load(const std::string& filename,
     {
       stringType = "Armadillo binary formatted data";
       loadType = arma::arma_binary;
+
+      // The header also gives the element type the data was saved with.
+      std::getline(stream, binaryHeader);
+      stream.clear();
+      stream.seekg(pos);
     }
     else // We can only assume it's raw binary.
     {
@@ -201,7 +246,18 @@ bool Load(const std::string& filename,
     Log::Info << "Loading '" << filename << "' as " << stringType << ".  "
         << std::flush;
 
-  const bool success = matrix.load(stream, loadType);
+  bool success;
+  if (loadType == arma::arma_binary &&
+      binaryHeader != arma::diskio::gen_bin_header(matrix))
+  {
+    Log::Info << "Converting from stored type (" << binaryHeader << ").  "
+        << std::flush;
+    success = LoadConvertedBinary(stream, binaryHeader, matrix);
+  }
+  else
+  {
+    success = matrix.load(stream, loadType);
+  }
 
   if (!success)
   {
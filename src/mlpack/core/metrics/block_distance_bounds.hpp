@@ -0,0 +1,201 @@
+/**
+ * @file block_distance_bounds.hpp
+ *
+ * Bounds on the Euclidean distances between every pair of points from two
+ * blocks of points, computed at once with a matrix multiplication.  Rules may
+ * use these to run many base cases at once (see tree::RuleTraits).
+ */
+#ifndef __MLPACK_CORE_METRICS_BLOCK_DISTANCE_BOUNDS_HPP
+#define __MLPACK_CORE_METRICS_BLOCK_DISTANCE_BOUNDS_HPP
+
+#include <mlpack/core.hpp>
+#include "lmetric.hpp"
+
+#include <limits>
+#include <vector>
+
+namespace mlpack {
+namespace metric {
+
+/**
+ * Compute the squared norm of each point (column) of the given dataset.
+ *
+ * @param data Dataset to compute the norms of.
+ * @param norms Vector to store the squared norms in.
+ */
+template<typename eT>
+void SquaredNorms(const arma::Mat<eT>& data, arma::vec& norms)
+{
+  const arma::Row<eT> sums = arma::sum(arma::square(data), 0);
+
+  norms.set_size(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    norms[i] = sums[i];
+}
+
+//! Compute the squared norm of each point (column) of the given sparse
+//! dataset.
+template<typename eT>
+void SquaredNorms(const arma::SpMat<eT>& data, arma::vec& norms)
+{
+  norms.zeros(data.n_cols);
+  for (typename arma::SpMat<eT>::const_iterator it = data.begin();
+       it != data.end(); ++it)
+    norms[it.col()] += (*it) * (*it);
+}
+
+/**
+ * Lower and upper bounds on the distance between each point of a block of
+ * query points and each point of a block of reference points, as
+ * LMetric<2, TakeRoot>::Evaluate() would compute it.  The squared distances
+ * are computed as ||q||^2 + ||r||^2 - 2 q^T r, so all of the inner products are
+ * one matrix multiplication (which BLAS vectorizes), instead of one loop over
+ * the dimensions for each pair of points.
+ *
+ * Because of cancellation, this is not accurate for points which are close
+ * relative to their norms, so the result is a pair of bounds which account for
+ * the rounding error of both ways of computing the distance.  When the bounds
+ * are tight (see Tight()), Distance() may be used as the distance; otherwise,
+ * a pair of points whose bounds can't be pruned should be evaluated with the
+ * metric.
+ *
+ * The memory used is kept between calls to Compute(), and is only grown, so an
+ * object which is used for each pair of leaves of a traversal allocates memory
+ * only for the first few pairs.
+ *
+ * @tparam eT Type of the elements of the datasets.
+ */
+template<typename eT>
+class BlockDistanceBounds
+{
+ public:
+  //! Create the object.  No memory is allocated until Compute() is called.
+  BlockDistanceBounds() : numQueries(0) { }
+
+  /**
+   * Compute the bounds on the distance between each of the given query points
+   * and each of the given reference points.
+   *
+   * @param metric Metric whose distances are bounded.
+   * @param querySet Set of query points.
+   * @param queryNorms Squared norms of all query points (see SquaredNorms()).
+   * @param queryIndices Indices of the query points to use.
+   * @param referenceSet Set of reference points.
+   * @param referenceNorms Squared norms of all reference points.
+   * @param referenceBegin Index of first reference point to use.
+   * @param referenceCount Number of reference points to use.
+   */
+  template<bool TakeRoot>
+  void Compute(const LMetric<2, TakeRoot>& metric,
+               const arma::Mat<eT>& querySet,
+               const arma::vec& queryNorms,
+               const std::vector<size_t>& queryIndices,
+               const arma::Mat<eT>& referenceSet,
+               const arma::vec& referenceNorms,
+               const size_t referenceBegin,
+               const size_t referenceCount);
+
+  //! Get the lower bound on the distance between the i'th query point and the
+  //! j'th reference point given to the last call to Compute().
+  double Lower(const size_t i, const size_t j) const
+  { return lower[i + j * numQueries]; }
+
+  //! Get the upper bound on the distance between the i'th query point and the
+  //! j'th reference point given to the last call to Compute().
+  double Upper(const size_t i, const size_t j) const
+  { return upper[i + j * numQueries]; }
+
+  /**
+   * Return whether the bounds on the distance between the i'th query point and
+   * the j'th reference point are within a relative 1e-10 of each other, so
+   * that Distance() can be used instead of evaluating the metric.
+   */
+  bool Tight(const size_t i, const size_t j) const
+  { return (Upper(i, j) - Lower(i, j)) <= 1e-10 * Lower(i, j); }
+
+  //! Get the estimate of the distance between the i'th query point and the
+  //! j'th reference point, halfway between its bounds.
+  double Distance(const size_t i, const size_t j) const
+  { return 0.5 * (Lower(i, j) + Upper(i, j)); }
+
+ private:
+  //! The number of query points given to the last call to Compute().
+  size_t numQueries;
+  //! Memory for the copies of the query points.
+  std::vector<eT> queries;
+  //! Memory for the inner products of the query and reference points.
+  std::vector<eT> products;
+  //! The lower bounds (queries x references, column-major).
+  std::vector<double> lower;
+  //! The upper bounds (queries x references, column-major).
+  std::vector<double> upper;
+};
+
+template<typename eT>
+template<bool TakeRoot>
+void BlockDistanceBounds<eT>::Compute(
+    const LMetric<2, TakeRoot>& /* metric */,
+    const arma::Mat<eT>& querySet,
+    const arma::vec& queryNorms,
+    const std::vector<size_t>& queryIndices,
+    const arma::Mat<eT>& referenceSet,
+    const arma::vec& referenceNorms,
+    const size_t referenceBegin,
+    const size_t referenceCount)
+{
+  numQueries = queryIndices.size();
+  if (numQueries == 0 || referenceCount == 0)
+    return;
+
+  // Resizing a vector within its capacity does not allocate memory, so the
+  // matrices below are only allocated when a block is larger than any before.
+  const size_t dimensions = querySet.n_rows;
+  queries.resize(dimensions * numQueries);
+  products.resize(numQueries * referenceCount);
+  lower.resize(numQueries * referenceCount);
+  upper.resize(numQueries * referenceCount);
+
+  // The query points may not be contiguous, so they are copied; the reference
+  // points are used in place.
+  arma::Mat<eT> queryBlock(&queries[0], dimensions, numQueries, false, true);
+  for (size_t i = 0; i < numQueries; ++i)
+    queryBlock.col(i) = querySet.col(queryIndices[i]);
+
+  const arma::Mat<eT> references(const_cast<eT*>(referenceSet.colptr(
+      referenceBegin)), dimensions, referenceCount, false, true);
+
+  arma::Mat<eT> productBlock(&products[0], numQueries, referenceCount, false,
+      true);
+  productBlock = arma::trans(queryBlock) * references;
+
+  // The rounding error of each sum over the dimensions is at most about
+  // (dimensions * epsilon) times the sum of the squared norms; this allows for
+  // it in the norms, the inner products, and LMetric::Evaluate(), with margin.
+  const double tolerance = (4.0 * dimensions + 8.0) *
+      std::numeric_limits<eT>::epsilon();
+
+  for (size_t j = 0; j < referenceCount; ++j)
+  {
+    for (size_t i = 0; i < numQueries; ++i)
+    {
+      const double norms = queryNorms[queryIndices[i]] +
+          referenceNorms[referenceBegin + j];
+      const double distance = norms - 2.0 * productBlock(i, j);
+      const double error = tolerance * norms;
+
+      const size_t index = i + j * numQueries;
+      lower[index] = std::max(distance - error, 0.0);
+      upper[index] = distance + error;
+      if (TakeRoot)
+      {
+        lower[index] = std::sqrt(lower[index]);
+        upper[index] = std::sqrt(upper[index]);
+      }
+    }
+  }
+}
+
+}; // namespace metric
+}; // namespace mlpack
+
+#endif
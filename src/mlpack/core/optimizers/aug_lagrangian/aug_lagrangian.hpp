@@ -14,6 +14,7 @@
 #include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
 
 #include "aug_lagrangian_function.hpp"
+#include "aug_lagrangian_state.hpp"
 
 namespace mlpack {
 namespace optimization {
@@ -98,6 +99,23 @@ class AugLagrangian
                 const double initSigma,
                 const size_t maxIterations = 1000);
 
+  /**
+   * Optimize the function, resuming the optimization described by the given
+   * state (see AugLagrangianState), which will be modified to describe the
+   * optimization at its end; a default-constructed state starts a new
+   * optimization from the current Lagrange multipliers and penalty parameter.
+   * The given coordinates should be the final coordinates of the optimization
+   * the state describes.
+   *
+   * @param coordinates Output matrix to store the optimized coordinates in.
+   * @param state State of the optimization to resume (will be modified).
+   * @param maxIterations Maximum number of iterations of the Augmented
+   *     Lagrangian algorithm in this run.  0 indicates no maximum.
+   */
+  bool Optimize(arma::mat& coordinates,
+                AugLagrangianState& state,
+                const size_t maxIterations = 1000);
+
   //! Get the LagrangianFunction.
   const LagrangianFunction& Function() const { return function; }
   //! Modify the LagrangianFunction.
@@ -66,8 +66,38 @@ template<typename LagrangianFunction>
 bool AugLagrangian<LagrangianFunction>::Optimize(arma::mat& coordinates,
                                                  const size_t maxIterations)
 {
-  // Ensure that we update lambda immediately.
-  double penaltyThreshold = DBL_MAX;
+  // Start a new optimization.
+  AugLagrangianState state;
+  return Optimize(coordinates, state, maxIterations);
+}
+
+template<typename LagrangianFunction>
+bool AugLagrangian<LagrangianFunction>::Optimize(arma::mat& coordinates,
+                                                 AugLagrangianState& state,
+                                                 const size_t maxIterations)
+{
+  if ((state.Iteration() == 0) && (state.Lambda().n_elem == 0))
+  {
+    // A new optimization starts from the current lambda and sigma.
+    state.Lambda() = augfunc.Lambda();
+    state.Sigma() = augfunc.Sigma();
+  }
+  else
+  {
+    if (state.Lambda().n_elem != function.NumConstraints())
+    {
+      Log::Fatal << "AugLagrangian::Optimize(): the state to resume has "
+          << state.Lambda().n_elem << " Lagrange multipliers, but the function "
+          << "has " << function.NumConstraints() << " constraints!"
+          << std::endl;
+    }
+
+    augfunc.Lambda() = state.Lambda();
+    augfunc.Sigma() = state.Sigma();
+  }
+
+  // Initially, this is DBL_MAX, so that we update lambda immediately.
+  double& penaltyThreshold = state.PenaltyThreshold();
 
   // Track the last objective to compare for convergence.
   double lastObjective = function.Evaluate(coordinates);
@@ -150,6 +180,11 @@ bool AugLagrangian<LagrangianFunction>::Optimize(arma::mat& coordinates,
       augfunc.Sigma() *= 10;
       Log::Warn << "Updated sigma to " << augfunc.Sigma() << "." << std::endl;
     }
+
+    // Save the state, so that the optimization can be resumed.
+    state.Lambda() = augfunc.Lambda();
+    state.Sigma() = augfunc.Sigma();
+    ++state.Iteration();
   }
 
   return false;
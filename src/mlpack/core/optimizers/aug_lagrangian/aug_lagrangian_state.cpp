@@ -0,0 +1,43 @@
+/**
+ * @file aug_lagrangian_state.cpp
+ *
+ * Implementation of the AugLagrangianState class.
+ */
+#include "aug_lagrangian_state.hpp"
+
+using namespace mlpack;
+using namespace mlpack::optimization;
+
+AugLagrangianState::AugLagrangianState() :
+    iteration(0),
+    sigma(0),
+    penaltyThreshold(DBL_MAX)
+{ /* Nothing to do. */ }
+
+void AugLagrangianState::Save(util::SaveRestoreUtility& sr) const
+{
+  sr.SaveParameter(iteration, "iteration");
+  sr.SaveParameter(sigma, "sigma");
+  sr.SaveParameter(penaltyThreshold, "penaltyThreshold");
+  sr.SaveParameter(lambda.n_elem, "constraints");
+  if (lambda.n_elem > 0)
+    sr.SaveParameter(lambda, "lambda");
+}
+
+void AugLagrangianState::Load(const util::SaveRestoreUtility& sr)
+{
+  sr.LoadParameter(iteration, "iteration");
+  sr.LoadParameter(sigma, "sigma");
+
+  // DBL_MAX (before lambda is first updated) may not be read back exactly; if
+  // it overflows, it is either left alone or set to DBL_MAX.
+  penaltyThreshold = DBL_MAX;
+  sr.LoadParameter(penaltyThreshold, "penaltyThreshold");
+
+  size_t constraints;
+  sr.LoadParameter(constraints, "constraints");
+  if (constraints > 0)
+    sr.LoadParameter(lambda, "lambda");
+  else
+    lambda.reset();
+}
@@ -0,0 +1,71 @@
+/**
+ * @file aug_lagrangian_state.hpp
+ *
+ * The state of an Augmented Lagrangian optimization, which can be saved and
+ * used to resume the optimization later.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_AUG_LAGRANGIAN_AUG_LAGRANGIAN_STATE_HPP
+#define __MLPACK_CORE_OPTIMIZERS_AUG_LAGRANGIAN_AUG_LAGRANGIAN_STATE_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * The state of an Augmented Lagrangian optimization: the number of iterations
+ * done, the Lagrange multipliers (lambda), the penalty parameter (sigma), and
+ * the penalty threshold below which lambda, rather than sigma, is updated.
+ * Together with the coordinates, this is all AugLagrangian::Optimize() needs
+ * to resume an optimization; see LBFGSState for an example of checkpointing.
+ *
+ * A default-constructed state starts a new optimization from the Lagrange
+ * multipliers and penalty parameter the AugLagrangian object has.
+ */
+class AugLagrangianState
+{
+ public:
+  //! Create the state of a new optimization.
+  AugLagrangianState();
+
+  //! Get the number of iterations done.
+  size_t Iteration() const { return iteration; }
+  //! Modify the number of iterations done.
+  size_t& Iteration() { return iteration; }
+
+  //! Get the Lagrange multipliers.
+  const arma::vec& Lambda() const { return lambda; }
+  //! Modify the Lagrange multipliers.
+  arma::vec& Lambda() { return lambda; }
+
+  //! Get the penalty parameter.
+  double Sigma() const { return sigma; }
+  //! Modify the penalty parameter.
+  double& Sigma() { return sigma; }
+
+  //! Get the penalty threshold.
+  double PenaltyThreshold() const { return penaltyThreshold; }
+  //! Modify the penalty threshold.
+  double& PenaltyThreshold() { return penaltyThreshold; }
+
+  //! Save the state to a SaveRestoreUtility.
+  void Save(util::SaveRestoreUtility& sr) const;
+
+  //! Load the state from a SaveRestoreUtility.
+  void Load(const util::SaveRestoreUtility& sr);
+
+ private:
+  //! The number of iterations done.
+  size_t iteration;
+  //! The Lagrange multipliers.
+  arma::vec lambda;
+  //! The penalty parameter.
+  double sigma;
+  //! The penalty threshold below which lambda is updated.
+  double penaltyThreshold;
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
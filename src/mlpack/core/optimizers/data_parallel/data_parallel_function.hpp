@@ -0,0 +1,144 @@
+/**
+ * @file data_parallel_function.hpp
+ *
+ * A wrapper around a decomposable objective function which evaluates the
+ * objective and the gradient over the whole dataset in parallel, for
+ * full-batch optimizers such as L-BFGS.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_DATA_PARALLEL_DATA_PARALLEL_FUNCTION_HPP
+#define __MLPACK_CORE_OPTIMIZERS_DATA_PARALLEL_DATA_PARALLEL_FUNCTION_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/evaluate_with_gradient.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * DataParallelFunction wraps a decomposable objective function (a sum of
+ * functions, one for each point of a dataset) so that a full-batch optimizer,
+ * such as L-BFGS, evaluates it in parallel.  The functions are split into a
+ * number of shards of contiguous functions; the objectives and gradients of
+ * the shards are computed in parallel (with OpenMP), and then summed in shard
+ * order.  So, for a given number of shards, the result does not depend on the
+ * number of threads or on their scheduling.  If mlpack is compiled without
+ * OpenMP, the shards are computed one after another.
+ *
+ * For example, to train logistic regression with L-BFGS on all cores:
+ *
+ * @code
+ * LogisticRegressionFunction<> f(data, responses, lambda);
+ * DataParallelFunction<LogisticRegressionFunction<> > parallelF(f);
+ * L_BFGS<DataParallelFunction<LogisticRegressionFunction<> > > lbfgs(
+ *     parallelF);
+ *
+ * arma::mat parameters = f.GetInitialPoint();
+ * lbfgs.Optimize(parameters);
+ * LogisticRegression<> lr(parameters, lambda);
+ * @endcode
+ *
+ * The FunctionType template parameter must implement the following functions,
+ * which must be safe to call from several threads at once:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates,
+ *                   const size_t begin,
+ *                   const size_t batchSize);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t begin,
+ *                 const size_t batchSize,
+ *                 arma::mat& gradient);
+ *
+ * Evaluate() should return the sum of the objectives of the functions begin
+ * to (begin + batchSize - 1), and Gradient() should store the sum of their
+ * gradients (these are the same functions mini-batch SGD uses).  If the
+ * FunctionType also implements
+ *
+ *   double EvaluateWithGradient(const arma::mat& coordinates,
+ *                               const size_t begin,
+ *                               const size_t batchSize,
+ *                               arma::mat& gradient);
+ *
+ * then it is used to compute the objective and gradient of each shard at once.
+ *
+ * @tparam FunctionType Decomposable objective function type to wrap.
+ */
+template<typename FunctionType>
+class DataParallelFunction
+{
+ public:
+  /**
+   * Wrap the given function.  If the number of shards is 0, the OpenMP
+   * default number of threads (which can be set with OmpSetNumThreads() or
+   * the OMP_NUM_THREADS environment variable) is used.
+   *
+   * @param function Function to wrap.
+   * @param shards Number of shards to split the functions into.
+   */
+  DataParallelFunction(FunctionType& function, const size_t shards = 0);
+
+  /**
+   * Evaluate the objective function, in parallel.
+   *
+   * @param coordinates Point to evaluate the function at.
+   */
+  double Evaluate(const arma::mat& coordinates) const;
+
+  /**
+   * Evaluate the gradient of the objective function, in parallel.
+   *
+   * @param coordinates Point to evaluate the gradient at.
+   * @param gradient Matrix to store the gradient in.
+   */
+  void Gradient(const arma::mat& coordinates, arma::mat& gradient) const;
+
+  /**
+   * Evaluate the objective function and its gradient, in parallel.
+   *
+   * @param coordinates Point to evaluate the function and gradient at.
+   * @param gradient Matrix to store the gradient in.
+   * @return The value of the objective function.
+   */
+  double EvaluateWithGradient(const arma::mat& coordinates,
+                              arma::mat& gradient) const;
+
+  //! Return the initial point of the wrapped function.
+  const arma::mat& GetInitialPoint() const
+  { return function.GetInitialPoint(); }
+
+  //! Get the wrapped function.
+  const FunctionType& Function() const { return function; }
+  //! Modify the wrapped function.
+  FunctionType& Function() { return function; }
+
+  //! Get the number of shards (0 means the number of threads).
+  size_t Shards() const { return shards; }
+  //! Modify the number of shards (0 means the number of threads).
+  size_t& Shards() { return shards; }
+
+  // Convert the object into a string.
+  std::string ToString() const;
+
+ private:
+  //! The wrapped function.
+  FunctionType& function;
+
+  //! The number of shards (0 means the number of threads).
+  size_t shards;
+
+  //! Return the number of shards to use, which is at most the number of
+  //! functions.
+  size_t NumShards() const;
+
+  //! Return the index of the first function of the given shard; the shards
+  //! are contiguous, so ShardBegin(numShards) is the number of functions.
+  size_t ShardBegin(const size_t shard, const size_t numShards) const;
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+// Include implementation.
+#include "data_parallel_function_impl.hpp"
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file data_parallel_function_impl.hpp
+ *
+ * Implementation of the DataParallelFunction wrapper.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_DATA_PARALLEL_DATA_PARALLEL_FUNCTION_IMPL_HPP
+#define __MLPACK_CORE_OPTIMIZERS_DATA_PARALLEL_DATA_PARALLEL_FUNCTION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "data_parallel_function.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename FunctionType>
+DataParallelFunction<FunctionType>::DataParallelFunction(
+    FunctionType& function,
+    const size_t shards) :
+    function(function),
+    shards(shards)
+{ /* Nothing to do. */ }
+
+template<typename FunctionType>
+double DataParallelFunction<FunctionType>::Evaluate(
+    const arma::mat& coordinates) const
+{
+  const size_t numShards = NumShards();
+
+  arma::vec objectives(numShards);
+  #pragma omp parallel for schedule(static)
+  for (size_t s = 0; s < numShards; ++s)
+  {
+    const size_t begin = ShardBegin(s, numShards);
+    objectives[s] = function.Evaluate(coordinates, begin,
+        ShardBegin(s + 1, numShards) - begin);
+  }
+
+  // Sum in shard order, so that the result does not depend on the threads.
+  double objective = 0.0;
+  for (size_t s = 0; s < numShards; ++s)
+    objective += objectives[s];
+
+  return objective;
+}
+
+template<typename FunctionType>
+void DataParallelFunction<FunctionType>::Gradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient) const
+{
+  const size_t numShards = NumShards();
+
+  std::vector<arma::mat> gradients(numShards);
+  #pragma omp parallel for schedule(static)
+  for (size_t s = 0; s < numShards; ++s)
+  {
+    const size_t begin = ShardBegin(s, numShards);
+    function.Gradient(coordinates, begin, ShardBegin(s + 1, numShards) - begin,
+        gradients[s]);
+  }
+
+  // Sum in shard order, so that the result does not depend on the threads.
+  gradient = gradients[0];
+  for (size_t s = 1; s < numShards; ++s)
+    gradient += gradients[s];
+}
+
+template<typename FunctionType>
+double DataParallelFunction<FunctionType>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient) const
+{
+  const size_t numShards = NumShards();
+
+  arma::vec objectives(numShards);
+  std::vector<arma::mat> gradients(numShards);
+  #pragma omp parallel for schedule(static)
+  for (size_t s = 0; s < numShards; ++s)
+  {
+    const size_t begin = ShardBegin(s, numShards);
+    objectives[s] = optimization::EvaluateWithGradient(function, coordinates,
+        begin, ShardBegin(s + 1, numShards) - begin, gradients[s]);
+  }
+
+  // Sum in shard order, so that the result does not depend on the threads.
+  double objective = objectives[0];
+  gradient = gradients[0];
+  for (size_t s = 1; s < numShards; ++s)
+  {
+    objective += objectives[s];
+    gradient += gradients[s];
+  }
+
+  return objective;
+}
+
+template<typename FunctionType>
+size_t DataParallelFunction<FunctionType>::NumShards() const
+{
+  const size_t numFunctions = function.NumFunctions();
+  if (numFunctions == 0)
+  {
+    Log::Fatal << "DataParallelFunction: the function has no points!"
+        << std::endl;
+  }
+
+  const size_t numShards = (shards == 0) ? (size_t) OmpGetMaxThreads() :
+      shards;
+  return std::min(numShards, numFunctions);
+}
+
+template<typename FunctionType>
+size_t DataParallelFunction<FunctionType>::ShardBegin(
+    const size_t shard,
+    const size_t numShards) const
+{
+  // The functions are split as evenly as possible.
+  return (shard * function.NumFunctions()) / numShards;
+}
+
+// Convert the object to a string.
+template<typename FunctionType>
+std::string DataParallelFunction<FunctionType>::ToString() const
+{
+  std::ostringstream convert;
+  convert << "DataParallelFunction [" << this << "]" << std::endl;
+  convert << "  Function:" << std::endl;
+  convert << util::Indent(function.ToString(), 2);
+  convert << "  Shards: " << shards << std::endl;
+  return convert.str();
+}
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,176 @@
+/**
+ * @file evaluate_with_gradient.hpp
+ *
+ * Detection of the optional EvaluateWithGradient() method of objective
+ * functions, which computes the objective and its gradient at once.  Functions
+ * whose objective and gradient share most of their work (such as a forward pass
+ * over a dataset) can implement it so that optimizers do not repeat that work.
+ * Optimizers call EvaluateWithGradient(function, ...) below, which uses the
+ * method if the function has it, and Evaluate() and Gradient() otherwise.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_EVALUATE_WITH_GRADIENT_HPP
+#define __MLPACK_CORE_OPTIMIZERS_EVALUATE_WITH_GRADIENT_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+HAS_MEM_FUNC(EvaluateWithGradient, HasEvaluateWithGradientMethod);
+
+/**
+ * Whether or not the given function type has the method
+ *
+ *   double EvaluateWithGradient(const arma::mat& coordinates,
+ *                               arma::mat& gradient);
+ *
+ * (const or not), which returns the objective and stores the gradient.
+ */
+template<typename FunctionType>
+struct HasEvaluateWithGradient
+{
+  static const bool value = HasEvaluateWithGradientMethod<FunctionType,
+      double(FunctionType::*)(const arma::mat&, arma::mat&) const>::value ||
+      HasEvaluateWithGradientMethod<FunctionType,
+      double(FunctionType::*)(const arma::mat&, arma::mat&)>::value;
+};
+
+/**
+ * Whether or not the given decomposable function type has the method
+ *
+ *   double EvaluateWithGradient(const arma::mat& coordinates,
+ *                               const size_t i,
+ *                               arma::mat& gradient);
+ *
+ * (const or not), which returns the objective of the i'th function and stores
+ * its gradient.
+ */
+template<typename FunctionType>
+struct HasDecomposableEvaluateWithGradient
+{
+  static const bool value = HasEvaluateWithGradientMethod<FunctionType,
+      double(FunctionType::*)(const arma::mat&, const size_t, arma::mat&)
+      const>::value ||
+      HasEvaluateWithGradientMethod<FunctionType,
+      double(FunctionType::*)(const arma::mat&, const size_t, arma::mat&)>::
+      value;
+};
+
+/**
+ * Whether or not the given decomposable function type has the method
+ *
+ *   double EvaluateWithGradient(const arma::mat& coordinates,
+ *                               const size_t begin,
+ *                               const size_t batchSize,
+ *                               arma::mat& gradient);
+ *
+ * (const or not), which returns the sum of the objectives of the functions
+ * begin to (begin + batchSize - 1) and stores the sum of their gradients.
+ */
+template<typename FunctionType>
+struct HasBatchEvaluateWithGradient
+{
+  static const bool value = HasEvaluateWithGradientMethod<FunctionType,
+      double(FunctionType::*)(const arma::mat&, const size_t, const size_t,
+      arma::mat&) const>::value ||
+      HasEvaluateWithGradientMethod<FunctionType,
+      double(FunctionType::*)(const arma::mat&, const size_t, const size_t,
+      arma::mat&)>::value;
+};
+
+//! Evaluate the objective and the gradient of a function which has
+//! EvaluateWithGradient().
+template<typename FunctionType>
+inline double EvaluateWithGradient(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    arma::mat& gradient,
+    const typename boost::enable_if_c<
+        HasEvaluateWithGradient<FunctionType>::value>::type* = 0)
+{
+  return function.EvaluateWithGradient(coordinates, gradient);
+}
+
+//! Evaluate the objective and the gradient of a function which has only
+//! Evaluate() and Gradient().
+template<typename FunctionType>
+inline double EvaluateWithGradient(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    arma::mat& gradient,
+    const typename boost::disable_if_c<
+        HasEvaluateWithGradient<FunctionType>::value>::type* = 0)
+{
+  const double objective = function.Evaluate(coordinates);
+  function.Gradient(coordinates, gradient);
+  return objective;
+}
+
+//! Evaluate the objective and the gradient of the i'th function of a
+//! decomposable function which has EvaluateWithGradient().
+template<typename FunctionType>
+inline double EvaluateWithGradient(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    const size_t i,
+    arma::mat& gradient,
+    const typename boost::enable_if_c<
+        HasDecomposableEvaluateWithGradient<FunctionType>::value>::type* = 0)
+{
+  return function.EvaluateWithGradient(coordinates, i, gradient);
+}
+
+//! Evaluate the objective and the gradient of the i'th function of a
+//! decomposable function which has only Evaluate() and Gradient().
+template<typename FunctionType>
+inline double EvaluateWithGradient(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    const size_t i,
+    arma::mat& gradient,
+    const typename boost::disable_if_c<
+        HasDecomposableEvaluateWithGradient<FunctionType>::value>::type* = 0)
+{
+  const double objective = function.Evaluate(coordinates, i);
+  function.Gradient(coordinates, i, gradient);
+  return objective;
+}
+
+//! Evaluate the objective and the gradient of a batch of functions of a
+//! decomposable function which has EvaluateWithGradient().
+template<typename FunctionType>
+inline double EvaluateWithGradient(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    const size_t begin,
+    const size_t batchSize,
+    arma::mat& gradient,
+    const typename boost::enable_if_c<
+        HasBatchEvaluateWithGradient<FunctionType>::value>::type* = 0)
+{
+  return function.EvaluateWithGradient(coordinates, begin, batchSize,
+      gradient);
+}
+
+//! Evaluate the objective and the gradient of a batch of functions of a
+//! decomposable function which has only Evaluate() and Gradient().
+template<typename FunctionType>
+inline double EvaluateWithGradient(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    const size_t begin,
+    const size_t batchSize,
+    arma::mat& gradient,
+    const typename boost::disable_if_c<
+        HasBatchEvaluateWithGradient<FunctionType>::value>::type* = 0)
+{
+  const double objective = function.Evaluate(coordinates, begin, batchSize);
+  function.Gradient(coordinates, begin, batchSize, gradient);
+  return objective;
+}
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
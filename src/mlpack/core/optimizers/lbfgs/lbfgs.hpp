@@ -9,6 +9,10 @@
 #define __MLPACK_CORE_OPTIMIZERS_LBFGS_LBFGS_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/evaluate_with_gradient.hpp>
+
+#include "lbfgs_state.hpp"
+#include "lbfgs_statistics.hpp"
 
 namespace mlpack {
 namespace optimization {
@@ -24,6 +28,22 @@ namespace optimization {
  *  - double Evaluate(const arma::mat& coordinates);
  *  - void Gradient(const arma::mat& coordinates, arma::mat& gradient);
  *  - arma::mat& GetInitialPoint();
+ *
+ * If the function also implements
+ *
+ *  - double EvaluateWithGradient(const arma::mat& coordinates,
+ *                                arma::mat& gradient);
+ *
+ * which returns the objective and stores the gradient, it is used instead of
+ * calling Evaluate() and Gradient() separately at each point.
+ *
+ * Each call to Optimize() records the number of function and gradient
+ * evaluations, the line search trials and step sizes, and the time spent in
+ * the function, in SearchDirection(), and in UpdateBasisSet(), for each
+ * iteration; see Statistics() and LBFGSStatistics.  The times are also
+ * accumulated in the "lbfgs_objective", "lbfgs_search_direction", and
+ * "lbfgs_update_basis_set" timers, so the function being optimized must not
+ * itself run an L_BFGS optimizer (a timer cannot be started twice).
  */
 template<typename FunctionType>
 class L_BFGS
@@ -67,6 +87,9 @@ class L_BFGS
    */
   const std::pair<arma::mat, double>& MinPointIterate() const;
 
+  //! Get the counters and timings of the last call to Optimize().
+  const LBFGSStatistics& Statistics() const { return statistics; }
+
   /**
    * Use L-BFGS to optimize the given function, starting at the given iterate
    * point and finding the minimum.  The maximum number of iterations is set in
@@ -94,6 +117,36 @@ class L_BFGS
    */
   double Optimize(arma::mat& iterate, const size_t maxIterations);
 
+  /**
+   * Use L-BFGS to optimize the given function, resuming the optimization
+   * described by the given state (see LBFGSState), which will be modified to
+   * describe the optimization at its end; a default-constructed state starts a
+   * new optimization.  The maximum number of iterations for this run is set in
+   * the constructor (or with MaxIterations()).  The given starting point
+   * should be the finishing point of the optimization the state describes; it
+   * will be modified to store the finishing point of this run, and the final
+   * objective value is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @param state State of the optimization to resume (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate, LBFGSState& state);
+
+  /**
+   * Use L-BFGS to optimize the given function, resuming the optimization
+   * described by the given state, and performing no more than the given
+   * maximum number of iterations in this run.
+   *
+   * @param iterate Starting point (will be modified).
+   * @param maxIterations Maximum number of iterations (0 specifies no limit).
+   * @param state State of the optimization to resume (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate,
+                  const size_t maxIterations,
+                  LBFGSState& state);
+
   //! Return the function that is being optimized.
   const FunctionType& Function() const { return function; }
   //! Modify the function that is being optimized.
@@ -173,6 +226,9 @@ class L_BFGS
   //! Best point found so far.
   std::pair<arma::mat, double> minPointIterate;
 
+  //! Counters and timings of the current optimization.
+  LBFGSStatistics statistics;
+
   /**
    * Evaluate the function at the given iterate point and store the result if it
    * is a new minimum.
@@ -181,6 +237,15 @@ class L_BFGS
    */
   double Evaluate(const arma::mat& iterate);
 
+  /**
+   * Evaluate the function and its gradient at the given iterate point (at
+   * once, if the function has EvaluateWithGradient()), and store the result if
+   * it is a new minimum.
+   *
+   * @return The value of the function.
+   */
+  double Evaluate(const arma::mat& iterate, arma::mat& gradient);
+
   /**
    * Calculate the scaling factor, gamma, which is used to scale the Hessian
    * approximation matrix.  See method M3 in Section 4 of Liu and Nocedal
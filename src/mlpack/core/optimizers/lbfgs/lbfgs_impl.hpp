@@ -73,7 +73,39 @@ double L_BFGS<FunctionType>::Evaluate(const arma::mat& iterate)
 {
   // Evaluate the function and keep track of the minimum function
   // value encountered during the optimization.
+  const timeval before = Timer::Get("lbfgs_objective");
+  Timer::Start("lbfgs_objective");
   double functionValue = function.Evaluate(iterate);
+  Timer::Stop("lbfgs_objective");
+  statistics.AddEvaluation(false, LBFGSStatistics::Seconds(
+      Timer::Get("lbfgs_objective")) - LBFGSStatistics::Seconds(before));
+
+  if (functionValue < minPointIterate.second)
+  {
+    minPointIterate.first = iterate;
+    minPointIterate.second = functionValue;
+  }
+
+  return functionValue;
+}
+
+/**
+ * Evaluate the function and its gradient at the given iterate point and store
+ * the result if it is a new minimum.
+ *
+ * @return The value of the function
+ */
+template<typename FunctionType>
+double L_BFGS<FunctionType>::Evaluate(const arma::mat& iterate,
+                                      arma::mat& gradient)
+{
+  const timeval before = Timer::Get("lbfgs_objective");
+  Timer::Start("lbfgs_objective");
+  const double functionValue = EvaluateWithGradient(function, iterate,
+      gradient);
+  Timer::Stop("lbfgs_objective");
+  statistics.AddEvaluation(true, LBFGSStatistics::Seconds(
+      Timer::Get("lbfgs_objective")) - LBFGSStatistics::Seconds(before));
 
   if (functionValue < minPointIterate.second)
   {
@@ -180,9 +212,9 @@ bool L_BFGS<FunctionType>::LineSearch(double& functionValue,
     // point.
     newIterateTmp = iterate;
     newIterateTmp += stepSize * searchDirection;
-    functionValue = Evaluate(newIterateTmp);
-    function.Gradient(newIterateTmp, gradient);
+    functionValue = Evaluate(newIterateTmp, gradient);
     numIterations++;
+    statistics.AddLineSearchTrial();
 
     if (functionValue > initialFunctionValue + stepSize *
         linearApproxFunctionValueDecrease)
@@ -227,6 +259,7 @@ bool L_BFGS<FunctionType>::LineSearch(double& functionValue,
 
   // Move to the new iterate.
   iterate = newIterateTmp;
+  statistics.StepSize(stepSize);
   return true;
 }
 
@@ -244,6 +277,9 @@ void L_BFGS<FunctionType>::SearchDirection(const arma::mat& gradient,
                                            const double scalingFactor,
                                            arma::mat& searchDirection)
 {
+  const timeval before = Timer::Get("lbfgs_search_direction");
+  Timer::Start("lbfgs_search_direction");
+
   // Start from this point.
   searchDirection = gradient;
 
@@ -278,6 +314,11 @@ void L_BFGS<FunctionType>::SearchDirection(const arma::mat& gradient,
 
   // Negate the search direction so that it is a descent direction.
   searchDirection *= -1;
+
+  Timer::Stop("lbfgs_search_direction");
+  statistics.AddSearchDirectionTime(LBFGSStatistics::Seconds(
+      Timer::Get("lbfgs_search_direction")) -
+      LBFGSStatistics::Seconds(before));
 }
 
 /**
@@ -298,11 +339,19 @@ void L_BFGS<FunctionType>::UpdateBasisSet(const size_t iterationNum,
                                           const arma::mat& gradient,
                                           const arma::mat& oldGradient)
 {
+  const timeval before = Timer::Get("lbfgs_update_basis_set");
+  Timer::Start("lbfgs_update_basis_set");
+
   // Overwrite a certain position instead of pushing everything in the vector
   // back one position.
   int overwritePos = iterationNum % numBasis;
   s.slice(overwritePos) = iterate - oldIterate;
   y.slice(overwritePos) = gradient - oldGradient;
+
+  Timer::Stop("lbfgs_update_basis_set");
+  statistics.AddUpdateBasisSetTime(LBFGSStatistics::Seconds(
+      Timer::Get("lbfgs_update_basis_set")) -
+      LBFGSStatistics::Seconds(before));
 }
 
 /**
@@ -336,15 +385,60 @@ inline double L_BFGS<FunctionType>::Optimize(arma::mat& iterate)
 template<typename FunctionType>
 double L_BFGS<FunctionType>::Optimize(arma::mat& iterate,
                                       const size_t maxIterations)
+{
+  // Start a new optimization.
+  LBFGSState state;
+  return Optimize(iterate, maxIterations, state);
+}
+
+template<typename FunctionType>
+inline double L_BFGS<FunctionType>::Optimize(arma::mat& iterate,
+                                             LBFGSState& state)
+{
+  return Optimize(iterate, maxIterations, state);
+}
+
+/**
+ * Use L_BFGS to optimize the given function, resuming the optimization
+ * described by the state, and performing no more than the specified number of
+ * maximum iterations.  The state is updated at the end, so that the
+ * optimization can be resumed again.
+ */
+template<typename FunctionType>
+double L_BFGS<FunctionType>::Optimize(arma::mat& iterate,
+                                      const size_t maxIterations,
+                                      LBFGSState& state)
 {
   // Ensure that the cubes holding past iterations' information are the right
-  // size.  Also set the current best point value to the maximum.
+  // size.  Also set the current best point value to the maximum.  If we are
+  // resuming an optimization, they are restored from the state instead.
   const size_t rows = function.GetInitialPoint().n_rows;
   const size_t cols = function.GetInitialPoint().n_cols;
 
-  s.set_size(rows, cols, numBasis);
-  y.set_size(rows, cols, numBasis);
-  minPointIterate.second = std::numeric_limits<double>::max();
+  if (state.Iteration() == 0)
+  {
+    s.set_size(rows, cols, numBasis);
+    y.set_size(rows, cols, numBasis);
+    minPointIterate.second = std::numeric_limits<double>::max();
+  }
+  else
+  {
+    if (state.S().n_rows != rows || state.S().n_cols != cols ||
+        state.S().n_slices != numBasis)
+    {
+      Log::Fatal << "L_BFGS::Optimize(): the state to resume has a basis of "
+          << "size " << state.S().n_rows << "x" << state.S().n_cols << "x"
+          << state.S().n_slices << ", but " << rows << "x" << cols << "x"
+          << numBasis << " was expected!" << std::endl;
+    }
+
+    s = state.S();
+    y = state.Y();
+    minPointIterate = state.MinPointIterate();
+  }
+
+  // Only this optimization is recorded in the statistics.
+  statistics.Reset();
 
   // The old iterate to be saved.
   arma::mat oldIterate;
@@ -353,9 +447,6 @@ double L_BFGS<FunctionType>::Optimize(arma::mat& iterate,
   // Whether to optimize until convergence.
   bool optimizeUntilConvergence = (maxIterations == 0);
 
-  // The initial function value.
-  double functionValue = Evaluate(iterate);
-
   // The gradient: the current and the old.
   arma::mat gradient;
   arma::mat oldGradient;
@@ -366,15 +457,17 @@ double L_BFGS<FunctionType>::Optimize(arma::mat& iterate,
   arma::mat searchDirection;
   searchDirection.zeros(iterate.n_rows, iterate.n_cols);
 
-  // The initial gradient value.
-  function.Gradient(iterate, gradient);
+  // The initial function value and gradient.
+  double functionValue = Evaluate(iterate, gradient);
 
-  // The main optimization loop.
-  for (size_t itNum = 0; optimizeUntilConvergence || (itNum != maxIterations);
-       ++itNum)
+  // The main optimization loop.  The iterations are numbered from the start
+  // of the optimization, because the basis is indexed by iteration number.
+  size_t itNum = state.Iteration();
+  const size_t lastIteration = itNum + maxIterations;
+  for (; optimizeUntilConvergence || (itNum != lastIteration); ++itNum)
   {
     Log::Debug << "L-BFGS iteration " << itNum << "; objective " <<
-        function.Evaluate(iterate) << "." << std::endl;
+        functionValue << "." << std::endl;
 
     // Break when the norm of the gradient becomes too small.
     if (GradientNormTooSmall(gradient))
@@ -384,6 +477,8 @@ double L_BFGS<FunctionType>::Optimize(arma::mat& iterate,
       break;
     }
 
+    statistics.StartIteration();
+
     // Choose the scaling factor.
     double scalingFactor = ChooseScalingFactor(itNum, gradient);
 
@@ -416,7 +511,17 @@ double L_BFGS<FunctionType>::Optimize(arma::mat& iterate,
 
   } // End of the optimization loop.
 
-  return function.Evaluate(iterate);
+  statistics.EndIteration();
+  const double objective = Evaluate(iterate);
+  Log::Debug << statistics.ToString();
+
+  // Save the state, so that the optimization can be resumed.
+  state.Iteration() = itNum;
+  state.S() = s;
+  state.Y() = y;
+  state.MinPointIterate() = minPointIterate;
+
+  return objective;
 }
 
 // Convert the object to a string.
@@ -0,0 +1,60 @@
+/**
+ * @file lbfgs_state.cpp
+ *
+ * Implementation of the LBFGSState class.
+ */
+#include "lbfgs_state.hpp"
+
+using namespace mlpack;
+using namespace mlpack::optimization;
+
+LBFGSState::LBFGSState() :
+    iteration(0),
+    minPointIterate(arma::mat(), std::numeric_limits<double>::max())
+{ /* Nothing to do. */ }
+
+void LBFGSState::Save(util::SaveRestoreUtility& sr) const
+{
+  sr.SaveParameter(iteration, "iteration");
+  sr.SaveParameter(s.n_rows, "rows");
+  sr.SaveParameter(s.n_cols, "cols");
+  sr.SaveParameter(s.n_slices, "slices");
+
+  // A new optimization has no basis and no best point yet.
+  if (iteration == 0)
+    return;
+
+  // Each slice of the cubes is saved as a column.
+  sr.SaveParameter(arma::mat(s.memptr(), s.n_rows * s.n_cols, s.n_slices),
+      "s");
+  sr.SaveParameter(arma::mat(y.memptr(), y.n_rows * y.n_cols, y.n_slices),
+      "y");
+  sr.SaveParameter(minPointIterate.first, "minPoint");
+  sr.SaveParameter(minPointIterate.second, "minValue");
+}
+
+void LBFGSState::Load(const util::SaveRestoreUtility& sr)
+{
+  size_t rows, cols, slices;
+  sr.LoadParameter(iteration, "iteration");
+  sr.LoadParameter(rows, "rows");
+  sr.LoadParameter(cols, "cols");
+  sr.LoadParameter(slices, "slices");
+
+  if (iteration == 0)
+  {
+    s.reset();
+    y.reset();
+    minPointIterate.first.reset();
+    minPointIterate.second = std::numeric_limits<double>::max();
+    return;
+  }
+
+  arma::mat slicesAsColumns;
+  sr.LoadParameter(slicesAsColumns, "s");
+  s = arma::cube(slicesAsColumns.memptr(), rows, cols, slices);
+  sr.LoadParameter(slicesAsColumns, "y");
+  y = arma::cube(slicesAsColumns.memptr(), rows, cols, slices);
+  sr.LoadParameter(minPointIterate.first, "minPoint");
+  sr.LoadParameter(minPointIterate.second, "minValue");
+}
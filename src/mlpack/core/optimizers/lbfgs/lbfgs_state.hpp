@@ -0,0 +1,90 @@
+/**
+ * @file lbfgs_state.hpp
+ *
+ * The state of an L-BFGS optimization, which can be saved and used to resume
+ * the optimization later.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_LBFGS_LBFGS_STATE_HPP
+#define __MLPACK_CORE_OPTIMIZERS_LBFGS_LBFGS_STATE_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * The state of an L-BFGS optimization: the number of iterations done, the s
+ * and y matrices of the basis (the memory of the Hessian approximation), and
+ * the best point found so far.  Together with the iterate, this is all
+ * L_BFGS::Optimize() needs to resume an optimization, so a long optimization
+ * can be checkpointed and continued later:
+ *
+ * @code
+ * L_BFGS<FunctionType> lbfgs(f);
+ * LBFGSState state;
+ * arma::mat iterate = f.GetInitialPoint();
+ *
+ * // Run 100 iterations at a time, and save a checkpoint after each run.
+ * lbfgs.Optimize(iterate, 100, state);
+ * util::SaveRestoreUtility sr;
+ * state.Save(sr);
+ * sr.SaveParameter(iterate, "iterate");
+ * sr.WriteFile("checkpoint.xml");
+ *
+ * // Later (possibly in another process), resume from the checkpoint.
+ * sr.ReadFile("checkpoint.xml");
+ * state.Load(sr);
+ * sr.LoadParameter(iterate, "iterate");
+ * lbfgs.Optimize(iterate, 100, state);
+ * @endcode
+ *
+ * A default-constructed state starts a new optimization.
+ */
+class LBFGSState
+{
+ public:
+  //! Create the state of a new optimization.
+  LBFGSState();
+
+  //! Get the number of iterations done.
+  size_t Iteration() const { return iteration; }
+  //! Modify the number of iterations done.
+  size_t& Iteration() { return iteration; }
+
+  //! Get the s matrices of the basis.
+  const arma::cube& S() const { return s; }
+  //! Modify the s matrices of the basis.
+  arma::cube& S() { return s; }
+
+  //! Get the y matrices of the basis.
+  const arma::cube& Y() const { return y; }
+  //! Modify the y matrices of the basis.
+  arma::cube& Y() { return y; }
+
+  //! Get the best point found so far, and its objective.
+  const std::pair<arma::mat, double>& MinPointIterate() const
+  { return minPointIterate; }
+  //! Modify the best point found so far, and its objective.
+  std::pair<arma::mat, double>& MinPointIterate() { return minPointIterate; }
+
+  //! Save the state to a SaveRestoreUtility.
+  void Save(util::SaveRestoreUtility& sr) const;
+
+  //! Load the state from a SaveRestoreUtility.
+  void Load(const util::SaveRestoreUtility& sr);
+
+ private:
+  //! The number of iterations done.
+  size_t iteration;
+  //! The s matrices of the basis.
+  arma::cube s;
+  //! The y matrices of the basis.
+  arma::cube y;
+  //! The best point found so far, and its objective.
+  std::pair<arma::mat, double> minPointIterate;
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
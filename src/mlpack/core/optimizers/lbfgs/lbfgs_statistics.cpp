@@ -0,0 +1,121 @@
+/**
+ * @file lbfgs_statistics.cpp
+ *
+ * Implementation of the LBFGSStatistics class.
+ */
+#include "lbfgs_statistics.hpp"
+
+using namespace mlpack;
+using namespace mlpack::optimization;
+
+LBFGSStatistics::LBFGSStatistics()
+{
+  Reset();
+}
+
+void LBFGSStatistics::Reset()
+{
+  functionEvaluations = 0;
+  gradientEvaluations = 0;
+  totalLineSearchTrials = 0;
+  objectiveTime = 0;
+  searchDirectionTime = 0;
+  updateBasisSetTime = 0;
+
+  iterationFunctionEvaluations.clear();
+  iterationGradientEvaluations.clear();
+  lineSearchTrials.clear();
+  stepSizes.clear();
+  iterationObjectiveTimes.clear();
+  iterationSearchDirectionTimes.clear();
+  iterationUpdateBasisSetTimes.clear();
+  inIteration = false;
+}
+
+void LBFGSStatistics::StartIteration()
+{
+  iterationFunctionEvaluations.push_back(0);
+  iterationGradientEvaluations.push_back(0);
+  lineSearchTrials.push_back(0);
+  stepSizes.push_back(0);
+  iterationObjectiveTimes.push_back(0);
+  iterationSearchDirectionTimes.push_back(0);
+  iterationUpdateBasisSetTimes.push_back(0);
+  inIteration = true;
+}
+
+void LBFGSStatistics::EndIteration()
+{
+  inIteration = false;
+}
+
+void LBFGSStatistics::AddEvaluation(const bool computeGradient,
+                                    const double seconds)
+{
+  ++functionEvaluations;
+  if (computeGradient)
+    ++gradientEvaluations;
+  objectiveTime += seconds;
+
+  // Evaluations outside of an iteration only count towards the totals.
+  if (!inIteration)
+    return;
+
+  ++iterationFunctionEvaluations.back();
+  if (computeGradient)
+    ++iterationGradientEvaluations.back();
+  iterationObjectiveTimes.back() += seconds;
+}
+
+void LBFGSStatistics::AddLineSearchTrial()
+{
+  ++totalLineSearchTrials;
+  ++lineSearchTrials.back();
+}
+
+void LBFGSStatistics::StepSize(const double stepSize)
+{
+  stepSizes.back() = stepSize;
+}
+
+void LBFGSStatistics::AddSearchDirectionTime(const double seconds)
+{
+  searchDirectionTime += seconds;
+  iterationSearchDirectionTimes.back() += seconds;
+}
+
+void LBFGSStatistics::AddUpdateBasisSetTime(const double seconds)
+{
+  updateBasisSetTime += seconds;
+  iterationUpdateBasisSetTimes.back() += seconds;
+}
+
+double LBFGSStatistics::Seconds(const timeval& time)
+{
+  return time.tv_sec + time.tv_usec / 1e6;
+}
+
+std::string LBFGSStatistics::ToString() const
+{
+  std::ostringstream stream;
+  stream << "L-BFGS: " << Iterations() << " iterations, "
+      << functionEvaluations << " function evaluations, "
+      << gradientEvaluations << " gradient evaluations, "
+      << totalLineSearchTrials << " line search trials." << std::endl;
+  stream << "L-BFGS: " << objectiveTime << "s evaluating the function, "
+      << searchDirectionTime << "s computing search directions, "
+      << updateBasisSetTime << "s updating the basis set." << std::endl;
+
+  for (size_t i = 0; i < Iterations(); ++i)
+  {
+    stream << "L-BFGS iteration " << i << ": "
+        << iterationFunctionEvaluations[i] << " function evaluations, "
+        << iterationGradientEvaluations[i] << " gradient evaluations, "
+        << lineSearchTrials[i] << " line search trials, step size "
+        << stepSizes[i] << "; " << iterationObjectiveTimes[i] << "s objective, "
+        << iterationSearchDirectionTimes[i] << "s search direction, "
+        << iterationUpdateBasisSetTimes[i] << "s basis update." << std::endl;
+  }
+
+  return stream.str();
+}
@@ -0,0 +1,146 @@
+/**
+ * @file lbfgs_statistics.hpp
+ *
+ * Counters and timings of an L-BFGS optimization, for profiling the optimizer
+ * and the function it optimizes.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_LBFGS_LBFGS_STATISTICS_HPP
+#define __MLPACK_CORE_OPTIMIZERS_LBFGS_LBFGS_STATISTICS_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * Counters and timings of an L-BFGS optimization.  For each iteration, this
+ * records the number of function and gradient evaluations, the number of line
+ * search trials, the step size the line search accepted (0 if it failed), and
+ * the time (in seconds) spent evaluating the function, computing the search
+ * direction, and updating the basis set.  The totals over the optimization are
+ * also kept; they include the evaluations done outside of any iteration (at
+ * the starting and finishing points), so they may be larger than the sums of
+ * the per-iteration values.
+ *
+ * L_BFGS resets its statistics at the start of each call to Optimize(); they
+ * can be obtained with L_BFGS::Statistics() once it returns.  The same times
+ * are accumulated in the "lbfgs_objective", "lbfgs_search_direction", and
+ * "lbfgs_update_basis_set" timers (see Timer), so they are also printed with
+ * the other timers of a program run with --verbose.
+ */
+class LBFGSStatistics
+{
+ public:
+  //! Create empty statistics.
+  LBFGSStatistics();
+
+  //! Clear all the counters and timings.
+  void Reset();
+
+  //! Start recording a new iteration (ending the current one).
+  void StartIteration();
+
+  //! End the current iteration; later evaluations only count in the totals.
+  void EndIteration();
+
+  /**
+   * Record an evaluation of the function (and its gradient, if computeGradient
+   * is true), which took the given time.
+   */
+  void AddEvaluation(const bool computeGradient, const double seconds);
+
+  //! Record a trial of the line search of the current iteration.
+  void AddLineSearchTrial();
+
+  //! Record the step size accepted by the line search of this iteration.
+  void StepSize(const double stepSize);
+
+  //! Record the time spent computing the search direction.
+  void AddSearchDirectionTime(const double seconds);
+
+  //! Record the time spent updating the basis set.
+  void AddUpdateBasisSetTime(const double seconds);
+
+  /**
+   * Return the time in seconds held by the given timer; the difference of two
+   * such values taken around a Timer::Start()/Timer::Stop() pair is the time
+   * of that run of the timer.
+   */
+  static double Seconds(const timeval& time);
+
+  //! Get the number of iterations recorded.
+  size_t Iterations() const { return lineSearchTrials.size(); }
+
+  //! Get the total number of function evaluations.
+  size_t FunctionEvaluations() const { return functionEvaluations; }
+  //! Get the total number of gradient evaluations.
+  size_t GradientEvaluations() const { return gradientEvaluations; }
+  //! Get the total number of line search trials.
+  size_t LineSearchTrials() const { return totalLineSearchTrials; }
+  //! Get the total time spent evaluating the function.
+  double ObjectiveTime() const { return objectiveTime; }
+  //! Get the total time spent computing search directions.
+  double SearchDirectionTime() const { return searchDirectionTime; }
+  //! Get the total time spent updating the basis set.
+  double UpdateBasisSetTime() const { return updateBasisSetTime; }
+
+  //! Get the number of function evaluations of each iteration.
+  const std::vector<size_t>& IterationFunctionEvaluations() const
+  { return iterationFunctionEvaluations; }
+  //! Get the number of gradient evaluations of each iteration.
+  const std::vector<size_t>& IterationGradientEvaluations() const
+  { return iterationGradientEvaluations; }
+  //! Get the number of line search trials of each iteration.
+  const std::vector<size_t>& IterationLineSearchTrials() const
+  { return lineSearchTrials; }
+  //! Get the step size accepted by the line search of each iteration.
+  const std::vector<double>& IterationStepSizes() const { return stepSizes; }
+  //! Get the time spent evaluating the function in each iteration.
+  const std::vector<double>& IterationObjectiveTimes() const
+  { return iterationObjectiveTimes; }
+  //! Get the time spent computing the search direction in each iteration.
+  const std::vector<double>& IterationSearchDirectionTimes() const
+  { return iterationSearchDirectionTimes; }
+  //! Get the time spent updating the basis set in each iteration.
+  const std::vector<double>& IterationUpdateBasisSetTimes() const
+  { return iterationUpdateBasisSetTimes; }
+
+  //! Return the totals and the per-iteration values as a string.
+  std::string ToString() const;
+
+ private:
+  //! The total number of function evaluations.
+  size_t functionEvaluations;
+  //! The total number of gradient evaluations.
+  size_t gradientEvaluations;
+  //! The total number of line search trials.
+  size_t totalLineSearchTrials;
+  //! The total time spent evaluating the function.
+  double objectiveTime;
+  //! The total time spent computing search directions.
+  double searchDirectionTime;
+  //! The total time spent updating the basis set.
+  double updateBasisSetTime;
+
+  //! The number of function evaluations of each iteration.
+  std::vector<size_t> iterationFunctionEvaluations;
+  //! The number of gradient evaluations of each iteration.
+  std::vector<size_t> iterationGradientEvaluations;
+  //! The number of line search trials of each iteration.
+  std::vector<size_t> lineSearchTrials;
+  //! The step size accepted by the line search of each iteration.
+  std::vector<double> stepSizes;
+  //! The time spent evaluating the function in each iteration.
+  std::vector<double> iterationObjectiveTimes;
+  //! The time spent computing the search direction in each iteration.
+  std::vector<double> iterationSearchDirectionTimes;
+  //! The time spent updating the basis set in each iteration.
+  std::vector<double> iterationUpdateBasisSetTimes;
+  //! Whether an iteration is being recorded.
+  bool inIteration;
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
@@ -27,7 +27,8 @@ class LRSDP
   /**
    * Create an LRSDP to be optimized.  The solution will end up being a matrix
    * of size (rank) x (rows).  To construct each constraint and the objective
-   * function, use the functions A(), B(), and C() to set them correctly.
+   * function, use the functions A(), B(), and C() (or SparseA() and SparseC())
+   * to set them correctly.
    *
    * @param numConstraints Number of constraints in the problem.
    * @param rank Rank of the solution (<= rows).
@@ -62,12 +63,24 @@ class LRSDP
   //! Modify the objective function matrix (C).
   arma::mat& C() { return function.C(); }
 
+  //! Return the sparse part of the objective function matrix (C).
+  const arma::sp_mat& SparseC() const { return function.SparseC(); }
+  //! Modify the sparse part of the objective function matrix (C).
+  arma::sp_mat& SparseC() { return function.SparseC(); }
+
   //! Return the vector of A matrices (which correspond to the constraints).
   const std::vector<arma::mat>& A() const { return function.A(); }
   //! Modify the veector of A matrices (which correspond to the constraints).
   std::vector<arma::mat>& A() { return function.A(); }
 
-  //! Return the vector of modes for the A matrices.
+  //! Return the vector of sparse A matrices (used by constraints of mode 2).
+  const std::vector<arma::sp_mat>& SparseA() const
+  { return function.SparseA(); }
+  //! Modify the vector of sparse A matrices (used by constraints of mode 2).
+  std::vector<arma::sp_mat>& SparseA() { return function.SparseA(); }
+
+  //! Return the vector of modes for the A matrices (0 for dense, 1 for a list
+  //! of entries, 2 for sparse; see LRSDPFunction).
   const arma::uvec& AModes() const { return function.AModes(); }
   //! Modify the vector of modes for the A matrices.
   arma::uvec& AModes() { return function.AModes(); }
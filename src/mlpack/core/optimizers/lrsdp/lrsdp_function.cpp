@@ -14,14 +14,125 @@ using namespace mlpack::optimization;
 LRSDPFunction::LRSDPFunction(const size_t numConstraints,
                              const arma::mat& initialPoint):
     a(numConstraints),
+    sparseA(numConstraints),
     b(numConstraints),
     initialPoint(initialPoint),
     aModes(numConstraints)
 { }
 
+namespace mlpack {
+namespace optimization {
+
+/**
+ * Compute R^T a for a rank-one constraint (mode 3), where a is given as a list
+ * of entries; rt must be trans(coordinates).
+ */
+static arma::vec RankOneProjection(const arma::mat& a, const arma::mat& rt)
+{
+  arma::vec projection = arma::zeros<arma::vec>(rt.n_rows);
+  for (size_t i = 0; i < a.n_cols; ++i)
+    projection += a(1, i) * rt.col((size_t) a(0, i));
+
+  return projection;
+}
+
+/**
+ * Compute Tr(C R R^T) = accu(R % (C R)), without forming R R^T.
+ */
+static double EvaluateObjective(const LRSDPFunction& function,
+                                const arma::mat& coordinates)
+{
+  double objective = 0.0;
+  if (function.C().n_elem > 0)
+    objective += accu(coordinates % (function.C() * coordinates));
+  if (function.SparseC().n_nonzero > 0)
+    objective += accu(coordinates % (function.SparseC() * coordinates));
+
+  return objective;
+}
+
+/**
+ * Compute Tr(A_i R R^T) - b_i, without forming R R^T.  rt must be
+ * trans(coordinates), so that the rows of R are contiguous for the dot products
+ * of constraints which are lists of entries.
+ */
+static double EvaluateConstraint(const LRSDPFunction& function,
+                                 const size_t index,
+                                 const arma::mat& coordinates,
+                                 const arma::mat& rt)
+{
+  double value = -function.B()[index];
+
+  if (function.AModes()[index] == 0)
+  {
+    value += accu(coordinates % (function.A()[index] * coordinates));
+  }
+  else if (function.AModes()[index] == 1)
+  {
+    // (R R^T)(j, k) is the dot product of rows j and k of R.
+    const arma::mat& a = function.A()[index];
+    for (size_t i = 0; i < a.n_cols; ++i)
+      value += a(2, i) * dot(rt.col((size_t) a(0, i)),
+          rt.col((size_t) a(1, i)));
+  }
+  else if (function.AModes()[index] == 2)
+  {
+    value += accu(coordinates % (function.SparseA()[index] * coordinates));
+  }
+  else
+  {
+    // Tr(a a^T R R^T) = || R^T a ||^2.
+    const arma::vec projection = RankOneProjection(function.A()[index], rt);
+    value += dot(projection, projection);
+  }
+
+  return value;
+}
+
+/**
+ * Add scale * (A_i R) to the gradient.  Constraints which are lists of entries
+ * add their rows to the transposed gradient, gradientT, where they are
+ * contiguous; rt must be trans(coordinates).
+ */
+static void AddConstraintGradient(const LRSDPFunction& function,
+                                  const size_t index,
+                                  const double scale,
+                                  const arma::mat& coordinates,
+                                  const arma::mat& rt,
+                                  arma::mat& gradient,
+                                  arma::mat& gradientT)
+{
+  if (function.AModes()[index] == 0)
+  {
+    gradient += scale * (function.A()[index] * coordinates);
+  }
+  else if (function.AModes()[index] == 1)
+  {
+    const arma::mat& a = function.A()[index];
+    for (size_t i = 0; i < a.n_cols; ++i)
+      gradientT.col((size_t) a(0, i)) += (scale * a(2, i)) *
+          rt.col((size_t) a(1, i));
+  }
+  else if (function.AModes()[index] == 2)
+  {
+    gradient += scale * (function.SparseA()[index] * coordinates);
+  }
+  else
+  {
+    // A_i R = a (R^T a)^T, so only the rows of the nonzero entries of a change.
+    const arma::mat& a = function.A()[index];
+    const arma::vec projection = RankOneProjection(a, rt);
+    for (size_t i = 0; i < a.n_cols; ++i)
+      gradientT.col((size_t) a(0, i)) += (scale * a(1, i)) * projection;
+  }
+}
+
+}; // namespace optimization
+}; // namespace mlpack
+
 double LRSDPFunction::Evaluate(const arma::mat& coordinates) const
 {
-  return -accu(coordinates * trans(coordinates));
+  return EvaluateObjective(*this, coordinates);
 }
 
 void LRSDPFunction::Gradient(const arma::mat& /* coordinates */,
@@ -34,17 +145,8 @@ void LRSDPFunction::Gradient(const arma::mat& /* coordinates */,
 double LRSDPFunction::EvaluateConstraint(const size_t index,
                                  const arma::mat& coordinates) const
 {
-  arma::mat rrt = coordinates * trans(coordinates);
-  if (aModes[index] == 0)
-    return trace(a[index] * rrt) - b[index];
-  else
-  {
-    double value = -b[index];
-    for (size_t i = 0; i < a[index].n_cols; ++i)
-      value += a[index](2, i) * rrt(a[index](0, i), a[index](1, i));
-
-    return value;
-  }
+  return optimization::EvaluateConstraint(*this, index, coordinates,
+      trans(coordinates));
 }
 
 void LRSDPFunction::GradientConstraint(const size_t /* index */,
@@ -67,6 +169,8 @@ std::string LRSDPFunction::ToString() const
   convert << "  Constraint b_i values: " << b.t();
   convert << "  Objective matrix (C) size: " << c.n_rows << "x" << c.n_cols
       << std::endl;
+  convert << "  Sparse objective matrix (C) nonzeros: " << sparseC.n_nonzero
+      << std::endl;
   return convert.str();
 }
 
@@ -82,30 +186,18 @@ double AugLagrangianFunction<LRSDPFunction>::Evaluate(
   // L(R, y, s) = Tr(C * (R R^T)) -
   //     sum_{i = 1}^{m} (y_i (Tr(A_i * (R R^T)) - b_i)) +
   //     (sigma / 2) * sum_{i = 1}^{m} (Tr(A_i * (R R^T)) - b_i)^2
+  // None of the traces need R R^T itself.
 
   // Let's start with the objective: Tr(C * (R R^T)).
-  // Simple, possibly slow solution.
-  arma::mat rrt = coordinates * trans(coordinates);
-  double objective = trace(function.C() * rrt);
+  double objective = EvaluateObjective(function, coordinates);
 
   // Now each constraint.
+  const arma::mat rt = trans(coordinates);
   for (size_t i = 0; i < function.B().n_elem; ++i)
   {
     // Take the trace subtracted by the b_i.
-    double constraint = -function.B()[i];
-
-    if (function.AModes()[i] == 0)
-    {
-      constraint += trace(function.A()[i] * rrt);
-    }
-    else
-    {
-      for (size_t j = 0; j < function.A()[i].n_cols; ++j)
-      {
-        constraint += function.A()[i](2, j) *
-            rrt(function.A()[i](0, j), function.A()[i](1, j));
-      }
-    }
+    const double constraint = EvaluateConstraint(function, i, coordinates,
+        rt);
 
     objective -= (lambda[i] * constraint);
     objective += (sigma / 2) * std::pow(constraint, 2.0);
@@ -125,45 +217,29 @@ void AugLagrangianFunction<LRSDPFunction>::Gradient(
   //   with
   // S' = C - sum_{i = 1}^{m} y'_i A_i
   // y'_i = y_i - sigma * (Trace(A_i * (R R^T)) - b_i)
-  arma::mat rrt = coordinates * trans(coordinates);
-  arma::mat s = function.C();
-
+  // S' is never formed; instead, each term is multiplied by R separately.
+  gradient.zeros(coordinates.n_rows, coordinates.n_cols);
+  if (function.C().n_elem > 0)
+    gradient += function.C() * coordinates;
+  if (function.SparseC().n_nonzero > 0)
+    gradient += function.SparseC() * coordinates;
+
+  const arma::mat rt = trans(coordinates);
+  arma::mat gradientT = arma::zeros<arma::mat>(coordinates.n_cols,
+      coordinates.n_rows);
   for (size_t i = 0; i < function.B().n_elem; ++i)
   {
-    double constraint = -function.B()[i];
-
-    if (function.AModes()[i] == 0)
-    {
-      constraint += trace(function.A()[i] * rrt);
-    }
-    else
-    {
-      for (size_t j = 0; j < function.A()[i].n_cols; ++j)
-      {
-        constraint += function.A()[i](2, j) *
-            rrt(function.A()[i](0, j), function.A()[i](1, j));
-      }
-    }
-
-    double y = lambda[i] - sigma * constraint;
-
-    if (function.AModes()[i] == 0)
-    {
-      s -= (y * function.A()[i]);
-    }
-    else
-    {
-      // We only need to subtract the entries which could be modified.
-      for (size_t j = 0; j < function.A()[i].n_cols; ++j)
-      {
-        s(function.A()[i](0, j), function.A()[i](1, j)) -= y;
-      }
-    }
+    const double constraint = EvaluateConstraint(function, i, coordinates,
+        rt);
+
+    const double y = lambda[i] - sigma * constraint;
+
+    AddConstraintGradient(function, i, -y, coordinates, rt, gradient,
+        gradientT);
   }
 
-  gradient = 2 * s * coordinates;
+  gradient = 2 * (gradient + trans(gradientT));
 }
 
 }; // namespace optimization
 }; // namespace mlpack
-
@@ -16,6 +16,25 @@ namespace optimization {
 
 /**
  * The objective function that LRSDP is trying to optimize.
+ *
+ * The objective matrix C is the sum of the dense C() and the sparse
+ * SparseC(); either can be left empty.  Each constraint matrix A_i is given in
+ * one of four ways, according to AModes()[i]:
+ *
+ *  - 0: A()[i] is the dense matrix A_i.
+ *  - 1: A()[i] is a 3 x k matrix listing the nonzero entries of A_i; each
+ *    column holds a row index, a column index, and a value.
+ *  - 2: SparseA()[i] is the sparse matrix A_i.
+ *  - 3: A_i is the rank-one matrix a a^T, and A()[i] is a 2 x k matrix listing
+ *    the nonzero entries of the vector a; each column holds an index and a
+ *    value.  Then Tr(A_i R R^T) = || R^T a ||^2, so, for instance, a distance
+ *    constraint || R_j - R_k ||^2 = b only needs two entries.
+ *
+ * C and each A_i should be symmetric (so each entry list should list both
+ * (j, k) and (k, j)).  The solution R R^T is never formed: traces are computed
+ * through the products C R and A_i R, entry lists through dot products of the
+ * rows of R, and rank-one constraints through R^T a, so the memory used is
+ * O(n r) for an n x r solution (plus that of the dense matrices, if any).
  */
 class LRSDPFunction
 {
@@ -64,11 +83,21 @@ class LRSDPFunction
   //! Modify the objective function matrix (C).
   arma::mat& C() { return c; }
 
+  //! Return the sparse part of the objective function matrix (C).
+  const arma::sp_mat& SparseC() const { return sparseC; }
+  //! Modify the sparse part of the objective function matrix (C).
+  arma::sp_mat& SparseC() { return sparseC; }
+
   //! Return the vector of A matrices (which correspond to the constraints).
   const std::vector<arma::mat>& A() const { return a; }
   //! Modify the veector of A matrices (which correspond to the constraints).
   std::vector<arma::mat>& A() { return a; }
 
+  //! Return the vector of sparse A matrices (used by constraints of mode 2).
+  const std::vector<arma::sp_mat>& SparseA() const { return sparseA; }
+  //! Modify the vector of sparse A matrices (used by constraints of mode 2).
+  std::vector<arma::sp_mat>& SparseA() { return sparseA; }
+
   //! Return the vector of modes for the A matrices.
   const arma::uvec& AModes() const { return aModes; }
   //! Modify the vector of modes for the A matrices.
@@ -85,14 +114,18 @@ class LRSDPFunction
  private:
   //! Objective function matrix c.
   arma::mat c;
+  //! Sparse part of the objective function matrix c.
+  arma::sp_mat sparseC;
   //! A_i for each constraint.
   std::vector<arma::mat> a;
+  //! Sparse A_i for each constraint of mode 2.
+  std::vector<arma::sp_mat> sparseA;
   //! b_i for each constraint.
   arma::vec b;
 
   //! Initial point.
   arma::mat initialPoint;
-  //! 1 if entries in matrix, 0 for normal.
+  //! 0 for dense, 1 if entries in matrix, 2 for sparse, 3 for rank-one.
   arma::uvec aModes;
 };
 
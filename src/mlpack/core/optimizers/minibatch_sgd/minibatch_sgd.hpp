@@ -0,0 +1,150 @@
+/**
+ * @file minibatch_sgd.hpp
+ *
+ * Mini-batch Stochastic Gradient Descent.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_MINIBATCH_SGD_HPP
+#define __MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_MINIBATCH_SGD_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * Mini-batch Stochastic Gradient Descent is a variant of SGD (see
+ * mlpack::optimization::SGD) which uses the average of the gradients of a
+ * batch of functions at each step, instead of the gradient of a single
+ * function:
+ *
+ * \f[
+ * A_{j + 1} = A_j - \frac{\alpha}{b} \sum_{i = k}^{k + b - 1} \nabla f_i(A)
+ * \f]
+ *
+ * where \f$ b \f$ is the batch size, and the batches are contiguous ranges of
+ * functions.  The batches are visited linearly, or in a random order.  Because
+ * the gradient of a batch is computed by one call, the function can compute it
+ * with matrix operations over many points at once; and because the step is
+ * the average gradient, the step size has the same meaning as for SGD.
+ *
+ * The objective function is computed (in batches, too) only at the start and
+ * after each full pass over the batches; the algorithm terminates when the
+ * maximum number of iterations (steps) is reached, or when a full pass
+ * improves the objective by less than the tolerance.
+ *
+ * For mini-batch SGD to work, a DecomposableFunctionType template parameter is
+ * required.  This class must implement the following functions:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates,
+ *                   const size_t begin,
+ *                   const size_t batchSize);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t begin,
+ *                 const size_t batchSize,
+ *                 arma::mat& gradient);
+ *
+ * Evaluate() should return the sum of the objectives of the functions begin
+ * to (begin + batchSize - 1), and Gradient() should store the sum of their
+ * gradients.
+ *
+ * @tparam DecomposableFunctionType Decomposable objective function type to be
+ *     minimized.
+ */
+template<typename DecomposableFunctionType>
+class MiniBatchSGD
+{
+ public:
+  /**
+   * Construct the mini-batch SGD optimizer with the given function and
+   * parameters.
+   *
+   * @param function Function to be optimized (minimized).
+   * @param stepSize Step size for each iteration.
+   * @param batchSize Number of functions in each batch.
+   * @param maxIterations Maximum number of iterations (steps) allowed (0 means
+   *     no limit).
+   * @param tolerance Maximum absolute tolerance to terminate algorithm.
+   * @param shuffle If true, the batch order is shuffled; otherwise, each batch
+   *     is visited in linear order.
+   */
+  MiniBatchSGD(DecomposableFunctionType& function,
+               const double stepSize = 0.01,
+               const size_t batchSize = 32,
+               const size_t maxIterations = 100000,
+               const double tolerance = 1e-5,
+               const bool shuffle = true);
+
+  /**
+   * Optimize the given function using mini-batch stochastic gradient descent.
+   * The given starting point will be modified to store the finishing point of
+   * the algorithm, and the final objective value is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate);
+
+  //! Get the instantiated function to be optimized.
+  const DecomposableFunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  DecomposableFunctionType& Function() { return function; }
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the batch size.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the batch size.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the maximum number of iterations (0 indicates no limit).
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations (0 indicates no limit).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the batches are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the batches are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+  // Convert the object into a string.
+  std::string ToString() const;
+
+ private:
+  //! The instantiated function.
+  DecomposableFunctionType& function;
+
+  //! The step size for each batch.
+  double stepSize;
+
+  //! The number of functions in each batch.
+  size_t batchSize;
+
+  //! The maximum number of allowed iterations.
+  size_t maxIterations;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! Controls whether or not the batches are shuffled when iterating.
+  bool shuffle;
+
+  //! Evaluate the full objective function, one batch at a time.
+  double Evaluate(const arma::mat& iterate);
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+// Include implementation.
+#include "minibatch_sgd_impl.hpp"
+
+#endif
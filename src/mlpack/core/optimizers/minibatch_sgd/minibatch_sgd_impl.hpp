@@ -0,0 +1,141 @@
+/**
+ * @file minibatch_sgd_impl.hpp
+ *
+ * Implementation of mini-batch stochastic gradient descent.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_MINIBATCH_SGD_IMPL_HPP
+#define __MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_MINIBATCH_SGD_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "minibatch_sgd.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename DecomposableFunctionType>
+MiniBatchSGD<DecomposableFunctionType>::MiniBatchSGD(
+    DecomposableFunctionType& function,
+    const double stepSize,
+    const size_t batchSize,
+    const size_t maxIterations,
+    const double tolerance,
+    const bool shuffle) :
+    function(function),
+    stepSize(stepSize),
+    batchSize(batchSize),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    shuffle(shuffle)
+{ /* Nothing to do. */ }
+
+//! Optimize the function (minimize).
+template<typename DecomposableFunctionType>
+double MiniBatchSGD<DecomposableFunctionType>::Optimize(arma::mat& iterate)
+{
+  if (batchSize == 0)
+  {
+    Log::Fatal << "MiniBatchSGD::Optimize(): batch size must be greater than "
+        << "0!" << std::endl;
+  }
+
+  // Find the number of functions and batches to use.
+  const size_t numFunctions = function.NumFunctions();
+  const size_t numBatches = (numFunctions + batchSize - 1) / batchSize;
+
+  // The order of visitation of the batches.
+  arma::uvec visitationOrder = arma::linspace<arma::uvec>(0, numBatches - 1,
+      numBatches);
+
+  // To keep track of where we are and how things are going.
+  size_t currentBatch = 0;
+  double overallObjective = Evaluate(iterate);
+  double lastObjective = DBL_MAX;
+
+  // Now iterate!
+  arma::mat gradient(iterate.n_rows, iterate.n_cols);
+  for (size_t i = 0; (maxIterations == 0) || (i < maxIterations); ++i)
+  {
+    // Is this iteration the start of a pass over the batches?
+    if (currentBatch == 0)
+    {
+      // Output current objective function.
+      Log::Info << "Mini-batch SGD: iteration " << i << ", objective "
+          << overallObjective << "." << std::endl;
+
+      if (overallObjective != overallObjective)
+      {
+        Log::Warn << "Mini-batch SGD: converged to " << overallObjective
+            << "; terminating with failure.  Try a smaller step size?"
+            << std::endl;
+        return overallObjective;
+      }
+
+      if (std::abs(lastObjective - overallObjective) < tolerance)
+      {
+        Log::Info << "Mini-batch SGD: minimized within tolerance " << tolerance
+            << "; terminating optimization." << std::endl;
+        return overallObjective;
+      }
+
+      lastObjective = overallObjective;
+
+      if (shuffle) // Determine order of visitation.
+        visitationOrder = arma::shuffle(visitationOrder);
+    }
+
+    // The last batch may be smaller than the others.
+    const size_t begin = visitationOrder[currentBatch] * batchSize;
+    const size_t effectiveBatchSize = std::min(batchSize, numFunctions - begin);
+
+    // Evaluate the gradient of the batch, and take a step along its average.
+    function.Gradient(iterate, begin, effectiveBatchSize, gradient);
+    iterate -= (stepSize / effectiveBatchSize) * gradient;
+
+    // At the end of a pass, compute the objective for the convergence check.
+    if (++currentBatch == numBatches)
+    {
+      currentBatch = 0;
+      overallObjective = Evaluate(iterate);
+    }
+  }
+
+  Log::Info << "Mini-batch SGD: maximum iterations (" << maxIterations
+      << ") reached; terminating optimization." << std::endl;
+  return Evaluate(iterate);
+}
+
+template<typename DecomposableFunctionType>
+double MiniBatchSGD<DecomposableFunctionType>::Evaluate(
+    const arma::mat& iterate)
+{
+  const size_t numFunctions = function.NumFunctions();
+
+  double objective = 0;
+  for (size_t begin = 0; begin < numFunctions; begin += batchSize)
+    objective += function.Evaluate(iterate, begin, std::min(batchSize,
+        numFunctions - begin));
+
+  return objective;
+}
+
+// Convert the object to a string.
+template<typename DecomposableFunctionType>
+std::string MiniBatchSGD<DecomposableFunctionType>::ToString() const
+{
+  std::ostringstream convert;
+  convert << "MiniBatchSGD [" << this << "]" << std::endl;
+  convert << "  Function:" << std::endl;
+  convert << util::Indent(function.ToString(), 2);
+  convert << "  Step size: " << stepSize << std::endl;
+  convert << "  Batch size: " << batchSize << std::endl;
+  convert << "  Maximum iterations: " << maxIterations << std::endl;
+  convert << "  Tolerance: " << tolerance << std::endl;
+  convert << "  Shuffle batches: " << (shuffle ? "true" : "false")
+      << std::endl;
+  return convert.str();
+}
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
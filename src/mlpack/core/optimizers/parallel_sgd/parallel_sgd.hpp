@@ -0,0 +1,192 @@
+/**
+ * @file parallel_sgd.hpp
+ *
+ * Parallel, lock-free Stochastic Gradient Descent (Hogwild!).
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_PARALLEL_SGD_PARALLEL_SGD_HPP
+#define __MLPACK_CORE_OPTIMIZERS_PARALLEL_SGD_PARALLEL_SGD_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/unregularized_gradient.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * A parallel variant of SGD (see mlpack::optimization::SGD) for decomposable
+ * functions whose individual gradients are sparse, following the Hogwild!
+ * scheme:
+ *
+ * @code
+ * @inproceedings{recht2011hogwild,
+ *   title={Hogwild!: A Lock-Free Approach to Parallelizing Stochastic Gradient
+ *       Descent},
+ *   author={Recht, Benjamin and Re, Christopher and Wright, Stephen and Niu,
+ *       Feng},
+ *   booktitle={Advances in Neural Information Processing Systems 24 (NIPS
+ *       2011)},
+ *   pages={693--701},
+ *   year={2011}
+ * }
+ * @endcode
+ *
+ * Each pass over the functions is split between the threads (with OpenMP),
+ * and each thread updates the shared iterate without any locks: it computes
+ * the gradient of its function at the iterate as it currently is, and then
+ * updates only the nonzero coordinates of the gradient, each with an atomic
+ * subtraction.  When the gradients are sparse, two threads rarely update the
+ * same coordinate at once, and the reads of stale coordinates affect the
+ * convergence only slightly.  If mlpack is compiled without OpenMP, this is
+ * plain SGD with sparse updates.
+ *
+ * The objective function is computed (in parallel) only at the start and
+ * after each full pass over the functions; the algorithm terminates when the
+ * maximum number of iterations (steps) is reached, or when a full pass
+ * improves the objective by less than the tolerance.
+ *
+ * For parallel SGD to work, a DecomposableFunctionType template parameter is
+ * required.  This class must implement the following functions, which must be
+ * safe to call from several threads at once:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::sp_mat& gradient);
+ *
+ * An L2-regularization term makes every gradient dense, so each step would
+ * then take one atomic update for every coordinate.  If the function has such a
+ * term, it should also implement the methods SGD uses to apply it lazily (see
+ * mlpack::optimization::SGD and HasUnregularizedGradient):
+ *
+ *   void Support(const size_t i, arma::uvec& coordinates);
+ *   void UnregularizedGradient(const arma::mat& coordinates,
+ *                              const size_t i,
+ *                              arma::sp_mat& gradient);
+ *   void L2Regularization(arma::mat& weights);
+ *
+ * Then each step only updates the coordinates in the support of its function,
+ * and the shrinkage of the other coordinates by the L2 term is accumulated and
+ * applied when they are next read, or at the end of the pass.  The steps of
+ * each thread are numbered as if the threads took turns, so with one thread
+ * the result is the same as with dense steps; with more, the shrinkage of a
+ * coordinate which several threads update is only approximate, like the reads
+ * of stale coordinates.  Functions with neither sparse gradients nor these
+ * methods (for instance, logistic regression on dense data) still work, but
+ * gain little from the parallelism.
+ *
+ * @tparam DecomposableFunctionType Decomposable objective function type to be
+ *     minimized.
+ */
+template<typename DecomposableFunctionType>
+class ParallelSGD
+{
+ public:
+  /**
+   * Construct the parallel SGD optimizer with the given function and
+   * parameters.  The number of threads is the OpenMP default (which can be set
+   * with OmpSetNumThreads() or the OMP_NUM_THREADS environment variable).
+   *
+   * @param function Function to be optimized (minimized).
+   * @param stepSize Step size for each iteration.
+   * @param maxIterations Maximum number of iterations (steps) allowed (0 means
+   *     no limit).
+   * @param tolerance Maximum absolute tolerance to terminate algorithm.
+   * @param shuffle If true, the function order is shuffled; otherwise, each
+   *     function is visited in linear order.
+   */
+  ParallelSGD(DecomposableFunctionType& function,
+              const double stepSize = 0.01,
+              const size_t maxIterations = 100000,
+              const double tolerance = 1e-5,
+              const bool shuffle = true);
+
+  /**
+   * Optimize the given function using parallel stochastic gradient descent.
+   * The given starting point will be modified to store the finishing point of
+   * the algorithm, and the final objective value is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate);
+
+  //! Get the instantiated function to be optimized.
+  const DecomposableFunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  DecomposableFunctionType& Function() { return function; }
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the maximum number of iterations (0 indicates no limit).
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations (0 indicates no limit).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the individual functions are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the individual functions are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+  // Convert the object into a string.
+  std::string ToString() const;
+
+ private:
+  //! The instantiated function.
+  DecomposableFunctionType& function;
+
+  //! The step size for each example.
+  double stepSize;
+
+  //! The maximum number of allowed iterations.
+  size_t maxIterations;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! Controls whether or not the individual functions are shuffled when
+  //! iterating.
+  bool shuffle;
+
+  //! Evaluate the full objective function, in parallel.
+  double Evaluate(const arma::mat& iterate);
+
+  //! Take the steps of one pass over the functions, in parallel, updating the
+  //! nonzero coordinates of the gradient of each function.
+  template<typename FunctionType>
+  void Pass(
+      FunctionType& function,
+      arma::mat& iterate,
+      const arma::uvec& visitationOrder,
+      const size_t passSize,
+      const typename boost::disable_if_c<
+          HasUnregularizedGradient<FunctionType>::value>::type* = 0);
+
+  //! Take the steps of one pass over the functions, in parallel, updating the
+  //! coordinates in the support of each function and applying the
+  //! L2-regularization lazily.
+  template<typename FunctionType>
+  void Pass(
+      FunctionType& function,
+      arma::mat& iterate,
+      const arma::uvec& visitationOrder,
+      const size_t passSize,
+      const typename boost::enable_if_c<
+          HasUnregularizedGradient<FunctionType>::value>::type* = 0);
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+// Include implementation.
+#include "parallel_sgd_impl.hpp"
+
+#endif
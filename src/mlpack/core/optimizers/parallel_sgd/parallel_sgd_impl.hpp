@@ -0,0 +1,242 @@
+/**
+ * @file parallel_sgd_impl.hpp
+ *
+ * Implementation of parallel, lock-free stochastic gradient descent.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_PARALLEL_SGD_PARALLEL_SGD_IMPL_HPP
+#define __MLPACK_CORE_OPTIMIZERS_PARALLEL_SGD_PARALLEL_SGD_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parallel_sgd.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename DecomposableFunctionType>
+ParallelSGD<DecomposableFunctionType>::ParallelSGD(
+    DecomposableFunctionType& function,
+    const double stepSize,
+    const size_t maxIterations,
+    const double tolerance,
+    const bool shuffle) :
+    function(function),
+    stepSize(stepSize),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    shuffle(shuffle)
+{ /* Nothing to do. */ }
+
+//! Optimize the function (minimize).
+template<typename DecomposableFunctionType>
+double ParallelSGD<DecomposableFunctionType>::Optimize(arma::mat& iterate)
+{
+  // Find the number of functions to use.
+  const size_t numFunctions = function.NumFunctions();
+
+  // The order of visitation of the functions.
+  arma::uvec visitationOrder = arma::linspace<arma::uvec>(0, numFunctions - 1,
+      numFunctions);
+
+  // To keep track of how things are going.
+  double overallObjective = Evaluate(iterate);
+  double lastObjective = DBL_MAX;
+
+  // Each pass over the functions is one parallel loop.
+  size_t i = 0;
+  while ((maxIterations == 0) || (i < maxIterations))
+  {
+    // Output current objective function.
+    Log::Info << "Parallel SGD: iteration " << i << ", objective "
+        << overallObjective << "." << std::endl;
+
+    if (overallObjective != overallObjective)
+    {
+      Log::Warn << "Parallel SGD: converged to " << overallObjective << "; "
+          << "terminating with failure.  Try a smaller step size?"
+          << std::endl;
+      return overallObjective;
+    }
+
+    if (std::abs(lastObjective - overallObjective) < tolerance)
+    {
+      Log::Info << "Parallel SGD: minimized within tolerance " << tolerance
+          << "; terminating optimization." << std::endl;
+      return overallObjective;
+    }
+
+    lastObjective = overallObjective;
+
+    if (shuffle) // Determine order of visitation.
+      visitationOrder = arma::shuffle(visitationOrder);
+
+    // The last pass may be cut short by the maximum number of iterations.
+    const size_t passSize = (maxIterations == 0) ? numFunctions :
+        std::min(numFunctions, maxIterations - i);
+
+    Pass(function, iterate, visitationOrder, passSize);
+
+    i += passSize;
+    overallObjective = Evaluate(iterate);
+  }
+
+  Log::Info << "Parallel SGD: maximum iterations (" << maxIterations << ") "
+      << "reached; terminating optimization." << std::endl;
+  return overallObjective;
+}
+
+//! Take the steps of one pass with the full gradient of each function.
+template<typename DecomposableFunctionType>
+template<typename FunctionType>
+void ParallelSGD<DecomposableFunctionType>::Pass(
+    FunctionType& function,
+    arma::mat& iterate,
+    const arma::uvec& visitationOrder,
+    const size_t passSize,
+    const typename boost::disable_if_c<
+        HasUnregularizedGradient<FunctionType>::value>::type*)
+{
+  #pragma omp parallel
+  {
+    arma::sp_mat gradient;
+
+    #pragma omp for schedule(static)
+    for (size_t j = 0; j < passSize; ++j)
+    {
+      // The gradient is computed at the iterate as it is now, while the other
+      // threads may be updating it.
+      function.Gradient(iterate, visitationOrder[j], gradient);
+
+      // Update only the nonzero coordinates of the gradient; no locks are
+      // taken, but each update of a coordinate is atomic.
+      for (arma::sp_mat::const_iterator it = gradient.begin();
+          it != gradient.end(); ++it)
+      {
+        const double update = stepSize * (*it);
+        double& coordinate = iterate(it.row(), it.col());
+
+        #pragma omp atomic
+        coordinate -= update;
+      }
+    }
+  }
+}
+
+//! Take the steps of one pass with sparse steps and lazy L2-regularization.
+template<typename DecomposableFunctionType>
+template<typename FunctionType>
+void ParallelSGD<DecomposableFunctionType>::Pass(
+    FunctionType& function,
+    arma::mat& iterate,
+    const arma::uvec& visitationOrder,
+    const size_t passSize,
+    const typename boost::enable_if_c<
+        HasUnregularizedGradient<FunctionType>::value>::type*)
+{
+  // At each step, the L2 term multiplies each coordinate by its shrinkage
+  // factor.  For each coordinate, we keep the number of steps of this pass
+  // that have been applied to it; the others are applied (at once) when it is
+  // next read, and at the end of the pass.
+  arma::mat weights;
+  function.L2Regularization(weights);
+  const arma::mat shrinkage = 1.0 - stepSize * weights;
+  arma::Mat<size_t> applied = arma::zeros<arma::Mat<size_t> >(iterate.n_rows,
+      iterate.n_cols);
+
+  #pragma omp parallel
+  {
+    arma::uvec support;
+    arma::sp_mat gradient;
+
+    // Each thread has a static share of the steps, and the threads take them
+    // at about the same rate, so the k'th step of a thread is numbered as the
+    // (k * threads)'th step of the pass.
+    const size_t threads = (size_t) OmpGetNumThreads();
+    size_t step = 0;
+
+    #pragma omp for schedule(static)
+    for (size_t j = 0; j < passSize; ++j)
+    {
+      // Bring the coordinates that the gradient depends on up to date.  With
+      // several threads, another thread may already have applied later steps.
+      function.Support(visitationOrder[j], support);
+      for (size_t k = 0; k < support.n_elem; ++k)
+      {
+        const size_t c = support[k];
+        if (applied[c] < step)
+        {
+          const double factor = std::pow(shrinkage[c],
+              (double) (step - applied[c]));
+          double& coordinate = iterate[c];
+
+          #pragma omp atomic
+          coordinate *= factor;
+        }
+      }
+
+      // Evaluate the gradient, and take the step: apply the L2 term of this
+      // step to the support, and then the gradient.
+      function.UnregularizedGradient(iterate, visitationOrder[j], gradient);
+      for (size_t k = 0; k < support.n_elem; ++k)
+      {
+        const size_t c = support[k];
+        const double factor = shrinkage[c];
+        double& coordinate = iterate[c];
+
+        #pragma omp atomic
+        coordinate *= factor;
+
+        applied[c] = step + 1;
+      }
+      for (arma::sp_mat::const_iterator it = gradient.begin();
+          it != gradient.end(); ++it)
+      {
+        const double update = stepSize * (*it);
+        double& coordinate = iterate(it.row(), it.col());
+
+        #pragma omp atomic
+        coordinate -= update;
+      }
+
+      step += threads;
+    }
+  }
+
+  // Bring every coordinate up to date.
+  for (size_t j = 0; j < iterate.n_elem; ++j)
+    if (applied[j] < passSize)
+      iterate[j] *= std::pow(shrinkage[j], (double) (passSize - applied[j]));
+}
+
+template<typename DecomposableFunctionType>
+double ParallelSGD<DecomposableFunctionType>::Evaluate(
+    const arma::mat& iterate)
+{
+  const size_t numFunctions = function.NumFunctions();
+
+  double objective = 0;
+  #pragma omp parallel for reduction(+:objective)
+  for (size_t i = 0; i < numFunctions; ++i)
+    objective += function.Evaluate(iterate, i);
+
+  return objective;
+}
+
+// Convert the object to a string.
+template<typename DecomposableFunctionType>
+std::string ParallelSGD<DecomposableFunctionType>::ToString() const
+{
+  std::ostringstream convert;
+  convert << "ParallelSGD [" << this << "]" << std::endl;
+  convert << "  Function:" << std::endl;
+  convert << util::Indent(function.ToString(), 2);
+  convert << "  Step size: " << stepSize << std::endl;
+  convert << "  Maximum iterations: " << maxIterations << std::endl;
+  convert << "  Tolerance: " << tolerance << std::endl;
+  convert << "  Shuffle points: " << (shuffle ? "true" : "false") << std::endl;
+  return convert.str();
+}
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
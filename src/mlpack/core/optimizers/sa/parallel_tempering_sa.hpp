@@ -0,0 +1,264 @@
+/**
+ * @file parallel_tempering_sa.hpp
+ *
+ * Simulated Annealing with parallel tempering: several Markov chains, one for
+ * each temperature, run in parallel and exchange their states.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_SA_PARALLEL_TEMPERING_SA_HPP
+#define __MLPACK_CORE_OPTIMIZERS_SA_PARALLEL_TEMPERING_SA_HPP
+
+#include <mlpack/core.hpp>
+
+#include "exponential_schedule.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * A parallel tempering (replica exchange) variant of simulated annealing (see
+ * mlpack::optimization::SA).  Instead of one Markov chain, it runs a ladder of
+ * chains at increasing temperatures
+ *
+ *   T_c = T * temperatureRatio^c,  c = 0, ..., numChains - 1,
+ *
+ * where T is the base temperature, which is cooled by the cooling schedule
+ * exactly as SA cools its temperature (once per move of each chain), so any
+ * CoolingScheduleType may be used.  Each chain makes its moves as SA does, one
+ * parameter at a time with feedback move control (each chain adapts its own
+ * move sizes), and the chains run in parallel (with OpenMP), one chain per
+ * thread.
+ *
+ * Every swapInterval moves, the chains stop, and the states of neighbouring
+ * chains (alternately the pairs (0, 1), (2, 3), ... and (1, 2), (3, 4), ...)
+ * are exchanged with probability
+ *
+ *   min{1, exp((1 / T_c - 1 / T_{c + 1}) (E_c - E_{c + 1}))}.
+ *
+ * So the hot chains explore the function widely, and good states found by
+ * them move down the ladder to the cold chains, which refine them; this helps
+ * to escape from local minima, using the extra cores without increasing the
+ * wall-clock time.  The best state seen by any chain is returned.
+ *
+ * The system is considered "frozen" when the energy of the coldest chain fails
+ * to change more than tolerance for maxToleranceSweep consecutive sweeps.  If
+ * mlpack is compiled without OpenMP, the chains run one after another.
+ *
+ * The FunctionType parameter must implement the same methods as for SA:
+ *
+ *   double Evaluate(const arma::mat& coordinates);
+ *   arma::mat& GetInitialPoint();
+ *
+ * and Evaluate() must be safe to call from several threads at once.  The
+ * CoolingScheduleType parameter must implement
+ *
+ *   double NextTemperature(const double currentTemperature,
+ *                          const double currentValue);
+ *
+ * which is only called for the base temperature (with the energy of the
+ * coldest chain), and never from several threads at once.
+ *
+ * @tparam FunctionType objective function type to be minimized.
+ * @tparam CoolingScheduleType type for cooling schedule
+ */
+template<
+    typename FunctionType,
+    typename CoolingScheduleType = ExponentialSchedule
+>
+class ParallelTemperingSA
+{
+ public:
+  /**
+   * Construct the parallel tempering SA optimizer with the given function and
+   * parameters.  The parameters up to gain have the same meaning as for SA.
+   * If the number of chains is 0, the OpenMP default number of threads (which
+   * can be set with OmpSetNumThreads() or the OMP_NUM_THREADS environment
+   * variable) is used.
+   *
+   * @param function Function to be minimized.
+   * @param coolingSchedule Instantiated cooling schedule.
+   * @param maxIterations Maximum number of iterations (moves of each chain)
+   *      allowed (0 indicates no limit).
+   * @param initT Initial temperature of the coldest chain.
+   * @param initMoves Number of initial iterations without changing temperature.
+   * @param moveCtrlSweep Sweeps per feedback move control.
+   * @param tolerance Tolerance to consider system frozen.
+   * @param maxToleranceSweep Maximum sweeps below tolerance to consider system
+   *      frozen.
+   * @param maxMoveCoef Maximum move size.
+   * @param initMoveCoef Initial move size.
+   * @param gain Proportional control in feedback move control.
+   * @param numChains Number of chains (temperatures).
+   * @param temperatureRatio Ratio of the temperatures of neighbouring chains.
+   * @param swapInterval Number of moves of each chain between exchanges.
+   */
+  ParallelTemperingSA(FunctionType& function,
+                      CoolingScheduleType& coolingSchedule,
+                      const size_t maxIterations = 1000000,
+                      const double initT = 10000.,
+                      const size_t initMoves = 1000,
+                      const size_t moveCtrlSweep = 100,
+                      const double tolerance = 1e-5,
+                      const size_t maxToleranceSweep = 3,
+                      const double maxMoveCoef = 20,
+                      const double initMoveCoef = 0.3,
+                      const double gain = 0.3,
+                      const size_t numChains = 0,
+                      const double temperatureRatio = 2.0,
+                      const size_t swapInterval = 100);
+
+  /**
+   * Optimize the given function using parallel tempering.  All chains start
+   * from the given point, which will be modified to store the best point found
+   * by the algorithm, and the objective value of that point is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate);
+
+  //! Get the instantiated function to be optimized.
+  const FunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  FunctionType& Function() { return function; }
+
+  //! Get the temperature (of the coldest chain).
+  double Temperature() const { return temperature; }
+  //! Modify the temperature (of the coldest chain).
+  double& Temperature() { return temperature; }
+
+  //! Get the initial moves.
+  size_t InitMoves() const { return initMoves; }
+  //! Modify the initial moves.
+  size_t& InitMoves() { return initMoves; }
+
+  //! Get sweeps per move control.
+  size_t MoveCtrlSweep() const { return moveCtrlSweep; }
+  //! Modify sweeps per move control.
+  size_t& MoveCtrlSweep() { return moveCtrlSweep; }
+
+  //! Get the tolerance.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance.
+  double& Tolerance() { return tolerance; }
+
+  //! Get the maxToleranceSweep.
+  size_t MaxToleranceSweep() const { return maxToleranceSweep; }
+  //! Modify the maxToleranceSweep.
+  size_t& MaxToleranceSweep() { return maxToleranceSweep; }
+
+  //! Get the gain.
+  double Gain() const { return gain; }
+  //! Modify the gain.
+  double& Gain() { return gain; }
+
+  //! Get the maximum number of iterations.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations.
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the maximum move size of each parameter.
+  arma::mat MaxMove() const { return maxMove; }
+  //! Modify the maximum move size of each parameter.
+  arma::mat& MaxMove() { return maxMove; }
+
+  //! Get the initial move size of each parameter.
+  arma::mat MoveSize() const { return moveSize; }
+  //! Modify the initial move size of each parameter.
+  arma::mat& MoveSize() { return moveSize; }
+
+  //! Get the number of chains (0 means the number of threads).
+  size_t NumChains() const { return numChains; }
+  //! Modify the number of chains (0 means the number of threads).
+  size_t& NumChains() { return numChains; }
+
+  //! Get the ratio of the temperatures of neighbouring chains.
+  double TemperatureRatio() const { return temperatureRatio; }
+  //! Modify the ratio of the temperatures of neighbouring chains.
+  double& TemperatureRatio() { return temperatureRatio; }
+
+  //! Get the number of moves of each chain between exchanges.
+  size_t SwapInterval() const { return swapInterval; }
+  //! Modify the number of moves of each chain between exchanges.
+  size_t& SwapInterval() { return swapInterval; }
+
+  //! Return a string representation of this object.
+  std::string ToString() const;
+
+ private:
+  //! The function to be optimized.
+  FunctionType& function;
+  //! The cooling schedule being used.
+  CoolingScheduleType& coolingSchedule;
+  //! The maximum number of iterations.
+  size_t maxIterations;
+  //! The current temperature of the coldest chain.
+  double temperature;
+  //! The number of initial moves before reducing the temperature.
+  size_t initMoves;
+  //! The number of sweeps before a MoveControl() call.
+  size_t moveCtrlSweep;
+  //! Tolerance for convergence.
+  double tolerance;
+  //! Number of sweeps in tolerance before system is considered frozen.
+  size_t maxToleranceSweep;
+  //! Proportional control in feedback move control.
+  double gain;
+  //! The number of chains (0 means the number of threads).
+  size_t numChains;
+  //! The ratio of the temperatures of neighbouring chains.
+  double temperatureRatio;
+  //! The number of moves of each chain between exchanges.
+  size_t swapInterval;
+
+  //! Maximum move size of each parameter.
+  arma::mat maxMove;
+  //! Initial move size of each parameter.
+  arma::mat moveSize;
+
+  /**
+   * The state of one Markov chain.  Each chain has its own random number
+   * generator, so that the chains can run in parallel.
+   */
+  struct Chain
+  {
+    //! Current position of the chain.
+    arma::mat iterate;
+    //! Energy of the current position.
+    double energy;
+    //! Move size of each parameter.
+    arma::mat moveSize;
+    //! Number of accepted moves of each parameter since the last MoveControl().
+    arma::mat accept;
+    //! The next parameter to move.
+    size_t idx;
+    //! The number of sweeps since the last MoveControl().
+    size_t sweepCounter;
+    //! The random number generator of the chain.
+    boost::random::mt19937 generator;
+  };
+
+  /**
+   * Propose a move of the next parameter of the chain, and accept it or not
+   * according to the Metropolis criterion at the given temperature, as
+   * SA::GenerateMove() does.
+   */
+  void GenerateMove(Chain& chain, const double chainTemperature);
+
+  /**
+   * Adapt the move sizes of the chain, as SA::MoveControl() does.
+   */
+  void MoveControl(const size_t nMoves, Chain& chain);
+
+  /**
+   * Make the given number of moves in each chain, in parallel; chain c is at
+   * temperature T * temperatureRatio^c.
+   */
+  void MoveChains(std::vector<Chain>& chains, const size_t moves);
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#include "parallel_tempering_sa_impl.hpp"
+
+#endif
@@ -0,0 +1,280 @@
+/**
+ * @file parallel_tempering_sa_impl.hpp
+ *
+ * Implementation of simulated annealing with parallel tempering.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_SA_PARALLEL_TEMPERING_SA_IMPL_HPP
+#define __MLPACK_CORE_OPTIMIZERS_SA_PARALLEL_TEMPERING_SA_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parallel_tempering_sa.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<
+    typename FunctionType,
+    typename CoolingScheduleType
+>
+ParallelTemperingSA<FunctionType, CoolingScheduleType>::ParallelTemperingSA(
+    FunctionType& function,
+    CoolingScheduleType& coolingSchedule,
+    const size_t maxIterations,
+    const double initT,
+    const size_t initMoves,
+    const size_t moveCtrlSweep,
+    const double tolerance,
+    const size_t maxToleranceSweep,
+    const double maxMoveCoef,
+    const double initMoveCoef,
+    const double gain,
+    const size_t numChains,
+    const double temperatureRatio,
+    const size_t swapInterval) :
+    function(function),
+    coolingSchedule(coolingSchedule),
+    maxIterations(maxIterations),
+    temperature(initT),
+    initMoves(initMoves),
+    moveCtrlSweep(moveCtrlSweep),
+    tolerance(tolerance),
+    maxToleranceSweep(maxToleranceSweep),
+    gain(gain),
+    numChains(numChains),
+    temperatureRatio(temperatureRatio),
+    swapInterval(swapInterval)
+{
+  const size_t rows = function.GetInitialPoint().n_rows;
+  const size_t cols = function.GetInitialPoint().n_cols;
+
+  maxMove.set_size(rows, cols);
+  maxMove.fill(maxMoveCoef);
+  moveSize.set_size(rows, cols);
+  moveSize.fill(initMoveCoef);
+}
+
+//! Optimize the function (minimize).
+template<
+    typename FunctionType,
+    typename CoolingScheduleType
+>
+double ParallelTemperingSA<FunctionType, CoolingScheduleType>::Optimize(
+    arma::mat& iterate)
+{
+  if (swapInterval == 0)
+  {
+    Log::Fatal << "ParallelTemperingSA::Optimize(): the swap interval must be "
+        << "greater than 0!" << std::endl;
+  }
+
+  // All of the chains start from the given point.
+  const size_t chainCount = (numChains == 0) ?
+      (size_t) OmpGetMaxThreads() : numChains;
+  std::vector<Chain> chains(chainCount);
+  for (size_t c = 0; c < chainCount; ++c)
+  {
+    chains[c].iterate = iterate;
+    chains[c].energy = function.Evaluate(iterate);
+    chains[c].moveSize = moveSize;
+    chains[c].accept.zeros(iterate.n_rows, iterate.n_cols);
+    chains[c].idx = 0;
+    chains[c].sweepCounter = 0;
+    chains[c].generator.seed(math::randGen());
+  }
+
+  double bestEnergy = chains[0].energy;
+  arma::mat bestIterate = iterate;
+
+  // Initial moves to get rid of dependency of initial states.
+  MoveChains(chains, initMoves);
+
+  size_t frozenCount = 0;
+  size_t round = 0;
+  size_t i = 0;
+  while (i != maxIterations)
+  {
+    const double oldEnergy = chains[0].energy;
+
+    // The last round may be cut short by the maximum number of iterations.
+    const size_t moves = (maxIterations == 0) ? swapInterval :
+        std::min(swapInterval, maxIterations - i);
+    MoveChains(chains, moves);
+    i += moves;
+
+    // Cool the base temperature once for each move, as SA does.
+    for (size_t m = 0; m < moves; ++m)
+      temperature = coolingSchedule.NextTemperature(temperature,
+          chains[0].energy);
+
+    // Try to exchange the states of neighbouring chains; alternate between
+    // the even and the odd pairs.
+    for (size_t c = (round % 2); c + 1 < chainCount; c += 2)
+    {
+      const double coldTemperature = temperature *
+          std::pow(temperatureRatio, (double) c);
+      const double hotTemperature = coldTemperature * temperatureRatio;
+      const double criterion = (1.0 / coldTemperature - 1.0 / hotTemperature) *
+          (chains[c].energy - chains[c + 1].energy);
+      if (criterion >= 0. || std::exp(criterion) > math::Random())
+      {
+        std::swap(chains[c].iterate, chains[c + 1].iterate);
+        std::swap(chains[c].energy, chains[c + 1].energy);
+      }
+    }
+    ++round;
+
+    // Keep the best point seen by any chain.
+    for (size_t c = 0; c < chainCount; ++c)
+    {
+      if (chains[c].energy < bestEnergy)
+      {
+        bestEnergy = chains[c].energy;
+        bestIterate = chains[c].iterate;
+      }
+    }
+
+    // Determine if the coldest chain has entered (or continues to be in) a
+    // frozen state.
+    if (std::abs(chains[0].energy - oldEnergy) < tolerance)
+      frozenCount += moves;
+    else
+      frozenCount = 0;
+
+    // Terminate, if possible.
+    if (frozenCount >= maxToleranceSweep * moveCtrlSweep * iterate.n_elem)
+    {
+      Log::Debug << "ParallelTemperingSA: minimized within tolerance "
+          << tolerance << " for " << maxToleranceSweep << " sweeps after "
+          << i << " iterations; terminating optimization." << std::endl;
+      iterate = bestIterate;
+      return bestEnergy;
+    }
+  }
+
+  Log::Debug << "ParallelTemperingSA: maximum iterations (" << maxIterations
+      << ") reached; terminating optimization." << std::endl;
+  iterate = bestIterate;
+  return bestEnergy;
+}
+
+template<
+    typename FunctionType,
+    typename CoolingScheduleType
+>
+void ParallelTemperingSA<FunctionType, CoolingScheduleType>::MoveChains(
+    std::vector<Chain>& chains,
+    const size_t moves)
+{
+  const size_t chainCount = chains.size();
+
+  // One chain for each thread.
+  #pragma omp parallel for schedule(static, 1)
+  for (size_t c = 0; c < chainCount; ++c)
+  {
+    const double chainTemperature = temperature *
+        std::pow(temperatureRatio, (double) c);
+    for (size_t m = 0; m < moves; ++m)
+      GenerateMove(chains[c], chainTemperature);
+  }
+}
+
+template<
+    typename FunctionType,
+    typename CoolingScheduleType
+>
+void ParallelTemperingSA<FunctionType, CoolingScheduleType>::GenerateMove(
+    Chain& chain,
+    const double chainTemperature)
+{
+  boost::random::uniform_01<> uniform;
+
+  const double prevEnergy = chain.energy;
+  const double prevValue = chain.iterate(chain.idx);
+
+  // Sample from a Laplace distribution with scale parameter moveSize(idx).
+  const double unif = 2.0 * uniform(chain.generator) - 1.0;
+  const double move = (unif < 0) ?
+      (chain.moveSize(chain.idx) * std::log(1 + unif)) :
+      (-chain.moveSize(chain.idx) * std::log(1 - unif));
+
+  chain.iterate(chain.idx) += move;
+  chain.energy = function.Evaluate(chain.iterate);
+  // According to the Metropolis criterion, accept the move with probability
+  // min{1, exp(-(E_new - E_old) / T)}.
+  const double xi = uniform(chain.generator);
+  const double delta = chain.energy - prevEnergy;
+  const double criterion = std::exp(-delta / chainTemperature);
+  if (delta <= 0. || criterion > xi)
+  {
+    chain.accept(chain.idx) += 1.;
+  }
+  else // Reject the move; restore previous state.
+  {
+    chain.iterate(chain.idx) = prevValue;
+    chain.energy = prevEnergy;
+  }
+
+  ++chain.idx;
+  if (chain.idx == chain.iterate.n_elem) // Finished with a sweep.
+  {
+    chain.idx = 0;
+    ++chain.sweepCounter;
+  }
+
+  if (chain.sweepCounter == moveCtrlSweep) // Do MoveControl().
+  {
+    MoveControl(moveCtrlSweep, chain);
+    chain.sweepCounter = 0;
+  }
+}
+
+template<
+    typename FunctionType,
+    typename CoolingScheduleType
+>
+void ParallelTemperingSA<FunctionType, CoolingScheduleType>::MoveControl(
+    const size_t nMoves,
+    Chain& chain)
+{
+  // Aim for an acceptance ratio of 0.44; see SA::MoveControl().
+  chain.moveSize = arma::log(chain.moveSize);
+  chain.moveSize += gain * (chain.accept / (double) nMoves - 0.44);
+  chain.moveSize = arma::exp(chain.moveSize);
+
+  for (size_t i = 0; i < chain.accept.n_elem; ++i)
+    chain.moveSize(i) = std::min(chain.moveSize(i), maxMove(i));
+
+  chain.accept.zeros();
+}
+
+template<
+    typename FunctionType,
+    typename CoolingScheduleType
+>
+std::string ParallelTemperingSA<FunctionType, CoolingScheduleType>::
+ToString() const
+{
+  std::ostringstream convert;
+  convert << "ParallelTemperingSA [" << this << "]" << std::endl;
+  convert << "  Function:" << std::endl;
+  convert << util::Indent(function.ToString(), 2);
+  convert << "  Cooling Schedule:" << std::endl;
+  convert << util::Indent(coolingSchedule.ToString(), 2);
+  convert << "  Temperature: " << temperature << std::endl;
+  convert << "  Initial moves: " << initMoves << std::endl;
+  convert << "  Sweeps per move control: " << moveCtrlSweep << std::endl;
+  convert << "  Tolerance: " << tolerance << std::endl;
+  convert << "  Maximum sweeps below tolerance: " << maxToleranceSweep
+      << std::endl;
+  convert << "  Move control gain: " << gain << std::endl;
+  convert << "  Maximum iterations: " << maxIterations << std::endl;
+  convert << "  Number of chains: " << numChains << std::endl;
+  convert << "  Temperature ratio: " << temperatureRatio << std::endl;
+  convert << "  Swap interval: " << swapInterval << std::endl;
+  return convert.str();
+}
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
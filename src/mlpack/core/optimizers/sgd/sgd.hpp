@@ -8,6 +8,10 @@
 #define __MLPACK_CORE_OPTIMIZERS_SGD_SGD_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/evaluate_with_gradient.hpp>
+#include <mlpack/core/optimizers/unregularized_gradient.hpp>
+
+#include "sgd_state.hpp"
 
 namespace mlpack {
 namespace optimization {
@@ -64,6 +68,39 @@ namespace optimization {
  * objective function on the first point in the dataset (presumably, the dataset
  * is held internally in the DecomposableFunctionType).
  *
+ * If the DecomposableFunctionType also implements
+ *
+ *   double EvaluateWithGradient(const arma::mat& coordinates,
+ *                               const size_t i,
+ *                               arma::mat& gradient);
+ *
+ * then it is used to compute the objective and the gradient of each function
+ * at once, before each step; otherwise, the gradient is computed before the
+ * step and the objective after it.  Either way, the sum of the objectives over
+ * an iteration through the functions is used to check convergence.
+ *
+ * If the gradient of each function is sparse except for an L2-regularization
+ * term (as for a linear model on sparse data), the DecomposableFunctionType can
+ * instead implement
+ *
+ *   double Evaluate(const arma::mat& coordinates);
+ *   void Support(const size_t i, arma::uvec& coordinates);
+ *   void UnregularizedGradient(const arma::mat& coordinates,
+ *                              const size_t i,
+ *                              arma::sp_mat& gradient);
+ *   void L2Regularization(arma::mat& weights);
+ *
+ * where Support() gives the indices of the coordinates the unregularized part
+ * of function i depends on (its gradient must be zero elsewhere), and
+ * L2Regularization() gives the weight of each coordinate in the L2 term, so
+ * that the L2 term of every function is 0.5 * sum_j (weights[j] * A[j]^2).
+ * Then each step updates only the coordinates in the support, and costs
+ * O(nnz) rather than O(d): the L2 term of a coordinate only shrinks it by a
+ * constant factor at each step, so the shrinkage is accumulated and applied
+ * lazily, when the coordinate is next read.  In this case the objective used
+ * to check convergence is computed with Evaluate(coordinates) after each
+ * iteration through the functions.
+ *
  * @tparam DecomposableFunctionType Decomposable objective function type to be
  *     minimized.
  */
@@ -98,6 +135,21 @@ class SGD
    */
   double Optimize(arma::mat& iterate);
 
+  /**
+   * Optimize the given function using stochastic gradient descent, resuming
+   * the optimization described by the given state (see SGDState), which will
+   * be modified to describe the optimization at its end; a default-constructed
+   * state starts a new optimization.  The maximum number of iterations applies
+   * to this run.  The given starting point should be the finishing point of
+   * the optimization the state describes; it will be modified to store the
+   * finishing point of this run, and the final objective value is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @param state State of the optimization to resume (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate, SGDState& state);
+
   //! Get the instantiated function to be optimized.
   const DecomposableFunctionType& Function() const { return function; }
   //! Modify the instantiated function.
@@ -142,6 +194,29 @@ class SGD
   //! Controls whether or not the individual functions are shuffled when
   //! iterating.
   bool shuffle;
+
+  //! Optimize the function, taking a dense step with the full gradient of
+  //! each function.
+  template<typename FunctionType>
+  double Optimize(
+      FunctionType& function,
+      arma::mat& iterate,
+      SGDState& state,
+      const typename boost::disable_if_c<
+          HasUnregularizedGradient<FunctionType>::value>::type* = 0);
+
+  //! Optimize the function, updating only the coordinates in the support of
+  //! each function and applying the L2-regularization lazily.
+  template<typename FunctionType>
+  double Optimize(
+      FunctionType& function,
+      arma::mat& iterate,
+      SGDState& state,
+      const typename boost::enable_if_c<
+          HasUnregularizedGradient<FunctionType>::value>::type* = 0);
+
+  //! Make sure that the state to resume matches the function.
+  void CheckState(const SGDState& state, const size_t numFunctions) const;
 };
 
 }; // namespace optimization
@@ -30,24 +30,54 @@ SGD<DecomposableFunctionType>::SGD(DecomposableFunctionType& function,
 //! Optimize the function (minimize).
 template<typename DecomposableFunctionType>
 double SGD<DecomposableFunctionType>::Optimize(arma::mat& iterate)
+{
+  // Start a new optimization.
+  SGDState state;
+  return Optimize(function, iterate, state);
+}
+
+//! Resume the optimization of the function.
+template<typename DecomposableFunctionType>
+double SGD<DecomposableFunctionType>::Optimize(arma::mat& iterate,
+                                               SGDState& state)
+{
+  return Optimize(function, iterate, state);
+}
+
+//! Optimize the function with dense steps.
+template<typename DecomposableFunctionType>
+template<typename FunctionType>
+double SGD<DecomposableFunctionType>::Optimize(
+    FunctionType& function,
+    arma::mat& iterate,
+    SGDState& state,
+    const typename boost::disable_if_c<
+        HasUnregularizedGradient<FunctionType>::value>::type*)
 {
   // Find the number of functions to use.
   const size_t numFunctions = function.NumFunctions();
 
-  // This is used only if shuffle is true.
-  arma::vec visitationOrder;
-  if (shuffle)
-    visitationOrder = arma::shuffle(arma::linspace(0, (numFunctions - 1),
-        numFunctions));
+  // To keep track of where we are and how things are going; all of this is
+  // kept in the state, so that the optimization can be resumed.
+  arma::vec& visitationOrder = state.VisitationOrder();
+  size_t& currentFunction = state.CurrentFunction();
+  double& overallObjective = state.OverallObjective();
+  double& lastObjective = state.LastObjective();
 
-  // To keep track of where we are and how things are going.
-  size_t currentFunction = 0;
-  double overallObjective = 0;
-  double lastObjective = DBL_MAX;
+  if ((state.Epoch() == 0) && (currentFunction == 0))
+  {
+    // This is a new optimization.  The visitation order is used only if
+    // shuffle is true.
+    if (shuffle)
+      visitationOrder = arma::shuffle(arma::linspace(0, (numFunctions - 1),
+          numFunctions));
 
-  // Calculate the first objective function.
-  for (size_t i = 0; i < numFunctions; ++i)
-    overallObjective += function.Evaluate(iterate, i);
+    // Calculate the first objective function.
+    overallObjective = 0;
+    for (size_t i = 0; i < numFunctions; ++i)
+      overallObjective += function.Evaluate(iterate, i);
+  }
+  CheckState(state, numFunctions);
 
   // Now iterate!
   arma::mat gradient(iterate.n_rows, iterate.n_cols);
@@ -78,35 +108,183 @@ double SGD<DecomposableFunctionType>::Optimize(arma::mat& iterate)
       lastObjective = overallObjective;
       overallObjective = 0;
       currentFunction = 0;
+      ++state.Epoch();
 
       if (shuffle) // Determine order of visitation.
         visitationOrder = arma::shuffle(visitationOrder);
     }
 
-    // Evaluate the gradient for this iteration.
-    if (shuffle)
-      function.Gradient(iterate, visitationOrder[currentFunction], gradient);
-    else
-      function.Gradient(iterate, currentFunction, gradient);
+    const size_t index = (shuffle) ?
+        (size_t) visitationOrder[currentFunction] : currentFunction;
 
-    // And update the iterate.
-    iterate -= stepSize * gradient;
+    if (HasDecomposableEvaluateWithGradient<FunctionType>::value)
+    {
+      // Evaluate the objective and the gradient for this iteration at once,
+      // and add the objective to the overall objective function.
+      overallObjective += EvaluateWithGradient(function, iterate, index,
+          gradient);
 
-    // Now add that to the overall objective function.
-    if (shuffle)
-      overallObjective += function.Evaluate(iterate,
-          visitationOrder[currentFunction]);
+      // And update the iterate.
+      iterate -= stepSize * gradient;
+    }
     else
-      overallObjective += function.Evaluate(iterate, currentFunction);
+    {
+      // Evaluate the gradient for this iteration.
+      function.Gradient(iterate, index, gradient);
+
+      // And update the iterate.
+      iterate -= stepSize * gradient;
+
+      // Now add that to the overall objective function.
+      overallObjective += function.Evaluate(iterate, index);
+    }
   }
 
   Log::Info << "SGD: maximum iterations (" << maxIterations << ") reached; "
       << "terminating optimization." << std::endl;
-  // Calculate final objective.
-  overallObjective = 0;
+  // Calculate final objective (the objective of the current epoch stays in
+  // the state).
+  double objective = 0;
   for (size_t i = 0; i < numFunctions; ++i)
-    overallObjective += function.Evaluate(iterate, i);
-  return overallObjective;
+    objective += function.Evaluate(iterate, i);
+  return objective;
+}
+
+//! Optimize the function with sparse steps and lazy L2-regularization.
+template<typename DecomposableFunctionType>
+template<typename FunctionType>
+double SGD<DecomposableFunctionType>::Optimize(
+    FunctionType& function,
+    arma::mat& iterate,
+    SGDState& state,
+    const typename boost::enable_if_c<
+        HasUnregularizedGradient<FunctionType>::value>::type*)
+{
+  // Find the number of functions to use.
+  const size_t numFunctions = function.NumFunctions();
+
+  // To keep track of where we are and how things are going; all of this is
+  // kept in the state, so that the optimization can be resumed.
+  arma::vec& visitationOrder = state.VisitationOrder();
+  size_t& currentFunction = state.CurrentFunction();
+  double& overallObjective = state.OverallObjective();
+  double& lastObjective = state.LastObjective();
+
+  if ((state.Epoch() == 0) && (currentFunction == 0))
+  {
+    // This is a new optimization.  The visitation order is used only if
+    // shuffle is true.
+    if (shuffle)
+      visitationOrder = arma::shuffle(arma::linspace(0, (numFunctions - 1),
+          numFunctions));
+
+    overallObjective = function.Evaluate(iterate);
+  }
+  CheckState(state, numFunctions);
+
+  // At each step, the L2 term multiplies each coordinate by its shrinkage
+  // factor.  For each coordinate, we keep the number of steps that have been
+  // applied to it; the others are applied (at once) when it is next read.  All
+  // of them are applied before we return, so this is not part of the state.
+  arma::mat weights;
+  function.L2Regularization(weights);
+  const arma::mat shrinkage = 1.0 - stepSize * weights;
+  arma::Mat<size_t> applied = arma::zeros<arma::Mat<size_t> >(iterate.n_rows,
+      iterate.n_cols);
+  size_t steps = 0;
+
+  // Now iterate!
+  arma::uvec support;
+  arma::sp_mat gradient;
+  for (size_t i = 1; i != maxIterations; ++i, ++currentFunction)
+  {
+    // Is this iteration the start of a sequence?
+    if ((currentFunction % numFunctions) == 0)
+    {
+      if (state.Epoch() > 0)
+      {
+        // Bring every coordinate up to date, and calculate the objective.
+        for (size_t j = 0; j < iterate.n_elem; ++j)
+        {
+          iterate[j] *= std::pow(shrinkage[j], (double) (steps - applied[j]));
+          applied[j] = steps;
+        }
+        overallObjective = function.Evaluate(iterate);
+      }
+
+      // Output current objective function.
+      Log::Info << "SGD: iteration " << i << ", objective " << overallObjective
+          << "." << std::endl;
+
+      if (overallObjective != overallObjective)
+      {
+        Log::Warn << "SGD: converged to " << overallObjective << "; terminating"
+            << " with failure.  Try a smaller step size?" << std::endl;
+        return overallObjective;
+      }
+
+      if (std::abs(lastObjective - overallObjective) < tolerance)
+      {
+        Log::Info << "SGD: minimized within tolerance " << tolerance << "; "
+            << "terminating optimization." << std::endl;
+        return overallObjective;
+      }
+
+      // Reset the counter variables.
+      lastObjective = overallObjective;
+      currentFunction = 0;
+      ++state.Epoch();
+
+      if (shuffle) // Determine order of visitation.
+        visitationOrder = arma::shuffle(visitationOrder);
+    }
+
+    const size_t index = (shuffle) ?
+        (size_t) visitationOrder[currentFunction] : currentFunction;
+
+    // Bring the coordinates that the gradient depends on up to date.
+    function.Support(index, support);
+    for (size_t j = 0; j < support.n_elem; ++j)
+    {
+      const size_t c = support[j];
+      iterate[c] *= std::pow(shrinkage[c], (double) (steps - applied[c]));
+    }
+
+    // Evaluate the gradient for this iteration, and take the step: apply the
+    // L2 term of this step to the support, and then the gradient.
+    function.UnregularizedGradient(iterate, index, gradient);
+    for (size_t j = 0; j < support.n_elem; ++j)
+    {
+      const size_t c = support[j];
+      iterate[c] *= shrinkage[c];
+      applied[c] = steps + 1;
+    }
+    for (arma::sp_mat::const_iterator it = gradient.begin();
+        it != gradient.end(); ++it)
+      iterate(it.row(), it.col()) -= stepSize * (*it);
+
+    ++steps;
+  }
+
+  Log::Info << "SGD: maximum iterations (" << maxIterations << ") reached; "
+      << "terminating optimization." << std::endl;
+  // Bring every coordinate up to date, and calculate the final objective.
+  for (size_t j = 0; j < iterate.n_elem; ++j)
+    iterate[j] *= std::pow(shrinkage[j], (double) (steps - applied[j]));
+  return function.Evaluate(iterate);
+}
+
+template<typename DecomposableFunctionType>
+void SGD<DecomposableFunctionType>::CheckState(const SGDState& state,
+                                               const size_t numFunctions) const
+{
+  if ((shuffle && (state.VisitationOrder().n_elem != numFunctions)) ||
+      (state.CurrentFunction() > numFunctions))
+  {
+    Log::Fatal << "SGD::Optimize(): the state to resume does not match the "
+        << "function (which has " << numFunctions << " functions)!"
+        << std::endl;
+  }
 }
 
 // Convert the object to a string.
@@ -0,0 +1,46 @@
+/**
+ * @file sgd_state.cpp
+ *
+ * Implementation of the SGDState class.
+ */
+#include "sgd_state.hpp"
+
+using namespace mlpack;
+using namespace mlpack::optimization;
+
+SGDState::SGDState() :
+    epoch(0),
+    currentFunction(0),
+    overallObjective(0),
+    lastObjective(DBL_MAX)
+{ /* Nothing to do. */ }
+
+void SGDState::Save(util::SaveRestoreUtility& sr) const
+{
+  sr.SaveParameter(epoch, "epoch");
+  sr.SaveParameter(currentFunction, "currentFunction");
+  sr.SaveParameter(overallObjective, "overallObjective");
+  sr.SaveParameter(lastObjective, "lastObjective");
+  sr.SaveParameter(visitationOrder.n_elem, "functions");
+  if (visitationOrder.n_elem > 0)
+    sr.SaveParameter(visitationOrder, "visitationOrder");
+}
+
+void SGDState::Load(const util::SaveRestoreUtility& sr)
+{
+  sr.LoadParameter(epoch, "epoch");
+  sr.LoadParameter(currentFunction, "currentFunction");
+  sr.LoadParameter(overallObjective, "overallObjective");
+
+  // DBL_MAX (before the first epoch ends) may not be read back exactly; if it
+  // overflows, it is either left alone or set to DBL_MAX.
+  lastObjective = DBL_MAX;
+  sr.LoadParameter(lastObjective, "lastObjective");
+
+  size_t functions;
+  sr.LoadParameter(functions, "functions");
+  if (functions > 0)
+    sr.LoadParameter(visitationOrder, "visitationOrder");
+  else
+    visitationOrder.reset();
+}
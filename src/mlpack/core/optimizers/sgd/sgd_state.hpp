@@ -0,0 +1,79 @@
+/**
+ * @file sgd_state.hpp
+ *
+ * The state of an SGD optimization, which can be saved and used to resume the
+ * optimization later.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_SGD_SGD_STATE_HPP
+#define __MLPACK_CORE_OPTIMIZERS_SGD_SGD_STATE_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * The state of an SGD optimization: the epoch (the number of iterations
+ * through the functions that have been started), the order in which the
+ * functions of the current epoch are visited, the number of them visited so
+ * far, and the objectives used to check convergence.  Together with the
+ * iterate, this is all SGD::Optimize() needs to resume an optimization, even
+ * in the middle of an epoch; see LBFGSState for an example of checkpointing.
+ *
+ * A default-constructed state starts a new optimization.
+ */
+class SGDState
+{
+ public:
+  //! Create the state of a new optimization.
+  SGDState();
+
+  //! Get the number of epochs started.
+  size_t Epoch() const { return epoch; }
+  //! Modify the number of epochs started.
+  size_t& Epoch() { return epoch; }
+
+  //! Get the order of visitation of the functions in the current epoch (empty
+  //! if the functions are not shuffled).
+  const arma::vec& VisitationOrder() const { return visitationOrder; }
+  //! Modify the order of visitation of the functions in the current epoch.
+  arma::vec& VisitationOrder() { return visitationOrder; }
+
+  //! Get the number of functions visited in the current epoch.
+  size_t CurrentFunction() const { return currentFunction; }
+  //! Modify the number of functions visited in the current epoch.
+  size_t& CurrentFunction() { return currentFunction; }
+
+  //! Get the objective of the current epoch (so far).
+  double OverallObjective() const { return overallObjective; }
+  //! Modify the objective of the current epoch (so far).
+  double& OverallObjective() { return overallObjective; }
+
+  //! Get the objective of the last epoch.
+  double LastObjective() const { return lastObjective; }
+  //! Modify the objective of the last epoch.
+  double& LastObjective() { return lastObjective; }
+
+  //! Save the state to a SaveRestoreUtility.
+  void Save(util::SaveRestoreUtility& sr) const;
+
+  //! Load the state from a SaveRestoreUtility.
+  void Load(const util::SaveRestoreUtility& sr);
+
+ private:
+  //! The number of epochs started.
+  size_t epoch;
+  //! The order of visitation of the functions in the current epoch.
+  arma::vec visitationOrder;
+  //! The number of functions visited in the current epoch.
+  size_t currentFunction;
+  //! The objective of the current epoch (so far).
+  double overallObjective;
+  //! The objective of the last epoch.
+  double lastObjective;
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
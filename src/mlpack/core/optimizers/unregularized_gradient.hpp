@@ -0,0 +1,49 @@
+/**
+ * @file unregularized_gradient.hpp
+ *
+ * Detection of the optional UnregularizedGradient() method of decomposable
+ * objective functions, which computes the gradient of one function without its
+ * L2-regularization term, as a sparse matrix.  Decomposable functions over
+ * sparse, high-dimensional data (such as logistic regression on text features)
+ * can implement it, together with Support() and L2Regularization(), so that SGD
+ * can update only the coordinates each function touches and apply the
+ * regularization lazily.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_UNREGULARIZED_GRADIENT_HPP
+#define __MLPACK_CORE_OPTIMIZERS_UNREGULARIZED_GRADIENT_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+HAS_MEM_FUNC(UnregularizedGradient, HasUnregularizedGradientMethod);
+
+/**
+ * Whether or not the given decomposable function type has the method
+ *
+ *   void UnregularizedGradient(const arma::mat& coordinates,
+ *                              const size_t i,
+ *                              arma::sp_mat& gradient);
+ *
+ * (const or not), which stores the gradient of the i'th function without its
+ * L2-regularization term.  A function type which has the method but should not
+ * be optimized with sparse steps (for instance, because its data is dense) can
+ * specialize this trait with a value of false.
+ */
+template<typename FunctionType>
+struct HasUnregularizedGradient
+{
+  static const bool value = HasUnregularizedGradientMethod<FunctionType,
+      void(FunctionType::*)(const arma::mat&, const size_t, arma::sp_mat&)
+      const>::value ||
+      HasUnregularizedGradientMethod<FunctionType,
+      void(FunctionType::*)(const arma::mat&, const size_t, arma::sp_mat&)>::
+      value;
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
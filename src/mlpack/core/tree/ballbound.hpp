@@ -19,7 +19,8 @@ namespace bound {
  * specific point (center). TMetricType is the custom metric type that defaults
  * to the Euclidean (L2) distance.
  *
- * @tparam VecType Type of vector (arma::vec or arma::sp_vec).
+ * @tparam VecType Type of vector (arma::vec, arma::fvec, or arma::sp_vec); the
+ *     element type must match the element type of the data.
  * @tparam TMetricType metric type used in the distance measure.
  */
 template<typename VecType = arma::vec,
@@ -242,7 +242,7 @@ BallBound<VecType, TMetricType>::operator|=(const MatType& data)
     {
       // Move towards the new point and increase the radius just enough to
       // accomodate the new point.
-      arma::vec diff = data.col(i) - center;
+      VecType diff = data.col(i) - center;
       center += ((dist - radius) / (2 * dist)) * diff;
       radius = 0.5 * (dist + radius);
     }
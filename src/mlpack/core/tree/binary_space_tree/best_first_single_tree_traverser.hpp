@@ -0,0 +1,124 @@
+/**
+ * @file best_first_single_tree_traverser.hpp
+ *
+ * Defines the BestFirstSingleTreeTraverser for the BinarySpaceTree tree type.
+ * This is a nested class of BinarySpaceTree which visits the reference nodes in
+ * order of their scores, using a priority queue, and which can stop after a
+ * given number of base cases or node visits.
+ */
+#ifndef __MLPACK_CORE_TREE_BINARY_SPACE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_HPP
+#define __MLPACK_CORE_TREE_BINARY_SPACE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_HPP
+
+#include <mlpack/core.hpp>
+
+#include "binary_space_tree.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A single-tree traverser which visits the reference node with the lowest score
+ * first, instead of recursing.  For neighbor search, the score of a node is the
+ * smallest possible distance to a point in it, so the most promising node is
+ * always visited next, and good candidates are found early.
+ *
+ * The traversal of each query point can be given a budget: a maximum number of
+ * base cases and a maximum number of visited nodes.  When the budget is spent,
+ * the traversal stops, and the results of the rules are the best found so far.
+ * Exact() tells whether the traversal was finished anyway, that is, whether
+ * every node which was not visited could be pruned; in that case the results
+ * are the same as those of a traversal without a budget.
+ */
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+template<typename RuleType>
+class BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
+    BestFirstSingleTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the traverser with the given rule set and budget.
+   *
+   * @param rule Rules to traverse with.
+   * @param maxBaseCases Maximum number of base cases for each query point (0
+   *     means no limit).
+   * @param maxVisits Maximum number of visited nodes for each query point (0
+   *     means no limit).
+   */
+  BestFirstSingleTreeTraverser(RuleType& rule,
+                               const size_t maxBaseCases = 0,
+                               const size_t maxVisits = 0);
+
+  /**
+   * Traverse the tree with the given point, until the traversal is finished or
+   * the budget is spent.  This resets NumVisited(), NumBaseCases() and Exact(),
+   * but not the number of prunes.
+   *
+   * @param queryIndex The index of the point in the query set which is being
+   *     used as the query point.
+   * @param referenceNode The tree node to be traversed.
+   */
+  void Traverse(const size_t queryIndex, BinarySpaceTree& referenceNode);
+
+  //! Get the maximum number of base cases for each query point (0 if there is
+  //! no limit).
+  size_t MaxBaseCases() const { return maxBaseCases; }
+  //! Modify the maximum number of base cases for each query point.
+  size_t& MaxBaseCases() { return maxBaseCases; }
+
+  //! Get the maximum number of visited nodes for each query point (0 if there
+  //! is no limit).
+  size_t MaxVisits() const { return maxVisits; }
+  //! Modify the maximum number of visited nodes for each query point.
+  size_t& MaxVisits() { return maxVisits; }
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return numPrunes; }
+  //! Modify the number of prunes.
+  size_t& NumPrunes() { return numPrunes; }
+
+  //! Get the number of nodes visited in the last traversal.
+  size_t NumVisited() const { return numVisited; }
+
+  //! Get the number of base cases calculated in the last traversal.
+  size_t NumBaseCases() const { return numBaseCases; }
+
+  //! Return whether the last traversal was finished (so its results are the
+  //! same as without a budget).
+  bool Exact() const { return exact; }
+
+ private:
+  //! A node in the queue, with its score.
+  typedef std::pair<double, BinarySpaceTree*> QueueEntry;
+
+  //! Reference to the rules with which the tree will be traversed.
+  RuleType& rule;
+
+  //! The maximum number of base cases for each query point.
+  size_t maxBaseCases;
+  //! The maximum number of visited nodes for each query point.
+  size_t maxVisits;
+
+  //! The number of prunes.
+  size_t numPrunes;
+  //! The number of nodes visited in the last traversal.
+  size_t numVisited;
+  //! The number of base cases calculated in the last traversal.
+  size_t numBaseCases;
+  //! Whether the last traversal was finished.
+  bool exact;
+
+  //! The priority queue (a heap with the lowest score first), held in the
+  //! class so that it isn't reallocated for each query point.
+  std::vector<QueueEntry> queue;
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "best_first_single_tree_traverser_impl.hpp"
+
+#endif // __MLPACK_CORE_TREE_BINARY_SPACE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_HPP
@@ -0,0 +1,129 @@
+/**
+ * @file best_first_single_tree_traverser_impl.hpp
+ *
+ * Implementation of the BestFirstSingleTreeTraverser for BinarySpaceTree.
+ */
+#ifndef __MLPACK_CORE_TREE_BINARY_SPACE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_IMPL_HPP
+#define __MLPACK_CORE_TREE_BINARY_SPACE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "best_first_single_tree_traverser.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace mlpack {
+namespace tree {
+
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+template<typename RuleType>
+BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
+BestFirstSingleTreeTraverser<RuleType>::BestFirstSingleTreeTraverser(
+    RuleType& rule,
+    const size_t maxBaseCases,
+    const size_t maxVisits) :
+    rule(rule),
+    maxBaseCases(maxBaseCases),
+    maxVisits(maxVisits),
+    numPrunes(0),
+    numVisited(0),
+    numBaseCases(0),
+    exact(true)
+{ /* Nothing to do. */ }
+
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+template<typename RuleType>
+void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
+BestFirstSingleTreeTraverser<RuleType>::Traverse(
+    const size_t queryIndex,
+    BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>&
+        referenceNode)
+{
+  numVisited = 0;
+  numBaseCases = 0;
+  exact = true;
+  queue.clear();
+
+  const double rootScore = rule.Score(queryIndex, referenceNode);
+  if (rootScore == DBL_MAX)
+  {
+    ++numPrunes;
+    return;
+  }
+
+  queue.push_back(QueueEntry(rootScore, &referenceNode));
+
+  while (!queue.empty())
+  {
+    std::pop_heap(queue.begin(), queue.end(), std::greater<QueueEntry>());
+    BinarySpaceTree& node = *queue.back().second;
+    const double oldScore = queue.back().first;
+    queue.pop_back();
+
+    // The base cases since the node was scored may allow it to be pruned now.
+    // When the scores increase with the bounds of the rules (as they do for
+    // neighbor search), every other node in the queue is then pruned too.
+    if (rule.Rescore(queryIndex, node, oldScore) == DBL_MAX)
+    {
+      ++numPrunes;
+      continue;
+    }
+
+    // This node can't be pruned, so if the budget is spent, the results may be
+    // different from those of a finished traversal.
+    if ((maxVisits != 0 && numVisited == maxVisits) ||
+        (maxBaseCases != 0 && numBaseCases == maxBaseCases))
+    {
+      exact = false;
+      break;
+    }
+
+    ++numVisited;
+
+    if (node.IsLeaf())
+    {
+      size_t end = node.End();
+      if (maxBaseCases != 0 && node.Count() > maxBaseCases - numBaseCases)
+      {
+        // Only part of the leaf fits into the budget.
+        end = node.Begin() + (maxBaseCases - numBaseCases);
+        exact = false;
+      }
+
+      for (size_t i = node.Begin(); i < end; ++i)
+        rule.BaseCase(queryIndex, i);
+      numBaseCases += end - node.Begin();
+
+      if (!exact)
+        break;
+    }
+    else
+    {
+      // Score the children, and queue the ones which can't be pruned.
+      for (size_t i = 0; i < 2; ++i)
+      {
+        BinarySpaceTree& child = (i == 0) ? *node.Left() : *node.Right();
+        const double score = rule.Score(queryIndex, child);
+        if (score == DBL_MAX)
+        {
+          ++numPrunes;
+          continue;
+        }
+
+        queue.push_back(QueueEntry(score, &child));
+        std::push_heap(queue.begin(), queue.end(), std::greater<QueueEntry>());
+      }
+    }
+  }
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
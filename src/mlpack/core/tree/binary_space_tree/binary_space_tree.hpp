@@ -10,6 +10,7 @@
 #include "mean_split.hpp"
 
 #include "../statistic.hpp"
+#include "../tree_file.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -74,6 +75,11 @@ class BinarySpaceTree
   //! The dataset.
   MatType& dataset;
 
+  //! Nodes with at least this many points are built in parallel (when OpenMP
+  //! is available): their children are built by separate tasks, and their
+  //! bound is found by tasks that each handle this many points.
+  static const size_t ParallelBuildThreshold = 16384;
+
  public:
   //! So other classes can use TreeType::Mat.
   typedef MatType Mat;
@@ -90,10 +96,19 @@ class BinarySpaceTree
   template<typename RuleType>
   class BreadthFirstDualTreeTraverser;
 
+  //! A best-first single-tree traverser with a budget for each query point;
+  //! see best_first_single_tree_traverser.hpp.
+  template<typename RuleType>
+  class BestFirstSingleTreeTraverser;
+
   /**
    * Construct this as the root node of a binary space tree using the given
    * dataset.  This will modify the ordering of the points in the dataset!
    *
+   * Large trees are built in parallel with OpenMP, if it is available.  The
+   * resulting tree (and the ordering of the dataset) does not depend on the
+   * number of threads.
+   *
    * @param data Dataset to create tree from.  This will be modified!
    * @param maxLeafSize Size of each leaf in the tree.
    */
@@ -210,6 +225,19 @@ class BinarySpaceTree
    */
   BinarySpaceTree(const BinarySpaceTree& other);
 
+  /**
+   * Load a node, and all of its descendants, that was written with Save().
+   * Usually this is not called directly; use LoadedTree instead.  The
+   * statistics are built again (from the bottom of the tree up).
+   *
+   * @param data Dataset of the saved tree (in the order of the saved tree).
+   * @param reader Tree file to read the node from.
+   * @param parent Parent of this node (NULL indicates no parent).
+   */
+  BinarySpaceTree(MatType& data,
+                  TreeFileReader& reader,
+                  BinarySpaceTree* parent = NULL);
+
   /**
    * Deletes this node, deallocating the memory for the children and calling
    * their destructors in turn.  This will invalidate any pointers or references
@@ -265,6 +293,14 @@ class BinarySpaceTree
   //! Fills the tree to the specified level.
   size_t ExtendTree(const size_t level);
 
+  /**
+   * Write this node, and all of its descendants, to a tree file.  Usually this
+   * is not called directly; use SaveTree() instead.
+   *
+   * @param writer Tree file to write the node to.
+   */
+  void Save(TreeFileWriter& writer) const;
+
   //! Gets the left child of this node.
   BinarySpaceTree* Left() const { return left; }
   //! Modify the left child of this node.
@@ -294,7 +330,8 @@ class BinarySpaceTree
   typename BoundType::MetricType Metric() const { return bound.Metric(); }
 
   //! Get the centroid of the node and store it in the given vector.
-  void Centroid(arma::vec& centroid) { bound.Centroid(centroid); }
+  void Centroid(typename BoundType::Vec& centroid)
+  { bound.Centroid(centroid); }
 
   //! Return the number of children in this node.
   size_t NumChildren() const;
@@ -463,6 +500,17 @@ class BinarySpaceTree
     return new BinarySpaceTree(begin, count, bound, stat, maxLeafSize);
   }
 
+  /**
+   * Return whether or not a tree on the given dataset should be built by a team
+   * of threads: only if the dataset is large, and not sparse (columns of a
+   * sparse matrix can't be swapped concurrently).
+   */
+  static bool BuildInParallel(const MatType& data)
+  {
+    return (data.n_cols >= ParallelBuildThreshold) &&
+        !arma::is_SpMat<MatType>::value;
+  }
+
   /**
    * Splits the current node, assigning its left and right children recursively.
    *
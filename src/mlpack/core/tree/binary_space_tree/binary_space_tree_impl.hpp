@@ -16,6 +16,58 @@
 namespace mlpack {
 namespace tree {
 
+/**
+ * Expand the given bound to include the points data.cols(begin, begin + count -
+ * 1).  This is the generic version, which adds the points in order, for bounds
+ * such as BallBound that depend on the order of the points.
+ */
+template<typename BoundType, typename MatType>
+void ExpandBound(BoundType& bound,
+                 const MatType& data,
+                 const size_t begin,
+                 const size_t count,
+                 const size_t /* chunkSize */)
+{
+  bound |= data.cols(begin, begin + count - 1);
+}
+
+/**
+ * Expand the given hyperrectangle bound to include the points
+ * data.cols(begin, begin + count - 1).  If there are many points, they are
+ * split into chunks of chunkSize points, and the bound of each chunk is found
+ * by a separate task; the result is the same either way.
+ */
+template<int Power, bool TakeRoot, typename MatType>
+void ExpandBound(bound::HRectBound<Power, TakeRoot>& bound,
+                 const MatType& data,
+                 const size_t begin,
+                 const size_t count,
+                 const size_t chunkSize)
+{
+  if (count < 2 * chunkSize)
+  {
+    bound |= data.cols(begin, begin + count - 1);
+    return;
+  }
+
+  const size_t numChunks = (count + chunkSize - 1) / chunkSize;
+  std::vector<bound::HRectBound<Power, TakeRoot> > chunkBounds(numChunks,
+      bound::HRectBound<Power, TakeRoot>(data.n_rows));
+  for (size_t i = 0; i < numChunks; ++i)
+  {
+    #pragma omp task shared(chunkBounds, data)
+    {
+      const size_t first = begin + i * chunkSize;
+      const size_t last = std::min(first + chunkSize, begin + count) - 1;
+      chunkBounds[i] |= data.cols(first, last);
+    }
+  }
+  #pragma omp taskwait
+
+  for (size_t i = 0; i < numChunks; ++i)
+    bound |= chunkBounds[i];
+}
+
 // Each of these overloads is kept as a separate function to keep the overhead
 // from the two std::vectors out, if possible.
 template<typename BoundType,
@@ -35,8 +87,14 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
     dataset(data)
 {
-  // Do the actual splitting of this node.
-  SplitNode(data);
+  // Do the actual splitting of this node.  If the dataset is large, a team of
+  // threads is started, and SplitNode() splits the work between them as tasks;
+  // see BuildInParallel().
+  #pragma omp parallel if (BuildInParallel(data))
+  {
+    #pragma omp single
+    SplitNode(data);
+  }
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -65,8 +123,14 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
   for (size_t i = 0; i < data.n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
-  // Now do the actual splitting.
-  SplitNode(data, oldFromNew);
+  // Now do the actual splitting.  If the dataset is large, a team of threads is
+  // started, and SplitNode() splits the work between them as tasks; see
+  // BuildInParallel().
+  #pragma omp parallel if (BuildInParallel(data))
+  {
+    #pragma omp single
+    SplitNode(data, oldFromNew);
+  }
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -96,8 +160,14 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
   for (size_t i = 0; i < data.n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
-  // Now do the actual splitting.
-  SplitNode(data, oldFromNew);
+  // Now do the actual splitting.  If the dataset is large, a team of threads is
+  // started, and SplitNode() splits the work between them as tasks; see
+  // BuildInParallel().
+  #pragma omp parallel if (BuildInParallel(data))
+  {
+    #pragma omp single
+    SplitNode(data, oldFromNew);
+  }
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -254,6 +324,52 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
   }
 }
 
+/**
+ * Load a node and its descendants from a tree file.
+ */
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
+    MatType& data,
+    TreeFileReader& reader,
+    BinarySpaceTree* parent) :
+    left(NULL),
+    right(NULL),
+    parent(parent),
+    bound(data.n_rows),
+    dataset(data)
+{
+  // The fields are read in the order they are written by Save().
+  reader.Read(begin);
+  reader.Read(count);
+  reader.Read(maxLeafSize);
+  reader.Read(splitDimension);
+  reader.Read(parentDistance);
+  reader.Read(furthestDescendantDistance);
+  reader.Read(minimumBoundDistance);
+  LoadBound(reader, bound);
+
+  if (begin > data.n_cols || count > data.n_cols - begin)
+  {
+    Log::Fatal << "BinarySpaceTree: tree file is corrupt (node with " << count
+        << " points from point " << begin << " of " << data.n_cols << ")!"
+        << std::endl;
+  }
+
+  uint8_t hasChildren;
+  reader.Read(hasChildren);
+  if (hasChildren)
+  {
+    left = new BinarySpaceTree(data, reader, this);
+    right = new BinarySpaceTree(data, reader, this);
+  }
+
+  // The statistic is built after the children, as it is during construction.
+  stat = StatisticType(*this);
+}
+
 /**
  * Deletes this node, deallocating the memory for the children and calling their
  * destructors in turn.  This will invalidate any pointers or references to any
@@ -340,6 +456,32 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::FindByBeginCount(
     return NULL;
 }
 
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::Save(
+    TreeFileWriter& writer) const
+{
+  writer.Write(begin);
+  writer.Write(count);
+  writer.Write(maxLeafSize);
+  writer.Write(splitDimension);
+  writer.Write(parentDistance);
+  writer.Write(furthestDescendantDistance);
+  writer.Write(minimumBoundDistance);
+  SaveBound(writer, bound);
+
+  // Every node has either two children or none.
+  const uint8_t hasChildren = (left != NULL) ? 1 : 0;
+  writer.Write(hasChildren);
+  if (hasChildren)
+  {
+    left->Save(writer);
+    right->Save(writer);
+  }
+}
+
 template<typename BoundType,
          typename StatisticType,
          typename MatType,
@@ -566,7 +708,7 @@ void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::SplitNode(
     MatType& data)
 {
   // We need to expand the bounds of this node properly.
-  bound |= data.cols(begin, begin + count - 1);
+  ExpandBound(bound, data, begin, count, ParallelBuildThreshold);
 
   // Calculate the furthest descendant distance.
   furthestDescendantDistance = 0.5 * bound.Diameter();
@@ -591,14 +733,18 @@ void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::SplitNode(
     return;
 
   // Now that we know the split column, we will recursively split the children
-  // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree<BoundType, StatisticType, MatType>(data, begin,
-      splitCol - begin, this, maxLeafSize);
-  right = new BinarySpaceTree<BoundType, StatisticType, MatType>(data, splitCol,
-      begin + count - splitCol, this, maxLeafSize);
+  // by calling their constructors (which perform this splitting process).  The
+  // children hold disjoint parts of the dataset, so if this node is large
+  // enough, they are built by separate tasks.
+  #pragma omp task shared(data) if (count >= ParallelBuildThreshold)
+  left = new BinarySpaceTree(data, begin, splitCol - begin, this, maxLeafSize);
+  #pragma omp task shared(data) if (count >= ParallelBuildThreshold)
+  right = new BinarySpaceTree(data, splitCol, begin + count - splitCol, this,
+      maxLeafSize);
+  #pragma omp taskwait
 
   // Calculate parent distances for those two nodes.
-  arma::vec centroid, leftCentroid, rightCentroid;
+  typename BoundType::Vec centroid, leftCentroid, rightCentroid;
   Centroid(centroid);
   left->Centroid(leftCentroid);
   right->Centroid(rightCentroid);
@@ -620,9 +766,8 @@ void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::SplitNode(
     MatType& data,
     std::vector<size_t>& oldFromNew)
 {
-  // This should be a single function for Bound.
   // We need to expand the bounds of this node properly.
-  bound |= data.cols(begin, begin + count - 1);
+  ExpandBound(bound, data, begin, count, ParallelBuildThreshold);
 
   // Calculate the furthest descendant distance.
   furthestDescendantDistance = 0.5 * bound.Diameter();
@@ -648,14 +793,19 @@ void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::SplitNode(
     return;
 
   // Now that we know the split column, we will recursively split the children
-  // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree<BoundType, StatisticType, MatType>(data, begin,
-      splitCol - begin, oldFromNew, this, maxLeafSize);
-  right = new BinarySpaceTree<BoundType, StatisticType, MatType>(data, splitCol,
-      begin + count - splitCol, oldFromNew, this, maxLeafSize);
+  // by calling their constructors (which perform this splitting process).  The
+  // children hold disjoint parts of the dataset and oldFromNew, so if this node
+  // is large enough, they are built by separate tasks.
+  #pragma omp task shared(data, oldFromNew) if (count >= ParallelBuildThreshold)
+  left = new BinarySpaceTree(data, begin, splitCol - begin, oldFromNew, this,
+      maxLeafSize);
+  #pragma omp task shared(data, oldFromNew) if (count >= ParallelBuildThreshold)
+  right = new BinarySpaceTree(data, splitCol, begin + count - splitCol,
+      oldFromNew, this, maxLeafSize);
+  #pragma omp taskwait
 
   // Calculate parent distances for those two nodes.
-  arma::vec centroid, leftCentroid, rightCentroid;
+  typename BoundType::Vec centroid, leftCentroid, rightCentroid;
   Centroid(centroid);
   left->Centroid(leftCentroid);
   right->Centroid(rightCentroid);
@@ -13,6 +13,7 @@
 #include <mlpack/core.hpp>
 
 #include "binary_space_tree.hpp"
+#include "../tree_traits.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -80,6 +81,11 @@ class BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
   //! Traversal information, held in the class so that it isn't continually
   //! being reallocated.
   typename RuleType::TraversalInfoType traversalInfo;
+
+  //! The points of a query leaf which were not pruned, held in the class so
+  //! that it isn't continually being reallocated (only used for rules with
+  //! RuleTraits<RuleType>::HasBlockBaseCase).
+  std::vector<size_t> blockQueries;
 };
 
 }; // namespace tree
@@ -15,6 +15,39 @@
 namespace mlpack {
 namespace tree {
 
+//! Run the base cases between the given query points and a range of reference
+//! points one pair at a time, for rules without BlockBaseCase().
+template<typename RuleType>
+void BlockBaseCase(
+    RuleType& rule,
+    const std::vector<size_t>& queryIndices,
+    const size_t referenceBegin,
+    const size_t referenceCount,
+    const typename boost::enable_if_c<
+        RuleTraits<RuleType>::HasBlockBaseCase == false, RuleType*
+    >::type = 0)
+{
+  for (size_t i = 0; i < queryIndices.size(); ++i)
+    for (size_t ref = referenceBegin; ref < referenceBegin + referenceCount;
+         ++ref)
+      rule.BaseCase(queryIndices[i], ref);
+}
+
+//! Run the base cases between the given query points and a range of reference
+//! points all at once, for rules with BlockBaseCase().
+template<typename RuleType>
+void BlockBaseCase(
+    RuleType& rule,
+    const std::vector<size_t>& queryIndices,
+    const size_t referenceBegin,
+    const size_t referenceCount,
+    const typename boost::enable_if_c<
+        RuleTraits<RuleType>::HasBlockBaseCase == true, RuleType*
+    >::type = 0)
+{
+  rule.BlockBaseCase(queryIndices, referenceBegin, referenceCount);
+}
+
 template<typename BoundType,
          typename StatisticType,
          typename MatType,
@@ -47,7 +80,27 @@ DualTreeTraverser<RuleType>::Traverse(
   traversalInfo = rule.TraversalInfo();
 
   // If both are leaves, we must evaluate the base case.
-  if (queryNode.IsLeaf() && referenceNode.IsLeaf())
+  if (queryNode.IsLeaf() && referenceNode.IsLeaf() &&
+      RuleTraits<RuleType>::HasBlockBaseCase)
+  {
+    // Find the query points which can't be pruned, and then run all of their
+    // base cases at once.
+    blockQueries.clear();
+    for (size_t query = queryNode.Begin(); query < queryNode.End(); ++query)
+    {
+      rule.TraversalInfo() = traversalInfo;
+      if (rule.Score(query, referenceNode) != DBL_MAX)
+        blockQueries.push_back(query);
+    }
+
+    if (!blockQueries.empty())
+    {
+      BlockBaseCase(rule, blockQueries, referenceNode.Begin(),
+          referenceNode.Count());
+      numBaseCases += blockQueries.size() * referenceNode.Count();
+    }
+  }
+  else if (queryNode.IsLeaf() && referenceNode.IsLeaf())
   {
     // Loop through each of the points in each node.
     for (size_t query = queryNode.Begin(); query < queryNode.End(); ++query)
@@ -18,6 +18,10 @@ namespace tree /** Trees and tree-building procedures. */ {
  * A binary space partitioning tree node is split into its left and right child.
  * The split is done in the dimension that has the maximum width. The points are
  * divided into two parts based on the mean in this dimension.
+ *
+ * Large nodes are partitioned in parallel with OpenMP tasks (when OpenMP is
+ * available), in a way that gives exactly the same ordering of the points as
+ * the serial partition.
  */
 template<typename BoundType, typename MatType = arma::mat>
 class MeanSplit
@@ -69,6 +73,10 @@ class MeanSplit
                         std::vector<size_t>& oldFromNew);
 
  private:
+  //! Nodes with at least twice this many points are partitioned in parallel,
+  //! by tasks that each handle this many points.
+  static const size_t ParallelChunkSize = 16384;
+
   /**
    * Reorder the dataset into two parts such that they lie on either side of
    * splitCol.
@@ -107,6 +115,30 @@ class MeanSplit
                              const size_t splitDimension,
                              const double splitVal,
                              std::vector<size_t>& oldFromNew);
+
+  /**
+   * Reorder the dataset into two parts such that they lie on either side of
+   * splitCol, using tasks that each handle ParallelChunkSize points.  The
+   * points that are on the wrong side are found with parallel scans; then the
+   * k'th wrong point from the left is swapped with the k'th wrong point from
+   * the right, which is exactly what the serial PerformSplit() does.
+   *
+   * @param data The dataset used by the binary space tree.
+   * @param begin Index of the starting point in the dataset that belongs to
+   *    this node.
+   * @param count Number of points in this node.
+   * @param splitDimension The dimension to split the node on.
+   * @param splitVal The split in dimension splitDimension is based on this
+   *    value.
+   * @param oldFromNew Vector of the old positions of each new point to update
+   *    (or NULL, if there is none).
+   */
+  static size_t ParallelPerformSplit(MatType& data,
+                                     const size_t begin,
+                                     const size_t count,
+                                     const size_t splitDimension,
+                                     const double splitVal,
+                                     std::vector<size_t>* oldFromNew);
 };
 
 }; // namespace tree
@@ -99,6 +99,11 @@ size_t MeanSplit<BoundType, MatType>::
                  const size_t splitDimension,
                  const double splitVal)
 {
+  // Large nodes are split by several tasks.
+  if (count >= 2 * ParallelChunkSize)
+    return ParallelPerformSplit(data, begin, count, splitDimension, splitVal,
+        NULL);
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.  The points less than
   // splitVal should be on the left side of the matrix, and the points greater
@@ -146,6 +151,11 @@ size_t MeanSplit<BoundType, MatType>::
                  const double splitVal,
                  std::vector<size_t>& oldFromNew)
 {
+  // Large nodes are split by several tasks.
+  if (count >= 2 * ParallelChunkSize)
+    return ParallelPerformSplit(data, begin, count, splitDimension, splitVal,
+        &oldFromNew);
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.  The points less than
   // splitVal should be on the left side of the matrix, and the points greater
@@ -189,6 +199,94 @@ size_t MeanSplit<BoundType, MatType>::
   return left;
 }
 
+template<typename BoundType, typename MatType>
+size_t MeanSplit<BoundType, MatType>::
+    ParallelPerformSplit(MatType& data,
+                         const size_t begin,
+                         const size_t count,
+                         const size_t splitDimension,
+                         const double splitVal,
+                         std::vector<size_t>* oldFromNew)
+{
+  const size_t end = begin + count;
+  const size_t numChunks = (count + ParallelChunkSize - 1) / ParallelChunkSize;
+
+  // First, count the points that belong on the left side in each chunk; this
+  // tells us where splitCol will be.
+  std::vector<size_t> leftCounts(numChunks, 0);
+  for (size_t c = 0; c < numChunks; ++c)
+  {
+    #pragma omp task shared(data, leftCounts)
+    {
+      const size_t first = begin + c * ParallelChunkSize;
+      const size_t last = std::min(first + ParallelChunkSize, end);
+      for (size_t i = first; i < last; ++i)
+        if (data(splitDimension, i) < splitVal)
+          ++leftCounts[c];
+    }
+  }
+  #pragma omp taskwait
+
+  size_t splitCol = begin;
+  for (size_t c = 0; c < numChunks; ++c)
+    splitCol += leftCounts[c];
+
+  // Now find the points that are on the wrong side of splitCol, in order.
+  std::vector<std::vector<size_t> > misplaced(numChunks);
+  for (size_t c = 0; c < numChunks; ++c)
+  {
+    #pragma omp task shared(data, misplaced)
+    {
+      const size_t first = begin + c * ParallelChunkSize;
+      const size_t last = std::min(first + ParallelChunkSize, end);
+      for (size_t i = first; i < last; ++i)
+      {
+        const bool belongsLeft = (data(splitDimension, i) < splitVal);
+        if (belongsLeft != (i < splitCol))
+          misplaced[c].push_back(i);
+      }
+    }
+  }
+  #pragma omp taskwait
+
+  std::vector<size_t> wrongLeft, wrongRight;
+  for (size_t c = 0; c < numChunks; ++c)
+  {
+    for (size_t i = 0; i < misplaced[c].size(); ++i)
+    {
+      if (misplaced[c][i] < splitCol)
+        wrongLeft.push_back(misplaced[c][i]);
+      else
+        wrongRight.push_back(misplaced[c][i]);
+    }
+  }
+
+  Log::Assert(wrongLeft.size() == wrongRight.size());
+
+  // The serial algorithm swaps the first wrong point from the left with the
+  // first wrong point from the right, and so on; do the same swaps.
+  const size_t numSwaps = wrongLeft.size();
+  for (size_t first = 0; first < numSwaps; first += ParallelChunkSize)
+  {
+    #pragma omp task shared(data, wrongLeft, wrongRight)
+    {
+      const size_t last = std::min(first + ParallelChunkSize, numSwaps);
+      for (size_t k = first; k < last; ++k)
+      {
+        const size_t leftIndex = wrongLeft[k];
+        const size_t rightIndex = wrongRight[numSwaps - 1 - k];
+        data.swap_cols(leftIndex, rightIndex);
+
+        if (oldFromNew != NULL)
+          std::swap((*oldFromNew)[leftIndex], (*oldFromNew)[rightIndex]);
+      }
+    }
+  }
+  #pragma omp taskwait
+
+  return splitCol;
+}
+
 }; // namespace tree
 }; // namespace mlpack
 
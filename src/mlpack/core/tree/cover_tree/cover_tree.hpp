@@ -11,6 +11,7 @@
 #include <mlpack/core/metrics/lmetric.hpp>
 #include "first_point_is_root.hpp"
 #include "../statistic.hpp"
+#include "../tree_file.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -71,24 +72,30 @@ namespace tree {
  * }
  * @endcode
  *
- * The CoverTree class offers three template parameters; a custom metric type
+ * The CoverTree class offers four template parameters; a custom metric type
  * can be used with MetricType (this class defaults to the L2-squared metric).
  * The root node's point can be chosen with the RootPointPolicy; by default, the
  * FirstPointIsRoot policy is used, meaning the first point in the dataset is
  * used.  The StatisticType policy allows you to define statistics which can be
- * gathered during the creation of the tree.
+ * gathered during the creation of the tree.  The MatType parameter is the type
+ * of the dataset; use arma::fmat to build the tree on single-precision data.
  *
  * @tparam MetricType Metric type to use during tree construction.
  * @tparam RootPointPolicy Determines which point to use as the root node.
  * @tparam StatisticType Statistic to be used during tree creation.
+ * @tparam MatType Type of matrix (arma::mat or arma::fmat).
  */
 template<typename MetricType = metric::LMetric<2, true>,
          typename RootPointPolicy = FirstPointIsRoot,
-         typename StatisticType = EmptyStatistic>
+         typename StatisticType = EmptyStatistic,
+         typename MatType = arma::mat>
 class CoverTree
 {
  public:
-  typedef arma::mat Mat;
+  //! So other classes can use TreeType::Mat.
+  typedef MatType Mat;
+  //! The type of a point in the dataset.
+  typedef arma::Col<typename MatType::elem_type> VecType;
 
   /**
    * Create the cover tree with the given dataset and given base.
@@ -100,7 +107,7 @@ class CoverTree
    * @param dataset Reference to the dataset to build a tree on.
    * @param base Base to use during tree building (default 2.0).
    */
-  CoverTree(const arma::mat& dataset,
+  CoverTree(const MatType& dataset,
             const double base = 2.0,
             MetricType* metric = NULL);
 
@@ -113,7 +120,7 @@ class CoverTree
    * @param metric Instantiated metric to use during tree building.
    * @param base Base to use during tree building (default 2.0).
    */
-  CoverTree(const arma::mat& dataset,
+  CoverTree(const MatType& dataset,
             MetricType& metric,
             const double base = 2.0);
 
@@ -148,7 +155,7 @@ class CoverTree
    *     any points in the far set).
    * @param usedSetSize The number of points used will be added to this number.
    */
-  CoverTree(const arma::mat& dataset,
+  CoverTree(const MatType& dataset,
             const double base,
             const size_t pointIndex,
             const int scale,
@@ -177,7 +184,7 @@ class CoverTree
    * @param furthestDescendantDistance Distance to furthest descendant point.
    * @param metric Instantiated metric (optional).
    */
-  CoverTree(const arma::mat& dataset,
+  CoverTree(const MatType& dataset,
             const double base,
             const size_t pointIndex,
             const int scale,
@@ -194,11 +201,49 @@ class CoverTree
    */
   CoverTree(const CoverTree& other);
 
+  /**
+   * Load a node, and all of its descendants, that was written with Save().
+   * Usually this is not called directly; use LoadedTree instead.  The
+   * statistics are built again (from the bottom of the tree up).
+   *
+   * @param dataset Dataset of the saved tree.
+   * @param reader Tree file to read the node from.
+   * @param parent Parent of this node (NULL indicates no parent).
+   * @param metric Instantiated metric (optional; the children of the node use
+   *     the same metric).
+   */
+  CoverTree(const MatType& dataset,
+            TreeFileReader& reader,
+            CoverTree* parent = NULL,
+            MetricType* metric = NULL);
+
   /**
    * Delete this cover tree node and its children.
    */
   ~CoverTree();
 
+  /**
+   * Insert a point into the tree, without rebuilding it.  The point must
+   * already be a column of the dataset the tree was built on (for instance,
+   * added with insert_cols() after the tree was built; the dataset is held by
+   * reference).  The point is placed below the deepest node that covers it, so
+   * the covering and nesting invariants are kept, but the separation invariant
+   * is not enforced; after many insertions the tree may be less efficient than
+   * a freshly built one.  If this is not the root of the tree, the point is
+   * inserted starting at the root.
+   *
+   * @param pointIndex Index of the point in the dataset.
+   */
+  void Insert(const size_t pointIndex);
+
+  /**
+   * Write this node, and all of its descendants, to a tree file.  Usually this
+   * is not called directly; use SaveTree() instead.
+   *
+   * @param writer Tree file to write the node to.
+   */
+  void Save(TreeFileWriter& writer) const;
+
   //! A single-tree cover tree traverser; see single_tree_traverser.hpp for
   //! implementation.
   template<typename RuleType>
@@ -209,7 +254,7 @@ class CoverTree
   class DualTreeTraverser;
 
   //! Get a reference to the dataset.
-  const arma::mat& Dataset() const { return dataset; }
+  const MatType& Dataset() const { return dataset; }
 
   //! Get the index of the point which this node represents.
   size_t Point() const { return point; }
@@ -261,11 +306,11 @@ class CoverTree
   double MinDistance(const CoverTree* other, const double distance) const;
 
   //! Return the minimum distance to another point.
-  double MinDistance(const arma::vec& other) const;
+  double MinDistance(const VecType& other) const;
 
   //! Return the minimum distance to another point given that the distance from
   //! the center to the point has already been calculated.
-  double MinDistance(const arma::vec& other, const double distance) const;
+  double MinDistance(const VecType& other, const double distance) const;
 
   //! Return the maximum distance to another node.
   double MaxDistance(const CoverTree* other) const;
@@ -275,11 +320,11 @@ class CoverTree
   double MaxDistance(const CoverTree* other, const double distance) const;
 
   //! Return the maximum distance to another point.
-  double MaxDistance(const arma::vec& other) const;
+  double MaxDistance(const VecType& other) const;
 
   //! Return the maximum distance to another point given that the distance from
   //! the center to the point has already been calculated.
-  double MaxDistance(const arma::vec& other, const double distance) const;
+  double MaxDistance(const VecType& other, const double distance) const;
 
   //! Return the minimum and maximum distance to another node.
   math::Range RangeDistance(const CoverTree* other) const;
@@ -290,11 +335,11 @@ class CoverTree
       const;
 
   //! Return the minimum and maximum distance to another point.
-  math::Range RangeDistance(const arma::vec& other) const;
+  math::Range RangeDistance(const VecType& other) const;
 
   //! Return the minimum and maximum distance to another point given that the
   //! point-to-point distance has already been calculated.
-  math::Range RangeDistance(const arma::vec& other, const double distance)
+  math::Range RangeDistance(const VecType& other, const double distance)
       const;
 
   //! Returns true: this tree does have self-children.
@@ -325,14 +370,14 @@ class CoverTree
   double MinimumBoundDistance() const { return furthestDescendantDistance; }
 
   //! Get the centroid of the node and store it in the given vector.
-  void Centroid(arma::vec& centroid) const { centroid = dataset.col(point); }
+  void Centroid(VecType& centroid) const { centroid = dataset.col(point); }
 
   //! Get the instantiated metric.
   MetricType& Metric() const { return *metric; }
 
  private:
   //! Reference to the matrix which this tree is built on.
-  const arma::mat& dataset;
+  const MatType& dataset;
 
   //! Index of the point in the matrix which this node represents.
   size_t point;
@@ -367,6 +412,9 @@ class CoverTree
   //! The metric used for this tree.
   MetricType* metric;
 
+  //! Point sets at least this large have their distances computed in parallel.
+  static const size_t ParallelDistanceThreshold = 4096;
+
   /**
    * Create the children for this node.
    */
@@ -428,12 +476,17 @@ class CoverTree
    * @param childFarSetSize Number of points in child far set (childFarSet).
    * @param childUsedSetSize Number of points in child used set (childUsedSet).
    * @param farSetSize Number of points in far set (farSet).
+   * @param indicesBuffer Scratch space for indices; grown if it is too small.
+   * @param distancesBuffer Scratch space for distances; grown if it is too
+   *     small.
    */
   size_t SortPointSet(arma::Col<size_t>& indices,
                       arma::vec& distances,
                       const size_t childFarSetSize,
                       const size_t childUsedSetSize,
-                      const size_t farSetSize);
+                      const size_t farSetSize,
+                      arma::Col<size_t>& indicesBuffer,
+                      arma::vec& distancesBuffer);
 
   void MoveToUsedSet(arma::Col<size_t>& indices,
                      arma::vec& distances,
@@ -455,6 +508,16 @@ class CoverTree
    */
   void RemoveNewImplicitNodes();
 
+  /**
+   * Insert a point into the subtree rooted at this node, which covers it.  The
+   * number of descendants, the furthest descendant distance and the statistic
+   * of each node on the way down are updated.
+   *
+   * @param pointIndex Index of the point in the dataset.
+   * @param distance Distance between the point of this node and the new point.
+   */
+  void InsertPoint(const size_t pointIndex, const double distance);
+
  public:
   /**
    * Returns a string representation of this object.
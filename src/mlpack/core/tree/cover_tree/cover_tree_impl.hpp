@@ -17,9 +17,12 @@ namespace mlpack {
 namespace tree {
 
 // Create the cover tree.
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-CoverTree<MetricType, RootPointPolicy, StatisticType>::CoverTree(
-    const arma::mat& dataset,
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CoverTree(
+    const MatType& dataset,
     const double base,
     MetricType* metric) :
     dataset(dataset),
@@ -98,9 +101,12 @@ CoverTree<MetricType, RootPointPolicy, StatisticType>::CoverTree(
       << "construction." << std::endl;
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-CoverTree<MetricType, RootPointPolicy, StatisticType>::CoverTree(
-    const arma::mat& dataset,
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CoverTree(
+    const MatType& dataset,
     MetricType& metric,
     const double base) :
     dataset(dataset),
@@ -175,9 +181,12 @@ CoverTree<MetricType, RootPointPolicy, StatisticType>::CoverTree(
       << "construction." << std::endl;
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-CoverTree<MetricType, RootPointPolicy, StatisticType>::CoverTree(
-    const arma::mat& dataset,
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CoverTree(
+    const MatType& dataset,
     const double base,
     const size_t pointIndex,
     const int scale,
@@ -218,9 +227,12 @@ CoverTree<MetricType, RootPointPolicy, StatisticType>::CoverTree(
 }
 
 // Manually create a cover tree node.
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-CoverTree<MetricType, RootPointPolicy, StatisticType>::CoverTree(
-    const arma::mat& dataset,
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CoverTree(
+    const MatType& dataset,
     const double base,
     const size_t pointIndex,
     const int scale,
@@ -248,8 +260,11 @@ CoverTree<MetricType, RootPointPolicy, StatisticType>::CoverTree(
   stat = StatisticType(*this);
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-CoverTree<MetricType, RootPointPolicy, StatisticType>::CoverTree(
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CoverTree(
     const CoverTree& other) :
     dataset(other.dataset),
     point(other.point),
@@ -272,8 +287,54 @@ CoverTree<MetricType, RootPointPolicy, StatisticType>::CoverTree(
   }
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-CoverTree<MetricType, RootPointPolicy, StatisticType>::~CoverTree()
+// Load a node and its descendants from a tree file.
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CoverTree(
+    const MatType& dataset,
+    TreeFileReader& reader,
+    CoverTree* parent,
+    MetricType* metric) :
+    dataset(dataset),
+    parent(parent),
+    localMetric(metric == NULL),
+    metric(metric),
+    distanceComps(0)
+{
+  // If necessary, create a local metric.
+  if (localMetric)
+    this->metric = new MetricType();
+
+  // The fields are read in the order they are written by Save().
+  reader.Read(point);
+  if (point >= dataset.n_cols)
+  {
+    Log::Fatal << "CoverTree: tree file is corrupt (point " << point << " of "
+        << dataset.n_cols << ")!" << std::endl;
+  }
+
+  reader.Read(scale);
+  reader.Read(base);
+  reader.Read(numDescendants);
+  reader.Read(parentDistance);
+  reader.Read(furthestDescendantDistance);
+
+  uint64_t numChildren;
+  reader.Read(numChildren);
+  for (size_t i = 0; i < numChildren; ++i)
+    children.push_back(new CoverTree(dataset, reader, this, this->metric));
+
+  // The statistic is built after the children, as it is during construction.
+  stat = StatisticType(*this);
+}
+
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::~CoverTree()
 {
   // Delete each child.
   for (size_t i = 0; i < children.size(); ++i)
@@ -285,17 +346,24 @@ CoverTree<MetricType, RootPointPolicy, StatisticType>::~CoverTree()
 }
 
 //! Return the number of descendant points.
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
 inline size_t
-CoverTree<MetricType, RootPointPolicy, StatisticType>::NumDescendants() const
+CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+    NumDescendants() const
 {
   return numDescendants;
 }
 
 //! Return the index of a particular descendant point.
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
 inline size_t
-CoverTree<MetricType, RootPointPolicy, StatisticType>::Descendant(
+CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::Descendant(
     const size_t index) const
 {
   // The first descendant is the point contained within this node.
@@ -319,9 +387,13 @@ CoverTree<MetricType, RootPointPolicy, StatisticType>::Descendant(
   return (size_t() - 1);
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-double CoverTree<MetricType, RootPointPolicy, StatisticType>::MinDistance(
-    const CoverTree<MetricType, RootPointPolicy, StatisticType>* other) const
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+double CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+MinDistance(
+    const CoverTree* other) const
 {
   // Every cover tree node will contain points up to base^(scale + 1) away.
   return std::max(metric->Evaluate(dataset.unsafe_col(point),
@@ -329,9 +401,13 @@ double CoverTree<MetricType, RootPointPolicy, StatisticType>::MinDistance(
       furthestDescendantDistance - other->FurthestDescendantDistance(), 0.0);
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-double CoverTree<MetricType, RootPointPolicy, StatisticType>::MinDistance(
-    const CoverTree<MetricType, RootPointPolicy, StatisticType>* other,
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+double CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+MinDistance(
+    const CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>* other,
     const double distance) const
 {
   // We already have the distance as evaluated by the metric.
@@ -339,34 +415,50 @@ double CoverTree<MetricType, RootPointPolicy, StatisticType>::MinDistance(
       other->FurthestDescendantDistance(), 0.0);
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-double CoverTree<MetricType, RootPointPolicy, StatisticType>::MinDistance(
-    const arma::vec& other) const
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+double CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+MinDistance(
+    const VecType& other) const
 {
   return std::max(metric->Evaluate(dataset.unsafe_col(point), other) -
       furthestDescendantDistance, 0.0);
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-double CoverTree<MetricType, RootPointPolicy, StatisticType>::MinDistance(
-    const arma::vec& /* other */,
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+double CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+MinDistance(
+    const VecType& /* other */,
     const double distance) const
 {
   return std::max(distance - furthestDescendantDistance, 0.0);
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-double CoverTree<MetricType, RootPointPolicy, StatisticType>::MaxDistance(
-    const CoverTree<MetricType, RootPointPolicy, StatisticType>* other) const
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+double CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+MaxDistance(
+    const CoverTree* other) const
 {
   return metric->Evaluate(dataset.unsafe_col(point),
       other->Dataset().unsafe_col(other->Point())) +
       furthestDescendantDistance + other->FurthestDescendantDistance();
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-double CoverTree<MetricType, RootPointPolicy, StatisticType>::MaxDistance(
-    const CoverTree<MetricType, RootPointPolicy, StatisticType>* other,
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+double CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+MaxDistance(
+    const CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>* other,
     const double distance) const
 {
   // We already have the distance as evaluated by the metric.
@@ -374,25 +466,36 @@ double CoverTree<MetricType, RootPointPolicy, StatisticType>::MaxDistance(
       other->FurthestDescendantDistance();
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-double CoverTree<MetricType, RootPointPolicy, StatisticType>::MaxDistance(
-    const arma::vec& other) const
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+double CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+MaxDistance(
+    const VecType& other) const
 {
   return metric->Evaluate(dataset.unsafe_col(point), other) +
       furthestDescendantDistance;
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-double CoverTree<MetricType, RootPointPolicy, StatisticType>::MaxDistance(
-    const arma::vec& /* other */,
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+double CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+MaxDistance(
+    const VecType& /* other */,
     const double distance) const
 {
   return distance + furthestDescendantDistance;
 }
 
 //! Return the minimum and maximum distance to another node.
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-math::Range CoverTree<MetricType, RootPointPolicy, StatisticType>::
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+math::Range CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
     RangeDistance(const CoverTree* other) const
 {
   const double distance = metric->Evaluate(dataset.unsafe_col(point),
@@ -409,8 +512,11 @@ math::Range CoverTree<MetricType, RootPointPolicy, StatisticType>::
 
 //! Return the minimum and maximum distance to another node given that the
 //! point-to-point distance has already been calculated.
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-math::Range CoverTree<MetricType, RootPointPolicy, StatisticType>::
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+math::Range CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
     RangeDistance(const CoverTree* other,
                   const double distance) const
 {
@@ -424,9 +530,12 @@ math::Range CoverTree<MetricType, RootPointPolicy, StatisticType>::
 }
 
 //! Return the minimum and maximum distance to another point.
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-math::Range CoverTree<MetricType, RootPointPolicy, StatisticType>::
-    RangeDistance(const arma::vec& other) const
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+math::Range CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+    RangeDistance(const VecType& other) const
 {
   const double distance = metric->Evaluate(dataset.unsafe_col(point), other);
 
@@ -436,9 +545,12 @@ math::Range CoverTree<MetricType, RootPointPolicy, StatisticType>::
 
 //! Return the minimum and maximum distance to another point given that the
 //! point-to-point distance has already been calculated.
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-math::Range CoverTree<MetricType, RootPointPolicy, StatisticType>::
-    RangeDistance(const arma::vec& /* other */,
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+math::Range CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+    RangeDistance(const VecType& /* other */,
                   const double distance) const
 {
   return math::Range(distance - furthestDescendantDistance,
@@ -446,15 +558,25 @@ math::Range CoverTree<MetricType, RootPointPolicy, StatisticType>::
 }
 
 //! For a newly initialized node, create children using the near and far set.
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
 inline void
-CoverTree<MetricType, RootPointPolicy, StatisticType>::CreateChildren(
+CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CreateChildren(
     arma::Col<size_t>& indices,
     arma::vec& distances,
     size_t nearSetSize,
     size_t& farSetSize,
     size_t& usedSetSize)
 {
+  // Scratch space for the near and far sets of the children, which is shared
+  // by all of the children of this node and by SortPointSet().  The point set
+  // only shrinks as children are created, so it is allocated at most a few
+  // times instead of once per child.
+  arma::Col<size_t> childIndices;
+  arma::vec childDistances;
+
   // Determine the next scale level.  This should be the first level where there
   // are any points in the far set.  So, if we know the maximum distance in the
   // distances array, this will be the largest i such that
@@ -493,7 +615,8 @@ CoverTree<MetricType, RootPointPolicy, StatisticType>::CreateChildren(
     // [ used | far | other used ]
     // and we want
     // [ far | all used ].
-    SortPointSet(indices, distances, 0, usedSetSize, farSetSize);
+    SortPointSet(indices, distances, 0, usedSetSize, farSetSize, childIndices,
+        childDistances);
 
     return;
   }
@@ -533,7 +656,7 @@ CoverTree<MetricType, RootPointPolicy, StatisticType>::CreateChildren(
   // [ near | far | childUsed + used ]
   // is what we are trying to make.
   SortPointSet(indices, distances, childFarSetSize, childUsedSetSize,
-      farSetSize);
+      farSetSize, childIndices, childDistances);
 
   // Update size of near set and used set.
   nearSetSize -= childUsedSetSize;
@@ -584,11 +707,15 @@ CoverTree<MetricType, RootPointPolicy, StatisticType>::CreateChildren(
     }
 
     // Create the near and far set indices and distance vectors.  We don't fill
-    // in the self-point, yet.
-    arma::Col<size_t> childIndices(nearSetSize + farSetSize);
+    // in the self-point, yet.  The vectors may be longer than the point set;
+    // only the first (nearSetSize + farSetSize) elements are used.
+    if (childIndices.n_elem < nearSetSize + farSetSize)
+    {
+      childIndices.set_size(nearSetSize + farSetSize);
+      childDistances.set_size(nearSetSize + farSetSize);
+    }
     childIndices.rows(0, (nearSetSize + farSetSize - 2)) = indices.rows(1,
         nearSetSize + farSetSize - 1);
-    arma::vec childDistances(nearSetSize + farSetSize);
 
     // Build distances for the child.
     ComputeDistances(indices[0], childIndices, childDistances, nearSetSize
@@ -636,8 +763,12 @@ CoverTree<MetricType, RootPointPolicy, StatisticType>::CreateChildren(
       furthestDescendantDistance = distances[i];
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-size_t CoverTree<MetricType, RootPointPolicy, StatisticType>::SplitNearFar(
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+size_t CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+SplitNearFar(
     arma::Col<size_t>& indices,
     arma::vec& distances,
     const double bound,
@@ -689,16 +820,25 @@ size_t CoverTree<MetricType, RootPointPolicy, StatisticType>::SplitNearFar(
 }
 
 // Returns the maximum distance between points.
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-void CoverTree<MetricType, RootPointPolicy, StatisticType>::ComputeDistances(
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+ComputeDistances(
     const size_t pointIndex,
     const arma::Col<size_t>& indices,
     arma::vec& distances,
     const size_t pointSetSize)
 {
   // For each point, rebuild the distances.  The indices do not need to be
-  // modified.
+  // modified.  Large point sets (near the top of the tree, where most of the
+  // construction time is spent) are split between threads; each distance is
+  // independent of the others, so the result does not depend on the number of
+  // threads.
   distanceComps += pointSetSize;
+  #pragma omp parallel for if (pointSetSize >= ParallelDistanceThreshold) \
+      schedule(static)
   for (size_t i = 0; i < pointSetSize; ++i)
   {
     distances[i] = metric->Evaluate(dataset.unsafe_col(pointIndex),
@@ -706,17 +846,23 @@ void CoverTree<MetricType, RootPointPolicy, StatisticType>::ComputeDistances(
   }
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-size_t CoverTree<MetricType, RootPointPolicy, StatisticType>::SortPointSet(
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+size_t CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+SortPointSet(
     arma::Col<size_t>& indices,
     arma::vec& distances,
     const size_t childFarSetSize,
     const size_t childUsedSetSize,
-    const size_t farSetSize)
+    const size_t farSetSize,
+    arma::Col<size_t>& indicesBuffer,
+    arma::vec& distancesBuffer)
 {
   // We'll use low-level memcpy calls ourselves, just to ensure it's done
   // quickly and the way we want it to be.  Unfortunately this takes up more
-  // memory than one-element swaps, but there's not a great way around that.
+  // memory than one-element swaps, but the buffers are reused by the caller.
   const size_t bufferSize = std::min(farSetSize, childUsedSetSize);
   const size_t bigCopySize = std::max(farSetSize, childUsedSetSize);
 
@@ -725,8 +871,11 @@ size_t CoverTree<MetricType, RootPointPolicy, StatisticType>::SortPointSet(
   if (bufferSize == 0)
     return (childFarSetSize + farSetSize);
 
-  size_t* indicesBuffer = new size_t[bufferSize];
-  double* distancesBuffer = new double[bufferSize];
+  if (indicesBuffer.n_elem < bufferSize)
+  {
+    indicesBuffer.set_size(bufferSize);
+    distancesBuffer.set_size(bufferSize);
+  }
 
   // The start of the memory region to copy to the buffer.
   const size_t bufferFromLocation = ((bufferSize == farSetSize) ?
@@ -742,9 +891,9 @@ size_t CoverTree<MetricType, RootPointPolicy, StatisticType>::SortPointSet(
       (childFarSetSize + farSetSize) : childFarSetSize);
 
   // Copy the smaller piece to the buffer.
-  memcpy(indicesBuffer, indices.memptr() + bufferFromLocation,
+  memcpy(indicesBuffer.memptr(), indices.memptr() + bufferFromLocation,
       sizeof(size_t) * bufferSize);
-  memcpy(distancesBuffer, distances.memptr() + bufferFromLocation,
+  memcpy(distancesBuffer.memptr(), distances.memptr() + bufferFromLocation,
       sizeof(double) * bufferSize);
 
   // Now move the other memory.
@@ -754,20 +903,21 @@ size_t CoverTree<MetricType, RootPointPolicy, StatisticType>::SortPointSet(
       distances.memptr() + directFromLocation, sizeof(double) * bigCopySize);
 
   // Now copy the temporary memory to the right place.
-  memcpy(indices.memptr() + bufferToLocation, indicesBuffer,
+  memcpy(indices.memptr() + bufferToLocation, indicesBuffer.memptr(),
       sizeof(size_t) * bufferSize);
-  memcpy(distances.memptr() + bufferToLocation, distancesBuffer,
+  memcpy(distances.memptr() + bufferToLocation, distancesBuffer.memptr(),
       sizeof(double) * bufferSize);
 
-  delete[] indicesBuffer;
-  delete[] distancesBuffer;
-
   // This returns the complete size of the far set.
   return (childFarSetSize + farSetSize);
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-void CoverTree<MetricType, RootPointPolicy, StatisticType>::MoveToUsedSet(
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+MoveToUsedSet(
     arma::Col<size_t>& indices,
     arma::vec& distances,
     size_t& nearSetSize,
@@ -907,8 +1057,12 @@ void CoverTree<MetricType, RootPointPolicy, StatisticType>::MoveToUsedSet(
   Log::Assert(originalSum == (nearSetSize + farSetSize + usedSetSize));
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-size_t CoverTree<MetricType, RootPointPolicy, StatisticType>::PruneFarSet(
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+size_t CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+PruneFarSet(
     arma::Col<size_t>& indices,
     arma::vec& distances,
     const double bound,
@@ -948,8 +1102,11 @@ size_t CoverTree<MetricType, RootPointPolicy, StatisticType>::PruneFarSet(
  * Take a look at the last child (the most recently created one) and remove any
  * implicit nodes that have been created.
  */
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-inline void CoverTree<MetricType, RootPointPolicy, StatisticType>::
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+inline void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
     RemoveNewImplicitNodes()
 {
   // If we created an implicit node, take its self-child instead (this could
@@ -975,11 +1132,154 @@ inline void CoverTree<MetricType, RootPointPolicy, StatisticType>::
   }
 }
 
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::Save(
+    TreeFileWriter& writer) const
+{
+  writer.Write(point);
+  writer.Write(scale);
+  writer.Write(base);
+  writer.Write(numDescendants);
+  writer.Write(parentDistance);
+  writer.Write(furthestDescendantDistance);
+
+  writer.Write((uint64_t) children.size());
+  for (size_t i = 0; i < children.size(); ++i)
+    children[i]->Save(writer);
+}
+
+// Insert a point into the tree.
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::Insert(
+    const size_t pointIndex)
+{
+  // The ancestors of a node must be updated too, so always start at the root.
+  if (parent != NULL)
+  {
+    CoverTree* root = parent;
+    while (root->Parent() != NULL)
+      root = root->Parent();
+
+    root->Insert(pointIndex);
+    return;
+  }
+
+  if (pointIndex >= dataset.n_cols)
+  {
+    Log::Fatal << "CoverTree::Insert(): point index " << pointIndex << " is "
+        << "out of range (the dataset has " << dataset.n_cols << " points)!"
+        << std::endl;
+  }
+
+  const double distance = metric->Evaluate(dataset.unsafe_col(point),
+      dataset.unsafe_col(pointIndex));
+  ++distanceComps;
+
+  InsertPoint(pointIndex, distance);
+
+  // The root has no parent to limit its scale, so it only needs to be large
+  // enough to cover every descendant.
+  if (furthestDescendantDistance > 0)
+    scale = std::max(scale,
+        (int) ceil(log(furthestDescendantDistance) / log(base)));
+}
+
+// Insert a point into the subtree rooted at this node.
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+InsertPoint(
+    const size_t pointIndex,
+    const double distance)
+{
+  if (children.size() == 0)
+  {
+    // This is a leaf, so it becomes a node with a self-child and a leaf for the
+    // new point.  Its scale has to be below the scale of its parent and large
+    // enough to cover the new point.
+    int newScale = (parent == NULL) ? 0 : parent->Scale() - 1;
+    if (distance > 0)
+    {
+      const int coverScale = (int) ceil(log(distance) / log(base));
+      newScale = (parent == NULL) ? coverScale :
+          std::min(newScale, coverScale);
+    }
+
+    children.push_back(new CoverTree(dataset, base, point, INT_MIN, this, 0, 0,
+        metric));
+    children.push_back(new CoverTree(dataset, base, pointIndex, INT_MIN, this,
+        distance, 0, metric));
+
+    scale = newScale;
+    numDescendants = 2;
+    furthestDescendantDistance = distance;
+    stat = StatisticType(*this);
+    return;
+  }
+
+  // Find the closest child that covers the new point.  Non-leaf children cover
+  // pow(base, scale) around their point; leaves sit one level below this node
+  // (their scale is INT_MIN only because they have no children).
+  const double leafBound = pow(base, scale - 1);
+  size_t bestChild = children.size();
+  double bestDistance = DBL_MAX;
+  for (size_t i = 0; i < children.size(); ++i)
+  {
+    // The self-child holds the same point as this node.
+    double childDistance = distance;
+    if (i > 0)
+    {
+      childDistance = metric->Evaluate(
+          dataset.unsafe_col(children[i]->Point()),
+          dataset.unsafe_col(pointIndex));
+      ++distanceComps;
+    }
+
+    const double bound = (children[i]->Scale() == INT_MIN) ? leafBound :
+        pow(base, children[i]->Scale());
+    if (childDistance <= bound && childDistance < bestDistance)
+    {
+      bestChild = i;
+      bestDistance = childDistance;
+    }
+  }
+
+  if (bestChild == children.size())
+  {
+    // No child covers the point, so it becomes a new leaf of this node.
+    children.push_back(new CoverTree(dataset, base, pointIndex, INT_MIN, this,
+        distance, 0, metric));
+  }
+  else
+  {
+    children[bestChild]->InsertPoint(pointIndex, bestDistance);
+  }
+
+  ++numDescendants;
+  if (distance > furthestDescendantDistance)
+    furthestDescendantDistance = distance;
+
+  // Statistics are initialized from the bottom up, as in the constructor.
+  stat = StatisticType(*this);
+}
+
 /**
  * Returns a string representation of this object.
  */
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
-std::string CoverTree<MetricType, RootPointPolicy, StatisticType>::ToString()
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
+std::string CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+    ToString()
     const
 {
   std::ostringstream convert;
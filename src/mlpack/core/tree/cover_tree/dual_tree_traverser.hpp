@@ -13,9 +13,13 @@
 namespace mlpack {
 namespace tree {
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
 template<typename RuleType>
-class CoverTree<MetricType, RootPointPolicy, StatisticType>::DualTreeTraverser
+class CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+    DualTreeTraverser
 {
  public:
   /**
@@ -53,7 +57,7 @@ class CoverTree<MetricType, RootPointPolicy, StatisticType>::DualTreeTraverser
   struct DualCoverTreeMapEntry
   {
     //! The node this entry refers to.
-    CoverTree<MetricType, RootPointPolicy, StatisticType>* referenceNode;
+    CoverTree* referenceNode;
     //! The score of the node.
     double score;
     //! The base case.
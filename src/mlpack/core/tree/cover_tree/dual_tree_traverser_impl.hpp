@@ -13,20 +13,26 @@
 namespace mlpack {
 namespace tree {
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
 template<typename RuleType>
-CoverTree<MetricType, RootPointPolicy, StatisticType>::
+CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
 DualTreeTraverser<RuleType>::DualTreeTraverser(RuleType& rule) :
     rule(rule),
     numPrunes(0)
 { /* Nothing to do. */ }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
 template<typename RuleType>
-void CoverTree<MetricType, RootPointPolicy, StatisticType>::
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
 DualTreeTraverser<RuleType>::Traverse(
-    CoverTree<MetricType, RootPointPolicy, StatisticType>& queryNode,
-    CoverTree<MetricType, RootPointPolicy, StatisticType>& referenceNode)
+    CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>& queryNode,
+    CoverTree& referenceNode)
 {
   // Start by creating a map and adding the reference root node to it.
   std::map<int, std::vector<DualCoverTreeMapEntry> > refMap;
@@ -46,11 +52,14 @@ DualTreeTraverser<RuleType>::Traverse(
   Traverse(queryNode, refMap);
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
 template<typename RuleType>
-void CoverTree<MetricType, RootPointPolicy, StatisticType>::
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
 DualTreeTraverser<RuleType>::Traverse(
-    CoverTree<MetricType, RootPointPolicy, StatisticType>& queryNode,
+    CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>& queryNode,
     std::map<int, std::vector<DualCoverTreeMapEntry> >& referenceMap)
 {
   if (referenceMap.size() == 0)
@@ -100,7 +109,7 @@ DualTreeTraverser<RuleType>::Traverse(
     // Get a reference to the frame.
     const DualCoverTreeMapEntry& frame = pointVector[i];
 
-    CoverTree<MetricType, RootPointPolicy, StatisticType>* refNode =
+    CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>* refNode =
         frame.referenceNode;
 
     // If the point is the same as both parents, then we have already done this
@@ -128,9 +137,12 @@ DualTreeTraverser<RuleType>::Traverse(
   }
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
 template<typename RuleType>
-void CoverTree<MetricType, RootPointPolicy, StatisticType>::
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
 DualTreeTraverser<RuleType>::PruneMap(
     CoverTree& queryNode,
     std::map<int, std::vector<DualCoverTreeMapEntry> >& referenceMap,
@@ -159,7 +171,7 @@ DualTreeTraverser<RuleType>::PruneMap(
       const DualCoverTreeMapEntry& frame = scaleVector[j];
 
       // First evaluate if we can prune without performing the base case.
-      CoverTree<MetricType, RootPointPolicy, StatisticType>* refNode =
+      CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>* refNode =
           frame.referenceNode;
 
       // Perform the actual scoring, after restoring the traversal info.
@@ -213,7 +225,7 @@ DualTreeTraverser<RuleType>::PruneMap(
       const DualCoverTreeMapEntry& frame = scaleVector[j];
 
       // First evaluate if we can prune without performing the base case.
-      CoverTree<MetricType, RootPointPolicy, StatisticType>* refNode =
+      CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>* refNode =
           frame.referenceNode;
 
       // Perform the actual scoring, after restoring the traversal info.
@@ -246,9 +258,12 @@ DualTreeTraverser<RuleType>::PruneMap(
   }
 }
 
-template<typename MetricType, typename RootPointPolicy, typename StatisticType>
+template<typename MetricType,
+         typename RootPointPolicy,
+         typename StatisticType,
+         typename MatType>
 template<typename RuleType>
-void CoverTree<MetricType, RootPointPolicy, StatisticType>::
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
 DualTreeTraverser<RuleType>::ReferenceRecursion(
     CoverTree& queryNode,
     std::map<int, std::vector<DualCoverTreeMapEntry> >& referenceMap)
@@ -282,7 +297,7 @@ DualTreeTraverser<RuleType>::ReferenceRecursion(
       // Get a reference to the current element.
       const DualCoverTreeMapEntry& frame = scaleVector.at(i);
 
-      CoverTree<MetricType, RootPointPolicy, StatisticType>* refNode =
+      CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>* refNode =
           frame.referenceNode;
 
       // Create the score for the children.
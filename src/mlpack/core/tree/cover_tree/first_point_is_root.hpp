@@ -28,7 +28,8 @@ class FirstPointIsRoot
    * Return the point to be used as the root point of the cover tree.  This just
    * returns 0.
    */
-  static size_t ChooseRoot(const arma::mat& /* dataset */) { return 0; }
+  template<typename MatType>
+  static size_t ChooseRoot(const MatType& /* dataset */) { return 0; }
 };
 
 }; // namespace tree
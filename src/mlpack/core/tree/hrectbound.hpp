@@ -31,6 +31,9 @@ class HRectBound
  public:
   //! This is the metric type that this bound is using.
   typedef metric::LMetric<Power, TakeRoot> MetricType;
+  //! The type of the centroid of the bound.  The extents of the bound are held
+  //! in double precision for any type of data.
+  typedef arma::vec Vec;
 
   /**
    * Empty constructor; creates a bound of dimensionality 0.
@@ -140,7 +143,7 @@ class HRectBound
    * Expands this region to include new points.
    *
    * @tparam MatType Type of matrix; could be Mat, SpMat, a subview, or just a
-   *   vector.
+   *   vector, of any element type.
    * @param data Data points to expand this region to include.
    */
   template<typename MatType>
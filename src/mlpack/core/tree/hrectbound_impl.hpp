@@ -352,8 +352,10 @@ inline HRectBound<Power, TakeRoot>& HRectBound<Power, TakeRoot>::operator|=(
 {
   Log::Assert(data.n_rows == dim);
 
-  arma::vec mins(min(data, 1));
-  arma::vec maxs(max(data, 1));
+  // Take the extents in the element type of the data, then widen them.
+  typedef typename MatType::elem_type ElemType;
+  arma::Col<ElemType> mins(min(data, 1));
+  arma::Col<ElemType> maxs(max(data, 1));
 
   minWidth = DBL_MAX;
   for (size_t i = 0; i < dim; i++)
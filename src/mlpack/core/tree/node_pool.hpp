@@ -0,0 +1,145 @@
+/**
+ * @file node_pool.hpp
+ *
+ * Definition of the NodePool class, which allocates tree nodes of one type
+ * from large contiguous chunks of memory.
+ */
+#ifndef __MLPACK_CORE_TREE_NODE_POOL_HPP
+#define __MLPACK_CORE_TREE_NODE_POOL_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+/**
+ * A pool of memory for tree nodes of type NodeType.  Instead of asking the
+ * system allocator for each node separately, memory is taken from chunks that
+ * each hold ChunkSize nodes, so that nodes which are allocated one after the
+ * other (such as the nodes made while a tree is built) are next to each other
+ * in memory.  This makes allocation much cheaper and traversal more cache
+ * friendly.
+ *
+ * Freed nodes are kept on a free list and reused by later allocations; the
+ * chunks themselves are only released when the program exits.  The pool is
+ * shared by all trees of the same type and is safe to use from multiple
+ * threads.
+ *
+ * A tree uses the pool by defining class-specific operator new and operator
+ * delete that call Allocate() and Free():
+ *
+ * @code
+ * static void* operator new(size_t size)
+ * { return NodePool<TreeType>::Allocate(size); }
+ * static void operator delete(void* node, size_t size)
+ * { NodePool<TreeType>::Free(node, size); }
+ * @endcode
+ *
+ * @tparam NodeType Type of node held in the pool.
+ */
+template<typename NodeType>
+class NodePool
+{
+ public:
+  //! The number of nodes in each chunk of memory.
+  static const size_t ChunkSize = 256;
+
+  /**
+   * Allocate memory for one node.  If size is not the size of NodeType (for
+   * instance, if a class derived from NodeType is allocated), the system
+   * allocator is used instead.
+   *
+   * @param size Number of bytes requested.
+   */
+  static void* Allocate(const size_t size)
+  {
+    if (size != sizeof(NodeType))
+      return ::operator new(size);
+
+    void* node;
+    #pragma omp critical(node_pool)
+    {
+      State& state = GetState();
+      if (state.freeList == NULL)
+        state.AddChunk();
+
+      node = state.freeList;
+      state.freeList = *reinterpret_cast<void**>(node);
+    }
+
+    return node;
+  }
+
+  /**
+   * Return the memory of one node (allocated with Allocate()) to the pool.
+   *
+   * @param node Memory to return.
+   * @param size Size the memory was allocated with.
+   */
+  static void Free(void* node, const size_t size)
+  {
+    if (node == NULL)
+      return;
+
+    if (size != sizeof(NodeType))
+    {
+      ::operator delete(node);
+      return;
+    }
+
+    #pragma omp critical(node_pool)
+    {
+      State& state = GetState();
+      *reinterpret_cast<void**>(node) = state.freeList;
+      state.freeList = node;
+    }
+  }
+
+ private:
+  //! The size of each block of the pool; it must be able to hold a pointer.
+  static const size_t BlockSize = (sizeof(NodeType) > sizeof(void*)) ?
+      sizeof(NodeType) : sizeof(void*);
+
+  //! The chunks of memory and the list of free blocks in them.
+  struct State
+  {
+    //! All chunks that have been allocated.
+    std::vector<char*> chunks;
+    //! The first free block (each free block holds a pointer to the next).
+    void* freeList;
+
+    State() : freeList(NULL) { }
+
+    ~State()
+    {
+      for (size_t i = 0; i < chunks.size(); ++i)
+        ::operator delete(chunks[i]);
+    }
+
+    //! Allocate a new chunk and put its blocks on the free list, in order.
+    void AddChunk()
+    {
+      char* chunk = static_cast<char*>(::operator new(ChunkSize * BlockSize));
+      chunks.push_back(chunk);
+
+      for (size_t i = ChunkSize; i > 0; --i)
+      {
+        void* block = chunk + (i - 1) * BlockSize;
+        *reinterpret_cast<void**>(block) = freeList;
+        freeList = block;
+      }
+    }
+  };
+
+  //! Get the state of the pool, which is created the first time it is used.
+  static State& GetState()
+  {
+    static State state;
+    return state;
+  }
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
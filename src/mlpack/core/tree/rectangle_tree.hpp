@@ -23,5 +23,7 @@
 #include "rectangle_tree/r_star_tree_descent_heuristic.hpp"
 #include "rectangle_tree/traits.hpp"
 #include "rectangle_tree/x_tree_split.hpp"
+#include "rectangle_tree/str_bulk_load.hpp"
+#include "rectangle_tree/hilbert_bulk_load.hpp"
 
 #endif
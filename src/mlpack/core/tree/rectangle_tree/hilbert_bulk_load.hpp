@@ -0,0 +1,77 @@
+/**
+ * @file hilbert_bulk_load.hpp
+ *
+ * Definition of the HilbertBulkLoad class, which orders points (or nodes) along
+ * a Hilbert curve for bulk loading of rectangle type trees.
+ */
+#ifndef __MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_BULK_LOAD_HPP
+#define __MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_BULK_LOAD_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+/**
+ * Hilbert-sort packing, for use with the bulk loading constructor of
+ * RectangleTree.  The bounding box of the points (or node centroids) is
+ * divided into a grid with 2^16 cells in each dimension, and the points are
+ * sorted by the position of their cell along the Hilbert curve through the
+ * grid.  Because the Hilbert curve preserves locality well, each group of
+ * consecutive points forms a compact node.
+ *
+ * The Hilbert index of each cell is calculated with the algorithm given in the
+ * following paper:
+ *
+ * @code
+ * @inproceedings{skilling2004programming,
+ *   title={Programming the Hilbert curve},
+ *   author={Skilling, J.},
+ *   booktitle={AIP Conference Proceedings},
+ *   volume={707},
+ *   pages={381--387},
+ *   year={2004}
+ * }
+ * @endcode
+ */
+class HilbertBulkLoad
+{
+ public:
+  /**
+   * Order the given indices of points in the dataset by their position along
+   * the Hilbert curve, so that each group of consecutive indices of size
+   * capacity can form a node.  This takes O(n log n) time for n points.
+   *
+   * @param data Dataset (or matrix of node centroids).
+   * @param indices Indices of the points in the dataset to order.
+   * @param capacity Number of points in each node (unused).
+   */
+  template<typename MatType>
+  static void Order(const MatType& data,
+                    std::vector<size_t>& indices,
+                    const size_t capacity);
+
+  //! The number of bits used for each dimension of the grid.
+  static const size_t Bits = 16;
+
+  /**
+   * Calculate the Hilbert index of the given grid cell, whose coordinates must
+   * each be less than 2^Bits.  The index is stored most significant bits
+   * first, in as many 64-bit words as necessary (Bits times the number of
+   * dimensions, divided by 64 and rounded up), so that indices can be compared
+   * lexicographically.
+   *
+   * @param coordinates Coordinates of the cell; these are modified.
+   * @param index Array of words to store the Hilbert index in.
+   */
+  static void HilbertIndex(arma::Col<uint32_t>& coordinates,
+                           uint64_t* index);
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "hilbert_bulk_load_impl.hpp"
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * @file hilbert_bulk_load_impl.hpp
+ *
+ * Implementation of the HilbertBulkLoad class.
+ */
+#ifndef __MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_BULK_LOAD_IMPL_HPP
+#define __MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_BULK_LOAD_IMPL_HPP
+
+#include "hilbert_bulk_load.hpp"
+
+namespace mlpack {
+namespace tree {
+
+//! Compare the positions of two points by their Hilbert indices.
+class HilbertIndexComparator
+{
+ public:
+  HilbertIndexComparator(const std::vector<uint64_t>& indices,
+                         const size_t numWords) :
+      indices(indices), numWords(numWords) { }
+
+  bool operator()(const size_t a, const size_t b) const
+  {
+    for (size_t i = 0; i < numWords; ++i)
+    {
+      const uint64_t wordA = indices[a * numWords + i];
+      const uint64_t wordB = indices[b * numWords + i];
+      if (wordA != wordB)
+        return wordA < wordB;
+    }
+
+    return false;
+  }
+
+ private:
+  const std::vector<uint64_t>& indices;
+  const size_t numWords;
+};
+
+template<typename MatType>
+void HilbertBulkLoad::Order(const MatType& data,
+                            std::vector<size_t>& indices,
+                            const size_t /* capacity */)
+{
+  if (indices.size() <= 1)
+    return;
+
+  // Find the bounding box of the points.
+  arma::vec minimums(data.n_rows);
+  arma::vec maximums(data.n_rows);
+  minimums.fill(DBL_MAX);
+  maximums.fill(-DBL_MAX);
+  for (size_t i = 0; i < indices.size(); ++i)
+  {
+    for (size_t d = 0; d < data.n_rows; ++d)
+    {
+      minimums[d] = std::min(minimums[d], (double) data(d, indices[i]));
+      maximums[d] = std::max(maximums[d], (double) data(d, indices[i]));
+    }
+  }
+
+  // Calculate the Hilbert index of the grid cell of each point.
+  const size_t numWords = (Bits * data.n_rows + 63) / 64;
+  const double cells = (double) ((uint64_t(1) << Bits) - 1);
+  std::vector<uint64_t> hilbertIndices(indices.size() * numWords);
+  arma::Col<uint32_t> coordinates(data.n_rows);
+  for (size_t i = 0; i < indices.size(); ++i)
+  {
+    for (size_t d = 0; d < data.n_rows; ++d)
+    {
+      const double width = maximums[d] - minimums[d];
+      coordinates[d] = (width > 0) ? (uint32_t) (cells *
+          ((data(d, indices[i]) - minimums[d]) / width)) : 0;
+    }
+
+    HilbertIndex(coordinates, &hilbertIndices[i * numWords]);
+  }
+
+  // Sort the positions by Hilbert index, then rearrange the indices.
+  std::vector<size_t> order(indices.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+
+  std::sort(order.begin(), order.end(),
+      HilbertIndexComparator(hilbertIndices, numWords));
+
+  std::vector<size_t> oldIndices(indices);
+  for (size_t i = 0; i < order.size(); ++i)
+    indices[i] = oldIndices[order[i]];
+}
+
+inline void HilbertBulkLoad::HilbertIndex(arma::Col<uint32_t>& coordinates,
+                                          uint64_t* index)
+{
+  const size_t dims = coordinates.n_elem;
+  const uint32_t highest = uint32_t(1) << (Bits - 1);
+
+  // Skilling's transformation of the coordinates into the "transposed" Hilbert
+  // index.  First, undo the excess work (inverse undo).
+  for (uint32_t q = highest; q > 1; q >>= 1)
+  {
+    const uint32_t p = q - 1;
+    for (size_t i = 0; i < dims; ++i)
+    {
+      if (coordinates[i] & q)
+      {
+        coordinates[0] ^= p; // Invert.
+      }
+      else
+      {
+        // Exchange.
+        const uint32_t t = (coordinates[0] ^ coordinates[i]) & p;
+        coordinates[0] ^= t;
+        coordinates[i] ^= t;
+      }
+    }
+  }
+
+  // Gray encode.
+  for (size_t i = 1; i < dims; ++i)
+    coordinates[i] ^= coordinates[i - 1];
+
+  uint32_t t = 0;
+  for (uint32_t q = highest; q > 1; q >>= 1)
+    if (coordinates[dims - 1] & q)
+      t ^= q - 1;
+
+  for (size_t i = 0; i < dims; ++i)
+    coordinates[i] ^= t;
+
+  // Now interleave the bits of the transposed index, most significant first.
+  const size_t numWords = (Bits * dims + 63) / 64;
+  for (size_t i = 0; i < numWords; ++i)
+    index[i] = 0;
+
+  size_t position = 0;
+  for (size_t bit = Bits; bit > 0; --bit)
+  {
+    for (size_t i = 0; i < dims; ++i, ++position)
+    {
+      if ((coordinates[i] >> (bit - 1)) & 1)
+        index[position / 64] |= uint64_t(1) << (63 - (position % 64));
+    }
+  }
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
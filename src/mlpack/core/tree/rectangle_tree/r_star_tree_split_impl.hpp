@@ -37,7 +37,6 @@ void RStarTreeSplit<DescentType, StatisticType, MatType>::SplitLeafNode(
     TreeType* copy = new TreeType(*tree, false);
     copy->Parent() = tree;
     tree->Count() = 0;
-    tree->NullifyData();
     // Because this was a leaf node, numChildren must be 0.
     tree->Children()[(tree->NumChildren())++] = copy;
     assert(tree->NumChildren() == 1);
@@ -69,7 +68,7 @@ void RStarTreeSplit<DescentType, StatisticType, MatType>::SplitLeafNode(
     for (size_t i = 0; i < sorted.size(); i++)
     {
       sorted[i].d = tree->Bound().Metric().Evaluate(centroid,
-          tree->LocalDataset().col(i));
+          tree->Dataset().col(tree->Points()[i]));
       sorted[i].n = i;
     }
 
@@ -105,7 +104,7 @@ void RStarTreeSplit<DescentType, StatisticType, MatType>::SplitLeafNode(
     std::vector<SortStruct> sorted(tree->Count());
     for (size_t i = 0; i < sorted.size(); i++)
     {
-      sorted[i].d = tree->LocalDataset().col(i)[j];
+      sorted[i].d = tree->Dataset().col(tree->Points()[i])[j];
       sorted[i].n = i;
     }
 
@@ -141,25 +140,26 @@ void RStarTreeSplit<DescentType, StatisticType, MatType>::SplitLeafNode(
       std::vector<double> minG2(maxG1.size());
       for (size_t k = 0; k < tree->Bound().Dim(); k++)
       {
-        minG1[k] = maxG1[k] = tree->LocalDataset().col(sorted[0].n)[k];
+        minG1[k] = maxG1[k] = tree->Dataset()(k, tree->Points()[sorted[0].n]);
         minG2[k] = maxG2[k] =
-            tree->LocalDataset().col(sorted[sorted.size() - 1].n)[k];
+            tree->Dataset()(k, tree->Points()[sorted[sorted.size() - 1].n]);
 
         for (size_t l = 1; l < tree->Count() - 1; l++)
         {
+          const double value = tree->Dataset()(k, tree->Points()[sorted[l].n]);
           if (l < cutOff)
           {
-            if (tree->LocalDataset().col(sorted[l].n)[k] < minG1[k])
-              minG1[k] = tree->LocalDataset().col(sorted[l].n)[k];
-            else if (tree->LocalDataset().col(sorted[l].n)[k] > maxG1[k])
-              maxG1[k] = tree->LocalDataset().col(sorted[l].n)[k];
+            if (value < minG1[k])
+              minG1[k] = value;
+            else if (value > maxG1[k])
+              maxG1[k] = value;
           }
           else
           {
-            if (tree->LocalDataset().col(sorted[l].n)[k] < minG2[k])
-              minG2[k] = tree->LocalDataset().col(sorted[l].n)[k];
-            else if (tree->LocalDataset().col(sorted[l].n)[k] > maxG2[k])
-              maxG2[k] = tree->LocalDataset().col(sorted[l].n)[k];
+            if (value < minG2[k])
+              minG2[k] = value;
+            else if (value > maxG2[k])
+              maxG2[k] = value;
           }
         }
       }
@@ -209,7 +209,7 @@ void RStarTreeSplit<DescentType, StatisticType, MatType>::SplitLeafNode(
   std::vector<SortStruct> sorted(tree->Count());
   for (size_t i = 0; i < sorted.size(); i++)
   {
-    sorted[i].d = tree->LocalDataset().col(i)[bestAxis];
+    sorted[i].d = tree->Dataset().col(tree->Points()[i])[bestAxis];
     sorted[i].n = i;
   }
 
@@ -286,7 +286,6 @@ bool RStarTreeSplit<DescentType, StatisticType, MatType>::SplitNonLeafNode(
 
     copy->Parent() = tree;
     tree->NumChildren() = 0;
-    tree->NullifyData();
     tree->Children()[(tree->NumChildren())++] = copy;
 
     SplitNonLeafNode(copy, relevels);
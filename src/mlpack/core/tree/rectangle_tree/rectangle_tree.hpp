@@ -12,6 +12,8 @@
 
 #include "../hrectbound.hpp"
 #include "../statistic.hpp"
+#include "../node_pool.hpp"
+#include "../tree_file.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -27,6 +29,11 @@ using bound::HRectBound;
  * This tree does allow growth, so you can add and delete nodes
  * from it.
  *
+ * Leaves do not hold copies of their points; each node holds only the indices
+ * of its points in the dataset the tree was built on, so the tree takes little
+ * memory beyond the dataset itself.  Nodes are allocated from a NodePool, so
+ * that nodes built together lie together in memory.
+ *
  * @tparam StatisticType Extra data contained in the node.  See statistic.hpp
  *     for the necessary skeleton interface.
  * @tparam MatType The dataset class.
@@ -93,10 +100,8 @@ class RectangleTree
   double furthestDescendantDistance;
   //! The dataset.
   MatType& dataset;
-  //! The mapping to the dataset
+  //! The indices in the dataset of the points held in this node.
   std::vector<size_t> points;
-  //! The local dataset
-  MatType* localDataset;
 
  public:
   //! So other classes can use TreeType::Mat.
@@ -131,6 +136,37 @@ class RectangleTree
                 const size_t minNumChildren = 2,
                 const size_t firstDataIndex = 0);
 
+  /**
+   * Construct this as the root node of a rectangle type tree using the given
+   * dataset, by bulk loading instead of inserting each point in turn.  The
+   * points are ordered by the given BulkLoadType (such as STRBulkLoad or
+   * HilbertBulkLoad), so that each run of maxLeafSize points forms a leaf; the
+   * leaves are then grouped into nodes of maxNumChildren children in the same
+   * way, level by level, until the root is reached.  All leaves are at the same
+   * depth, and every leaf and node is full except possibly the last ones on
+   * each level (which are balanced so they meet the minimum fill when
+   * possible).  This takes O(n log n) time.  The dataset is not modified.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param bulkLoad Instantiated bulk loading algorithm (only used to select
+   *      the type).
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  template<typename BulkLoadType>
+  RectangleTree(MatType& data,
+                const BulkLoadType& bulkLoad,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2,
+                const typename boost::enable_if<
+                    boost::is_class<BulkLoadType> >::type* = 0);
+
   /**
    * Construct this as an empty node with the specified parent.  Copying the
    * parameters (maxLeafSize, minLeafSize, maxNumChildren, minNumChildren,
@@ -151,6 +187,19 @@ class RectangleTree
    */
   RectangleTree(const RectangleTree& other, const bool deepCopy = true);
 
+  /**
+   * Load a node, and all of its descendants, that was written with Save().
+   * Usually this is not called directly; use LoadedTree instead.  The
+   * statistics are built again (from the bottom of the tree up).
+   *
+   * @param data Dataset of the saved tree.
+   * @param reader Tree file to read the node from.
+   * @param parentNode Parent of this node (NULL indicates no parent).
+   */
+  RectangleTree(MatType& data,
+                TreeFileReader& reader,
+                RectangleTree* parentNode = NULL);
+
   /**
    * Deletes this node, deallocating the memory for the children and calling
    * their destructors in turn.  This will invalidate any younters or references
@@ -166,26 +215,35 @@ class RectangleTree
   void SoftDelete();
 
   /**
-   * Set dataset to null. Used for memory management.  Be cafeful.
+   * Write this node, and all of its descendants, to a tree file.  Usually this
+   * is not called directly; use SaveTree() instead.
+   *
+   * @param writer Tree file to write the node to.
    */
-  void NullifyData();
+  void Save(TreeFileWriter& writer) const;
+
+  //! Allocate a node from the pool of nodes of this type.
+  static void* operator new(size_t size)
+  { return NodePool<RectangleTree>::Allocate(size); }
+
+  //! Return a node to the pool of nodes of this type.
+  static void operator delete(void* node, size_t size)
+  { NodePool<RectangleTree>::Free(node, size); }
 
   /**
-   * Inserts a point into the tree. The point will be copied to the data matrix
-   * of the leaf node where it is finally inserted, but we pass by reference
-   * since it may be passed many times before it actually reaches a leaf.
+   * Inserts a point into the tree.  The index of the point is stored in the
+   * leaf node where it is finally inserted.
    *
-   * @param point The point (arma::vec&) to be inserted.
+   * @param point The index of the point in the dataset.
    */
   void InsertPoint(const size_t point);
 
   /**
    * Inserts a point into the tree, tracking which levels have been inserted
-   * into.  The point will be copied to the data matrix of the leaf node where
-   * it is finally inserted, but we pass by reference since it may be passed
-   * many times before it actually reaches a leaf.
+   * into.  The index of the point is stored in the leaf node where it is
+   * finally inserted.
    *
-   * @param point The point (arma::vec&) to be inserted.
+   * @param point The index of the point in the dataset.
    * @param relevels The levels that have been reinserted to on this top level
    *      insertion.
    */
@@ -312,11 +370,6 @@ class RectangleTree
   //! Modify the points vector for this node.  Be careful!
   std::vector<size_t>& Points() { return points; }
 
-  //! Get the local dataset of this node.
-  const arma::mat& LocalDataset() const { return *localDataset; }
-  //! Modify the local dataset of this node.
-  arma::mat& LocalDataset() { return *localDataset; }
-
   //! Get the metric which the tree uses.
   typename HRectBound<>::MetricType Metric() const { return bound.Metric(); }
 
@@ -502,6 +555,23 @@ class RectangleTree
     return new RectangleTree(begin, count, bound, stat, maxLeafSize);
   }
 
+  /**
+   * Calculate where the groups of a level of a bulk-loaded tree start, when
+   * numItems items are divided into groups of the given capacity.  If the last
+   * group would have fewer than minimum items, the last two groups are
+   * balanced.  The last element of starts is numItems.
+   */
+  static void GroupBounds(const size_t numItems,
+                          const size_t capacity,
+                          const size_t minimum,
+                          std::vector<size_t>& starts);
+
+  /**
+   * Initialize the statistics of all descendants of this node and then this
+   * node, once the tree is complete.
+   */
+  void InitializeStatistics();
+
   /**
    * Splits the current node, recursing up the tree.
    *
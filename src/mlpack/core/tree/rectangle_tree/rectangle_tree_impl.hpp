@@ -41,8 +41,7 @@ RectangleTree<SplitType, DescentType, StatisticType, MatType>::RectangleTree(
     splitHistory(bound.Dim()),
     parentDistance(0),
     dataset(data),
-    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
-    localDataset(new MatType(data.n_rows, static_cast<int> (maxLeafSize) + 1))
+    points(maxLeafSize + 1) // Add one to make splitting the node simpler.
 {
   stat = StatisticType(*this);
 
@@ -53,6 +52,118 @@ RectangleTree<SplitType, DescentType, StatisticType, MatType>::RectangleTree(
     root->InsertPoint(i);
 }
 
+template<typename SplitType,
+         typename DescentType,
+         typename StatisticType,
+         typename MatType>
+template<typename BulkLoadType>
+RectangleTree<SplitType, DescentType, StatisticType, MatType>::RectangleTree(
+    MatType& data,
+    const BulkLoadType& /* bulkLoad */,
+    const size_t maxLeafSize,
+    const size_t minLeafSize,
+    const size_t maxNumChildren,
+    const size_t minNumChildren,
+    const typename boost::enable_if<boost::is_class<BulkLoadType> >::type*) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    splitHistory(bound.Dim()),
+    parentDistance(0),
+    dataset(data),
+    points(maxLeafSize + 1) // Add one to make splitting the node simpler.
+{
+  // If all the points fit in one leaf, the root is that leaf.
+  if (data.n_cols <= maxLeafSize)
+  {
+    for (size_t i = 0; i < data.n_cols; ++i)
+    {
+      bound |= data.col(i);
+      points[count++] = i;
+    }
+
+    stat = StatisticType(*this);
+    return;
+  }
+
+  // Order the points so that each run of points forms a leaf.
+  std::vector<size_t> order(data.n_cols);
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  BulkLoadType::Order(data, order, maxLeafSize);
+
+  std::vector<size_t> starts;
+  GroupBounds(order.size(), maxLeafSize, minLeafSize, starts);
+
+  std::vector<RectangleTree*> level;
+  for (size_t i = 0; i + 1 < starts.size(); ++i)
+  {
+    // The parent is set correctly when the level above is built.
+    RectangleTree* leaf = new RectangleTree(this);
+    for (size_t j = starts[i]; j < starts[i + 1]; ++j)
+    {
+      leaf->bound |= data.col(order[j]);
+      leaf->points[leaf->count++] = order[j];
+    }
+
+    level.push_back(leaf);
+  }
+
+  // Now group the nodes of each level the same way (by their centroids), until
+  // they fit in the root.
+  while (level.size() > maxNumChildren)
+  {
+    arma::mat centroids(data.n_rows, level.size());
+    for (size_t i = 0; i < level.size(); ++i)
+    {
+      arma::vec centroid;
+      level[i]->Bound().Centroid(centroid);
+      centroids.col(i) = centroid;
+    }
+
+    order.resize(level.size());
+    for (size_t i = 0; i < order.size(); ++i)
+      order[i] = i;
+    BulkLoadType::Order(centroids, order, maxNumChildren);
+
+    GroupBounds(order.size(), maxNumChildren, minNumChildren, starts);
+
+    std::vector<RectangleTree*> nextLevel;
+    for (size_t i = 0; i + 1 < starts.size(); ++i)
+    {
+      RectangleTree* node = new RectangleTree(this);
+      for (size_t j = starts[i]; j < starts[i + 1]; ++j)
+      {
+        RectangleTree* child = level[order[j]];
+        child->Parent() = node;
+        node->bound |= child->Bound();
+        node->children[node->numChildren++] = child;
+      }
+
+      nextLevel.push_back(node);
+    }
+
+    level.swap(nextLevel);
+  }
+
+  for (size_t i = 0; i < level.size(); ++i)
+  {
+    level[i]->Parent() = this;
+    bound |= level[i]->Bound();
+    children[numChildren++] = level[i];
+  }
+
+  // The statistics can be calculated now that the tree is built.
+  InitializeStatistics();
+}
+
 template<typename SplitType,
          typename DescentType,
          typename StatisticType,
@@ -72,9 +183,7 @@ RectangleTree<SplitType, DescentType, StatisticType, MatType>::RectangleTree(
     splitHistory(bound.Dim()),
     parentDistance(0),
     dataset(parentNode->Dataset()),
-    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
-    localDataset(new MatType(static_cast<int> (parentNode->Bound().Dim()),
-                             static_cast<int> (maxLeafSize) + 1))
+    points(maxLeafSize + 1) // Add one to make splitting the node simpler.
 {
   stat = StatisticType(*this);
 }
@@ -103,31 +212,92 @@ RectangleTree<SplitType, DescentType, StatisticType, MatType>::RectangleTree(
     splitHistory(other.SplitHistory()),
     parentDistance(other.ParentDistance()),
     dataset(other.dataset),
-    points(other.Points()),
-    localDataset(NULL)
+    points(other.Points())
 {
   if (deepCopy)
   {
-    if (numChildren > 0)
-    {
-      for (size_t i = 0; i < numChildren; i++)
-      {
-        children[i] = new RectangleTree(*(other.Children()[i]));
-      }
-    }
-    else
+    for (size_t i = 0; i < numChildren; i++)
     {
-      localDataset = new MatType(other.LocalDataset());
+      children[i] = new RectangleTree(*(other.Children()[i]));
+      children[i]->Parent() = this;
     }
   }
   else
   {
     children = other.Children();
-    arma::mat& otherData = const_cast<arma::mat&>(other.LocalDataset());
-    localDataset = &otherData;
   }
 }
 
+/**
+ * Load a node and its descendants from a tree file.
+ */
+template<typename SplitType,
+         typename DescentType,
+         typename StatisticType,
+         typename MatType>
+RectangleTree<SplitType, DescentType, StatisticType, MatType>::RectangleTree(
+    MatType& data,
+    TreeFileReader& reader,
+    RectangleTree* parentNode) :
+    parent(parentNode),
+    bound(data.n_rows),
+    splitHistory(bound.Dim()),
+    dataset(data)
+{
+  // The fields are read in the order they are written by Save().
+  reader.Read(maxNumChildren);
+  reader.Read(minNumChildren);
+  reader.Read(numChildren);
+  reader.Read(begin);
+  reader.Read(count);
+  reader.Read(maxLeafSize);
+  reader.Read(minLeafSize);
+  reader.Read(parentDistance);
+  reader.Read(furthestDescendantDistance);
+  LoadBound(reader, bound);
+
+  reader.Read(splitHistory.lastDimension);
+  for (size_t i = 0; i < splitHistory.history.size(); ++i)
+  {
+    uint8_t split;
+    reader.Read(split);
+    splitHistory.history[i] = (split != 0);
+  }
+
+  // The sizes are used to allocate the points and children, so a corrupt file
+  // must not be trusted with them.
+  if (minLeafSize > maxLeafSize || count > maxLeafSize ||
+      minNumChildren > maxNumChildren || numChildren > maxNumChildren ||
+      begin > data.n_cols || count > data.n_cols - begin)
+  {
+    Log::Fatal << "RectangleTree: tree file is corrupt (node with " << count
+        << " points of at most " << maxLeafSize << ", " << numChildren
+        << " children of at most " << maxNumChildren << ", and first point "
+        << begin << " of " << data.n_cols << ")!" << std::endl;
+  }
+
+  // Add one to make splitting the node simpler, as in the other constructors.
+  points.resize(maxLeafSize + 1);
+  if (count > 0)
+    reader.Read(&points[0], count);
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (points[i] >= data.n_cols)
+    {
+      Log::Fatal << "RectangleTree: tree file is corrupt (point " << points[i]
+          << " of " << data.n_cols << ")!" << std::endl;
+    }
+  }
+
+  children.resize(maxNumChildren + 1);
+  for (size_t i = 0; i < numChildren; ++i)
+    children[i] = new RectangleTree(data, reader, this);
+
+  // The statistic is built after the children, as it is during construction.
+  stat = StatisticType(*this);
+}
+
 /**
  * Deletes this node, deallocating the memory for the children and calling
  * their destructors in turn.  This will invalidate any pointers or references
@@ -141,8 +311,39 @@ RectangleTree<SplitType, DescentType, StatisticType, MatType>::~RectangleTree()
 {
   for (size_t i = 0; i < numChildren; i++)
     delete children[i];
+}
 
-  delete localDataset;
+/**
+ * Write this node and its descendants to a tree file.
+ */
+template<typename SplitType,
+         typename DescentType,
+         typename StatisticType,
+         typename MatType>
+void RectangleTree<SplitType, DescentType, StatisticType, MatType>::Save(
+    TreeFileWriter& writer) const
+{
+  writer.Write(maxNumChildren);
+  writer.Write(minNumChildren);
+  writer.Write(numChildren);
+  writer.Write(begin);
+  writer.Write(count);
+  writer.Write(maxLeafSize);
+  writer.Write(minLeafSize);
+  writer.Write(parentDistance);
+  writer.Write(furthestDescendantDistance);
+  SaveBound(writer, bound);
+
+  // The split history has one entry for each dimension of the bound.
+  writer.Write(splitHistory.lastDimension);
+  for (size_t i = 0; i < splitHistory.history.size(); ++i)
+    writer.Write((uint8_t) (splitHistory.history[i] ? 1 : 0));
+
+  if (count > 0)
+    writer.Write(&points[0], count);
+
+  for (size_t i = 0; i < numChildren; ++i)
+    children[i]->Save(writer);
 }
 
 /**
@@ -164,19 +365,6 @@ void RectangleTree<SplitType, DescentType, StatisticType, MatType>::SoftDelete()
   delete this;
 }
 
-/**
- * Set the local dataset to null.
- */
-template<typename SplitType,
-         typename DescentType,
-         typename StatisticType,
-         typename MatType>
-void RectangleTree<SplitType, DescentType, StatisticType, MatType>::
-    NullifyData()
-{
-  localDataset = NULL;
-}
-
 /**
  * Recurse through the tree and insert the point at the leaf node chosen
  * by the heuristic.
@@ -198,7 +386,6 @@ void RectangleTree<SplitType, DescentType, StatisticType, MatType>::InsertPoint(
   // If this is a leaf node, we stop here and add the point.
   if (numChildren == 0)
   {
-    localDataset->col(count) = dataset.col(point);
     points[count++] = point;
     SplitNode(lvls);
     return;
@@ -213,9 +400,8 @@ void RectangleTree<SplitType, DescentType, StatisticType, MatType>::InsertPoint(
 
 /**
  * Inserts a point into the tree, tracking which levels have been inserted into.
- * The point will be copied to the data matrix of the leaf node where it is
- * finally inserted, but we pass by reference since it may be passed many times
- * before it actually reaches a leaf.
+ * The index of the point is stored in the leaf node where it is finally
+ * inserted.
  */
 template<typename SplitType,
          typename DescentType,
@@ -231,7 +417,6 @@ void RectangleTree<SplitType, DescentType, StatisticType, MatType>::InsertPoint(
   // If this is a leaf node, we stop here and add the point.
   if (numChildren == 0)
   {
-    localDataset->col(count) = dataset.col(point);
     points[count++] = point;
     SplitNode(relevels);
     return;
@@ -303,8 +488,7 @@ bool RectangleTree<SplitType, DescentType, StatisticType, MatType>::DeletePoint(
     {
       if (points[i] == point)
       {
-        localDataset->col(i) = localDataset->col(--count); // Decrement count.
-        points[i] = points[count];
+        points[i] = points[--count]; // Decrement count.
         // This function wil ensure that minFill is satisfied.
         CondenseTree(dataset.col(point), lvls, true);
         return true;
@@ -338,8 +522,7 @@ bool RectangleTree<SplitType, DescentType, StatisticType, MatType>::DeletePoint(
     {
       if (points[i] == point)
       {
-        localDataset->col(i) = localDataset->col(--count);
-        points[i] = points[count];
+        points[i] = points[--count]; // Decrement count.
         // This function will ensure that minFill is satisfied.
         CondenseTree(dataset.col(point), relevels, true);
         return true;
@@ -535,6 +718,49 @@ inline size_t RectangleTree<SplitType, DescentType, StatisticType, MatType>::
   return points[index];
 }
 
+/**
+ * Calculate the groups of a level of a bulk-loaded tree.
+ */
+template<typename SplitType,
+         typename DescentType,
+         typename StatisticType,
+         typename MatType>
+void RectangleTree<SplitType, DescentType, StatisticType, MatType>::
+    GroupBounds(const size_t numItems,
+                const size_t capacity,
+                const size_t minimum,
+                std::vector<size_t>& starts)
+{
+  starts.clear();
+  for (size_t i = 0; i < numItems; i += capacity)
+    starts.push_back(i);
+  starts.push_back(numItems);
+
+  // If the last group is too small, split the last two groups evenly.
+  const size_t numGroups = starts.size() - 1;
+  if (numGroups > 1 && (numItems - starts[numGroups - 1]) < minimum)
+  {
+    const size_t lastTwo = numItems - starts[numGroups - 2];
+    starts[numGroups - 1] = starts[numGroups - 2] + (lastTwo + 1) / 2;
+  }
+}
+
+/**
+ * Initialize the statistics of this node and its descendants, children first.
+ */
+template<typename SplitType,
+         typename DescentType,
+         typename StatisticType,
+         typename MatType>
+void RectangleTree<SplitType, DescentType, StatisticType, MatType>::
+    InitializeStatistics()
+{
+  for (size_t i = 0; i < numChildren; ++i)
+    children[i]->InitializeStatistics();
+
+  stat = StatisticType(*this);
+}
+
 /**
  * Split the tree.  This calls the SplitType code to split a node.  This method
  * should only be called on a leaf node.
@@ -676,7 +902,6 @@ void RectangleTree<SplitType, DescentType, StatisticType, MatType>::
       {
         // In case the tree has a height of two.
         points[i] = child->Points()[i];
-        localDataset->col(i) = child->LocalDataset().col(i);
       }
 
       count = child->Count();
@@ -713,8 +938,8 @@ bool RectangleTree<SplitType, DescentType, StatisticType, MatType>::
         double min = DBL_MAX;
         for (size_t j = 0; j < count; j++)
         {
-          if (localDataset->col(j)[i] < min)
-            min = localDataset->col(j)[i];
+          if (dataset(i, points[j]) < min)
+            min = dataset(i, points[j]);
         }
 
         if (bound[i].Lo() < min)
@@ -732,8 +957,8 @@ bool RectangleTree<SplitType, DescentType, StatisticType, MatType>::
         double max = -1 * DBL_MAX;
         for (size_t j = 0; j < count; j++)
         {
-          if (localDataset->col(j)[i] > max)
-            max = localDataset->col(j)[i];
+          if (dataset(i, points[j]) > max)
+            max = dataset(i, points[j]);
         }
 
         if (bound[i].Hi() > max)
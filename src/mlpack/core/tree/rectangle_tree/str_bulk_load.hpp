@@ -0,0 +1,71 @@
+/**
+ * @file str_bulk_load.hpp
+ *
+ * Definition of the STRBulkLoad class, which orders points (or nodes) for
+ * Sort-Tile-Recursive bulk loading of rectangle type trees.
+ */
+#ifndef __MLPACK_CORE_TREE_RECTANGLE_TREE_STR_BULK_LOAD_HPP
+#define __MLPACK_CORE_TREE_RECTANGLE_TREE_STR_BULK_LOAD_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+/**
+ * The Sort-Tile-Recursive (STR) bulk loading algorithm, for use with the bulk
+ * loading constructor of RectangleTree.  Given a set of points (or node
+ * centroids) and a node capacity, the points are sorted along the first
+ * dimension and cut into slabs, each of which holds a whole number of nodes;
+ * each slab is then tiled in the same way along the next dimension, and so on.
+ * After ordering, each group of consecutive points of the given capacity forms
+ * a compact tile.
+ *
+ * For more information, see the following paper:
+ *
+ * @code
+ * @inproceedings{leutenegger1997str,
+ *   title={STR: A simple and efficient algorithm for R-tree packing},
+ *   author={Leutenegger, S.T. and Lopez, M.A. and Edgington, J.},
+ *   booktitle={Proceedings of the 13th International Conference on Data
+ *       Engineering (ICDE '97)},
+ *   pages={497--506},
+ *   year={1997}
+ * }
+ * @endcode
+ */
+class STRBulkLoad
+{
+ public:
+  /**
+   * Order the given indices of points in the dataset so that each group of
+   * consecutive indices of size capacity forms a node.  This takes
+   * O(d n log n) time for n points in d dimensions.
+   *
+   * @param data Dataset (or matrix of node centroids).
+   * @param indices Indices of the points in the dataset to order.
+   * @param capacity Number of points in each node.
+   */
+  template<typename MatType>
+  static void Order(const MatType& data,
+                    std::vector<size_t>& indices,
+                    const size_t capacity);
+
+ private:
+  //! Tile the given range of indices, starting with the given dimension.
+  template<typename MatType>
+  static void Tile(const MatType& data,
+                   std::vector<size_t>& indices,
+                   const size_t begin,
+                   const size_t end,
+                   const size_t dim,
+                   const size_t capacity);
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "str_bulk_load_impl.hpp"
+
+#endif
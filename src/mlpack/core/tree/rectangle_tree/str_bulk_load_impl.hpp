@@ -0,0 +1,76 @@
+/**
+ * @file str_bulk_load_impl.hpp
+ *
+ * Implementation of the STRBulkLoad class.
+ */
+#ifndef __MLPACK_CORE_TREE_RECTANGLE_TREE_STR_BULK_LOAD_IMPL_HPP
+#define __MLPACK_CORE_TREE_RECTANGLE_TREE_STR_BULK_LOAD_IMPL_HPP
+
+#include "str_bulk_load.hpp"
+
+namespace mlpack {
+namespace tree {
+
+//! Compare the indices of two points by their value in one dimension.
+template<typename MatType>
+class STRDimensionComparator
+{
+ public:
+  STRDimensionComparator(const MatType& data, const size_t dim) :
+      data(data), dim(dim) { }
+
+  bool operator()(const size_t a, const size_t b) const
+  {
+    return data(dim, a) < data(dim, b);
+  }
+
+ private:
+  const MatType& data;
+  const size_t dim;
+};
+
+template<typename MatType>
+void STRBulkLoad::Order(const MatType& data,
+                        std::vector<size_t>& indices,
+                        const size_t capacity)
+{
+  Tile(data, indices, 0, indices.size(), 0, capacity);
+}
+
+template<typename MatType>
+void STRBulkLoad::Tile(const MatType& data,
+                       std::vector<size_t>& indices,
+                       const size_t begin,
+                       const size_t end,
+                       const size_t dim,
+                       const size_t capacity)
+{
+  // If everything fits in one node, there is nothing to tile.
+  const size_t numPoints = end - begin;
+  if (numPoints <= capacity)
+    return;
+
+  std::sort(indices.begin() + begin, indices.begin() + end,
+      STRDimensionComparator<MatType>(data, dim));
+
+  // The last dimension has been sorted, so the tiles are just runs.
+  if (dim == data.n_rows - 1)
+    return;
+
+  // Cut the points into about P^(1 / d') slabs, where P is the number of nodes
+  // and d' is the number of dimensions left.  Every slab but the last holds a
+  // whole number of nodes, so that all nodes but the last are full.
+  const size_t numNodes = (numPoints + capacity - 1) / capacity;
+  const size_t numSlabs = (size_t) std::ceil(std::pow((double) numNodes,
+      1.0 / (data.n_rows - dim)));
+  const size_t slabSize = ((numNodes + numSlabs - 1) / numSlabs) * capacity;
+
+  for (size_t slab = begin; slab < end; slab += slabSize)
+    Tile(data, indices, slab, std::min(slab + slabSize, end), dim + 1,
+        capacity);
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
@@ -35,7 +35,6 @@ void XTreeSplit<DescentType, StatisticType, MatType>::SplitLeafNode(
 
     copy->Parent() = tree;
     tree->Count() = 0;
-    tree->NullifyData();
     tree->Children()[(tree->NumChildren())++] = copy; // Because this was a leaf node, numChildren must be 0.
     assert(tree->NumChildren() == 1);
     XTreeSplit<DescentType, StatisticType, MatType>::SplitLeafNode(copy, relevels);
@@ -60,7 +59,7 @@ void XTreeSplit<DescentType, StatisticType, MatType>::SplitLeafNode(
    arma::vec centroid;
    tree->Bound().Centroid(centroid); // Modifies centroid.
    for(size_t i = 0; i < sorted.size(); i++) {
-     sorted[i].d = tree->Bound().Metric().Evaluate(centroid, tree->LocalDataset().col(i));
+     sorted[i].d = tree->Bound().Metric().Evaluate(centroid, tree->Dataset().col(tree->Points()[i]));
      sorted[i].n = i;
    }
 
@@ -100,7 +99,7 @@ void XTreeSplit<DescentType, StatisticType, MatType>::SplitLeafNode(
     // Since we only have points in the leaf nodes, we only need to sort once.
     std::vector<sortStruct> sorted(tree->Count());
     for (size_t i = 0; i < sorted.size(); i++) {
-      sorted[i].d = tree->LocalDataset().col(i)[j];
+      sorted[i].d = tree->Dataset().col(tree->Points()[i])[j];
       sorted[i].n = i;
     }
 
@@ -127,19 +126,19 @@ void XTreeSplit<DescentType, StatisticType, MatType>::SplitLeafNode(
       std::vector<double> maxG2(maxG1.size());
       std::vector<double> minG2(maxG1.size());
       for (size_t k = 0; k < tree->Bound().Dim(); k++) {
-        minG1[k] = maxG1[k] = tree->LocalDataset().col(sorted[0].n)[k];
-        minG2[k] = maxG2[k] = tree->LocalDataset().col(sorted[sorted.size() - 1].n)[k];
+        minG1[k] = maxG1[k] = tree->Dataset().col(tree->Points()[sorted[0].n])[k];
+        minG2[k] = maxG2[k] = tree->Dataset().col(tree->Points()[sorted[sorted.size() - 1].n])[k];
         for (size_t l = 1; l < tree->Count() - 1; l++) {
           if (l < cutOff) {
-            if (tree->LocalDataset().col(sorted[l].n)[k] < minG1[k])
-              minG1[k] = tree->LocalDataset().col(sorted[l].n)[k];
-            else if (tree->LocalDataset().col(sorted[l].n)[k] > maxG1[k])
-              maxG1[k] = tree->LocalDataset().col(sorted[l].n)[k];
+            if (tree->Dataset().col(tree->Points()[sorted[l].n])[k] < minG1[k])
+              minG1[k] = tree->Dataset().col(tree->Points()[sorted[l].n])[k];
+            else if (tree->Dataset().col(tree->Points()[sorted[l].n])[k] > maxG1[k])
+              maxG1[k] = tree->Dataset().col(tree->Points()[sorted[l].n])[k];
           } else {
-            if (tree->LocalDataset().col(sorted[l].n)[k] < minG2[k])
-              minG2[k] = tree->LocalDataset().col(sorted[l].n)[k];
-            else if (tree->LocalDataset().col(sorted[l].n)[k] > maxG2[k])
-              maxG2[k] = tree->LocalDataset().col(sorted[l].n)[k];
+            if (tree->Dataset().col(tree->Points()[sorted[l].n])[k] < minG2[k])
+              minG2[k] = tree->Dataset().col(tree->Points()[sorted[l].n])[k];
+            else if (tree->Dataset().col(tree->Points()[sorted[l].n])[k] > maxG2[k])
+              maxG2[k] = tree->Dataset().col(tree->Points()[sorted[l].n])[k];
           }
         }
       }
@@ -177,7 +176,7 @@ void XTreeSplit<DescentType, StatisticType, MatType>::SplitLeafNode(
 
   std::vector<sortStruct> sorted(tree->Count());
   for (size_t i = 0; i < sorted.size(); i++) {
-    sorted[i].d = tree->LocalDataset().col(i)[bestAxis];
+    sorted[i].d = tree->Dataset().col(tree->Points()[i])[bestAxis];
     sorted[i].n = i;
   }
 
@@ -265,7 +264,6 @@ bool XTreeSplit<DescentType, StatisticType, MatType>::SplitNonLeafNode(
 
     copy->Parent() = tree;
     tree->NumChildren() = 0;
-    tree->NullifyData();
     tree->Children()[(tree->NumChildren())++] = copy;
     XTreeSplit<DescentType, StatisticType, MatType>::SplitNonLeafNode(copy, relevels);
     return true;
@@ -621,7 +619,6 @@ bool XTreeSplit<DescentType, StatisticType, MatType>::SplitNonLeafNode(
         }
         delete treeOne;
         delete treeTwo;
-        tree->NullifyData();
         tree->SoftDelete();
         return false;
       }
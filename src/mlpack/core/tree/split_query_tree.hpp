@@ -0,0 +1,62 @@
+/**
+ * @file split_query_tree.hpp
+ *
+ * Splitting of a query tree into disjoint subtrees, so that a dual-tree
+ * traversal can be run on each of them in parallel.
+ */
+#ifndef __MLPACK_CORE_TREE_SPLIT_QUERY_TREE_HPP
+#define __MLPACK_CORE_TREE_SPLIT_QUERY_TREE_HPP
+
+#include <mlpack/core.hpp>
+
+#include <vector>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * Split the given tree into (at least) the given number of disjoint subtrees,
+ * which together hold every point in the tree, by repeatedly replacing the
+ * largest subtree with its children.  If there are not enough non-leaf nodes,
+ * fewer subtrees are returned.  The subtrees can be traversed in parallel
+ * (each with its own rules) as query trees, since each query point is in
+ * exactly one of them.
+ *
+ * @param root Root of the tree to split.
+ * @param numSubtrees Number of subtrees to split the tree into.
+ * @param subtrees Vector to store the roots of the subtrees in.
+ */
+template<typename TreeType>
+void SplitQueryTree(TreeType& root,
+                    const size_t numSubtrees,
+                    std::vector<TreeType*>& subtrees)
+{
+  subtrees.clear();
+  subtrees.push_back(&root);
+
+  while (subtrees.size() < numSubtrees)
+  {
+    // Find the largest subtree which can be split.
+    size_t largest = subtrees.size();
+    for (size_t i = 0; i < subtrees.size(); ++i)
+    {
+      if ((subtrees[i]->NumChildren() > 0) && ((largest == subtrees.size()) ||
+          (subtrees[i]->NumDescendants() >
+           subtrees[largest]->NumDescendants())))
+        largest = i;
+    }
+
+    if (largest == subtrees.size())
+      return; // Every subtree is a leaf.
+
+    TreeType* node = subtrees[largest];
+    subtrees[largest] = &node->Child(0);
+    for (size_t i = 1; i < node->NumChildren(); ++i)
+      subtrees.push_back(&node->Child(i));
+  }
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * @file tree_file.cpp
+ *
+ * Implementation of the TreeFileWriter and TreeFileReader classes.
+ */
+#include "tree_file.hpp"
+
+using namespace mlpack;
+using namespace mlpack::tree;
+
+TreeFileWriter::TreeFileWriter(const std::string& filename) :
+    filename(filename),
+    stream(filename.c_str(), std::ios::out | std::ios::binary |
+        std::ios::trunc),
+    position(0)
+{
+  if (!stream.is_open())
+  {
+    Log::Fatal << "Cannot open file '" << filename << "' for writing!"
+        << std::endl;
+  }
+}
+
+void TreeFileWriter::Align()
+{
+  const char zeros[Alignment] = { 0 };
+  const size_t padding = (Alignment - (position % Alignment)) % Alignment;
+  Write(zeros, padding);
+}
+
+TreeFileReader::TreeFileReader(char* data,
+                               const size_t size,
+                               const std::string& filename) :
+    data(data),
+    size(size),
+    filename(filename),
+    position(0)
+{
+  // Nothing to do.
+}
+
+void TreeFileReader::Align()
+{
+  const size_t alignment = TreeFileWriter::Alignment;
+  const size_t padding = (alignment - (position % alignment)) % alignment;
+  Require(padding);
+  position += padding;
+}
+
+void TreeFileReader::Require(const size_t bytes) const
+{
+  if (bytes > size - position)
+  {
+    Log::Fatal << "Tree file '" << filename << "' is truncated or corrupt!"
+        << std::endl;
+  }
+}
@@ -0,0 +1,237 @@
+/**
+ * @file tree_file.hpp
+ *
+ * Saving of built trees to a binary file, and loading of them (without copying
+ * the dataset) with mmap().
+ */
+#ifndef __MLPACK_CORE_TREE_TREE_FILE_HPP
+#define __MLPACK_CORE_TREE_TREE_FILE_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/util/mapped_file.hpp>
+#include "bounds.hpp"
+
+#include <fstream>
+#include <string>
+#include <typeinfo>
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+/**
+ * The version of the tree file format written by SaveTree().  Files written
+ * with another version are not loaded.
+ */
+const uint32_t TreeFileVersion = 1;
+
+/**
+ * Write the contents of a tree file.  Values are written in the byte order and
+ * size of the machine; the header of the file records these, so that a file
+ * from an incompatible machine is detected when it is loaded.
+ */
+class TreeFileWriter
+{
+ public:
+  //! Arrays which are mapped directly when the file is loaded are aligned to
+  //! this many bytes.
+  static const size_t Alignment = 64;
+
+  /**
+   * Open the given file for writing.  If it cannot be opened, a fatal error is
+   * thrown.
+   *
+   * @param filename Name of file to write.
+   */
+  TreeFileWriter(const std::string& filename);
+
+  //! Write a single value.
+  template<typename T>
+  void Write(const T& value) { Write(&value, 1); }
+
+  //! Write an array of n values.
+  template<typename T>
+  void Write(const T* values, const size_t n);
+
+  //! Pad the file with zeros up to the next multiple of Alignment bytes.
+  void Align();
+
+ private:
+  //! The name of the file.
+  std::string filename;
+  //! The file.
+  std::ofstream stream;
+  //! The number of bytes written so far.
+  size_t position;
+};
+
+/**
+ * Read the contents of a tree file from memory (usually, a MappedFile).  Reads
+ * past the end of the memory throw a fatal error.
+ */
+class TreeFileReader
+{
+ public:
+  /**
+   * Read from the given memory.
+   *
+   * @param data Contents of the file.
+   * @param size Size of the file, in bytes.
+   * @param filename Name of the file (for error messages).
+   */
+  TreeFileReader(char* data, const size_t size, const std::string& filename);
+
+  //! Read a single value.
+  template<typename T>
+  void Read(T& value) { Read(&value, 1); }
+
+  //! Read (copy) an array of n values.
+  template<typename T>
+  void Read(T* values, const size_t n);
+
+  /**
+   * Return a pointer to the next n values in the file, without copying them,
+   * and move past them.  Call Align() first if the array was written after a
+   * call to TreeFileWriter::Align(); otherwise, the pointer may be misaligned.
+   */
+  template<typename T>
+  T* Map(const size_t n);
+
+  //! Move to the next multiple of TreeFileWriter::Alignment bytes.
+  void Align();
+
+ private:
+  //! The contents of the file.
+  char* data;
+  //! The size of the file, in bytes.
+  size_t size;
+  //! The name of the file.
+  std::string filename;
+  //! The number of bytes read so far.
+  size_t position;
+
+  //! Throw a fatal error if fewer than the given number of bytes are left.
+  void Require(const size_t bytes) const;
+
+  //! Return the size of n values of type T in bytes, throwing a fatal error if
+  //! it overflows.
+  template<typename T>
+  size_t Bytes(const size_t n) const;
+};
+
+//! Write a hyperrectangle bound to a tree file.
+template<int Power, bool TakeRoot>
+void SaveBound(TreeFileWriter& writer,
+               const bound::HRectBound<Power, TakeRoot>& bound);
+
+//! Read a hyperrectangle bound from a tree file; the bound must already have
+//! the dimensionality of the one in the file.
+template<int Power, bool TakeRoot>
+void LoadBound(TreeFileReader& reader,
+               bound::HRectBound<Power, TakeRoot>& bound);
+
+//! Write a ball bound to a tree file.
+template<typename VecType, typename MetricType>
+void SaveBound(TreeFileWriter& writer,
+               const bound::BallBound<VecType, MetricType>& bound);
+
+//! Read a ball bound from a tree file; the bound must already have the
+//! dimensionality of the one in the file.
+template<typename VecType, typename MetricType>
+void LoadBound(TreeFileReader& reader,
+               bound::BallBound<VecType, MetricType>& bound);
+
+/**
+ * Save a built tree, together with its dataset and the mapping from the new
+ * point indices to the old point indices (for trees which reorder the
+ * dataset), to a binary file.  The tree can be loaded again with LoadedTree.
+ * TreeType must have a Save(TreeFileWriter&) method, and its dataset must be a
+ * dense matrix.
+ *
+ * The statistics of the nodes are not written; they are built again when the
+ * tree is loaded, since the statistic of a node is a function of the node.
+ *
+ * @param filename Name of file to save to.
+ * @param tree Tree to save (this should be the root of the tree).
+ * @param oldFromNew Mapping from new point indices to old point indices
+ *     (optional).
+ */
+template<typename TreeType>
+void SaveTree(const std::string& filename,
+              const TreeType& tree,
+              const std::vector<size_t>& oldFromNew = std::vector<size_t>());
+
+/**
+ * A tree loaded from a file written by SaveTree().  The file is mapped into
+ * memory with mmap() (when available), and the dataset of the tree uses that
+ * memory directly, so loading takes time proportional to the number of nodes in
+ * the tree and not to the size of the dataset, and only the parts of the
+ * dataset which are used are read from disk.
+ *
+ * The tree and the dataset belong to the LoadedTree, and are destroyed with it.
+ * TreeType must have a constructor TreeType(MatType&, TreeFileReader&) which
+ * loads a node (and its descendants) written with TreeType::Save().
+ *
+ * @code
+ * LoadedTree<KDTree> loaded("tree.bin");
+ * AllkNN allknn(&loaded.Tree(), loaded.Dataset());
+ * @endcode
+ *
+ * @tparam TreeType Type of tree to load; this must be the type of the tree
+ *     which was saved.
+ */
+template<typename TreeType>
+class LoadedTree
+{
+ public:
+  //! The type of the dataset.
+  typedef typename TreeType::Mat MatType;
+
+  /**
+   * Load the tree from the given file.  If the file cannot be read, was not
+   * written by SaveTree(), or holds a different type of tree, a fatal error is
+   * thrown.
+   *
+   * @param filename Name of file to load.
+   */
+  LoadedTree(const std::string& filename);
+
+  //! Delete the tree and the dataset.
+  ~LoadedTree();
+
+  //! Get the tree.
+  const TreeType& Tree() const { return *tree; }
+  //! Modify the tree.
+  TreeType& Tree() { return *tree; }
+
+  //! Get the dataset.
+  const MatType& Dataset() const { return *dataset; }
+  //! Modify the dataset (the file is not changed).
+  MatType& Dataset() { return *dataset; }
+
+  //! Get the mapping from new point indices to old point indices (this is
+  //! empty if it was not saved).
+  const std::vector<size_t>& OldFromNew() const { return oldFromNew; }
+
+ private:
+  //! The file; this must outlive the dataset, which uses its memory.
+  util::MappedFile file;
+  //! The dataset, which uses the memory of the file.
+  MatType* dataset;
+  //! The mapping from new point indices to old point indices.
+  std::vector<size_t> oldFromNew;
+  //! The tree.
+  TreeType* tree;
+
+  //! A LoadedTree can't be copied.
+  LoadedTree(const LoadedTree& other);
+  //! A LoadedTree can't be copied.
+  LoadedTree& operator=(const LoadedTree& other);
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "tree_file_impl.hpp"
+
+#endif
@@ -0,0 +1,260 @@
+/**
+ * @file tree_file_impl.hpp
+ *
+ * Implementation of the templated parts of tree saving and loading.
+ */
+#ifndef __MLPACK_CORE_TREE_TREE_FILE_IMPL_HPP
+#define __MLPACK_CORE_TREE_TREE_FILE_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "tree_file.hpp"
+
+namespace mlpack {
+namespace tree {
+
+//! The first bytes of every tree file.
+const char TreeFileMagic[8] = { 'M', 'L', 'P', 'K', 'T', 'R', 'E', 'E' };
+
+//! Written to the header to detect files from machines with another byte
+//! order.
+const uint32_t TreeFileByteOrder = 0x01020304;
+
+template<typename T>
+void TreeFileWriter::Write(const T* values, const size_t n)
+{
+  if (n == 0)
+    return;
+
+  stream.write(reinterpret_cast<const char*>(values), sizeof(T) * n);
+  if (!stream.good())
+  {
+    Log::Fatal << "Error writing to tree file '" << filename << "'!"
+        << std::endl;
+  }
+
+  position += sizeof(T) * n;
+}
+
+template<typename T>
+size_t TreeFileReader::Bytes(const size_t n) const
+{
+  if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+  {
+    Log::Fatal << "Tree file '" << filename << "' is corrupt (array of " << n
+        << " values is too large)!" << std::endl;
+  }
+
+  return sizeof(T) * n;
+}
+
+template<typename T>
+void TreeFileReader::Read(T* values, const size_t n)
+{
+  Require(Bytes<T>(n));
+  if (n > 0)
+    memcpy(values, data + position, sizeof(T) * n);
+  position += sizeof(T) * n;
+}
+
+template<typename T>
+T* TreeFileReader::Map(const size_t n)
+{
+  Require(Bytes<T>(n));
+  T* values = reinterpret_cast<T*>(data + position);
+  position += sizeof(T) * n;
+  return values;
+}
+
+template<int Power, bool TakeRoot>
+void SaveBound(TreeFileWriter& writer,
+               const bound::HRectBound<Power, TakeRoot>& bound)
+{
+  writer.Write((uint64_t) bound.Dim());
+  for (size_t i = 0; i < bound.Dim(); ++i)
+  {
+    writer.Write(bound[i].Lo());
+    writer.Write(bound[i].Hi());
+  }
+  writer.Write(bound.MinWidth());
+}
+
+template<int Power, bool TakeRoot>
+void LoadBound(TreeFileReader& reader,
+               bound::HRectBound<Power, TakeRoot>& bound)
+{
+  uint64_t dim;
+  reader.Read(dim);
+  if (dim != bound.Dim())
+  {
+    Log::Fatal << "Tree file holds a bound of dimensionality " << dim
+        << ", but " << bound.Dim() << " was expected!" << std::endl;
+  }
+
+  bound = bound::HRectBound<Power, TakeRoot>(dim);
+  for (size_t i = 0; i < dim; ++i)
+  {
+    double lo, hi;
+    reader.Read(lo);
+    reader.Read(hi);
+    bound[i] = math::Range(lo, hi);
+  }
+  reader.Read(bound.MinWidth());
+}
+
+template<typename VecType, typename MetricType>
+void SaveBound(TreeFileWriter& writer,
+               const bound::BallBound<VecType, MetricType>& bound)
+{
+  writer.Write(bound.Radius());
+  writer.Write((uint64_t) bound.Center().n_elem);
+  for (size_t i = 0; i < bound.Center().n_elem; ++i)
+    writer.Write((double) bound.Center()[i]);
+}
+
+template<typename VecType, typename MetricType>
+void LoadBound(TreeFileReader& reader,
+               bound::BallBound<VecType, MetricType>& bound)
+{
+  reader.Read(bound.Radius());
+
+  uint64_t dim;
+  reader.Read(dim);
+  if (dim != (uint64_t) bound.Dim())
+  {
+    Log::Fatal << "Tree file holds a bound of dimensionality " << dim
+        << ", but " << bound.Dim() << " was expected!" << std::endl;
+  }
+
+  bound.Center().zeros(dim);
+  for (size_t i = 0; i < dim; ++i)
+  {
+    double value;
+    reader.Read(value);
+    bound.Center()[i] = value;
+  }
+}
+
+template<typename TreeType>
+void SaveTree(const std::string& filename,
+              const TreeType& tree,
+              const std::vector<size_t>& oldFromNew)
+{
+  typedef typename TreeType::Mat::elem_type ElemType;
+
+  TreeFileWriter writer(filename);
+
+  // The header: the format, the machine, and the type of the tree.
+  writer.Write(TreeFileMagic, 8);
+  writer.Write(TreeFileVersion);
+  writer.Write(TreeFileByteOrder);
+  writer.Write((uint32_t) sizeof(size_t));
+  writer.Write((uint32_t) sizeof(ElemType));
+
+  const std::string treeType = typeid(TreeType).name();
+  writer.Write((uint64_t) treeType.size());
+  writer.Write(treeType.c_str(), treeType.size());
+
+  // The dataset is aligned, so that it can be used directly after loading.
+  const typename TreeType::Mat& dataset = tree.Dataset();
+  writer.Write((uint64_t) dataset.n_rows);
+  writer.Write((uint64_t) dataset.n_cols);
+  writer.Align();
+  writer.Write(dataset.memptr(), dataset.n_elem);
+
+  writer.Write((uint64_t) oldFromNew.size());
+  if (oldFromNew.size() > 0)
+    writer.Write(&oldFromNew[0], oldFromNew.size());
+
+  // Lastly, the nodes of the tree.
+  tree.Save(writer);
+}
+
+template<typename TreeType>
+LoadedTree<TreeType>::LoadedTree(const std::string& filename) :
+    file(filename),
+    dataset(NULL),
+    tree(NULL)
+{
+  typedef typename MatType::elem_type ElemType;
+
+  TreeFileReader reader(file.Data(), file.Size(), filename);
+
+  char magic[8];
+  reader.Read(magic, 8);
+  if (memcmp(magic, TreeFileMagic, 8) != 0)
+  {
+    Log::Fatal << "File '" << filename << "' is not a tree file!"
+        << std::endl;
+  }
+
+  uint32_t version;
+  reader.Read(version);
+  if (version != TreeFileVersion)
+  {
+    Log::Fatal << "Tree file '" << filename << "' has version " << version
+        << ", but only version " << TreeFileVersion << " is supported!"
+        << std::endl;
+  }
+
+  uint32_t byteOrder, sizeSize, elemSize;
+  reader.Read(byteOrder);
+  reader.Read(sizeSize);
+  reader.Read(elemSize);
+  if (byteOrder != TreeFileByteOrder || sizeSize != sizeof(size_t) ||
+      elemSize != sizeof(ElemType))
+  {
+    Log::Fatal << "Tree file '" << filename << "' was written on a machine "
+        << "with a different byte order or word size, or with a different "
+        << "element type!" << std::endl;
+  }
+
+  uint64_t treeTypeSize;
+  reader.Read(treeTypeSize);
+  const char* treeType = reader.Map<char>(treeTypeSize);
+  if (std::string(treeType, treeTypeSize) != typeid(TreeType).name())
+  {
+    Log::Fatal << "Tree file '" << filename << "' holds a different type of "
+        << "tree!" << std::endl;
+  }
+
+  // Use the memory of the file for the dataset, without copying it.
+  uint64_t nRows, nCols;
+  reader.Read(nRows);
+  reader.Read(nCols);
+  if (nCols > 0 && nRows > std::numeric_limits<size_t>::max() /
+      sizeof(ElemType) / nCols)
+  {
+    Log::Fatal << "Tree file '" << filename << "' is corrupt (dataset of size "
+        << nRows << "x" << nCols << " is too large)!" << std::endl;
+  }
+
+  reader.Align();
+  ElemType* memory = reader.Map<ElemType>(nRows * nCols);
+  dataset = new MatType(memory, nRows, nCols, false, true);
+
+  uint64_t mappingSize;
+  reader.Read(mappingSize);
+  if (mappingSize != 0 && mappingSize != nCols)
+  {
+    Log::Fatal << "Tree file '" << filename << "' is corrupt (mapping of "
+        << mappingSize << " points for " << nCols << " points)!" << std::endl;
+  }
+
+  oldFromNew.resize(mappingSize);
+  if (mappingSize > 0)
+    reader.Read(&oldFromNew[0], mappingSize);
+
+  tree = new TreeType(*dataset, reader);
+}
+
+template<typename TreeType>
+LoadedTree<TreeType>::~LoadedTree()
+{
+  delete tree;
+  delete dataset;
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
@@ -96,6 +96,36 @@ class TreeTraits
   static const bool RearrangesDataset = false;
 };
 
+/**
+ * The RuleTraits class provides compile-time information on the rules (the
+ * BaseCase() and Score() functions) given to a traverser, so that a traverser
+ * can use faster ways of running the rules when they are supported.  Like
+ * TreeTraits, each trait is set to make as few assumptions as possible, so
+ * rules do not need to specialize this class unless they support one of the
+ * traits.
+ */
+template<typename RuleType>
+class RuleTraits
+{
+ public:
+  /**
+   * This is true if the rules have a function
+   *
+   * @code
+   * void BlockBaseCase(const std::vector<size_t>& queryIndices,
+   *                    const size_t referenceBegin,
+   *                    const size_t referenceCount);
+   * @endcode
+   *
+   * which has the same effect as calling BaseCase() for each of the given query
+   * points with each of the referenceCount reference points starting at
+   * referenceBegin (in that order), but does it faster by working on all of the
+   * points at once.  Traversers of trees which hold the points of a leaf
+   * contiguously may then call it for pairs of leaves.
+   */
+  static const bool HasBlockBaseCase = false;
+};
+
 }; // namespace tree
 }; // namespace mlpack
 
@@ -0,0 +1,95 @@
+/**
+ * @file mapped_file.cpp
+ *
+ * Implementation of the MappedFile class.
+ */
+#include <mlpack/core.hpp>
+#include "mapped_file.hpp"
+
+#include <fstream>
+
+#if defined(__unix__) || defined(__unix) || \
+    (defined(__MACH__) && defined(__APPLE__))
+  #include <fcntl.h>      // open()
+  #include <sys/mman.h>   // mmap(), munmap()
+  #include <sys/stat.h>   // fstat()
+  #include <unistd.h>     // close()
+  #define MLPACK_HAS_MMAP
+#endif
+
+using namespace mlpack;
+using namespace mlpack::util;
+
+MappedFile::MappedFile(const std::string& filename) :
+    filename(filename),
+    data(NULL),
+    size(0),
+    mapped(false)
+{
+#ifdef MLPACK_HAS_MMAP
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    Log::Fatal << "Cannot open file '" << filename << "' for reading!"
+        << std::endl;
+  }
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0)
+  {
+    close(fd);
+    Log::Fatal << "Cannot get the size of file '" << filename << "'!"
+        << std::endl;
+  }
+
+  size = (size_t) fileStat.st_size;
+
+  // An empty file can't be mapped, but there is nothing to map anyway.
+  if (size > 0)
+  {
+    void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+        0);
+    if (mapping == MAP_FAILED)
+    {
+      close(fd);
+      Log::Fatal << "Cannot map file '" << filename << "' into memory!"
+          << std::endl;
+    }
+
+    data = static_cast<char*>(mapping);
+    mapped = true;
+  }
+
+  // The mapping stays valid after the file is closed.
+  close(fd);
+#else
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+  {
+    Log::Fatal << "Cannot open file '" << filename << "' for reading!"
+        << std::endl;
+  }
+
+  stream.seekg(0, std::ios::end);
+  size = (size_t) stream.tellg();
+  stream.seekg(0, std::ios::beg);
+
+  // Memory from operator new is suitably aligned for any type.
+  data = static_cast<char*>(::operator new(size + 1));
+  if (!stream.read(data, size))
+  {
+    ::operator delete(data);
+    Log::Fatal << "Cannot read file '" << filename << "'!" << std::endl;
+  }
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef MLPACK_HAS_MMAP
+  if (mapped)
+    munmap(data, size);
+#else
+  ::operator delete(data);
+#endif
+}
@@ -0,0 +1,71 @@
+/**
+ * @file mapped_file.hpp
+ *
+ * Definition of the MappedFile class, which maps a file into memory so that it
+ * can be read without copying it.
+ */
+#ifndef __MLPACK_CORE_UTIL_MAPPED_FILE_HPP
+#define __MLPACK_CORE_UTIL_MAPPED_FILE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <string>
+
+namespace mlpack {
+namespace util {
+
+/**
+ * Map the contents of a file into memory.  On POSIX systems the file is mapped
+ * with mmap(), so pages are only read from disk when they are used and a large
+ * file can be "loaded" in constant time; elsewhere, the file is read into a
+ * buffer.
+ *
+ * The mapping is private: the contents may be modified through Data(), but the
+ * changes are never written back to the file.  The memory is released when the
+ * MappedFile is destroyed, so anything pointing into it (for instance, a matrix
+ * that uses the memory directly) must not outlive the MappedFile.
+ */
+class MappedFile
+{
+ public:
+  /**
+   * Map the given file into memory.  If the file cannot be opened or read, a
+   * fatal error is thrown.
+   *
+   * @param filename Name of the file to map.
+   */
+  MappedFile(const std::string& filename);
+
+  //! Release the memory of the file.
+  ~MappedFile();
+
+  //! Get the contents of the file.
+  const char* Data() const { return data; }
+  //! Modify the contents of the file (the file itself is not changed).
+  char* Data() { return data; }
+
+  //! Get the size of the file, in bytes.
+  size_t Size() const { return size; }
+
+  //! Get the name of the file.
+  const std::string& Filename() const { return filename; }
+
+ private:
+  //! The name of the file.
+  std::string filename;
+  //! The contents of the file.
+  char* data;
+  //! The size of the file, in bytes.
+  size_t size;
+  //! Whether the file was mapped with mmap() (otherwise, it was read).
+  bool mapped;
+
+  //! A MappedFile can't be copied.
+  MappedFile(const MappedFile& other);
+  //! A MappedFile can't be copied.
+  MappedFile& operator=(const MappedFile& other);
+};
+
+}; // namespace util
+}; // namespace mlpack
+
+#endif
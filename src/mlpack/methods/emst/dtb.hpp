@@ -104,6 +104,10 @@ class DualTreeBoruvka
   //! List of edge distances.
   arma::vec neighborsDistances;
 
+  //! Core distances of each point, if the MST is being computed with mutual
+  //! reachability distance (empty otherwise).
+  arma::vec coreDistances;
+
   //! Total distance of the tree.
   double totalDist;
 
@@ -169,6 +173,24 @@ class DualTreeBoruvka
    */
   void ComputeMST(arma::mat& results);
 
+  /**
+   * Compute the minimum spanning tree under the mutual reachability distance
+   * induced by the given core distances; that is, the distance between points
+   * a and b is taken as max(d(a, b), coreDistances[a], coreDistances[b]).
+   * This is the spanning tree used by HDBSCAN-style density-based hierarchical
+   * clustering.  If every core distance is zero, this gives the same results
+   * as ComputeMST(results).  The format of the results is the same as
+   * ComputeMST(results).
+   *
+   * The core distances should be given in the same order as the dataset given
+   * to the constructor.  (If a pre-built tree was given, this means the order
+   * of the points in the tree.)
+   *
+   * @param results Matrix which results will be stored in.
+   * @param coreDistances Core distance of each point.
+   */
+  void ComputeMST(arma::mat& results, const arma::vec& coreDistances);
+
   /**
    * Returns a string representation of this object.
    */
@@ -196,6 +218,12 @@ class DualTreeBoruvka
    */
   void CleanupHelper(TreeType* tree);
 
+  /**
+   * Set the minimum and maximum core distance statistics of each node in the
+   * tree.
+   */
+  void CoreDistanceHelper(TreeType* tree);
+
   /**
    * The values stored in the tree must be reset on each iteration.
    */
@@ -115,7 +115,7 @@ void DualTreeBoruvka<MetricType, TreeType>::ComputeMST(arma::mat& results)
 
   typedef DTBRules<MetricType, TreeType> RuleType;
   RuleType rules(data, connections, neighborsDistances, neighborsInComponent,
-                 neighborsOutComponent, metric);
+                 neighborsOutComponent, coreDistances, metric);
   while (edges.size() < (data.n_cols - 1))
   {
     if (naive)
@@ -151,6 +151,37 @@ void DualTreeBoruvka<MetricType, TreeType>::ComputeMST(arma::mat& results)
   Log::Info << "Total spanning tree length: " << totalDist << std::endl;
 }
 
+/**
+ * Find the minimum spanning tree under mutual reachability distance.
+ */
+template<typename MetricType, typename TreeType>
+void DualTreeBoruvka<MetricType, TreeType>::ComputeMST(
+    arma::mat& results,
+    const arma::vec& coreDistancesIn)
+{
+  Log::Assert(coreDistancesIn.n_elem == data.n_cols,
+      "DualTreeBoruvka::ComputeMST(): must have one core distance per point.");
+
+  // If we built the tree, the points have been permuted.
+  if (!naive && ownTree && tree::TreeTraits<TreeType>::RearrangesDataset)
+  {
+    coreDistances.set_size(data.n_cols);
+    for (size_t i = 0; i < data.n_cols; ++i)
+      coreDistances[i] = coreDistancesIn[oldFromNew[i]];
+  }
+  else
+  {
+    coreDistances = coreDistancesIn;
+  }
+
+  if (!naive)
+    CoreDistanceHelper(tree);
+
+  ComputeMST(results);
+
+  coreDistances.reset();
+}
+
 /**
  * Adds a single edge to the edge list
  */
@@ -275,6 +306,36 @@ void DualTreeBoruvka<MetricType, TreeType>::CleanupHelper(TreeType* tree)
   tree->Stat().ComponentMembership() = component;
 }
 
+/**
+ * Set the bounds on core distances held in each node of the tree.
+ */
+template<typename MetricType, typename TreeType>
+void DualTreeBoruvka<MetricType, TreeType>::CoreDistanceHelper(TreeType* tree)
+{
+  double minCoreDistance = DBL_MAX;
+  double maxCoreDistance = 0.0;
+
+  for (size_t i = 0; i < tree->NumChildren(); ++i)
+  {
+    CoreDistanceHelper(&tree->Child(i));
+    minCoreDistance = std::min(minCoreDistance,
+        tree->Child(i).Stat().MinCoreDistance());
+    maxCoreDistance = std::max(maxCoreDistance,
+        tree->Child(i).Stat().MaxCoreDistance());
+  }
+
+  for (size_t i = 0; i < tree->NumPoints(); ++i)
+  {
+    minCoreDistance = std::min(minCoreDistance,
+        coreDistances[tree->Point(i)]);
+    maxCoreDistance = std::max(maxCoreDistance,
+        coreDistances[tree->Point(i)]);
+  }
+
+  tree->Stat().MinCoreDistance() = minCoreDistance;
+  tree->Stat().MaxCoreDistance() = maxCoreDistance;
+}
+
 /**
  * The values stored in the tree must be reset on each iteration.
  */
@@ -18,11 +18,27 @@ template<typename MetricType, typename TreeType>
 class DTBRules
 {
  public:
+  /**
+   * Construct the rules.  If coreDistances is non-empty, distances between
+   * points are mutual reachability distances; that is, the distance between
+   * points a and b is max(d(a, b), coreDistances[a], coreDistances[b]).  In
+   * that case, the MinCoreDistance() and MaxCoreDistance() statistics of each
+   * node must already be set.
+   *
+   * @param dataSet The data points.
+   * @param connections Current components of the spanning tree.
+   * @param neighborsDistances Candidate edge distance for each component.
+   * @param neighborsInComponent Candidate edge endpoint in each component.
+   * @param neighborsOutComponent Candidate edge endpoint out of each component.
+   * @param coreDistances Core distance of each point (may be empty).
+   * @param metric Instantiated metric.
+   */
   DTBRules(const arma::mat& dataSet,
            UnionFind& connections,
            arma::vec& neighborsDistances,
            arma::Col<size_t>& neighborsInComponent,
            arma::Col<size_t>& neighborsOutComponent,
+           const arma::vec& coreDistances,
            MetricType& metric);
 
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
@@ -138,6 +154,9 @@ class DTBRules
   //! of the candidate edge.
   arma::Col<size_t>& neighborsOutComponent;
 
+  //! The core distance of each point; if empty, plain distances are used.
+  const arma::vec& coreDistances;
+
   //! The instantiated metric.
   MetricType& metric;
 
@@ -146,6 +165,15 @@ class DTBRules
    */
   inline double CalculateBound(TreeType& queryNode) const;
 
+  /**
+   * Adjust a lower bound on the distance between two nodes so that it is a
+   * lower bound on the mutual reachability distance (if core distances are
+   * being used).
+   */
+  inline double AdjustMinDistance(const double distance,
+                                  const double queryCoreDistance,
+                                  const TreeType& referenceNode) const;
+
   TraversalInfoType traversalInfo;
 
   //! The number of base cases calculated.
@@ -17,6 +17,7 @@ DTBRules(const arma::mat& dataSet,
          arma::vec& neighborsDistances,
          arma::Col<size_t>& neighborsInComponent,
          arma::Col<size_t>& neighborsOutComponent,
+         const arma::vec& coreDistances,
          MetricType& metric)
 :
   dataSet(dataSet),
@@ -24,6 +25,7 @@ DTBRules(const arma::mat& dataSet,
   neighborsDistances(neighborsDistances),
   neighborsInComponent(neighborsInComponent),
   neighborsOutComponent(neighborsOutComponent),
+  coreDistances(coreDistances),
   metric(metric),
   baseCases(0),
   scores(0)
@@ -52,6 +54,12 @@ double DTBRules<MetricType, TreeType>::BaseCase(const size_t queryIndex,
     double distance = metric.Evaluate(dataSet.col(queryIndex),
                                       dataSet.col(referenceIndex));
 
+    // Under mutual reachability distance, neither point can be closer than its
+    // core distance.
+    if (coreDistances.n_elem > 0)
+      distance = std::max(distance, std::max(coreDistances[queryIndex],
+          coreDistances[referenceIndex]));
+
     if (distance < neighborsDistances[queryComponentIndex])
     {
       Log::Assert(queryIndex != referenceIndex);
@@ -84,7 +92,10 @@ double DTBRules<MetricType, TreeType>::Score(const size_t queryIndex,
     return DBL_MAX;
 
   const arma::vec queryPoint = dataSet.unsafe_col(queryIndex);
-  const double distance = referenceNode.MinDistance(queryPoint);
+  const double distance = AdjustMinDistance(
+      referenceNode.MinDistance(queryPoint),
+      (coreDistances.n_elem > 0) ? coreDistances[queryIndex] : 0.0,
+      referenceNode);
 
   // If all the points in the reference node are farther than the candidate
   // nearest neighbor for the query's component, we prune.
@@ -108,8 +119,10 @@ double DTBRules<MetricType, TreeType>::Score(const size_t queryIndex,
     return DBL_MAX;
 
   const arma::vec queryPoint = dataSet.unsafe_col(queryIndex);
-  const double distance = referenceNode.MinDistance(queryPoint,
-                                                    baseCaseResult);
+  const double distance = AdjustMinDistance(
+      referenceNode.MinDistance(queryPoint, baseCaseResult),
+      (coreDistances.n_elem > 0) ? coreDistances[queryIndex] : 0.0,
+      referenceNode);
 
   // If all the points in the reference node are farther than the candidate
   // nearest neighbor for the query's component, we prune.
@@ -140,7 +153,9 @@ double DTBRules<MetricType, TreeType>::Score(TreeType& queryNode,
     return DBL_MAX;
 
   ++scores;
-  const double distance = queryNode.MinDistance(&referenceNode);
+  const double distance = AdjustMinDistance(
+      queryNode.MinDistance(&referenceNode),
+      queryNode.Stat().MinCoreDistance(), referenceNode);
   const double bound = CalculateBound(queryNode);
 
   // If all the points in the reference node are farther than the candidate
@@ -161,7 +176,9 @@ double DTBRules<MetricType, TreeType>::Score(TreeType& queryNode,
     return DBL_MAX;
 
   ++scores;
-  const double distance = queryNode.MinDistance(referenceNode, baseCaseResult);
+  const double distance = AdjustMinDistance(
+      queryNode.MinDistance(referenceNode, baseCaseResult),
+      queryNode.Stat().MinCoreDistance(), referenceNode);
   const double bound = CalculateBound(queryNode);
 
   // If all the points in the reference node are farther than the candidate
@@ -218,9 +235,15 @@ inline double DTBRules<MetricType, TreeType>::CalculateBound(
   const double worstBound = std::max(worstPointBound, worstChildBound);
   const double bestBound = std::min(bestPointBound, bestChildBound);
   // We must check that bestBound != DBL_MAX; otherwise, we risk overflow.
-  const double bestAdjustedBound = (bestBound == DBL_MAX) ? DBL_MAX :
+  double bestAdjustedBound = (bestBound == DBL_MAX) ? DBL_MAX :
       bestBound + 2 * queryNode.FurthestDescendantDistance();
 
+  // Under mutual reachability distance, the core distance of the query points
+  // may dominate the distance to the candidate neighbor.
+  if (coreDistances.n_elem > 0)
+    bestAdjustedBound = std::max(bestAdjustedBound,
+        queryNode.Stat().MaxCoreDistance());
+
   // Update the relevant quantities in the node.
   queryNode.Stat().MaxNeighborDistance() = worstBound;
   queryNode.Stat().MinNeighborDistance() = bestBound;
@@ -229,6 +252,21 @@ inline double DTBRules<MetricType, TreeType>::CalculateBound(
   return queryNode.Stat().Bound();
 }
 
+// Turn a lower bound on distance into a lower bound on mutual reachability
+// distance.  If core distances are not in use, this does nothing.
+template<typename MetricType, typename TreeType>
+inline double DTBRules<MetricType, TreeType>::AdjustMinDistance(
+    const double distance,
+    const double queryCoreDistance,
+    const TreeType& referenceNode) const
+{
+  if (coreDistances.n_elem == 0)
+    return distance;
+
+  return std::max(distance, std::max(queryCoreDistance,
+      referenceNode.Stat().MinCoreDistance()));
+}
+
 }; // namespace emst
 }; // namespace mlpack
 
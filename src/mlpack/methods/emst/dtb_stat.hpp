@@ -36,6 +36,14 @@ class DTBStat
   //! negative.
   int componentMembership;
 
+  //! The minimum core distance of any descendant point (only used when
+  //! computing the MST under mutual reachability distance).
+  double minCoreDistance;
+
+  //! The maximum core distance of any descendant point (only used when
+  //! computing the MST under mutual reachability distance).
+  double maxCoreDistance;
+
  public:
   /**
    * A generic initializer.  Sets the maximum neighbor distance to its default,
@@ -45,7 +53,9 @@ class DTBStat
       maxNeighborDistance(DBL_MAX),
       minNeighborDistance(DBL_MAX),
       bound(DBL_MAX),
-      componentMembership(-1) { }
+      componentMembership(-1),
+      minCoreDistance(0.0),
+      maxCoreDistance(0.0) { }
 
   /**
    * This is called when a node is finished initializing.  We set the maximum
@@ -61,7 +71,9 @@ class DTBStat
       bound(DBL_MAX),
       componentMembership(
           ((node.NumPoints() == 1) && (node.NumChildren() == 0)) ?
-            node.Point(0) : -1) { }
+            node.Point(0) : -1),
+      minCoreDistance(0.0),
+      maxCoreDistance(0.0) { }
 
   //! Get the maximum neighbor distance.
   double MaxNeighborDistance() const { return maxNeighborDistance; }
@@ -83,6 +95,16 @@ class DTBStat
   //! Modify the component membership of this node.
   int& ComponentMembership() { return componentMembership; }
 
+  //! Get the minimum core distance of any descendant point.
+  double MinCoreDistance() const { return minCoreDistance; }
+  //! Modify the minimum core distance of any descendant point.
+  double& MinCoreDistance() { return minCoreDistance; }
+
+  //! Get the maximum core distance of any descendant point.
+  double MaxCoreDistance() const { return maxCoreDistance; }
+  //! Modify the maximum core distance of any descendant point.
+  double& MaxCoreDistance() { return maxCoreDistance; }
+
 }; // class DTBStat
 
 }; // namespace emst
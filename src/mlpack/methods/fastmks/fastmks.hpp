@@ -12,6 +12,7 @@
 #include <mlpack/core/metrics/ip_metric.hpp>
 #include "fastmks_stat.hpp"
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/tree_file.hpp>
 
 namespace mlpack {
 namespace fastmks /** Fast max-kernel search. */ {
@@ -42,6 +43,24 @@ namespace fastmks /** Fast max-kernel search. */ {
  * on points in the dataset (and not centroids of regions or anything like
  * that).
  *
+ * If mlpack is compiled with OpenMP, searches are done in parallel.  The
+ * self-kernels of the points, which the pruning rules use, are computed once
+ * for each FastMKS object and reused by later searches.
+ *
+ * A FastMKS object can also be used as an index for online queries: the
+ * reference tree is built (or loaded from a file written with Save()) once,
+ * and each batch of query points is given to Search(querySet, k, ...).
+ *
+ * @code
+ * FastMKS<LinearKernel> index(referenceSet, true); // Single-tree search.
+ * index.Save("index.bin");
+ *
+ * // Later, possibly in another process.
+ * LinearKernel kernel;
+ * FastMKS<LinearKernel> loaded(std::string("index.bin"), kernel, true);
+ * loaded.Search(queries, 10, indices, products);
+ * @endcode
+ *
  * @tparam KernelType Type of kernel to run FastMKS with.
  * @tparam TreeType Type of tree to run FastMKS with; it must have metric
  *     IPMetric<KernelType>.
@@ -153,6 +172,24 @@ class FastMKS
           const bool single = false,
           const bool naive = false);
 
+  /**
+   * Create the FastMKS object with a reference tree loaded from a file written
+   * with Save().  The reference set is the dataset stored in the file (which is
+   * mapped into memory, and not copied), and it is also used as the query set
+   * for Search(k, ...).  The kernel must be the kernel the tree was built with;
+   * its parameters are not stored in the file.  (Pass the filename as a
+   * std::string; a string literal could also be converted to a matrix.)
+   *
+   * @param filename File to load the reference tree from.
+   * @param kernel Initialized kernel.
+   * @param single Whether or not to run single-tree search.
+   * @param naive Whether or not to run brute-force (naive) search.
+   */
+  FastMKS(const std::string& filename,
+          KernelType& kernel,
+          const bool single = false,
+          const bool naive = false);
+
   //! Destructor for the FastMKS object.
   ~FastMKS();
 
@@ -174,6 +211,36 @@ class FastMKS
               arma::Mat<size_t>& indices,
               arma::mat& products);
 
+  /**
+   * Search for the maximum kernels of the given query points, with the
+   * reference tree which was built or loaded when this object was created, so
+   * that the reference tree is not built again for each batch of queries.  The
+   * query set given to the constructor (if any) is not used.  In dual-tree mode
+   * a tree is built on the given query points for this search.
+   *
+   * @param querySet Set of query points.
+   * @param k The number of maximum kernels to find.
+   * @param indices Matrix to store resulting indices of max-kernel search in.
+   * @param products Matrix to store resulting max-kernel values in.
+   */
+  void Search(const arma::mat& querySet,
+              const size_t k,
+              arma::Mat<size_t>& indices,
+              arma::mat& products);
+
+  /**
+   * Save the reference tree, and the reference set, to a file, so that they
+   * can be loaded by the constructor which takes a file name, instead of
+   * building the tree again.  This is not possible in naive mode, where there
+   * is no tree.
+   *
+   * @param filename File to save the reference tree to.
+   */
+  void Save(const std::string& filename) const;
+
+  //! Get the reference set.
+  const arma::mat& ReferenceSet() const { return referenceSet; }
+
   //! Get the inner-product metric induced by the given kernel.
   const metric::IPMetric<KernelType>& Metric() const { return metric; }
   //! Modify the inner-product metric induced by the given kernel.
@@ -185,6 +252,14 @@ class FastMKS
   std::string ToString() const;
 
  private:
+  //! Naive search evaluates the kernel between blocks of this many query points
+  //! and this many reference points at once.
+  static const size_t BlockSize = 256;
+
+  //! The reference tree and dataset loaded from a file (NULL if they were not
+  //! loaded); this is declared first, since referenceSet may refer to it.
+  tree::LoadedTree<TreeType>* loadedTree;
+
   //! The reference dataset.
   const arma::mat& referenceSet;
   //! The query dataset.
@@ -207,6 +282,36 @@ class FastMKS
   //! The instantiated inner-product metric induced by the given kernel.
   metric::IPMetric<KernelType> metric;
 
+  //! The self-kernels sqrt(K(r, r)) of the reference points (empty until the
+  //! first tree search).
+  arma::vec referenceKernels;
+  //! The self-kernels of the query points, if there is a separate query set
+  //! (empty until the first tree search).
+  arma::vec queryKernels;
+
+  //! Compute the self-kernel sqrt(K(x, x)) of each point in the given dataset.
+  void SelfKernels(const arma::mat& data, arma::vec& kernels);
+
+  //! Reset the bound of each node in the given (query) tree.
+  void ResetBounds(TreeType& node);
+
+  //! Number the nodes of the given tree in their statistics, starting with the
+  //! given index, and return the index after the last node.
+  size_t IndexNodes(TreeType& node, const size_t index);
+
+  //! Build the statistic of each node in the given tree again (after the
+  //! kernel of a loaded tree is set).
+  void BuildStatistics(TreeType& node);
+
+  //! Search with the given query set, query tree (which is NULL for naive and
+  //! single-tree search) and query self-kernels.
+  void Search(const arma::mat& queries,
+              TreeType* queryRoot,
+              const arma::vec& querySelfKernels,
+              const size_t k,
+              arma::Mat<size_t>& indices,
+              arma::mat& products);
+
   //! Utility function.  Copied too many times from too many places.
   void InsertNeighbor(arma::Mat<size_t>& indices,
                       arma::mat& products,
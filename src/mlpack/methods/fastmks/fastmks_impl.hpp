@@ -13,16 +13,57 @@
 #include "fastmks_rules.hpp"
 
 #include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/tree/split_query_tree.hpp>
 #include <queue>
 
 namespace mlpack {
 namespace fastmks {
 
+/**
+ * Evaluate the kernel between each of a block of query points and each of a
+ * block of reference points, so that kernels(j, i) is K(q_i, r_j).  This is the
+ * general version, which evaluates each pair of points in turn.
+ */
+template<typename KernelType>
+void BlockEvaluate(KernelType& kernel,
+                   const arma::mat& queries,
+                   const arma::mat& references,
+                   arma::mat& kernels)
+{
+  kernels.set_size(references.n_cols, queries.n_cols);
+  for (size_t i = 0; i < queries.n_cols; ++i)
+    for (size_t j = 0; j < references.n_cols; ++j)
+      kernels(j, i) = kernel.Evaluate(queries.unsafe_col(i),
+          references.unsafe_col(j));
+}
+
+//! The linear kernel values are the inner products, which are all computed
+//! with one matrix multiplication (which BLAS vectorizes).
+inline void BlockEvaluate(kernel::LinearKernel& /* kernel */,
+                          const arma::mat& queries,
+                          const arma::mat& references,
+                          arma::mat& kernels)
+{
+  kernels = arma::trans(references) * queries;
+}
+
+//! The polynomial kernel is a function of the inner product, so the inner
+//! products are computed with one matrix multiplication.
+inline void BlockEvaluate(kernel::PolynomialKernel& kernel,
+                          const arma::mat& queries,
+                          const arma::mat& references,
+                          arma::mat& kernels)
+{
+  kernels = arma::pow(arma::trans(references) * queries + kernel.Offset(),
+      kernel.Degree());
+}
+
 // Single dataset, no instantiated kernel.
 template<typename KernelType, typename TreeType>
 FastMKS<KernelType, TreeType>::FastMKS(const arma::mat& referenceSet,
                                        const bool single,
                                        const bool naive) :
+    loadedTree(NULL),
     referenceSet(referenceSet),
     querySet(referenceSet),
     referenceTree(NULL),
@@ -48,6 +89,7 @@ FastMKS<KernelType, TreeType>::FastMKS(const arma::mat& referenceSet,
                                        const arma::mat& querySet,
                                        const bool single,
                                        const bool naive) :
+    loadedTree(NULL),
     referenceSet(referenceSet),
     querySet(querySet),
     referenceTree(NULL),
@@ -74,6 +116,7 @@ FastMKS<KernelType, TreeType>::FastMKS(const arma::mat& referenceSet,
                                        KernelType& kernel,
                                        const bool single,
                                        const bool naive) :
+    loadedTree(NULL),
     referenceSet(referenceSet),
     querySet(referenceSet),
     referenceTree(NULL),
@@ -102,6 +145,7 @@ FastMKS<KernelType, TreeType>::FastMKS(const arma::mat& referenceSet,
                                        KernelType& kernel,
                                        const bool single,
                                        const bool naive) :
+    loadedTree(NULL),
     referenceSet(referenceSet),
     querySet(querySet),
     referenceTree(NULL),
@@ -129,6 +173,7 @@ FastMKS<KernelType, TreeType>::FastMKS(const arma::mat& referenceSet,
                                        TreeType* referenceTree,
                                        const bool single,
                                        const bool naive) :
+    loadedTree(NULL),
     referenceSet(referenceSet),
     querySet(referenceSet),
     referenceTree(referenceTree),
@@ -138,9 +183,31 @@ FastMKS<KernelType, TreeType>::FastMKS(const arma::mat& referenceSet,
     naive(naive),
     metric(referenceTree->Metric())
 {
-  // The query tree cannot be the same as the reference tree.
-  if (referenceTree)
-    queryTree = new TreeType(*referenceTree);
+  // The query tree cannot be the same as the reference tree, so a copy of the
+  // reference tree is made for dual-tree search by the first call to
+  // Search(k, ...) (but not for Search(querySet, k, ...)).
+}
+
+// Reference tree loaded from a file.
+template<typename KernelType, typename TreeType>
+FastMKS<KernelType, TreeType>::FastMKS(const std::string& filename,
+                                       KernelType& kernel,
+                                       const bool single,
+                                       const bool naive) :
+    loadedTree(new tree::LoadedTree<TreeType>(filename)),
+    referenceSet(loadedTree->Dataset()),
+    querySet(referenceSet),
+    referenceTree(&loadedTree->Tree()),
+    queryTree(NULL),
+    treeOwner(false),
+    single(single),
+    naive(naive),
+    metric(kernel)
+{
+  // The loaded tree has a default kernel, and the statistics were built with
+  // it, so they are built again with the given kernel.
+  referenceTree->Metric().Kernel() = kernel;
+  BuildStatistics(*referenceTree);
 }
 
 // Two datasets, pre-built trees.
@@ -151,6 +218,7 @@ FastMKS<KernelType, TreeType>::FastMKS(const arma::mat& referenceSet,
                                        TreeType* queryTree,
                                        const bool single,
                                        const bool naive) :
+    loadedTree(NULL),
     referenceSet(referenceSet),
     querySet(querySet),
     referenceTree(referenceTree),
@@ -180,16 +248,80 @@ FastMKS<KernelType, TreeType>::~FastMKS()
     if (queryTree)
       delete queryTree;
   }
+
+  if (loadedTree)
+    delete loadedTree;
 }
 
 template<typename KernelType, typename TreeType>
 void FastMKS<KernelType, TreeType>::Search(const size_t k,
                                            arma::Mat<size_t>& indices,
                                            arma::mat& products)
+{
+  // If the reference tree was given, it has to be copied to be used as the
+  // query tree.
+  if (!naive && !single && (queryTree == NULL))
+    queryTree = new TreeType(*referenceTree);
+
+  // The query self-kernels are only computed for the first search.
+  if (!naive && (&querySet != &referenceSet) &&
+      (queryKernels.n_elem != querySet.n_cols))
+    SelfKernels(querySet, queryKernels);
+
+  Search(querySet, queryTree, (&querySet == &referenceSet) ?
+      referenceKernels : queryKernels, k, indices, products);
+}
+
+template<typename KernelType, typename TreeType>
+void FastMKS<KernelType, TreeType>::Search(const arma::mat& querySet,
+                                           const size_t k,
+                                           arma::Mat<size_t>& indices,
+                                           arma::mat& products)
+{
+  TreeType* batchTree = NULL;
+  arma::vec batchKernels;
+
+  if (!naive)
+  {
+    SelfKernels(querySet, batchKernels);
+
+    if (!single)
+    {
+      // The query tree is built with the same base as the reference tree.
+      Timer::Start("tree_building");
+      batchTree = new TreeType(querySet, metric, referenceTree->Base());
+      Timer::Stop("tree_building");
+    }
+  }
+
+  Search(querySet, batchTree, batchKernels, k, indices, products);
+
+  delete batchTree;
+}
+
+template<typename KernelType, typename TreeType>
+void FastMKS<KernelType, TreeType>::Save(const std::string& filename) const
+{
+  if (naive)
+  {
+    Log::Fatal << "FastMKS::Save(): there is no reference tree to save in "
+        << "naive mode!" << std::endl;
+  }
+
+  tree::SaveTree(filename, *referenceTree);
+}
+
+template<typename KernelType, typename TreeType>
+void FastMKS<KernelType, TreeType>::Search(const arma::mat& queries,
+                                           TreeType* queryRoot,
+                                           const arma::vec& querySelfKernels,
+                                           const size_t k,
+                                           arma::Mat<size_t>& indices,
+                                           arma::mat& products)
 {
   // No remapping will be necessary because we are using the cover tree.
-  indices.set_size(k, querySet.n_cols);
-  products.set_size(k, querySet.n_cols);
+  indices.set_size(k, queries.n_cols);
+  products.set_size(k, queries.n_cols);
   products.fill(-DBL_MAX);
 
   Timer::Start("computing_products");
@@ -197,25 +329,60 @@ void FastMKS<KernelType, TreeType>::Search(const size_t k,
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < querySet.n_cols; ++q)
+    // The kernel is evaluated between blocks of query points and blocks of
+    // reference points at once (with a matrix multiplication, for linear and
+    // polynomial kernels).  Each thread handles its own blocks of query points,
+    // and so its own columns of the results.
+    const size_t blockSize = BlockSize;
+    const size_t numQueryBlocks = (queries.n_cols + blockSize - 1) /
+        blockSize;
+
+    #pragma omp parallel
     {
-      for (size_t r = 0; r < referenceSet.n_cols; ++r)
+      arma::mat kernels;
+
+      #pragma omp for schedule(dynamic, 1)
+      for (size_t b = 0; b < numQueryBlocks; ++b)
       {
-        if ((&querySet == &referenceSet) && (q == r))
-          continue;
+        const size_t queryBegin = b * blockSize;
+        const size_t queryCount = std::min(blockSize,
+            (size_t) queries.n_cols - queryBegin);
+        const arma::mat queryBlock(const_cast<double*>(queries.colptr(
+            queryBegin)), queries.n_rows, queryCount, false, true);
+
+        for (size_t referenceBegin = 0; referenceBegin < referenceSet.n_cols;
+            referenceBegin += blockSize)
+        {
+          const size_t referenceCount = std::min(blockSize,
+              (size_t) referenceSet.n_cols - referenceBegin);
+          const arma::mat references(const_cast<double*>(referenceSet.colptr(
+              referenceBegin)), referenceSet.n_rows, referenceCount, false,
+              true);
 
-        const double eval = metric.Kernel().Evaluate(querySet.unsafe_col(q),
-            referenceSet.unsafe_col(r));
+          BlockEvaluate(metric.Kernel(), queryBlock, references, kernels);
 
-        size_t insertPosition;
-        for (insertPosition = 0; insertPosition < indices.n_rows;
-            ++insertPosition)
-          if (eval > products(insertPosition, q))
-            break;
+          for (size_t i = 0; i < queryCount; ++i)
+          {
+            const size_t q = queryBegin + i;
+            for (size_t j = 0; j < referenceCount; ++j)
+            {
+              const size_t r = referenceBegin + j;
+              if ((&queries == &referenceSet) && (q == r))
+                continue;
 
-        if (insertPosition < indices.n_rows)
-          InsertNeighbor(indices, products, q, insertPosition, r, eval);
+              const double eval = kernels(j, i);
+
+              size_t insertPosition;
+              for (insertPosition = 0; insertPosition < indices.n_rows;
+                  ++insertPosition)
+                if (eval > products(insertPosition, q))
+                  break;
+
+              if (insertPosition < indices.n_rows)
+                InsertNeighbor(indices, products, q, insertPosition, r, eval);
+            }
+          }
+        }
       }
     }
 
@@ -224,47 +391,83 @@ void FastMKS<KernelType, TreeType>::Search(const size_t k,
     return;
   }
 
+  // The reference self-kernels are only computed for the first search.
+  if (referenceKernels.n_elem != referenceSet.n_cols)
+    SelfKernels(referenceSet, referenceKernels);
+
+  typedef FastMKSRules<KernelType, TreeType> RuleType;
+
+  const int numThreads = OmpGetMaxThreads();
+  size_t numPrunes = 0;
+  size_t baseCases = 0;
+  size_t scores = 0;
+
   // Single-tree implementation.
   if (single)
   {
-    // Create rules object (this will store the results).  This constructor
-    // precalculates each self-kernel value.
-    typedef FastMKSRules<KernelType, TreeType> RuleType;
-    RuleType rules(referenceSet, querySet, indices, products, metric.Kernel());
-
-    typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    // The rules of each thread hold their own kernel caches, indexed by the
+    // number of each node, so all of the threads search the one reference tree.
+    const size_t referenceNodes = IndexNodes(*referenceTree, 0);
 
-    // Save the number of pruned nodes.
-    const size_t numPrunes = traverser.NumPrunes();
+    #pragma omp parallel num_threads(numThreads) \
+        reduction(+:numPrunes, baseCases, scores)
+    {
+      RuleType rules(referenceSet, queries, indices, products,
+          metric.Kernel(), referenceKernels, querySelfKernels, referenceNodes);
 
-    Log::Info << "Pruned " << numPrunes << " nodes." << std::endl;
+      typename TreeType::template SingleTreeTraverser<RuleType>
+          traverser(rules);
 
-    Log::Info << rules.BaseCases() << " base cases." << std::endl;
-    Log::Info << rules.Scores() << " scores." << std::endl;
+      #pragma omp for schedule(dynamic, 16)
+      for (size_t i = 0; i < queries.n_cols; ++i)
+        traverser.Traverse(i, *referenceTree);
 
-    Timer::Stop("computing_products");
-    return;
+      numPrunes += traverser.NumPrunes();
+      baseCases += rules.BaseCases();
+      scores += rules.Scores();
+    }
   }
+  else
+  {
+    // Dual-tree implementation.  The bounds in the query tree may be left over
+    // from an earlier search.
+    ResetBounds(*queryRoot);
+
+    // The query tree is split into disjoint subtrees, which are handed out to
+    // the threads; there are a few subtrees for each thread, so that the work
+    // is balanced.
+    std::vector<TreeType*> queryNodes;
+    tree::SplitQueryTree(*queryRoot, (numThreads == 1) ? 1 : 4 * numThreads,
+        queryNodes);
+
+    #pragma omp parallel num_threads(numThreads) \
+        reduction(+:numPrunes, baseCases, scores)
+    {
+      #pragma omp for schedule(dynamic, 1)
+      for (size_t i = 0; i < queryNodes.size(); ++i)
+      {
+        // The rules are created again for each subtree, so that the traversal
+        // information of one subtree is not used for the next one.
+        RuleType rules(referenceSet, queries, indices, products,
+            metric.Kernel(), referenceKernels, querySelfKernels);
 
-  // Dual-tree implementation.
-  typedef FastMKSRules<KernelType, TreeType> RuleType;
-  RuleType rules(referenceSet, querySet, indices, products, metric.Kernel());
-
-  typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
+        typename TreeType::template DualTreeTraverser<RuleType>
+            traverser(rules);
 
-  traverser.Traverse(*queryTree, *referenceTree);
+        traverser.Traverse(*queryNodes[i], *referenceTree);
 
-  const size_t numPrunes = traverser.NumPrunes();
+        numPrunes += traverser.NumPrunes();
+        baseCases += rules.BaseCases();
+        scores += rules.Scores();
+      }
+    }
+  }
 
   Log::Info << "Pruned " << numPrunes << " nodes." << std::endl;
-  Log::Info << rules.BaseCases() << " base cases." << std::endl;
-  Log::Info << rules.Scores() << " scores." << std::endl;
+  Log::Info << baseCases << " base cases." << std::endl;
+  Log::Info << scores << " scores." << std::endl;
 
   Timer::Stop("computing_products");
-  return;
 }
 
 /**
@@ -300,6 +503,49 @@ void FastMKS<KernelType, TreeType>::InsertNeighbor(arma::Mat<size_t>& indices,
   indices(pos, queryIndex) = neighbor;
 }
 
+template<typename KernelType, typename TreeType>
+void FastMKS<KernelType, TreeType>::SelfKernels(const arma::mat& data,
+                                                arma::vec& kernels)
+{
+  kernels.set_size(data.n_cols);
+
+  #pragma omp parallel for
+  for (size_t i = 0; i < data.n_cols; ++i)
+    kernels[i] = sqrt(metric.Kernel().Evaluate(data.unsafe_col(i),
+        data.unsafe_col(i)));
+}
+
+template<typename KernelType, typename TreeType>
+void FastMKS<KernelType, TreeType>::ResetBounds(TreeType& node)
+{
+  node.Stat().Bound() = -DBL_MAX;
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    ResetBounds(node.Child(i));
+}
+
+template<typename KernelType, typename TreeType>
+size_t FastMKS<KernelType, TreeType>::IndexNodes(TreeType& node,
+                                                 const size_t index)
+{
+  node.Stat().Index() = index;
+
+  size_t nextIndex = index + 1;
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    nextIndex = IndexNodes(node.Child(i), nextIndex);
+
+  return nextIndex;
+}
+
+template<typename KernelType, typename TreeType>
+void FastMKS<KernelType, TreeType>::BuildStatistics(TreeType& node)
+{
+  // The statistic of a node may use the statistics of its children.
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    BuildStatistics(node.Child(i));
+
+  node.Stat() = FastMKSStat(node);
+}
+
 // Return string of object.
 template<typename KernelType, typename TreeType>
 std::string FastMKS<KernelType, TreeType>::ToString() const
@@ -37,11 +37,19 @@ PROGRAM_INFO("FastMKS (Fast Max-Kernel Search)",
     "to the kernel evaluation between those two points."
     "\n\n"
     "This executable performs FastMKS using a cover tree.  The base used to "
-    "build the cover tree can be specified with the --base option.");
+    "build the cover tree can be specified with the --base option."
+    "\n\n"
+    "The reference tree can be saved with --reference_tree_out and loaded in a "
+    "later run with --reference_tree_in (instead of --reference_file), so that "
+    "it does not have to be built again for each set of queries.  The kernel "
+    "options must be the same when the tree is loaded as when it was saved."
+    "\n\n"
+    "If mlpack was compiled with OpenMP, the search is done in parallel; the "
+    "number of threads can be set with --threads.");
 
 // Define our input parameters.
-PARAM_STRING_REQ("reference_file", "File containing the reference dataset.",
-    "r");
+PARAM_STRING("reference_file", "File containing the reference dataset.", "r",
+    "");
 PARAM_STRING("query_file", "File containing the query dataset.", "q", "");
 
 PARAM_INT_REQ("k", "Number of maximum inner products to find.", "k");
@@ -68,34 +76,25 @@ PARAM_DOUBLE("bandwidth", "Bandwidth (for Gaussian, Epanechnikov, and "
     "triangular kernels).", "w", 1.0);
 PARAM_DOUBLE("scale", "Scale of kernel (for hyptan kernel).", "s", 1.0);
 
-//! Run FastMKS on a single dataset for the given kernel type.
-template<typename KernelType>
-void RunFastMKS(const arma::mat& referenceData,
-                const bool single,
-                const bool naive,
-                const double base,
-                const size_t k,
-                arma::Mat<size_t>& indices,
-                arma::mat& products,
-                KernelType& kernel)
-{
-  // Create the tree with the specified base.
-  typedef CoverTree<IPMetric<KernelType>, FirstPointIsRoot, FastMKSStat>
-      TreeType;
-  IPMetric<KernelType> metric(kernel);
-  TreeType tree(referenceData, metric, base);
-
-  // Create FastMKS object.
-  FastMKS<KernelType> fastmks(referenceData, &tree, (single && !naive), naive);
+PARAM_STRING("reference_tree_in", "File containing a reference tree saved with "
+    "--reference_tree_out, to use instead of --reference_file.", "T", "");
+PARAM_STRING("reference_tree_out", "File to save the reference tree to.", "O",
+    "");
 
-  // Now search with it.
-  fastmks.Search(k, indices, products);
-}
+PARAM_INT("threads", "Number of threads to use for the search.  If 0, the "
+    "OpenMP default is used (which can be set with the OMP_NUM_THREADS "
+    "environment variable).", "t", 0);
 
-//! Run FastMKS for a given query and reference set using the given kernel type.
+/**
+ * Run FastMKS for the given kernel type.  The reference tree is loaded from
+ * referenceTreeIn if it is given, and built from referenceData otherwise; if
+ * queryData is empty, the reference set is also used as the query set.
+ */
 template<typename KernelType>
 void RunFastMKS(const arma::mat& referenceData,
                 const arma::mat& queryData,
+                const string& referenceTreeIn,
+                const string& referenceTreeOut,
                 const bool single,
                 const bool naive,
                 const double base,
@@ -104,33 +103,67 @@ void RunFastMKS(const arma::mat& referenceData,
                 arma::mat& products,
                 KernelType& kernel)
 {
-  // Create the tree with the specified base.
   typedef CoverTree<IPMetric<KernelType>, FirstPointIsRoot, FastMKSStat>
       TreeType;
+
+  // The metric must outlive the tree, which holds a pointer to it.
   IPMetric<KernelType> metric(kernel);
-  TreeType referenceTree(referenceData, metric, base);
-  TreeType queryTree(queryData, metric, base);
+  TreeType* tree = NULL;
+  FastMKS<KernelType>* fastmks;
 
-  // Create FastMKS object.
-  FastMKS<KernelType> fastmks(referenceData, &referenceTree, queryData,
-      &queryTree, (single && !naive), naive);
+  if (referenceTreeIn != "")
+  {
+    Timer::Start("tree_loading");
+    fastmks = new FastMKS<KernelType>(referenceTreeIn, kernel, single);
+    Timer::Stop("tree_loading");
+
+    Log::Info << "Loaded reference tree from '" << referenceTreeIn << "' ("
+        << fastmks->ReferenceSet().n_rows << " x "
+        << fastmks->ReferenceSet().n_cols << ")." << endl;
+  }
+  else
+  {
+    // Create the tree with the specified base.
+    tree = new TreeType(referenceData, metric, base);
+    fastmks = new FastMKS<KernelType>(referenceData, tree, (single && !naive),
+        naive);
+  }
+
+  if (referenceTreeOut != "")
+    fastmks->Save(referenceTreeOut);
+
+  // Sanity check on k value.
+  if (k > fastmks->ReferenceSet().n_cols)
+  {
+    Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less ";
+    Log::Fatal << "than or equal to the number of reference points (";
+    Log::Fatal << fastmks->ReferenceSet().n_cols << ")." << endl;
+  }
 
   // Now search with it.
-  fastmks.Search(k, indices, products);
+  if (queryData.n_elem == 0)
+    fastmks->Search(k, indices, products);
+  else
+    fastmks->Search(queryData, k, indices, products);
+
+  delete fastmks;
+  delete tree;
 }
 
 int main(int argc, char** argv)
 {
   CLI::ParseCommandLine(argc, argv);
 
-  // Get reference dataset filename.
+  // Get reference dataset and tree filenames.
   const string referenceFile = CLI::GetParam<string>("reference_file");
+  const string referenceTreeIn = CLI::GetParam<string>("reference_tree_in");
+  const string referenceTreeOut = CLI::GetParam<string>("reference_tree_out");
 
   // The number of max kernel values to find.
   const size_t k = CLI::GetParam<int>("k");
 
   // Runtime parameters.
-  const bool naive = CLI::HasParam("naive");
+  bool naive = CLI::HasParam("naive");
   const bool single = CLI::HasParam("single");
 
   // For cover tree construction.
@@ -147,19 +180,63 @@ int main(int argc, char** argv)
   arma::mat referenceData;
   arma::mat queryData;
 
-  data::Load(referenceFile, referenceData, true);
+  if (referenceFile == "" && referenceTreeIn == "")
+  {
+    Log::Fatal << "Either --reference_file or --reference_tree_in must be "
+        << "specified." << endl;
+  }
 
-  Log::Info << "Loaded reference data from '" << referenceFile << "' ("
-      << referenceData.n_rows << " x " << referenceData.n_cols << ")." << endl;
+  if (referenceTreeIn != "")
+  {
+    if (referenceFile != "")
+    {
+      Log::Warn << "--reference_file ignored because --reference_tree_in is "
+          << "present." << endl;
+    }
 
-  // Sanity check on k value.
-  if (k > referenceData.n_cols)
+    // A loaded tree is used as it was built.
+    if (naive)
+    {
+      Log::Warn << "--naive ignored because --reference_tree_in is present."
+          << endl;
+      naive = false;
+    }
+  }
+  else
   {
-    Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less ";
-    Log::Fatal << "than or equal to the number of reference points (";
-    Log::Fatal << referenceData.n_cols << ")." << endl;
+    data::Load(referenceFile, referenceData, true);
+
+    Log::Info << "Loaded reference data from '" << referenceFile << "' ("
+        << referenceData.n_rows << " x " << referenceData.n_cols << ")."
+        << endl;
+  }
+
+  // No tree is built in naive mode.
+  if (naive && referenceTreeOut != "")
+  {
+    Log::Fatal << "--reference_tree_out cannot be used with --naive." << endl;
+  }
+
+  // Sanity check on the number of threads.
+  const int threads = CLI::GetParam<int>("threads");
+  if (threads < 0)
+  {
+    Log::Fatal << "Invalid number of threads: " << threads << ".  Must be "
+        << "greater than or equal to 0." << endl;
+  }
+  else if (threads > 0)
+  {
+    OmpSetNumThreads(threads);
   }
 
+#ifndef HAS_OPENMP
+  if (threads > 1)
+  {
+    Log::Warn << "--threads ignored because mlpack was compiled without "
+        << "OpenMP; only one thread will be used." << endl;
+  }
+#endif
+
   // Check on kernel type.
   if ((kernelType != "linear") && (kernelType != "polynomial") &&
       (kernelType != "cosine") && (kernelType != "gaussian") &&
@@ -196,97 +273,49 @@ int main(int argc, char** argv)
   arma::Mat<size_t> indices;
   arma::mat products;
 
-  // Construct FastMKS object.
-  if (queryData.n_elem == 0)
+  // Construct FastMKS object and search with it.
+  if (kernelType == "linear")
   {
-    if (kernelType == "linear")
-    {
-      LinearKernel lk;
-      RunFastMKS<LinearKernel>(referenceData, single, naive, base, k, indices,
-          products, lk);
-    }
-    else if (kernelType == "polynomial")
-    {
-
-      PolynomialKernel pk(degree, offset);
-      RunFastMKS<PolynomialKernel>(referenceData, single, naive, base, k,
-          indices, products, pk);
-    }
-    else if (kernelType == "cosine")
-    {
-      CosineDistance cd;
-      RunFastMKS<CosineDistance>(referenceData, single, naive, base, k, indices,
-          products, cd);
-    }
-    else if (kernelType == "gaussian")
-    {
-      GaussianKernel gk(bandwidth);
-      RunFastMKS<GaussianKernel>(referenceData, single, naive, base, k, indices,
-          products, gk);
-    }
-    else if (kernelType == "epanechnikov")
-    {
-      EpanechnikovKernel ek(bandwidth);
-      RunFastMKS<EpanechnikovKernel>(referenceData, single, naive, base, k,
-          indices, products, ek);
-    }
-    else if (kernelType == "triangular")
-    {
-      TriangularKernel tk(bandwidth);
-      RunFastMKS<TriangularKernel>(referenceData, single, naive, base, k,
-          indices, products, tk);
-    }
-    else if (kernelType == "hyptan")
-    {
-      HyperbolicTangentKernel htk(scale, offset);
-      RunFastMKS<HyperbolicTangentKernel>(referenceData, single, naive, base, k,
-          indices, products, htk);
-    }
+    LinearKernel lk;
+    RunFastMKS<LinearKernel>(referenceData, queryData, referenceTreeIn,
+        referenceTreeOut, single, naive, base, k, indices, products, lk);
   }
-  else
+  else if (kernelType == "polynomial")
   {
-    if (kernelType == "linear")
-    {
-      LinearKernel lk;
-      RunFastMKS<LinearKernel>(referenceData, queryData, single, naive, base, k,
-          indices, products, lk);
-    }
-    else if (kernelType == "polynomial")
-    {
-      PolynomialKernel pk(degree, offset);
-      RunFastMKS<PolynomialKernel>(referenceData, queryData, single, naive,
-          base, k, indices, products, pk);
-    }
-    else if (kernelType == "cosine")
-    {
-      CosineDistance cd;
-      RunFastMKS<CosineDistance>(referenceData, queryData, single, naive, base,
-          k, indices, products, cd);
-    }
-    else if (kernelType == "gaussian")
-    {
-      GaussianKernel gk(bandwidth);
-      RunFastMKS<GaussianKernel>(referenceData, queryData, single, naive, base,
-          k, indices, products, gk);
-    }
-    else if (kernelType == "epanechnikov")
-    {
-      EpanechnikovKernel ek(bandwidth);
-      RunFastMKS<EpanechnikovKernel>(referenceData, queryData, single, naive,
-          base, k, indices, products, ek);
-    }
-    else if (kernelType == "triangular")
-    {
-      TriangularKernel tk(bandwidth);
-      RunFastMKS<TriangularKernel>(referenceData, queryData, single, naive,
-          base, k, indices, products, tk);
-    }
-    else if (kernelType == "hyptan")
-    {
-      HyperbolicTangentKernel htk(scale, offset);
-      RunFastMKS<HyperbolicTangentKernel>(referenceData, queryData, single,
-          naive, base, k, indices, products, htk);
-    }
+    PolynomialKernel pk(degree, offset);
+    RunFastMKS<PolynomialKernel>(referenceData, queryData, referenceTreeIn,
+        referenceTreeOut, single, naive, base, k, indices, products, pk);
+  }
+  else if (kernelType == "cosine")
+  {
+    CosineDistance cd;
+    RunFastMKS<CosineDistance>(referenceData, queryData, referenceTreeIn,
+        referenceTreeOut, single, naive, base, k, indices, products, cd);
+  }
+  else if (kernelType == "gaussian")
+  {
+    GaussianKernel gk(bandwidth);
+    RunFastMKS<GaussianKernel>(referenceData, queryData, referenceTreeIn,
+        referenceTreeOut, single, naive, base, k, indices, products, gk);
+  }
+  else if (kernelType == "epanechnikov")
+  {
+    EpanechnikovKernel ek(bandwidth);
+    RunFastMKS<EpanechnikovKernel>(referenceData, queryData, referenceTreeIn,
+        referenceTreeOut, single, naive, base, k, indices, products, ek);
+  }
+  else if (kernelType == "triangular")
+  {
+    TriangularKernel tk(bandwidth);
+    RunFastMKS<TriangularKernel>(referenceData, queryData, referenceTreeIn,
+        referenceTreeOut, single, naive, base, k, indices, products, tk);
+  }
+  else if (kernelType == "hyptan")
+  {
+    HyperbolicTangentKernel htk(scale, offset);
+    RunFastMKS<HyperbolicTangentKernel>(referenceData, queryData,
+        referenceTreeIn, referenceTreeOut, single, naive, base, k, indices,
+        products, htk);
   }
 
   // Save output, if we were asked to.
@@ -22,11 +22,30 @@ template<typename KernelType, typename TreeType>
 class FastMKSRules
 {
  public:
+  /**
+   * Construct the rules.  The self-kernels sqrt(K(x, x)) of the points are
+   * given, rather than computed here, so that they are computed only once for
+   * many searches (or many threads).
+   *
+   * @param referenceSet Set of reference points.
+   * @param querySet Set of query points.
+   * @param indices Matrix to store the indices of the results in.
+   * @param products Matrix to store the kernel values of the results in.
+   * @param kernel Kernel to search with.
+   * @param referenceKernels Self-kernels of the reference points.
+   * @param queryKernels Self-kernels of the query points.
+   * @param referenceNodes Number of nodes in the reference tree, which must be
+   *     numbered by their statistics (FastMKSStat::Index()), for single-tree
+   *     search.
+   */
   FastMKSRules(const arma::mat& referenceSet,
                const arma::mat& querySet,
                arma::Mat<size_t>& indices,
                arma::mat& products,
-               KernelType& kernel);
+               KernelType& kernel,
+               const arma::vec& referenceKernels,
+               const arma::vec& queryKernels,
+               const size_t referenceNodes = 0);
 
   //! Compute the base case (kernel value) between two points.
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
@@ -108,9 +127,9 @@ class FastMKSRules
   arma::mat& products;
 
   //! Cached query set self-kernels (|| q || for each q).
-  arma::vec queryKernels;
+  const arma::vec& queryKernels;
   //! Cached reference set self-kernels (|| r || for each r).
-  arma::vec referenceKernels;
+  const arma::vec& referenceKernels;
 
   //! The instantiated kernel.
   KernelType& kernel;
@@ -122,6 +141,15 @@ class FastMKSRules
   //! The last kernel evaluation resulting from BaseCase().
   double lastKernel;
 
+  //! The last kernel evaluation of a query point with each reference node
+  //! during single-tree search, for parent-child prunes, indexed by
+  //! FastMKSStat::Index().  These are held by the rules and not by the nodes,
+  //! so the reference tree is only read and several threads can search it at
+  //! once.
+  std::vector<double> nodeKernels;
+  //! The query point each of the kernels in nodeKernels belongs to.
+  std::vector<size_t> nodeKernelQueries;
+
   //! Calculate the bound for a given query node.
   double CalculateBound(TreeType& queryNode) const;
 
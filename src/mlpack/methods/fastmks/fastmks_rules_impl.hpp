@@ -14,33 +14,30 @@ namespace mlpack {
 namespace fastmks {
 
 template<typename KernelType, typename TreeType>
-FastMKSRules<KernelType, TreeType>::FastMKSRules(const arma::mat& referenceSet,
-                                                 const arma::mat& querySet,
-                                                 arma::Mat<size_t>& indices,
-                                                 arma::mat& products,
-                                                 KernelType& kernel) :
+FastMKSRules<KernelType, TreeType>::FastMKSRules(
+    const arma::mat& referenceSet,
+    const arma::mat& querySet,
+    arma::Mat<size_t>& indices,
+    arma::mat& products,
+    KernelType& kernel,
+    const arma::vec& referenceKernels,
+    const arma::vec& queryKernels,
+    const size_t referenceNodes) :
     referenceSet(referenceSet),
     querySet(querySet),
     indices(indices),
     products(products),
+    queryKernels(queryKernels),
+    referenceKernels(referenceKernels),
     kernel(kernel),
     lastQueryIndex(-1),
     lastReferenceIndex(-1),
     lastKernel(0.0),
+    nodeKernels(referenceNodes),
+    nodeKernelQueries(referenceNodes, size_t(-1)),
     baseCases(0),
     scores(0)
 {
-  // Precompute each self-kernel.
-  queryKernels.set_size(querySet.n_cols);
-  for (size_t i = 0; i < querySet.n_cols; ++i)
-    queryKernels[i] = sqrt(kernel.Evaluate(querySet.unsafe_col(i),
-                                           querySet.unsafe_col(i)));
-
-  referenceKernels.set_size(referenceSet.n_cols);
-  for (size_t i = 0; i < referenceSet.n_cols; ++i)
-    referenceKernels[i] = sqrt(kernel.Evaluate(referenceSet.unsafe_col(i),
-                                               referenceSet.unsafe_col(i)));
-
   // Set to invalid memory, so that the first node combination does not try to
   // dereference null pointers.
   traversalInfo.LastQueryNode() = (TreeType*) this;
@@ -103,14 +100,23 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
   // Compare with the current best.
   const double bestKernel = products(products.n_rows - 1, queryIndex);
 
+  // The kernel of the query point with the parent is only known if the parent
+  // has been scored with this query point (it has not if it is the root of a
+  // binary space tree).
+  const bool parentScored = (referenceNode.Parent() != NULL) &&
+      (nodeKernelQueries[referenceNode.Parent()->Stat().Index()] ==
+      queryIndex);
+  const double parentKernel = parentScored ?
+      nodeKernels[referenceNode.Parent()->Stat().Index()] : 0.0;
+
   // See if we can perform a parent-child prune.
   const double furthestDist = referenceNode.FurthestDescendantDistance();
-  if (referenceNode.Parent() != NULL)
+  if (parentScored)
   {
     double maxKernelBound;
     const double parentDist = referenceNode.ParentDistance();
     const double combinedDistBound = parentDist + furthestDist;
-    const double lastKernel = referenceNode.Parent()->Stat().LastKernel();
+    const double lastKernel = parentKernel;
     if (kernel::KernelTraits<KernelType>::IsNormalized)
     {
       const double squaredDist = std::pow(combinedDistBound, 2.0);
@@ -144,10 +150,10 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
   {
     // Could it be that this kernel evaluation has already been calculated?
     if (tree::TreeTraits<TreeType>::HasSelfChildren &&
-        referenceNode.Parent() != NULL &&
+        parentScored &&
         referenceNode.Point(0) == referenceNode.Parent()->Point(0))
     {
-      kernelEval = referenceNode.Parent()->Stat().LastKernel();
+      kernelEval = parentKernel;
     }
     else
     {
@@ -163,7 +169,8 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
     kernelEval = kernel.Evaluate(queryPoint, refCentroid);
   }
 
-  referenceNode.Stat().LastKernel() = kernelEval;
+  nodeKernels[referenceNode.Stat().Index()] = kernelEval;
+  nodeKernelQueries[referenceNode.Stat().Index()] = queryIndex;
 
   double maxKernel;
   if (kernel::KernelTraits<KernelType>::IsNormalized)
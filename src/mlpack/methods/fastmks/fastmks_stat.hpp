@@ -27,7 +27,8 @@ class FastMKSStat
       bound(-DBL_MAX),
       selfKernel(0.0),
       lastKernel(0.0),
-      lastKernelNode(NULL)
+      lastKernelNode(NULL),
+      index(0)
   { }
 
   /**
@@ -41,7 +42,8 @@ class FastMKSStat
   FastMKSStat(const TreeType& node) :
       bound(-DBL_MAX),
       lastKernel(0.0),
-      lastKernelNode(NULL)
+      lastKernelNode(NULL),
+      index(0)
   {
     // Do we have to calculate the centroid?
     if (tree::TreeTraits<TreeType>::FirstPointIsCentroid)
@@ -93,6 +95,11 @@ class FastMKSStat
   //! evaluation.
   void*& LastKernelNode() { return lastKernelNode; }
 
+  //! Get the index of the node in its tree (see FastMKSRules).
+  size_t Index() const { return index; }
+  //! Modify the index of the node in its tree.
+  size_t& Index() { return index; }
+
  private:
   //! The bound for pruning.
   double bound;
@@ -106,6 +113,10 @@ class FastMKSStat
   //! The node corresponding to the last kernel evaluation.  This has to be void
   //! otherwise we get recursive template arguments.
   void* lastKernelNode;
+
+  //! The index of the node in its tree, so that per-node values of a search can
+  //! be held in arrays outside of the tree.
+  size_t index;
 };
 
 }; // namespace fastmks
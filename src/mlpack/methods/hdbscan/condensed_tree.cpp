@@ -0,0 +1,204 @@
+/**
+ * @file condensed_tree.cpp
+ *
+ * Implementation of the condensed cluster tree used by HDBSCAN.
+ */
+#include "condensed_tree.hpp"
+
+using namespace mlpack;
+using namespace mlpack::hdbscan;
+
+CondensedTree::CondensedTree(const arma::mat& dendrogram,
+                             const size_t minClusterSize) :
+    numPoints(dendrogram.n_cols + 1)
+{
+  if (minClusterSize < 2)
+    Log::Fatal << "CondensedTree::CondensedTree(): minimum cluster size must "
+        << "be at least 2!" << std::endl;
+
+  pointCluster.set_size(numPoints);
+
+  // The root cluster contains everything.
+  clusterParent.push_back(0);
+  birthLambda.push_back(0.0);
+
+  if (numPoints == 1)
+  {
+    pointCluster[0] = 0;
+    stability.zeros(1);
+    return;
+  }
+
+  // Cluster (relative to numPoints) that each internal dendrogram node belongs
+  // to.  The root of the dendrogram is the last merge.
+  arma::Col<size_t> nodeCluster(dendrogram.n_cols);
+  nodeCluster[dendrogram.n_cols - 1] = 0;
+
+  // Walk the dendrogram from the root downwards, without recursion, since the
+  // dendrogram may be as deep as the number of points.  A second stack is used
+  // to collect the points under a node that falls out of its cluster.
+  std::vector<size_t> nodeStack;
+  std::vector<size_t> fallStack;
+  nodeStack.push_back(numPoints + dendrogram.n_cols - 1);
+
+  while (!nodeStack.empty())
+  {
+    const size_t node = nodeStack.back() - numPoints;
+    nodeStack.pop_back();
+
+    const size_t cluster = nodeCluster[node];
+    const double distance = dendrogram(2, node);
+    const double lambda = (distance > 0.0) ? (1.0 / distance) : DBL_MAX;
+
+    const size_t left = (size_t) dendrogram(0, node);
+    const size_t right = (size_t) dendrogram(1, node);
+    const size_t leftSize = (left < numPoints) ? 1 :
+        (size_t) dendrogram(3, left - numPoints);
+    const size_t rightSize = (right < numPoints) ? 1 :
+        (size_t) dendrogram(3, right - numPoints);
+
+    const bool leftIsCluster = (leftSize >= minClusterSize);
+    const bool rightIsCluster = (rightSize >= minClusterSize);
+
+    if (leftIsCluster && rightIsCluster)
+    {
+      // A true split: both children become new clusters.
+      nodeCluster[left - numPoints] = clusterParent.size();
+      clusterParent.push_back(cluster);
+      birthLambda.push_back(lambda);
+      AddEdge(cluster, numPoints + nodeCluster[left - numPoints], lambda,
+          leftSize);
+
+      nodeCluster[right - numPoints] = clusterParent.size();
+      clusterParent.push_back(cluster);
+      birthLambda.push_back(lambda);
+      AddEdge(cluster, numPoints + nodeCluster[right - numPoints], lambda,
+          rightSize);
+
+      nodeStack.push_back(right);
+      nodeStack.push_back(left);
+      continue;
+    }
+
+    // Otherwise, the cluster continues down the larger side (if it is large
+    // enough), and everything else falls out of the cluster at this lambda.
+    if (leftIsCluster)
+    {
+      nodeCluster[left - numPoints] = cluster;
+      nodeStack.push_back(left);
+    }
+    else
+    {
+      fallStack.push_back(left);
+    }
+
+    if (rightIsCluster)
+    {
+      nodeCluster[right - numPoints] = cluster;
+      nodeStack.push_back(right);
+    }
+    else
+    {
+      fallStack.push_back(right);
+    }
+
+    while (!fallStack.empty())
+    {
+      const size_t fallNode = fallStack.back();
+      fallStack.pop_back();
+
+      if (fallNode < numPoints)
+      {
+        pointCluster[fallNode] = cluster;
+        AddEdge(cluster, fallNode, lambda, 1);
+      }
+      else
+      {
+        fallStack.push_back((size_t) dendrogram(0, fallNode - numPoints));
+        fallStack.push_back((size_t) dendrogram(1, fallNode - numPoints));
+      }
+    }
+  }
+
+  // Now compute the stability of each cluster: the sum, over each point in the
+  // cluster, of the difference between the lambda where the point leaves the
+  // cluster and the lambda where the cluster is born.
+  stability.zeros(clusterParent.size());
+  for (size_t i = 0; i < parents.size(); ++i)
+  {
+    const size_t cluster = parents[i] - numPoints;
+    stability[cluster] += (lambdas[i] - birthLambda[cluster]) * childSizes[i];
+  }
+}
+
+size_t CondensedTree::ExtractClusters(arma::Col<size_t>& assignments,
+                                      const bool allowSingleCluster) const
+{
+  const size_t numClusters = clusterParent.size();
+
+  // Children always have larger indices than their parents, so a reverse pass
+  // visits every cluster after all of its descendants.
+  std::vector<bool> selected(numClusters, false);
+  arma::vec childStability(numClusters);
+  childStability.zeros();
+  for (size_t c = numClusters - 1; c > 0; --c)
+  {
+    if (stability[c] >= childStability[c])
+    {
+      selected[c] = true;
+      childStability[clusterParent[c]] += stability[c];
+    }
+    else
+    {
+      childStability[clusterParent[c]] += childStability[c];
+    }
+  }
+
+  if (allowSingleCluster && (stability[0] >= childStability[0]))
+    selected[0] = true;
+
+  // A forward pass assigns labels: a selected cluster gets a new label (and
+  // all of its descendants are deselected and share that label), and anything
+  // else inherits the label of its parent.
+  const size_t noise = size_t() - 1;
+  std::vector<size_t> labels(numClusters, noise);
+  size_t numSelected = 0;
+  if (selected[0])
+    labels[0] = numSelected++;
+  for (size_t c = 1; c < numClusters; ++c)
+  {
+    if (labels[clusterParent[c]] != noise)
+      labels[c] = labels[clusterParent[c]];
+    else if (selected[c])
+      labels[c] = numSelected++;
+  }
+
+  assignments.set_size(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    assignments[i] = labels[pointCluster[i]];
+
+  return numSelected;
+}
+
+void CondensedTree::Matrix(arma::mat& tree) const
+{
+  tree.set_size(4, parents.size());
+  for (size_t i = 0; i < parents.size(); ++i)
+  {
+    tree(0, i) = parents[i];
+    tree(1, i) = children[i];
+    tree(2, i) = lambdas[i];
+    tree(3, i) = childSizes[i];
+  }
+}
+
+void CondensedTree::AddEdge(const size_t parent,
+                            const size_t child,
+                            const double lambda,
+                            const size_t childSize)
+{
+  parents.push_back(numPoints + parent);
+  children.push_back(child);
+  lambdas.push_back(lambda);
+  childSizes.push_back(childSize);
+}
@@ -0,0 +1,125 @@
+/**
+ * @file condensed_tree.hpp
+ *
+ * The condensed cluster tree used by HDBSCAN, which simplifies a
+ * single-linkage dendrogram by discarding splits that shed fewer than a minimum
+ * number of points, and then selects a flat clustering by maximizing cluster
+ * stability.
+ */
+#ifndef __MLPACK_METHODS_HDBSCAN_CONDENSED_TREE_HPP
+#define __MLPACK_METHODS_HDBSCAN_CONDENSED_TREE_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace hdbscan {
+
+/**
+ * A condensed cluster tree, as described in the following paper:
+ *
+ * @code
+ * @inproceedings{campello2013density,
+ *   title={Density-based clustering based on hierarchical density estimates},
+ *   author={Campello, R.J.G.B. and Moulavi, D. and Sander, J.},
+ *   booktitle={Advances in Knowledge Discovery and Data Mining (PAKDD 2013)},
+ *   pages={160--172},
+ *   year={2013}
+ * }
+ * @endcode
+ *
+ * The tree is built from a single-linkage dendrogram (see SingleLinkage()).
+ * Walking down the dendrogram, a split only creates two new clusters if both
+ * sides hold at least minClusterSize points; otherwise, the points on the
+ * smaller side are considered to have "fallen out" of the parent cluster, which
+ * continues on.  Each split happens at a density level lambda = 1 / distance.
+ *
+ * Clusters are numbered starting at the number of points N (the root cluster
+ * is N), so that point indices and cluster indices can be told apart.  The
+ * tree is stored as a list of edges (parent cluster, child cluster or point,
+ * lambda, child size), in the order they were found.  Construction is done
+ * iteratively and takes O(N) time and memory, so it is suitable for very large
+ * datasets.
+ */
+class CondensedTree
+{
+ public:
+  /**
+   * Build the condensed tree from the given single-linkage dendrogram.
+   *
+   * @param dendrogram Single-linkage dendrogram, as produced by
+   *      SingleLinkage().
+   * @param minClusterSize Minimum number of points in a cluster (at least 2).
+   */
+  CondensedTree(const arma::mat& dendrogram, const size_t minClusterSize);
+
+  /**
+   * Select a flat clustering from the condensed tree using the "excess of
+   * mass" criterion: a cluster is selected if its stability is at least the
+   * total stability of its selected descendants.  Points that do not belong to
+   * any selected cluster are labeled as noise, with the label SIZE_MAX.
+   * Selected clusters are labeled 0 to (NumClusters() - 1).
+   *
+   * @param assignments Vector to store cluster labels in.
+   * @param allowSingleCluster If true, the root cluster may be selected (in
+   *      which case every point will belong to one cluster).
+   * @return The number of clusters that were selected.
+   */
+  size_t ExtractClusters(arma::Col<size_t>& assignments,
+                         const bool allowSingleCluster = false) const;
+
+  //! Get the number of points in the tree.
+  size_t NumPoints() const { return numPoints; }
+  //! Get the number of clusters in the tree (including the root cluster).
+  size_t NumClusters() const { return birthLambda.size(); }
+
+  //! Get the parent clusters of each edge in the tree.
+  const std::vector<size_t>& Parents() const { return parents; }
+  //! Get the children (clusters or points) of each edge in the tree.
+  const std::vector<size_t>& Children() const { return children; }
+  //! Get the lambda value of each edge in the tree.
+  const std::vector<double>& Lambdas() const { return lambdas; }
+  //! Get the number of points in the child of each edge in the tree.
+  const std::vector<size_t>& ChildSizes() const { return childSizes; }
+
+  //! Get the stability of each cluster (indexed from zero, not from N).
+  const arma::vec& Stability() const { return stability; }
+
+  /**
+   * Store the condensed tree in a 4xM matrix, where each column is an edge:
+   * the parent cluster, the child, the lambda value, and the child size.
+   */
+  void Matrix(arma::mat& tree) const;
+
+ private:
+  //! The number of points in the tree.
+  size_t numPoints;
+
+  //! The parent cluster of each edge.
+  std::vector<size_t> parents;
+  //! The child cluster or point of each edge.
+  std::vector<size_t> children;
+  //! The lambda value at which each edge splits off.
+  std::vector<double> lambdas;
+  //! The number of points under the child of each edge.
+  std::vector<size_t> childSizes;
+
+  //! The parent of each cluster (the root's parent is itself).
+  std::vector<size_t> clusterParent;
+  //! The lambda value at which each cluster is created.
+  std::vector<double> birthLambda;
+  //! The stability of each cluster.
+  arma::vec stability;
+  //! The cluster from which each point falls out.
+  arma::Col<size_t> pointCluster;
+
+  //! Add an edge to the condensed tree.
+  void AddEdge(const size_t parent,
+               const size_t child,
+               const double lambda,
+               const size_t childSize);
+};
+
+}; // namespace hdbscan
+}; // namespace mlpack
+
+#endif
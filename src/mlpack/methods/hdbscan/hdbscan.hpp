@@ -0,0 +1,183 @@
+/**
+ * @file hdbscan.hpp
+ *
+ * Defines the HDBSCAN class, which performs hierarchical density-based
+ * clustering using the dual-tree Boruvka algorithm to find the minimum spanning
+ * tree under mutual reachability distance.
+ */
+#ifndef __MLPACK_METHODS_HDBSCAN_HDBSCAN_HPP
+#define __MLPACK_METHODS_HDBSCAN_HDBSCAN_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+#include "single_linkage.hpp"
+#include "condensed_tree.hpp"
+
+namespace mlpack {
+namespace hdbscan /** Hierarchical density-based clustering. */ {
+
+/**
+ * An implementation of HDBSCAN*, described in the following paper:
+ *
+ * @code
+ * @inproceedings{campello2013density,
+ *   title={Density-based clustering based on hierarchical density estimates},
+ *   author={Campello, R.J.G.B. and Moulavi, D. and Sander, J.},
+ *   booktitle={Advances in Knowledge Discovery and Data Mining (PAKDD 2013)},
+ *   pages={160--172},
+ *   year={2013}
+ * }
+ * @endcode
+ *
+ * The clustering is done in four steps:
+ *
+ *  - The core distance of each point (the distance to its minPoints'th nearest
+ *    neighbor, counting the point itself) is found with dual-tree all-k-nearest
+ *    neighbor search (NeighborSearch).
+ *  - The minimum spanning tree under mutual reachability distance,
+ *    max(d(a, b), core(a), core(b)), is found with the dual-tree Boruvka
+ *    algorithm (emst::DualTreeBoruvka).
+ *  - The spanning tree is turned into a single-linkage dendrogram
+ *    (SingleLinkage()).
+ *  - The dendrogram is condensed, and the most stable clusters are extracted
+ *    (CondensedTree).
+ *
+ * Apart from the tree-based searches, everything takes O(N log N) time and O(N)
+ * memory.  If minPoints is 1, the core distances are all zero and this reduces
+ * to single-linkage clustering on the Euclidean minimum spanning tree.
+ *
+ * @code
+ * extern arma::mat data; // Dataset we want to cluster.
+ * HDBSCAN<> h(10); // Clusters must have at least 10 points.
+ *
+ * arma::Col<size_t> assignments;
+ * const size_t clusters = h.Cluster(data, assignments);
+ * @endcode
+ *
+ * @tparam MetricType The metric to use; this must satisfy the triangle
+ *     inequality.
+ */
+template<typename MetricType = metric::EuclideanDistance>
+class HDBSCAN
+{
+ public:
+  /**
+   * Create the HDBSCAN object with the given parameters.
+   *
+   * @param minClusterSize Minimum number of points in a cluster (at least 2).
+   * @param minPoints Number of neighbors (counting the point itself) used to
+   *      calculate the core distance of each point.
+   * @param naive If true, O(n^2) naive computation is used.
+   * @param leafSize Leaf size for the kd-trees that are built.
+   * @param allowSingleCluster If true, a single cluster containing all the
+   *      points may be returned.
+   * @param metric Instantiated metric.
+   */
+  HDBSCAN(const size_t minClusterSize = 5,
+          const size_t minPoints = 5,
+          const bool naive = false,
+          const size_t leafSize = 1,
+          const bool allowSingleCluster = false,
+          const MetricType metric = MetricType());
+
+  /**
+   * Cluster the given dataset.  Each point is assigned a label between 0 and
+   * (number of clusters - 1); noise points are given the label SIZE_MAX (that
+   * is, size_t() - 1).
+   *
+   * @param data Dataset to cluster.
+   * @param assignments Vector to store cluster labels in.
+   * @return The number of clusters found.
+   */
+  size_t Cluster(const arma::mat& data, arma::Col<size_t>& assignments);
+
+  /**
+   * Cluster the given dataset, and also return the single-linkage dendrogram
+   * under mutual reachability distance (see SingleLinkage() for the format).
+   *
+   * @param data Dataset to cluster.
+   * @param assignments Vector to store cluster labels in.
+   * @param dendrogram Matrix to store the dendrogram in.
+   * @return The number of clusters found.
+   */
+  size_t Cluster(const arma::mat& data,
+                 arma::Col<size_t>& assignments,
+                 arma::mat& dendrogram);
+
+  /**
+   * Compute the core distance of each point in the dataset: the distance to
+   * its minPoints'th nearest neighbor, counting the point itself.
+   *
+   * @param data Dataset to compute core distances of.
+   * @param coreDistances Vector to store core distances in.
+   */
+  void CoreDistances(const arma::mat& data, arma::vec& coreDistances);
+
+  /**
+   * Compute the minimum spanning tree of the dataset under mutual reachability
+   * distance, in the format returned by DualTreeBoruvka::ComputeMST().
+   *
+   * @param data Dataset to compute the minimum spanning tree of.
+   * @param coreDistances Core distance of each point.
+   * @param mst Matrix to store the spanning tree edges in.
+   */
+  void MutualReachabilityMST(const arma::mat& data,
+                             const arma::vec& coreDistances,
+                             arma::mat& mst);
+
+  //! Get the minimum cluster size.
+  size_t MinClusterSize() const { return minClusterSize; }
+  //! Modify the minimum cluster size.
+  size_t& MinClusterSize() { return minClusterSize; }
+
+  //! Get the number of points used to calculate core distances.
+  size_t MinPoints() const { return minPoints; }
+  //! Modify the number of points used to calculate core distances.
+  size_t& MinPoints() { return minPoints; }
+
+  //! Get whether naive computation is used.
+  bool Naive() const { return naive; }
+  //! Modify whether naive computation is used.
+  bool& Naive() { return naive; }
+
+  //! Get the leaf size for tree building.
+  size_t LeafSize() const { return leafSize; }
+  //! Modify the leaf size for tree building.
+  size_t& LeafSize() { return leafSize; }
+
+  //! Get whether a single cluster may be returned.
+  bool AllowSingleCluster() const { return allowSingleCluster; }
+  //! Modify whether a single cluster may be returned.
+  bool& AllowSingleCluster() { return allowSingleCluster; }
+
+  //! Get the instantiated metric.
+  const MetricType& Metric() const { return metric; }
+  //! Modify the instantiated metric.
+  MetricType& Metric() { return metric; }
+
+  //! Returns a string representation of this object.
+  std::string ToString() const;
+
+ private:
+  //! Minimum number of points in a cluster.
+  size_t minClusterSize;
+  //! Number of points used to calculate core distances.
+  size_t minPoints;
+  //! Whether or not naive computation is used.
+  bool naive;
+  //! Leaf size for tree building.
+  size_t leafSize;
+  //! Whether or not a single cluster may be returned.
+  bool allowSingleCluster;
+  //! Instantiated metric.
+  MetricType metric;
+};
+
+}; // namespace hdbscan
+}; // namespace mlpack
+
+// Include implementation.
+#include "hdbscan_impl.hpp"
+
+#endif
@@ -0,0 +1,190 @@
+/**
+ * @file hdbscan_impl.hpp
+ *
+ * Implementation of the HDBSCAN class.
+ */
+#ifndef __MLPACK_METHODS_HDBSCAN_HDBSCAN_IMPL_HPP
+#define __MLPACK_METHODS_HDBSCAN_HDBSCAN_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "hdbscan.hpp"
+
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/emst/dtb.hpp>
+
+namespace mlpack {
+namespace hdbscan {
+
+template<typename MetricType>
+HDBSCAN<MetricType>::HDBSCAN(const size_t minClusterSize,
+                             const size_t minPoints,
+                             const bool naive,
+                             const size_t leafSize,
+                             const bool allowSingleCluster,
+                             const MetricType metric) :
+    minClusterSize(minClusterSize),
+    minPoints(minPoints),
+    naive(naive),
+    leafSize(leafSize),
+    allowSingleCluster(allowSingleCluster),
+    metric(metric)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType>
+size_t HDBSCAN<MetricType>::Cluster(const arma::mat& data,
+                                    arma::Col<size_t>& assignments)
+{
+  arma::mat dendrogram;
+  return Cluster(data, assignments, dendrogram);
+}
+
+template<typename MetricType>
+size_t HDBSCAN<MetricType>::Cluster(const arma::mat& data,
+                                    arma::Col<size_t>& assignments,
+                                    arma::mat& dendrogram)
+{
+  if (data.n_cols < 2)
+    Log::Fatal << "HDBSCAN::Cluster(): dataset must have at least two points!"
+        << std::endl;
+
+  arma::vec coreDistances;
+  CoreDistances(data, coreDistances);
+
+  arma::mat mst;
+  MutualReachabilityMST(data, coreDistances, mst);
+  coreDistances.reset();
+
+  Timer::Start("hdbscan/condensed_tree");
+
+  SingleLinkage(mst, dendrogram);
+  mst.reset();
+
+  CondensedTree tree(dendrogram, minClusterSize);
+  const size_t clusters = tree.ExtractClusters(assignments,
+      allowSingleCluster);
+
+  Timer::Stop("hdbscan/condensed_tree");
+
+  Log::Info << clusters << " clusters found." << std::endl;
+
+  return clusters;
+}
+
+template<typename MetricType>
+void HDBSCAN<MetricType>::CoreDistances(const arma::mat& data,
+                                        arma::vec& coreDistances)
+{
+  // The point itself is its first neighbor, so when minPoints is 1 there is
+  // nothing to do.
+  if (minPoints <= 1)
+  {
+    coreDistances.zeros(data.n_cols);
+    return;
+  }
+
+  const size_t k = minPoints - 1;
+  if (k >= data.n_cols)
+    Log::Fatal << "HDBSCAN::CoreDistances(): minPoints (" << minPoints << ") "
+        << "must be no greater than the number of points (" << data.n_cols
+        << ")!" << std::endl;
+
+  Timer::Start("hdbscan/core_distances");
+
+  typedef tree::BinarySpaceTree<bound::HRectBound<2>,
+      neighbor::NeighborSearchStat<neighbor::NearestNeighborSort> > TreeType;
+  typedef neighbor::NeighborSearch<neighbor::NearestNeighborSort, MetricType,
+      TreeType> KNNType;
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  coreDistances.set_size(data.n_cols);
+
+  if (naive)
+  {
+    KNNType knn(data, true, false, metric);
+    knn.Search(k, neighbors, distances);
+
+    coreDistances = trans(distances.row(k - 1));
+  }
+  else
+  {
+    // Build the tree by hand so that we can set the leaf size.
+    arma::mat dataCopy(data);
+    std::vector<size_t> oldFromNew;
+    TreeType tree(dataCopy, oldFromNew, leafSize);
+
+    KNNType knn(&tree, dataCopy, false, metric);
+    knn.Search(k, neighbors, distances);
+
+    // The results are in the order of the tree.
+    for (size_t i = 0; i < data.n_cols; ++i)
+      coreDistances[oldFromNew[i]] = distances(k - 1, i);
+  }
+
+  Timer::Stop("hdbscan/core_distances");
+}
+
+template<typename MetricType>
+void HDBSCAN<MetricType>::MutualReachabilityMST(const arma::mat& data,
+                                                const arma::vec& coreDistances,
+                                                arma::mat& mst)
+{
+  Timer::Start("hdbscan/mst");
+
+  if (naive)
+  {
+    emst::DualTreeBoruvka<MetricType> dtb(data, true, metric);
+    dtb.ComputeMST(mst, coreDistances);
+  }
+  else
+  {
+    // Build the tree by hand so that we can set the leaf size.
+    typedef tree::BinarySpaceTree<bound::HRectBound<2>, emst::DTBStat>
+        TreeType;
+
+    arma::mat dataCopy(data);
+    std::vector<size_t> oldFromNew;
+    TreeType tree(dataCopy, oldFromNew, leafSize);
+
+    arma::vec mappedCoreDistances(coreDistances.n_elem);
+    for (size_t i = 0; i < coreDistances.n_elem; ++i)
+      mappedCoreDistances[i] = coreDistances[oldFromNew[i]];
+
+    emst::DualTreeBoruvka<MetricType, TreeType> dtb(&tree, dataCopy, metric);
+    dtb.ComputeMST(mst, mappedCoreDistances);
+
+    // Unmap the edges.  They remain sorted by distance.
+    for (size_t i = 0; i < mst.n_cols; ++i)
+    {
+      const size_t indexA = oldFromNew[(size_t) mst(0, i)];
+      const size_t indexB = oldFromNew[(size_t) mst(1, i)];
+
+      mst(0, i) = std::min(indexA, indexB);
+      mst(1, i) = std::max(indexA, indexB);
+    }
+  }
+
+  Timer::Stop("hdbscan/mst");
+}
+
+template<typename MetricType>
+std::string HDBSCAN<MetricType>::ToString() const
+{
+  std::ostringstream convert;
+  convert << "HDBSCAN [" << this << "]" << std::endl;
+  convert << "  Minimum cluster size: " << minClusterSize << std::endl;
+  convert << "  Minimum points: " << minPoints << std::endl;
+  convert << "  Naive: " << naive << std::endl;
+  convert << "  Leaf size: " << leafSize << std::endl;
+  convert << "  Metric: " << std::endl;
+  convert << util::Indent(metric.ToString(), 2);
+  convert << std::endl;
+  return convert.str();
+}
+
+}; // namespace hdbscan
+}; // namespace mlpack
+
+#endif
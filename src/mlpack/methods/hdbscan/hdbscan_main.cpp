@@ -0,0 +1,92 @@
+/**
+ * @file hdbscan_main.cpp
+ *
+ * Executable for running HDBSCAN hierarchical density-based clustering.
+ */
+#include <mlpack/core.hpp>
+
+#include "hdbscan.hpp"
+
+using namespace mlpack;
+using namespace mlpack::hdbscan;
+using namespace std;
+
+PROGRAM_INFO("HDBSCAN Hierarchical Density-Based Clustering", "This program "
+    "performs hierarchical density-based clustering (HDBSCAN*) on the given "
+    "dataset.  First, the core distance of each point (the distance to its "
+    "--min_points'th nearest neighbor, counting the point itself) is computed "
+    "with dual-tree nearest neighbor search.  Then, the minimum spanning tree "
+    "of the dataset under mutual reachability distance is computed with the "
+    "dual-tree Boruvka algorithm (as in the 'emst' program).  This tree is "
+    "turned into a single-linkage dendrogram, which is condensed using the "
+    "given --min_cluster_size, and the most stable clusters are selected."
+    "\n\n"
+    "The cluster labels are saved to the file given by --output_file; points "
+    "that are not in any cluster (noise) are given the label -1."
+    "\n\n"
+    "Optionally, the single-linkage dendrogram under mutual reachability "
+    "distance can be saved with --dendrogram_file.  Each row corresponds to one"
+    " merge, in the format of a SciPy linkage matrix: the indices of the two "
+    "merged clusters (indices less than the number of points are single "
+    "points, and the cluster created by row i has index (number of points + "
+    "i)), the merge distance, and the number of points in the merged cluster.  "
+    "If --min_points is 1, this is the single-linkage dendrogram of the "
+    "Euclidean minimum spanning tree.");
+
+PARAM_STRING_REQ("input_file", "Input dataset to perform clustering on.", "i");
+PARAM_STRING("output_file", "File to save cluster labels to.", "o",
+    "hdbscan_labels.csv");
+PARAM_STRING("dendrogram_file", "If specified, the single-linkage dendrogram "
+    "will be saved to this file.", "d", "");
+
+PARAM_INT("min_cluster_size", "Minimum number of points in a cluster.", "m",
+    5);
+PARAM_INT("min_points", "Number of neighbors (counting the point itself) used "
+    "to calculate the core distance of each point.", "k", 5);
+PARAM_INT("leaf_size", "Leaf size for the kd-trees.", "l", 1);
+PARAM_FLAG("naive", "Use O(n^2) naive computation.", "n");
+PARAM_FLAG("allow_single_cluster", "Allow a single cluster containing all the "
+    "points to be returned.", "s");
+
+int main(int argc, char** argv)
+{
+  CLI::ParseCommandLine(argc, argv);
+
+  const int minClusterSize = CLI::GetParam<int>("min_cluster_size");
+  const int minPoints = CLI::GetParam<int>("min_points");
+  const int leafSize = CLI::GetParam<int>("leaf_size");
+
+  if (minClusterSize < 2)
+    Log::Fatal << "Invalid minimum cluster size (" << minClusterSize << ")!  "
+        << "Must be greater than or equal to 2." << endl;
+
+  if (minPoints < 1)
+    Log::Fatal << "Invalid number of minimum points (" << minPoints << ")!  "
+        << "Must be greater than or equal to 1." << endl;
+
+  if (leafSize <= 0)
+    Log::Fatal << "Invalid leaf size (" << leafSize << ")!  Must be greater "
+        << "than or equal to 1." << endl;
+
+  arma::mat dataset;
+  data::Load(CLI::GetParam<string>("input_file"), dataset, true);
+
+  HDBSCAN<> hdbscan((size_t) minClusterSize, (size_t) minPoints,
+      CLI::HasParam("naive"), (size_t) leafSize,
+      CLI::HasParam("allow_single_cluster"));
+
+  arma::Col<size_t> assignments;
+  arma::mat dendrogram;
+  hdbscan.Cluster(dataset, assignments, dendrogram);
+
+  // Noise points are saved with the label -1.
+  arma::rowvec labels(assignments.n_elem);
+  for (size_t i = 0; i < assignments.n_elem; ++i)
+    labels[i] = (assignments[i] == size_t() - 1) ? -1.0 :
+        (double) assignments[i];
+
+  data::Save(CLI::GetParam<string>("output_file"), labels, true);
+
+  if (CLI::GetParam<string>("dendrogram_file") != "")
+    data::Save(CLI::GetParam<string>("dendrogram_file"), dendrogram, true);
+}
@@ -0,0 +1,58 @@
+/**
+ * @file single_linkage.cpp
+ *
+ * Implementation of the conversion from a minimum spanning tree to a
+ * single-linkage dendrogram.
+ */
+#include "single_linkage.hpp"
+
+#include <mlpack/methods/emst/union_find.hpp>
+
+namespace mlpack {
+namespace hdbscan {
+
+void SingleLinkage(const arma::mat& mst, arma::mat& dendrogram)
+{
+  const size_t numPoints = mst.n_cols + 1;
+
+  dendrogram.set_size(4, mst.n_cols);
+
+  // The union-find structure tracks which points have been merged; for the
+  // representative of each component we store the index of the dendrogram node
+  // holding that component, and its size.
+  emst::UnionFind connections(numPoints);
+  arma::Col<size_t> clusterIndex(numPoints);
+  arma::Col<size_t> clusterSize(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    clusterIndex[i] = i;
+    clusterSize[i] = 1;
+  }
+
+  for (size_t i = 0; i < mst.n_cols; ++i)
+  {
+    if ((i > 0) && (mst(2, i) < mst(2, i - 1)))
+      Log::Fatal << "SingleLinkage(): edges of the minimum spanning tree must "
+          << "be sorted by distance!" << std::endl;
+
+    const size_t a = connections.Find((size_t) mst(0, i));
+    const size_t b = connections.Find((size_t) mst(1, i));
+
+    if (a == b)
+      Log::Fatal << "SingleLinkage(): given edge list is not a tree!"
+          << std::endl;
+
+    dendrogram(0, i) = std::min(clusterIndex[a], clusterIndex[b]);
+    dendrogram(1, i) = std::max(clusterIndex[a], clusterIndex[b]);
+    dendrogram(2, i) = mst(2, i);
+    dendrogram(3, i) = clusterSize[a] + clusterSize[b];
+
+    connections.Union(a, b);
+    const size_t root = connections.Find(a);
+    clusterIndex[root] = numPoints + i;
+    clusterSize[root] = (size_t) dendrogram(3, i);
+  }
+}
+
+}; // namespace hdbscan
+}; // namespace mlpack
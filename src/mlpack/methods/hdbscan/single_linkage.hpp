@@ -0,0 +1,37 @@
+/**
+ * @file single_linkage.hpp
+ *
+ * Conversion of a minimum spanning tree edge list (such as the output of
+ * DualTreeBoruvka::ComputeMST()) into a single-linkage dendrogram.
+ */
+#ifndef __MLPACK_METHODS_HDBSCAN_SINGLE_LINKAGE_HPP
+#define __MLPACK_METHODS_HDBSCAN_SINGLE_LINKAGE_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace hdbscan {
+
+/**
+ * Given the edges of a minimum spanning tree in the format returned by
+ * DualTreeBoruvka::ComputeMST() (a 3xN matrix where each column holds the
+ * lesser index, greater index, and distance of an edge, sorted by increasing
+ * distance), build the single-linkage dendrogram of the points.  This takes
+ * O(N) time, since the edges are already sorted.
+ *
+ * The dendrogram has the same format as a SciPy linkage matrix, except that it
+ * is stored column-major: it is a 4x(N) matrix, where column i describes the
+ * merge that creates cluster (N + 1 + i).  The first two rows hold the indices
+ * of the merged clusters (indices less than N + 1 are single points), the third
+ * row holds the distance at which they merge, and the fourth row holds the
+ * number of points in the new cluster.
+ *
+ * @param mst Sorted edge list of the minimum spanning tree.
+ * @param dendrogram Matrix to store the dendrogram in.
+ */
+void SingleLinkage(const arma::mat& mst, arma::mat& dendrogram);
+
+}; // namespace hdbscan
+}; // namespace mlpack
+
+#endif
@@ -10,14 +10,23 @@
 
 #include <mlpack/core.hpp>
 #include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
+#include <mlpack/core/optimizers/data_parallel/data_parallel_function.hpp>
 
 #include "logistic_regression_function.hpp"
 
 namespace mlpack {
 namespace regression {
 
+/**
+ * Logistic regression, trained with the given optimizer.  The predictors may be
+ * dense (arma::mat) or sparse (arma::sp_mat); see LogisticRegressionFunction.
+ *
+ * @tparam OptimizerType Optimizer to train the model with.
+ * @tparam MatType Type of the predictors matrix (arma::mat or arma::sp_mat).
+ */
 template<
-  template<typename> class OptimizerType = mlpack::optimization::L_BFGS
+  template<typename> class OptimizerType = mlpack::optimization::L_BFGS,
+  typename MatType = arma::mat
 >
 class LogisticRegression
 {
@@ -32,7 +41,7 @@ class LogisticRegression
    * @param responses Outputs resulting from input training variables.
    * @param lambda L2-regularization parameter.
    */
-  LogisticRegression(const arma::mat& predictors,
+  LogisticRegression(const MatType& predictors,
                      const arma::vec& responses,
                      const double lambda = 0);
 
@@ -47,7 +56,7 @@ class LogisticRegression
    * @param initialPoint Initial model to train with.
    * @param lambda L2-regularization parameter.
    */
-  LogisticRegression(const arma::mat& predictors,
+  LogisticRegression(const MatType& predictors,
                      const arma::vec& responses,
                      const arma::mat& initialPoint,
                      const double lambda = 0);
@@ -63,7 +72,23 @@ class LogisticRegression
    *
    * @param optimizer Instantiated optimizer with instantiated error function.
    */
-  LogisticRegression(OptimizerType<LogisticRegressionFunction>& optimizer);
+  LogisticRegression(
+      OptimizerType<LogisticRegressionFunction<MatType> >& optimizer);
+
+  /**
+   * Construct the LogisticRegression class with the given labeled training
+   * data, and train the model with the given optimizer, whose error function
+   * is a LogisticRegressionFunction wrapped in an
+   * optimization::DataParallelFunction.  A full-batch optimizer (such as
+   * L-BFGS) then evaluates the objective and gradient over the data in
+   * parallel.  As with the other optimizer constructor, the predictors,
+   * responses and initial point are taken from the wrapped error function.
+   *
+   * @param optimizer Instantiated optimizer with instantiated parallel error
+   *     function.
+   */
+  LogisticRegression(OptimizerType<optimization::DataParallelFunction<
+      LogisticRegressionFunction<MatType> > >& optimizer);
 
   /**
    * Construct a logistic regression model from the given parameters, without
@@ -97,7 +122,7 @@ class LogisticRegression
    * @param responses Vector to put output predictions of responses into.
    * @param decisionBoundary Decision boundary (default 0.5).
    */
-  void Predict(const arma::mat& predictors,
+  void Predict(const MatType& predictors,
                arma::vec& responses,
                const double decisionBoundary = 0.5) const;
 
@@ -115,7 +140,7 @@ class LogisticRegression
    * @param decisionBoundary Decision boundary (default 0.5).
    * @return Percentage of responses that are predicted correctly.
    */
-  double ComputeAccuracy(const arma::mat& predictors,
+  double ComputeAccuracy(const MatType& predictors,
                          const arma::vec& responses,
                          const double decisionBoundary = 0.5) const;
 
@@ -127,7 +152,7 @@ class LogisticRegression
    * @param predictors Input predictors.
    * @param responses Vector of responses.
    */
-  double ComputeError(const arma::mat& predictors,
+  double ComputeError(const MatType& predictors,
                       const arma::vec& responses) const;
 
   // Returns a string representation of this object. 
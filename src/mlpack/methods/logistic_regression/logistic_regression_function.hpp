@@ -10,6 +10,9 @@
 #define __MLPACK_METHODS_LOGISTIC_REGRESSION_LOGISTIC_REGRESSION_FUNCTION_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/unregularized_gradient.hpp>
+
+#include <boost/type_traits/is_same.hpp>
 
 namespace mlpack {
 namespace regression {
@@ -18,15 +21,25 @@ namespace regression {
  * The log-likelihood function for the logistic regression objective function.
  * This is used by various mlpack optimizers to train a logistic regression
  * model.
+ *
+ * The predictors may be dense (arma::mat) or sparse (arma::sp_mat).  With
+ * sparse predictors, the per-point functions only touch the nonzero dimensions
+ * of the point, so high-dimensional sparse data (such as text features) can be
+ * used efficiently, especially with SGD, which then uses
+ * UnregularizedGradient() to take steps that cost O(nnz) instead of O(d).
+ * With dense predictors, SGD takes ordinary dense steps.
+ *
+ * @tparam MatType Type of the predictors matrix (arma::mat or arma::sp_mat).
  */
+template<typename MatType = arma::mat>
 class LogisticRegressionFunction
 {
  public:
-  LogisticRegressionFunction(const arma::mat& predictors,
+  LogisticRegressionFunction(const MatType& predictors,
                              const arma::vec& responses,
                              const double lambda = 0);
 
-  LogisticRegressionFunction(const arma::mat& predictors,
+  LogisticRegressionFunction(const MatType& predictors,
                              const arma::vec& responses,
                              const arma::mat& initialPoint,
                              const double lambda = 0);
@@ -42,7 +55,7 @@ class LogisticRegressionFunction
   double& Lambda() { return lambda; }
 
   //! Return the matrix of predictors.
-  const arma::mat& Predictors() const { return predictors; }
+  const MatType& Predictors() const { return predictors; }
   //! Return the vector of responses.
   const arma::vec& Responses() const { return responses; }
 
@@ -98,6 +111,132 @@ class LogisticRegressionFunction
                 const size_t i,
                 arma::mat& gradient) const;
 
+  /**
+   * Evaluate the logistic regression log-likelihood function with the given
+   * parameters, but using only the points begin to (begin + batchSize - 1);
+   * the result is the sum of Evaluate(parameters, i) over those points.  This
+   * is used by mini-batch SGD.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize) const;
+
+  /**
+   * Evaluate the gradient of the logistic regression log-likelihood function
+   * with the given parameters, using only the points begin to (begin +
+   * batchSize - 1); the result is the sum of Gradient(parameters, i, gradient)
+   * over those points.  This is used by mini-batch SGD.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   * @param gradient Vector to output gradient into.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                const size_t batchSize,
+                arma::mat& gradient) const;
+
+  /**
+   * Evaluate the gradient of the logistic regression log-likelihood function
+   * with the given parameters, and with respect to only one point in the
+   * dataset, as a sparse vector.  This is used by parallel SGD, which only
+   * updates the nonzero coordinates.  Without regularization, the gradient is
+   * nonzero only for the intercept and the nonzero dimensions of the point;
+   * the regularization term makes every coordinate nonzero.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param i Index of point to use for objective function gradient evaluation.
+   * @param gradient Sparse vector to output gradient into.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::sp_mat& gradient) const;
+
+  /**
+   * Store the indices of the coordinates which the unregularized objective of
+   * the given point depends on: the intercept and the nonzero dimensions of
+   * the point (shifted by one, for the intercept).  The indices are sorted.
+   * This is used by SGD to apply the L2-regularization lazily.
+   *
+   * @param i Index of point.
+   * @param coordinates Vector to store the coordinate indices in.
+   */
+  void Support(const size_t i, arma::uvec& coordinates) const;
+
+  /**
+   * Evaluate the gradient of the logistic regression log-likelihood function
+   * with respect to only one point in the dataset, without the
+   * L2-regularization term, as a sparse vector.  The gradient is nonzero only
+   * for the coordinates given by Support(), so it takes O(nnz) time to
+   * compute.  This is used by SGD, which applies the regularization (given by
+   * L2Regularization()) lazily.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param i Index of point to use for objective function gradient evaluation.
+   * @param gradient Sparse vector to output gradient into.
+   */
+  void UnregularizedGradient(const arma::mat& parameters,
+                             const size_t i,
+                             arma::sp_mat& gradient) const;
+
+  /**
+   * Store the L2-regularization weight of each coordinate, such that the
+   * regularization term of Evaluate(parameters, i) is 0.5 * sum_j (weights[j]
+   * * parameters[j]^2).  The intercept is not regularized, so its weight is
+   * 0; every other weight is lambda divided by the number of points.
+   *
+   * @param weights Vector to store the regularization weights in.
+   */
+  void L2Regularization(arma::mat& weights) const;
+
+  /**
+   * Evaluate the logistic regression log-likelihood function and its gradient
+   * with the given parameters.  The sigmoids are calculated only once, so this
+   * is cheaper than calling Evaluate() and Gradient().
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param gradient Vector to output gradient into.
+   * @return The value of the objective function.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient) const;
+
+  /**
+   * Evaluate the logistic regression log-likelihood function and its gradient
+   * with the given parameters, and with respect to only one point in the
+   * dataset.  This is used by SGD.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param i Index of point to use for objective function evaluation.
+   * @param gradient Vector to output gradient into.
+   * @return The value of the objective function for point i.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t i,
+                              arma::mat& gradient) const;
+
+  /**
+   * Evaluate the logistic regression log-likelihood function and its gradient
+   * with the given parameters, using only the points begin to (begin +
+   * batchSize - 1).  The sigmoids are calculated only once.  This is used by
+   * mlpack::optimization::DataParallelFunction.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   * @param gradient Vector to output gradient into.
+   * @return The value of the objective function for the batch.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t begin,
+                              const size_t batchSize,
+                              arma::mat& gradient) const;
+
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
 
@@ -108,14 +247,104 @@ class LogisticRegressionFunction
   //! The initial point, from which to start the optimization.
   arma::mat initialPoint;
   //! The matrix of data points (predictors).
-  const arma::mat& predictors;
+  const MatType& predictors;
   //! The vector of responses to the input data points.
   const arma::vec& responses;
   //! The regularization parameter for L2-regularization.
   double lambda;
+
+  /**
+   * Evaluate the logistic regression log-likelihood function, and its gradient
+   * if computeGradient is true, using only the points begin to (begin +
+   * batchSize - 1).  The full-data and single-point overloads of Evaluate(),
+   * Gradient() and EvaluateWithGradient() are batches of all points and of one
+   * point.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   * @param computeGradient Whether to calculate the gradient.
+   * @param gradient Vector to output gradient into (if computeGradient is
+   *     true).
+   * @return The value of the objective function for the batch.
+   */
+  double EvaluateBatch(const arma::mat& parameters,
+                       const size_t begin,
+                       const size_t batchSize,
+                       const bool computeGradient,
+                       arma::mat& gradient) const;
+
+  //! Compute the dot product of the given dense point and the parameters
+  //! (without the intercept).
+  static double Dot(const arma::mat& predictors,
+                    const size_t i,
+                    const arma::mat& parameters);
+  //! Compute the dot product of the given sparse point and the parameters
+  //! (without the intercept), touching only the nonzero dimensions.
+  static double Dot(const arma::sp_mat& predictors,
+                    const size_t i,
+                    const arma::mat& parameters);
+
+  //! Compute the exponents (the intercept plus the dot product with the
+  //! parameters) of the given dense points.
+  static void Exponents(const arma::mat& predictors,
+                        const size_t begin,
+                        const size_t batchSize,
+                        const arma::mat& parameters,
+                        arma::vec& exponents);
+  //! Compute the exponents of the given sparse points, touching only the
+  //! nonzero dimensions.
+  static void Exponents(const arma::sp_mat& predictors,
+                        const size_t begin,
+                        const size_t batchSize,
+                        const arma::mat& parameters,
+                        arma::vec& exponents);
+
+  //! Add the given dense points, each times its scale, to the gradient (after
+  //! the intercept).
+  static void AddPoints(const arma::mat& predictors,
+                        const size_t begin,
+                        const arma::vec& scales,
+                        arma::mat& gradient);
+  //! Add the given sparse points, each times its scale, to the gradient (after
+  //! the intercept), touching only the nonzero dimensions.
+  static void AddPoints(const arma::sp_mat& predictors,
+                        const size_t begin,
+                        const arma::vec& scales,
+                        arma::mat& gradient);
+
+  //! Store the nonzero dimensions of the given dense point and their values.
+  static void Nonzeros(const arma::mat& predictors,
+                       const size_t i,
+                       arma::uvec& dimensions,
+                       arma::vec& values);
+  //! Store the nonzero dimensions of the given sparse point and their values.
+  static void Nonzeros(const arma::sp_mat& predictors,
+                       const size_t i,
+                       arma::uvec& dimensions,
+                       arma::vec& values);
 };
 
 }; // namespace regression
+
+namespace optimization {
+
+/**
+ * LogisticRegressionFunction has UnregularizedGradient() for any type of
+ * predictors, but a sparse step only pays off when the points are sparse; with
+ * dense predictors, SGD takes dense steps (with EvaluateWithGradient()).
+ */
+template<typename MatType>
+struct HasUnregularizedGradient<
+    regression::LogisticRegressionFunction<MatType> >
+{
+  static const bool value = boost::is_same<MatType, arma::sp_mat>::value;
+};
+
+}; // namespace optimization
 }; // namespace mlpack
 
+// Include implementation.
+#include "logistic_regression_function_impl.hpp"
+
 #endif // __MLPACK_METHODS_LOGISTIC_REGRESSION_LOGISTIC_REGRESSION_FUNCTION_HPP
@@ -0,0 +1,421 @@
+/**
+ * @file logistic_regression_function_impl.hpp
+ * @author Sumedh Ghaisas
+ *
+ * Implementation of the LogisticRegressionFunction class.
+ */
+#ifndef __MLPACK_METHODS_LOGISTIC_REGRESSION_LOGISTIC_REGRESSION_FUNCTION_IMPL_HPP
+#define __MLPACK_METHODS_LOGISTIC_REGRESSION_LOGISTIC_REGRESSION_FUNCTION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "logistic_regression_function.hpp"
+
+namespace mlpack {
+namespace regression {
+
+template<typename MatType>
+LogisticRegressionFunction<MatType>::LogisticRegressionFunction(
+    const MatType& predictors,
+    const arma::vec& responses,
+    const double lambda) :
+    predictors(predictors),
+    responses(responses),
+    lambda(lambda)
+{
+  initialPoint = arma::zeros<arma::mat>(predictors.n_rows + 1, 1);
+}
+
+template<typename MatType>
+LogisticRegressionFunction<MatType>::LogisticRegressionFunction(
+    const MatType& predictors,
+    const arma::vec& responses,
+    const arma::mat& initialPoint,
+    const double lambda) :
+    initialPoint(initialPoint),
+    predictors(predictors),
+    responses(responses),
+    lambda(lambda)
+{
+  //to check if initialPoint is compatible with predictors
+  if (initialPoint.n_rows != (predictors.n_rows + 1) ||
+      initialPoint.n_cols != 1)
+    this->initialPoint = arma::zeros<arma::mat>(predictors.n_rows + 1, 1);
+}
+
+/**
+ * Evaluate the logistic regression objective function given the estimated
+ * parameters.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::Evaluate(
+    const arma::mat& parameters) const
+{
+  arma::mat gradient;
+  return EvaluateBatch(parameters, 0, predictors.n_cols, false, gradient);
+}
+
+/**
+ * Evaluate the logistic regression objective function, but with only one point.
+ * This is useful for optimizers that use a separable objective function, such
+ * as SGD.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::Evaluate(
+    const arma::mat& parameters,
+    const size_t i) const
+{
+  arma::mat gradient;
+  return EvaluateBatch(parameters, i, 1, false, gradient);
+}
+
+//! Evaluate the gradient of the logistic regression objective function.
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  EvaluateBatch(parameters, 0, predictors.n_cols, true, gradient);
+}
+
+/**
+ * Evaluate the individual gradients of the logistic regression objective
+ * function with respect to individual points.  This is useful for optimizers
+ * that use a separable objective function, such as SGD.
+ */
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::mat& gradient) const
+{
+  EvaluateBatch(parameters, i, 1, true, gradient);
+}
+
+/**
+ * Evaluate the logistic regression objective function over a batch of points.
+ * This is useful for mini-batch SGD.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::Evaluate(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize) const
+{
+  arma::mat gradient;
+  return EvaluateBatch(parameters, begin, batchSize, false, gradient);
+}
+
+/**
+ * Evaluate the gradient of the logistic regression objective function over a
+ * batch of points.  This is useful for mini-batch SGD.
+ */
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize,
+    arma::mat& gradient) const
+{
+  EvaluateBatch(parameters, begin, batchSize, true, gradient);
+}
+
+/**
+ * Evaluate the individual gradient with respect to one point as a sparse
+ * vector.  This is useful for parallel SGD, which only updates the nonzero
+ * coordinates.
+ */
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::sp_mat& gradient) const
+{
+  if (lambda != 0.0)
+  {
+    // Every coordinate is regularized, so the gradient is dense.
+    arma::mat denseGradient;
+    Gradient(parameters, i, denseGradient);
+    gradient = arma::sp_mat(denseGradient);
+    return;
+  }
+
+  UnregularizedGradient(parameters, i, gradient);
+}
+
+//! Find the coordinates which the objective of one point depends on.
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Support(const size_t i,
+                                                  arma::uvec& coordinates)
+    const
+{
+  arma::uvec dimensions;
+  arma::vec values;
+  Nonzeros(predictors, i, dimensions, values);
+
+  // The intercept comes first.
+  coordinates.set_size(dimensions.n_elem + 1);
+  coordinates[0] = 0;
+  for (size_t j = 0; j < dimensions.n_elem; ++j)
+    coordinates[j + 1] = dimensions[j] + 1;
+}
+
+/**
+ * Evaluate the individual gradient with respect to one point, without the
+ * regularization, as a sparse vector.  This is useful for SGD, which applies
+ * the regularization lazily.
+ */
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::UnregularizedGradient(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::sp_mat& gradient) const
+{
+  const double sigmoid = 1.0 / (1.0 + std::exp(-parameters(0, 0)
+      - Dot(predictors, i, parameters)));
+  const double error = -(responses[i] - sigmoid);
+
+  // Only the intercept and the nonzero dimensions of the point have a nonzero
+  // gradient.
+  arma::uvec dimensions;
+  arma::vec values;
+  Nonzeros(predictors, i, dimensions, values);
+
+  arma::umat locations(2, dimensions.n_elem + 1);
+  arma::vec gradientValues(dimensions.n_elem + 1);
+  locations(0, 0) = 0;
+  locations(1, 0) = 0;
+  gradientValues[0] = error;
+  for (size_t j = 0; j < dimensions.n_elem; ++j)
+  {
+    locations(0, j + 1) = dimensions[j] + 1;
+    locations(1, j + 1) = 0;
+    gradientValues[j + 1] = error * values[j];
+  }
+
+  gradient = arma::sp_mat(locations, gradientValues, parameters.n_elem, 1);
+}
+
+//! Find the L2-regularization weight of each coordinate.
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::L2Regularization(
+    arma::mat& weights) const
+{
+  // Each point gets 1 / (number of points) of the regularization term, and the
+  // intercept is not regularized.
+  weights.set_size(predictors.n_rows + 1, 1);
+  weights.fill(lambda / predictors.n_cols);
+  weights[0] = 0.0;
+}
+
+/**
+ * Evaluate the logistic regression objective function and its gradient at
+ * once, sharing the calculation of the sigmoids.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  return EvaluateBatch(parameters, 0, predictors.n_cols, true, gradient);
+}
+
+/**
+ * Evaluate the logistic regression objective function and its gradient with
+ * respect to only one point, sharing the calculation of the sigmoid.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::mat& gradient) const
+{
+  return EvaluateBatch(parameters, i, 1, true, gradient);
+}
+
+/**
+ * Evaluate the logistic regression objective function and its gradient over a
+ * batch of points, sharing the calculation of the sigmoids.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize,
+    arma::mat& gradient) const
+{
+  return EvaluateBatch(parameters, begin, batchSize, true, gradient);
+}
+
+/**
+ * Evaluate the objective function, and its gradient if computeGradient is true,
+ * over the points begin to (begin + batchSize - 1).  Every other overload of
+ * Evaluate(), Gradient() and EvaluateWithGradient() calls this.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::EvaluateBatch(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize,
+    const bool computeGradient,
+    arma::mat& gradient) const
+{
+  // The objective function is the log-likelihood function (w is the parameters
+  // vector for the model; y is the responses; x is the predictors; sig() is the
+  // sigmoid function):
+  //   f(w) = sum(y log(sig(w'x)) + (1 - y) log(sig(1 - w'x))).
+  // We want to minimize this function.  L2-regularization is just lambda
+  // multiplied by the squared l2-norm of the parameters then divided by two.
+  // Each point gets 1 / (number of points) of the regularization term, so that
+  // the objective over a batch is the sum of the objectives of its points.  The
+  // intercept term (the first parameter) is not regularized.
+  const double regularizationWeight = lambda * (double(batchSize) /
+      predictors.n_cols);
+  const arma::vec weights = parameters.col(0).subvec(1, parameters.n_elem - 1);
+
+  // Calculate vectors of sigmoids.  The intercept term is parameters(0, 0) and
+  // does not need to be multiplied by any of the predictors.
+  arma::vec exponents;
+  Exponents(predictors, begin, batchSize, parameters, exponents);
+  const arma::vec sigmoids = 1.0 / (1.0 + arma::exp(-exponents));
+
+  // Often the objective function and the regularization as given are divided
+  // by the number of features, but this doesn't actually affect the
+  // optimization result, so we'll just ignore those terms for computational
+  // efficiency.
+  double result = 0.0;
+  for (size_t i = 0; i < batchSize; ++i)
+  {
+    if (responses[begin + i] == 1)
+      result += log(sigmoids[i]);
+    else
+      result += log(1.0 - sigmoids[i]);
+  }
+
+  if (computeGradient)
+  {
+    const arma::vec errors = sigmoids -
+        responses.subvec(begin, begin + batchSize - 1);
+
+    // Start with the regularization term, and then add the points.
+    gradient.set_size(parameters.n_elem, 1);
+    gradient[0] = arma::accu(errors);
+    gradient.col(0).subvec(1, parameters.n_elem - 1) = regularizationWeight *
+        weights;
+    AddPoints(predictors, begin, errors, gradient);
+  }
+
+  // Invert the result, because it's a minimization.
+  return -result + 0.5 * regularizationWeight * arma::dot(weights, weights);
+}
+
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::Dot(const arma::mat& predictors,
+                                                const size_t i,
+                                                const arma::mat& parameters)
+{
+  return arma::dot(predictors.col(i),
+      parameters.col(0).subvec(1, parameters.n_elem - 1));
+}
+
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::Dot(const arma::sp_mat& predictors,
+                                                const size_t i,
+                                                const arma::mat& parameters)
+{
+  double result = 0.0;
+  for (arma::sp_mat::const_iterator it = predictors.begin_col(i);
+      it != predictors.end_col(i); ++it)
+    result += (*it) * parameters(it.row() + 1, 0);
+
+  return result;
+}
+
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Exponents(
+    const arma::mat& predictors,
+    const size_t begin,
+    const size_t batchSize,
+    const arma::mat& parameters,
+    arma::vec& exponents)
+{
+  exponents = parameters(0, 0) +
+      predictors.cols(begin, begin + batchSize - 1).t() *
+      parameters.col(0).subvec(1, parameters.n_elem - 1);
+}
+
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Exponents(
+    const arma::sp_mat& predictors,
+    const size_t begin,
+    const size_t batchSize,
+    const arma::mat& parameters,
+    arma::vec& exponents)
+{
+  exponents.set_size(batchSize);
+  for (size_t i = 0; i < batchSize; ++i)
+    exponents[i] = parameters(0, 0) + Dot(predictors, begin + i, parameters);
+}
+
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::AddPoints(
+    const arma::mat& predictors,
+    const size_t begin,
+    const arma::vec& scales,
+    arma::mat& gradient)
+{
+  gradient.col(0).subvec(1, gradient.n_elem - 1) +=
+      predictors.cols(begin, begin + scales.n_elem - 1) * scales;
+}
+
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::AddPoints(
+    const arma::sp_mat& predictors,
+    const size_t begin,
+    const arma::vec& scales,
+    arma::mat& gradient)
+{
+  for (size_t i = 0; i < scales.n_elem; ++i)
+  {
+    for (arma::sp_mat::const_iterator it = predictors.begin_col(begin + i);
+        it != predictors.end_col(begin + i); ++it)
+      gradient(it.row() + 1, 0) += scales[i] * (*it);
+  }
+}
+
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Nonzeros(
+    const arma::mat& predictors,
+    const size_t i,
+    arma::uvec& dimensions,
+    arma::vec& values)
+{
+  dimensions = arma::find(predictors.col(i));
+  values.set_size(dimensions.n_elem);
+  for (size_t j = 0; j < dimensions.n_elem; ++j)
+    values[j] = predictors(dimensions[j], i);
+}
+
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Nonzeros(
+    const arma::sp_mat& predictors,
+    const size_t i,
+    arma::uvec& dimensions,
+    arma::vec& values)
+{
+  const size_t nonzeros = predictors.col_ptrs[i + 1] - predictors.col_ptrs[i];
+  dimensions.set_size(nonzeros);
+  values.set_size(nonzeros);
+
+  size_t j = 0;
+  for (arma::sp_mat::const_iterator it = predictors.begin_col(i);
+      it != predictors.end_col(i); ++it, ++j)
+  {
+    dimensions[j] = it.row();
+    values[j] = (*it);
+  }
+}
+
+}; // namespace regression
+}; // namespace mlpack
+
+#endif // __MLPACK_METHODS_LOGISTIC_REGRESSION_LOGISTIC_REGRESSION_FUNCTION_IMPL_HPP
@@ -8,6 +8,8 @@
 #include "logistic_regression.hpp"
 
 #include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
+#include <mlpack/core/optimizers/parallel_sgd/parallel_sgd.hpp>
 
 using namespace std;
 using namespace mlpack;
@@ -36,7 +38,17 @@ PROGRAM_INFO("L2-regularized Logistic Regression and Prediction",
     "have more options, but the C++ interface must be used for those.  For the "
     "SGD optimizer, the --step_size parameter controls the step size taken at "
     "each iteration by the optimizer.  If the objective function for your data "
-    "is oscillating between Inf and 0, the step size is probably too large.\n"
+    "is oscillating between Inf and 0, the step size is probably too large.  "
+    "L-BFGS evaluates the objective function over the points in parallel.\n"
+    "\n"
+    "Two variants of SGD are also available.  With '--optimizer minibatch-sgd',"
+    " each step uses the average gradient of a batch of points (the batch size "
+    "is set with --batch_size), which is computed with matrix operations.  "
+    "With '--optimizer parallel-sgd', the points are split between threads, "
+    "which update the parameters without locks (this is known as Hogwild!); "
+    "this is best when the data is sparse and --lambda is 0, so that each "
+    "point updates few parameters.  For L-BFGS and parallel SGD, the number of "
+    "threads can be set with the OMP_NUM_THREADS environment variable.\n"
     "\n"
     "This implementation of logistic regression supports L2-regularization, "
     "which can help the parameter vector b from overfitting.  This parameter "
@@ -73,12 +85,13 @@ PARAM_DOUBLE("decision_boundary", "Decision boundary for prediction; if the "
     "taken to be 0; otherwise, the class is 1.", "d", 0.5);
 
 PARAM_DOUBLE("lambda", "L2-regularization parameter for training.", "l", 0.0);
-PARAM_STRING("optimizer", "Optimizer to use for training ('lbfgs' or 'sgd').",
-    "O", "lbfgs");
+PARAM_STRING("optimizer", "Optimizer to use for training ('lbfgs', 'sgd', "
+    "'minibatch-sgd', or 'parallel-sgd').", "O", "lbfgs");
 PARAM_DOUBLE("tolerance", "Convergence tolerance for optimizer.", "T", 1e-10);
 PARAM_INT("max_iterations", "Maximum iterations for optimizer (0 indicates no "
     "limit).", "M", 0);
-PARAM_DOUBLE("step_size", "Step size for SGD optimizer.", "s", 0.01);
+PARAM_DOUBLE("step_size", "Step size for SGD optimizers.", "s", 0.01);
+PARAM_INT("batch_size", "Batch size for mini-batch SGD optimizer.", "b", 32);
 
 int main(int argc, char** argv)
 {
@@ -98,6 +111,7 @@ int main(int argc, char** argv)
   const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
   const double decisionBoundary = CLI::GetParam<double>("decision_boundary");
   const double stepSize = CLI::GetParam<double>("step_size");
+  const int batchSize = CLI::GetParam<int>("batch_size");
 
   // One of inputFile and modelFile must be specified.
   if (inputFile.empty() && modelFile.empty())
@@ -121,9 +135,12 @@ int main(int argc, char** argv)
     Log::Fatal << "Tolerance must be positive (received " << tolerance << ")."
         << endl;
 
-  // Optimizer has to be L-BFGS or SGD.
-  if (optimizerType != "lbfgs" && optimizerType != "sgd")
-    Log::Fatal << "--optimizer must be 'lbfgs' or 'sgd'." << endl;
+  // Optimizer has to be L-BFGS or one of the SGD variants.
+  const bool sgdVariant = (optimizerType == "sgd" ||
+      optimizerType == "minibatch-sgd" || optimizerType == "parallel-sgd");
+  if (optimizerType != "lbfgs" && !sgdVariant)
+    Log::Fatal << "--optimizer must be 'lbfgs', 'sgd', 'minibatch-sgd', or "
+        << "'parallel-sgd'." << endl;
 
   // Lambda must be positive.
   if (lambda < 0.0)
@@ -135,10 +152,14 @@ int main(int argc, char** argv)
     Log::Fatal << "Decision boundary (--decision_boundary) must be between 0.0 "
         << "and 1.0 (received " << decisionBoundary << ")." << endl;
 
-  if ((stepSize < 0.0) && (optimizerType == "sgd"))
+  if ((stepSize < 0.0) && sgdVariant)
     Log::Fatal << "Step size (--step_size) must be positive (received "
         << stepSize << ")." << endl;
 
+  if ((batchSize <= 0) && (optimizerType == "minibatch-sgd"))
+    Log::Fatal << "Batch size (--batch_size) must be positive (received "
+        << batchSize << ")." << endl;
+
   // These are the matrices we might use.
   arma::mat regressors;
   arma::mat responses;
@@ -188,7 +209,7 @@ int main(int argc, char** argv)
   {
     // We need to train the model.  Prepare the optimizers.
     arma::vec responsesVec = responses.unsafe_col(0);
-    LogisticRegressionFunction lrf(regressors, responsesVec, lambda);
+    LogisticRegressionFunction<> lrf(regressors, responsesVec, lambda);
     // Set the initial point, if necessary.
     if (!model.empty())
     {
@@ -199,7 +220,11 @@ int main(int argc, char** argv)
 
     if (optimizerType == "lbfgs")
     {
-      L_BFGS<LogisticRegressionFunction> lbfgsOpt(lrf);
+      // L-BFGS evaluates the objective over all of the points at once, so
+      // the points are split between threads.
+      DataParallelFunction<LogisticRegressionFunction<> > parallelLrf(lrf);
+      L_BFGS<DataParallelFunction<LogisticRegressionFunction<> > > lbfgsOpt(
+          parallelLrf);
       lbfgsOpt.MaxIterations() = maxIterations;
       lbfgsOpt.MinGradientNorm() = tolerance;
       Log::Info << "Training model with L-BFGS optimizer." << endl;
@@ -211,7 +236,7 @@ int main(int argc, char** argv)
     }
     else if (optimizerType == "sgd")
     {
-      SGD<LogisticRegressionFunction> sgdOpt(lrf);
+      SGD<LogisticRegressionFunction<> > sgdOpt(lrf);
       sgdOpt.MaxIterations() = maxIterations;
       sgdOpt.Tolerance() = tolerance;
       sgdOpt.StepSize() = stepSize;
@@ -222,6 +247,34 @@ int main(int argc, char** argv)
       // Extract the newly trained model.
       model = lr.Parameters();
     }
+    else if (optimizerType == "minibatch-sgd")
+    {
+      MiniBatchSGD<LogisticRegressionFunction<> > sgdOpt(lrf);
+      sgdOpt.MaxIterations() = maxIterations;
+      sgdOpt.Tolerance() = tolerance;
+      sgdOpt.StepSize() = stepSize;
+      sgdOpt.BatchSize() = (size_t) batchSize;
+      Log::Info << "Training model with mini-batch SGD optimizer (batch size "
+          << batchSize << ")." << endl;
+
+      // This will train the model.
+      LogisticRegression<MiniBatchSGD> lr(sgdOpt);
+      // Extract the newly trained model.
+      model = lr.Parameters();
+    }
+    else if (optimizerType == "parallel-sgd")
+    {
+      ParallelSGD<LogisticRegressionFunction<> > sgdOpt(lrf);
+      sgdOpt.MaxIterations() = maxIterations;
+      sgdOpt.Tolerance() = tolerance;
+      sgdOpt.StepSize() = stepSize;
+      Log::Info << "Training model with parallel SGD optimizer." << endl;
+
+      // This will train the model.
+      LogisticRegression<ParallelSGD> lr(sgdOpt);
+      // Extract the newly trained model.
+      model = lr.Parameters();
+    }
   }
 
   if (!testSet.empty())
@@ -2,13 +2,10 @@
  * @file mvu.cpp
  * @author Ryan Curtin
  *
- * Implementation of the MVU class and its auxiliary objective function class.
- *
- * Note: this implementation of MVU does not work.  See #189.
+ * Implementation of the MVU class.
  */
 #include "mvu.hpp"
 
-//#include <mlpack/core/optimizers/aug_lagrangian/aug_lagrangian.hpp>
 #include <mlpack/core/optimizers/lrsdp/lrsdp.hpp>
 
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
@@ -16,6 +13,7 @@
 using namespace mlpack;
 using namespace mlpack::mvu;
 using namespace mlpack::optimization;
+using namespace mlpack::neighbor;
 
 MVU::MVU(const arma::mat& data) : data(data)
 {
@@ -26,82 +24,239 @@ void MVU::Unfold(const size_t newDim,
                  const size_t numNeighbors,
                  arma::mat& outputData)
 {
-  // First we have to choose the output point.  We'll take a linear projection
-  // of the data for now (this is probably not a good final solution).
-//  outputData = trans(data.rows(0, newDim - 1));
-  // Following Nick's idea.
-  outputData.randu(data.n_cols, newDim);
-
-  // The number of constraints is the number of nearest neighbors plus one.
-  LRSDP mvuSolver(numNeighbors * data.n_cols + 1, outputData);
-
-  // Set up the objective.  Because we are maximizing the trace of (R R^T),
-  // we'll instead state it as min(-I_n * (R R^T)), meaning C() is -I_n.
-  mvuSolver.C().eye(data.n_cols, data.n_cols);
-  mvuSolver.C() *= -1;
-
-  // Now set up each of the constraints.
-  // The first constraint is trace(ones * R * R^T) = 0.
-  mvuSolver.B()[0] = 0;
-  mvuSolver.A()[0].ones(data.n_cols, data.n_cols);
+  std::vector<std::pair<size_t, size_t> > edges;
+  NeighborEdges(numNeighbors, edges);
+
+  // Without landmarks, the weights are the identity: each point is its own
+  // row of the solution.
+  arma::umat locations(2, data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    locations(0, i) = i;
+    locations(1, i) = i;
+  }
+  const arma::vec values = arma::ones<arma::vec>(data.n_cols);
+  const arma::sp_mat weights(locations, values, data.n_cols, data.n_cols);
+
+  Unfold(newDim, edges, weights, outputData);
+}
+
+void MVU::Unfold(const size_t newDim,
+                 const size_t numNeighbors,
+                 const size_t numLandmarks,
+                 arma::mat& outputData)
+{
+  if (numLandmarks <= newDim || numLandmarks > data.n_cols)
+  {
+    Log::Fatal << "MVU::Unfold(): invalid number of landmarks ("
+        << numLandmarks << "); must be greater than the new dimensionality ("
+        << newDim << ") and at most the number of points (" << data.n_cols
+        << ")." << std::endl;
+  }
+
+  // Choose the landmarks at random.
+  const arma::uvec order = arma::shuffle(arma::linspace<arma::uvec>(0,
+      data.n_cols - 1, data.n_cols));
+
+  Unfold(newDim, numNeighbors, order.subvec(0, numLandmarks - 1), outputData);
+}
+
+void MVU::Unfold(const size_t newDim,
+                 const size_t numNeighbors,
+                 const arma::uvec& landmarks,
+                 arma::mat& outputData)
+{
+  if (landmarks.n_elem <= newDim)
+  {
+    Log::Fatal << "MVU::Unfold(): invalid number of landmarks ("
+        << landmarks.n_elem << "); must be greater than the new "
+        << "dimensionality (" << newDim << ")." << std::endl;
+  }
+
+  std::vector<std::pair<size_t, size_t> > edges;
+  NeighborEdges(numNeighbors, edges);
 
-  // All of our other constraints will be sparse except the first.  So set that
-  // vector of modes accordingly.
-  mvuSolver.AModes().ones();
-  mvuSolver.AModes()[0] = 0;
+  arma::sp_mat weights;
+  ReconstructionWeights(landmarks, numNeighbors, weights);
+
+  Unfold(newDim, edges, weights, outputData);
+}
 
-  // Now all of the other constraints.  We first have to run AllkNN to get the
-  // list of nearest neighbors.
+void MVU::NeighborEdges(const size_t numNeighbors,
+                        std::vector<std::pair<size_t, size_t> >& edges) const
+{
   arma::Mat<size_t> neighbors;
   arma::mat distances;
 
   AllkNN allknn(data);
   allknn.Search(numNeighbors, neighbors, distances);
 
-  // Add each of the other constraints.  They are sparse constraints:
-  //   Tr(A_ij K) = d_ij;
-  //   A_ij = zeros except for 1 at (i, i), (j, j); -1 at (i, j), (j, i).
+  // If j is a neighbor of i and i is a neighbor of j, the constraint is only
+  // needed once.
+  edges.clear();
+  edges.reserve(neighbors.n_elem);
   for (size_t i = 0; i < neighbors.n_cols; ++i)
   {
     for (size_t j = 0; j < numNeighbors; ++j)
     {
-      // This is the index of the constraint.
-      const size_t index = (i * numNeighbors) + j + 1;
+      const size_t neighbor = neighbors(j, i);
+      edges.push_back(std::make_pair(std::min(i, neighbor),
+          std::max(i, neighbor)));
+    }
+  }
 
-      arma::mat& aRef = mvuSolver.A()[index];
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
 
-      aRef.set_size(3, 4);
+  Log::Info << "Nearest neighbor graph has " << edges.size() << " edges."
+      << std::endl;
+}
 
-      // A_ij(i, i) = 1.
-      aRef(0, 0) = i;
-      aRef(1, 0) = i;
-      aRef(2, 0) = 1;
+void MVU::ReconstructionWeights(const arma::uvec& landmarks,
+                                const size_t numNeighbors,
+                                arma::sp_mat& weights) const
+{
+  // The index of each point in the landmarks (or landmarks.n_elem, if the
+  // point is not a landmark).
+  std::vector<size_t> landmarkIndex(data.n_cols, landmarks.n_elem);
+  for (size_t i = 0; i < landmarks.n_elem; ++i)
+  {
+    if (landmarks[i] >= data.n_cols ||
+        landmarkIndex[landmarks[i]] != landmarks.n_elem)
+    {
+      Log::Fatal << "MVU: invalid landmark " << landmarks[i] << " (landmarks "
+          << "must be distinct points of the dataset)!" << std::endl;
+    }
 
-      // A_ij(i, j) = -1.
-      aRef(0, 1) = i;
-      aRef(1, 1) = neighbors(j, i);
-      aRef(2, 1) = -1;
+    landmarkIndex[landmarks[i]] = i;
+  }
 
-      // A_ij(j, i) = -1.
-      aRef(0, 2) = neighbors(j, i);
-      aRef(1, 2) = i;
-      aRef(2, 2) = -1;
+  const arma::mat landmarkData = data.cols(landmarks);
+  const size_t k = std::min(numNeighbors, (size_t) landmarks.n_elem);
 
-      // A_ij(j, j) = 1.
-      aRef(0, 3) = neighbors(j, i);
-      aRef(1, 3) = neighbors(j, i);
-      aRef(2, 3) = 1;
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+
+  AllkNN allknn(landmarkData, data);
+  allknn.Search(k, neighbors, distances);
+
+  arma::umat locations(2, data.n_cols * k);
+  arma::vec values(data.n_cols * k);
+  size_t nonzeros = 0;
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    if (landmarkIndex[i] != landmarks.n_elem)
+    {
+      locations(0, nonzeros) = landmarkIndex[i];
+      locations(1, nonzeros) = i;
+      values[nonzeros++] = 1.0;
+      continue;
+    }
+
+    // Find the weights, summing to one, which best reconstruct the point from
+    // its nearest landmarks, as in LLE: solve G w = 1 for the local Gram
+    // matrix G, which is regularized in case it is singular.
+    const arma::uvec indices = arma::conv_to<arma::uvec>::from(
+        neighbors.col(i));
+    arma::mat offsets = landmarkData.cols(indices);
+    offsets.each_col() -= data.col(i);
+
+    arma::mat gram = trans(offsets) * offsets;
+    const double regularization = 1e-3 * trace(gram);
+    gram.diag() += (regularization > 0.0) ? regularization : 1e-3;
 
-      // The constraint b_ij is the distance between these two points.
-      mvuSolver.B()[index] = distances(j, i);
+    arma::vec w = arma::solve(gram, arma::ones<arma::vec>(k));
+    w /= accu(w);
+
+    for (size_t j = 0; j < k; ++j)
+    {
+      locations(0, nonzeros) = indices[j];
+      locations(1, nonzeros) = i;
+      values[nonzeros++] = w[j];
     }
   }
 
+  locations.resize(2, nonzeros);
+  values.resize(nonzeros);
+  weights = arma::sp_mat(locations, values, landmarks.n_elem, data.n_cols);
+}
+
+void MVU::Unfold(const size_t newDim,
+                 const std::vector<std::pair<size_t, size_t> >& edges,
+                 const arma::sp_mat& weights,
+                 arma::mat& outputData)
+{
+  // The embedding is Y = W^T R, for the weights W and the solution R, which
+  // has one row for each row of the weights.  We'll start from a random R.
+  arma::mat coordinates;
+  coordinates.randu(weights.n_rows, newDim);
+
+  // The number of constraints is the number of edges plus one.
+  LRSDP mvuSolver(edges.size() + 1, coordinates);
+
+  // Set up the objective.  Because we are maximizing the trace of (Y Y^T) =
+  // Tr(W W^T R R^T), we'll instead state it as min(-W W^T * (R R^T)), meaning
+  // C() is -W W^T (which is -I_n without landmarks).
+  const arma::sp_mat weightsT = trans(weights);
+  mvuSolver.SparseC() = weights * weightsT;
+  mvuSolver.SparseC() *= -1;
+
+  // All of the constraints are rank-one: Tr(a a^T R R^T) = || R^T a ||^2.
+  mvuSolver.AModes().fill(3);
+
+  // The first constraint centers the embedding: Y^T 1 = R^T (W 1) = 0.
+  arma::vec center = arma::zeros<arma::vec>(weights.n_rows);
+  for (arma::sp_mat::const_iterator it = weights.begin(); it != weights.end();
+      ++it)
+    center[it.row()] += (*it);
+
+  arma::mat& centerRef = mvuSolver.A()[0];
+  centerRef.set_size(2, weights.n_rows);
+  for (size_t i = 0; i < weights.n_rows; ++i)
+  {
+    centerRef(0, i) = i;
+    centerRef(1, i) = center[i];
+  }
+  mvuSolver.B()[0] = 0;
+
+  // Each other constraint keeps the squared distance of an edge (i, j):
+  //   || y_i - y_j ||^2 = || R^T (w_i - w_j) ||^2 = || x_i - x_j ||^2,
+  // where w_i is column i of the weights (e_i without landmarks).
+  for (size_t e = 0; e < edges.size(); ++e)
+  {
+    const size_t i = edges[e].first;
+    const size_t j = edges[e].second;
+
+    arma::mat& aRef = mvuSolver.A()[e + 1];
+    aRef.set_size(2, (weights.col_ptrs[i + 1] - weights.col_ptrs[i]) +
+        (weights.col_ptrs[j + 1] - weights.col_ptrs[j]));
+
+    // Repeated indices are fine; their values are summed.
+    size_t entry = 0;
+    for (arma::sp_mat::const_iterator it = weights.begin_col(i);
+        it != weights.end_col(i); ++it, ++entry)
+    {
+      aRef(0, entry) = it.row();
+      aRef(1, entry) = (*it);
+    }
+    for (arma::sp_mat::const_iterator it = weights.begin_col(j);
+        it != weights.end_col(j); ++it, ++entry)
+    {
+      aRef(0, entry) = it.row();
+      aRef(1, entry) = -(*it);
+    }
+
+    mvuSolver.B()[e + 1] = metric::SquaredEuclideanDistance::Evaluate(
+        data.col(i), data.col(j));
+  }
+
   // Now on with the solving.
-  double objective = mvuSolver.Optimize(outputData);
+  double objective = mvuSolver.Optimize(coordinates);
 
   Log::Info << "Final objective is " << objective << "." << std::endl;
 
-  // Revert to original data format.
-  outputData = trans(outputData);
+  // Compute the embedding, in the original data format (one point per
+  // column).
+  const arma::mat embedding = weightsT * coordinates;
+  outputData = trans(embedding);
 }
@@ -3,11 +3,10 @@
  * @author Ryan Curtin
  *
  * An implementation of Maximum Variance Unfolding.  This file defines an MVU
- * class as well as a class representing the objective function (a semidefinite
- * program) which MVU seeks to minimize.  Minimization is performed by the
- * Augmented Lagrangian optimizer (which in turn uses the L-BFGS optimizer).
- *
- * Note: this implementation of MVU does not work.  See #189.
+ * class, which sets up the semidefinite program which MVU solves from the
+ * nearest neighbor graph of the data.  The program is solved by LRSDP, which
+ * uses the Augmented Lagrangian optimizer (which in turn uses the L-BFGS
+ * optimizer).
  */
 #ifndef __MLPACK_METHODS_MVU_MVU_HPP
 #define __MLPACK_METHODS_MVU_MVU_HPP
@@ -23,18 +22,127 @@ namespace mvu {
  *
  * - dataset
  * - new dimensionality
+ * - number of nearest neighbors
+ * - number of landmarks (optional)
+ *
+ * MVU finds the embedding of largest variance which keeps the distances between
+ * each point and its nearest neighbors.  The nearest neighbor graph is
+ * computed with AllkNN; each (undirected) edge of the graph gives one distance
+ * constraint, and one more constraint centers the embedding.  Each constraint
+ * is passed to LRSDP as a rank-one constraint with only a few nonzero entries,
+ * and the objective as a sparse matrix, so no n x n matrix is ever formed:
+ * the memory used is O(n (k + d)) for n points, k neighbors, and a new
+ * dimensionality of d.
+ *
+ * With landmarks, the embedding is only solved for a random subset of m
+ * landmark points, and each point is placed at a fixed linear combination of
+ * the landmarks nearest to it (with weights which best reconstruct the point
+ * from those landmarks in the original space, as in LLE).  The distance
+ * constraints still cover the whole nearest neighbor graph, but the
+ * semidefinite program has only m x d variables.  See
+ *
+ * @code
+ * @inproceedings{weinberger2005nonlinear,
+ *   title={Nonlinear Dimensionality Reduction by Semidefinite Programming and
+ *       Kernel Matrix Factorization},
+ *   author={Weinberger, Kilian Q. and Packer, Benjamin D. and Saul, Lawrence
+ *       K.},
+ *   booktitle={Proceedings of the Tenth International Workshop on Artificial
+ *       Intelligence and Statistics (AISTATS 2005)},
+ *   pages={381--388},
+ *   year={2005}
+ * }
+ * @endcode
  */
 class MVU
 {
  public:
   MVU(const arma::mat& dataIn);
 
+  /**
+   * Unfold the dataset into the given number of dimensions.
+   *
+   * @param newDim New dimensionality of the dataset.
+   * @param numNeighbors Number of nearest neighbors of each point to keep the
+   *     distances to.
+   * @param outputCoordinates Matrix to store the unfolded dataset in (one
+   *     point per column).
+   */
   void Unfold(const size_t newDim,
               const size_t numNeighbors,
               arma::mat& outputCoordinates);
 
+  /**
+   * Unfold the dataset into the given number of dimensions with landmark MVU,
+   * solving the embedding only for the given number of randomly chosen
+   * landmark points.
+   *
+   * @param newDim New dimensionality of the dataset.
+   * @param numNeighbors Number of nearest neighbors of each point to keep the
+   *     distances to (and number of landmarks to reconstruct each point from).
+   * @param numLandmarks Number of landmark points.
+   * @param outputCoordinates Matrix to store the unfolded dataset in (one
+   *     point per column).
+   */
+  void Unfold(const size_t newDim,
+              const size_t numNeighbors,
+              const size_t numLandmarks,
+              arma::mat& outputCoordinates);
+
+  /**
+   * Unfold the dataset into the given number of dimensions with landmark MVU,
+   * using the given landmark points.  Each other point i is placed at
+   * sum_j weights(j, i) * y_{landmarks[j]}, for the weights given by
+   * ReconstructionWeights().
+   *
+   * @param newDim New dimensionality of the dataset.
+   * @param numNeighbors Number of nearest neighbors of each point to keep the
+   *     distances to (and number of landmarks to reconstruct each point from).
+   * @param landmarks Indices of the landmark points (distinct, and more than
+   *     newDim of them).
+   * @param outputCoordinates Matrix to store the unfolded dataset in (one
+   *     point per column).
+   */
+  void Unfold(const size_t newDim,
+              const size_t numNeighbors,
+              const arma::uvec& landmarks,
+              arma::mat& outputCoordinates);
+
+  /**
+   * Compute the weights which best reconstruct each point from its nearest
+   * landmarks, as in LLE: the weights of a point sum to one, and minimize the
+   * (slightly regularized) squared distance between the point and the
+   * weighted sum of the landmarks.  Column i of the weights holds the weights
+   * of point i, and row j the weights of landmarks[j]; a landmark is its own
+   * reconstruction.
+   *
+   * @param landmarks Indices of the landmark points.
+   * @param numNeighbors Number of landmarks to reconstruct each point from.
+   * @param weights Sparse matrix to store the weights in (number of landmarks
+   *     x number of points).
+   */
+  void ReconstructionWeights(const arma::uvec& landmarks,
+                             const size_t numNeighbors,
+                             arma::sp_mat& weights) const;
+
  private:
   const arma::mat& data;
+
+  /**
+   * Find the edges of the nearest neighbor graph of the data, each undirected
+   * edge only once (with the smaller index first).
+   */
+  void NeighborEdges(const size_t numNeighbors,
+                     std::vector<std::pair<size_t, size_t> >& edges) const;
+
+  /**
+   * Solve MVU for the embedding trans(weights) * R, where R holds one row for
+   * each column of the weights.
+   */
+  void Unfold(const size_t newDim,
+              const std::vector<std::pair<size_t, size_t> >& edges,
+              const arma::sp_mat& weights,
+              arma::mat& outputCoordinates);
 };
 
 }; // namespace mvu
@@ -3,8 +3,6 @@
  * @author Ryan Curtin
  *
  * Executable for MVU.
- *
- * Note: this implementation of MVU does not work.  See #189.
  */
 #include <mlpack/core.hpp>
 #include "mvu.hpp"
@@ -13,7 +11,12 @@ PROGRAM_INFO("Maximum Variance Unfolding (MVU)", "This program implements "
     "Maximum Variance Unfolding, a nonlinear dimensionality reduction "
     "technique.  The method minimizes dimensionality by unfolding a manifold "
     "such that the distances to the nearest neighbors of each point are held "
-    "constant.");
+    "constant."
+    "\n\n"
+    "For larger datasets, landmark MVU can be used by specifying a number of "
+    "landmarks with --landmarks (-l); then the embedding is only solved for "
+    "that many randomly chosen landmark points, and every other point is "
+    "reconstructed from its nearest landmarks.");
 
 PARAM_STRING_REQ("input_file", "Filename of input dataset.", "i");
 PARAM_INT_REQ("new_dim", "New dimensionality of dataset.", "d");
@@ -22,6 +25,8 @@ PARAM_STRING("output_file", "Filename to save unfolded dataset to.", "o",
     "output.csv");
 PARAM_INT("num_neighbors", "Number of nearest neighbors to consider while "
     "unfolding.", "k", 5);
+PARAM_INT("landmarks", "Number of landmark points to use for landmark MVU (0 "
+    "means landmarks are not used).", "l", 0);
 
 using namespace mlpack;
 using namespace mlpack::mvu;
@@ -59,11 +64,25 @@ int main(int argc, char **argv)
         << data.n_cols << ")." << std::endl;
   }
 
+  // Verify that the number of landmarks is valid.
+  const int numLandmarks = CLI::GetParam<int>("landmarks");
+  if (numLandmarks != 0 && (numLandmarks <= newDim ||
+      numLandmarks > (int) data.n_cols))
+  {
+    Log::Fatal << "Invalid number of landmarks (" << numLandmarks << ").  "
+        << "Must be 0 (no landmarks), or greater than the new dimensionality "
+        << "and at most the number of points in the input dataset ("
+        << data.n_cols << ")." << std::endl;
+  }
+
   // Now run MVU.
   MVU mvu(data);
 
   mat output;
-  mvu.Unfold(newDim, numNeighbors, output);
+  if (numLandmarks == 0)
+    mvu.Unfold(newDim, numNeighbors, output);
+  else
+    mvu.Unfold(newDim, numNeighbors, numLandmarks, output);
 
   // Save results to file.
   const string outputFile = CLI::GetParam<string>("output_file");
@@ -39,11 +39,30 @@ PROGRAM_INFO("All K-Nearest-Neighbors",
     "neighbors output file corresponds to the index of the point in the "
     "reference set which is the i'th nearest neighbor from the point in the "
     "query set with index j.  Row i and column j in the distances output file "
-    "corresponds to the distance between those two points.");
+    "corresponds to the distance between those two points."
+    "\n\n"
+    "The reference tree can be saved with --reference_tree_out and loaded in a "
+    "later run with --reference_tree_in (instead of --reference_file), so that "
+    "it does not have to be built again.  A saved tree is mapped into memory "
+    "when it is loaded, so loading is almost instant even for large trees.  "
+    "The tree type options (--cover_tree, --r_tree) must be the same when the "
+    "tree is loaded as when it was saved."
+    "\n\n"
+    "With --epsilon, approximate search is used, which can be much faster.  To "
+    "measure the quality of approximate results, give the output of an exact "
+    "search with --true_neighbors_file and --true_distances_file; the recall "
+    "(the fraction of the true neighbors that were found) and the effective "
+    "error (the average relative error of the distances) are then printed.  "
+    "With -v, the 'computing_neighbors' timer of each run gives the speedup."
+    "\n\n"
+    "With --block_base_cases, dual-tree search with kd-trees computes the "
+    "distances between the points of two leaves at once, with a matrix "
+    "multiplication; compare the 'computing_neighbors' timer with and without "
+    "it to see whether it is faster for a dataset.");
 
 // Define our input parameters that this program will take.
-PARAM_STRING_REQ("reference_file", "File containing the reference dataset.",
-    "r");
+PARAM_STRING("reference_file", "File containing the reference dataset.", "r",
+    "");
 PARAM_STRING_REQ("distances_file", "File to output distances into.", "d");
 PARAM_STRING_REQ("neighbors_file", "File to output neighbors into.", "n");
 
@@ -59,9 +78,83 @@ PARAM_FLAG("cover_tree", "If true, use cover trees to perform the search "
     "(experimental, may be slow).", "c");
 PARAM_FLAG("r_tree", "If true, use an R-Tree to perform the search "
     "(experimental, may be slow.).", "T");
+PARAM_STRING("r_tree_build", "Algorithm used to build R trees (with --r_tree):"
+    " 'insert' (insert each point in turn), 'str' (Sort-Tile-Recursive bulk "
+    "loading), or 'hilbert' (Hilbert curve bulk loading).  Bulk loading is "
+    "much faster and gives fully packed leaves.", "b", "insert");
+PARAM_DOUBLE("epsilon", "If nonzero, approximate search is used: the "
+    "distance to each neighbor found is at most (1 + epsilon) times the "
+    "distance to the true neighbor of the same rank.", "e", 0.0);
+PARAM_STRING("true_neighbors_file", "File of the neighbors found by exact "
+    "search, to calculate the recall of approximate search.", "t", "");
+PARAM_STRING("true_distances_file", "File of the distances found by exact "
+    "search, to calculate the effective error of approximate search.", "D", "");
+PARAM_FLAG("block_base_cases", "If true, the distances between the points of "
+    "two leaves are computed at once in dual-tree search with kd-trees.", "B");
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
 PARAM_INT("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
+PARAM_STRING("reference_tree_in", "File containing a reference tree saved with "
+    "--reference_tree_out, to use instead of --reference_file.", "i", "");
+PARAM_STRING("reference_tree_out", "File to save the reference tree to.", "o",
+    "");
+
+// The kd-tree type used for the search.
+typedef BinarySpaceTree<bound::HRectBound<2>,
+    NeighborSearchStat<NearestNeighborSort> > KDTreeType;
+
+// The cover tree type used for the search.
+typedef CoverTree<metric::LMetric<2, true>, tree::FirstPointIsRoot,
+    NeighborSearchStat<NearestNeighborSort> > CoverTreeType;
+
+// The R tree type used for the search.
+typedef RectangleTree<tree::RStarTreeSplit<tree::RStarTreeDescentHeuristic,
+    NeighborSearchStat<NearestNeighborSort>, arma::mat>,
+    tree::RStarTreeDescentHeuristic, NeighborSearchStat<NearestNeighborSort>,
+    arma::mat> RStarTreeType;
+
+/**
+ * Build an R tree on the given data with the given construction algorithm
+ * ('insert', 'str', or 'hilbert').
+ */
+RStarTreeType* BuildRTree(arma::mat& data,
+                          const string& method,
+                          const size_t leafSize)
+{
+  if (method == "str")
+  {
+    return new RStarTreeType(data, tree::STRBulkLoad(), leafSize,
+        leafSize * 0.4, 5, 2);
+  }
+  else if (method == "hilbert")
+  {
+    return new RStarTreeType(data, tree::HilbertBulkLoad(), leafSize,
+        leafSize * 0.4, 5, 2);
+  }
+  else
+  {
+    return new RStarTreeType(data, leafSize, leafSize * 0.4, 5, 2, 0);
+  }
+}
+
+/**
+ * Save the reference tree to the file given with --reference_tree_out, if one
+ * was given.
+ */
+template<typename TreeType>
+void SaveReferenceTree(const TreeType& tree,
+                       const std::vector<size_t>& oldFromNew =
+                           std::vector<size_t>())
+{
+  const string filename = CLI::GetParam<string>("reference_tree_out");
+  if (filename != "")
+  {
+    Log::Info << "Saving reference tree to '" << filename << "'..." << endl;
+    Timer::Start("tree_saving");
+    SaveTree(filename, tree, oldFromNew);
+    Timer::Stop("tree_saving");
+  }
+}
 
 int main(int argc, char *argv[])
 {
@@ -76,6 +169,7 @@ int main(int argc, char *argv[])
   // Get all the parameters.
   const string referenceFile = CLI::GetParam<string>("reference_file");
   const string queryFile = CLI::GetParam<string>("query_file");
+  const string referenceTreeIn = CLI::GetParam<string>("reference_tree_in");
 
   const string distancesFile = CLI::GetParam<string>("distances_file");
   const string neighborsFile = CLI::GetParam<string>("neighbors_file");
@@ -87,13 +181,68 @@ int main(int argc, char *argv[])
   bool naive = CLI::HasParam("naive");
   bool singleMode = CLI::HasParam("single_mode");
   const bool randomBasis = CLI::HasParam("random_basis");
+  const double epsilon = CLI::GetParam<double>("epsilon");
+
+  if (referenceFile == "" && referenceTreeIn == "")
+  {
+    Log::Fatal << "Either --reference_file or --reference_tree_in must be "
+        << "specified." << endl;
+  }
+
+  if (referenceFile != "" && referenceTreeIn != "")
+  {
+    Log::Warn << "--reference_file ignored because --reference_tree_in is "
+        << "present." << endl;
+  }
+
+  // The basis of a saved tree is not known.
+  if (randomBasis && referenceTreeIn != "")
+  {
+    Log::Fatal << "--random_basis cannot be used with --reference_tree_in."
+        << endl;
+  }
+
+  // A loaded reference tree holds the reference set.  Only the tree of the type
+  // being used is loaded.
+  LoadedTree<KDTreeType>* kdTreeIn = NULL;
+  LoadedTree<RStarTreeType>* rTreeIn = NULL;
+  LoadedTree<CoverTreeType>* coverTreeIn = NULL;
 
   arma::mat referenceData;
   arma::mat queryData; // So it doesn't go out of scope.
-  data::Load(referenceFile, referenceData, true);
+  arma::mat* referenceSet = &referenceData;
+  if (referenceTreeIn != "")
+  {
+    Timer::Start("tree_loading");
+    if (CLI::HasParam("cover_tree"))
+    {
+      coverTreeIn = new LoadedTree<CoverTreeType>(referenceTreeIn);
+      referenceSet = &coverTreeIn->Dataset();
+    }
+    else if (CLI::HasParam("r_tree"))
+    {
+      rTreeIn = new LoadedTree<RStarTreeType>(referenceTreeIn);
+      referenceSet = &rTreeIn->Dataset();
+    }
+    else
+    {
+      kdTreeIn = new LoadedTree<KDTreeType>(referenceTreeIn);
+      referenceSet = &kdTreeIn->Dataset();
+    }
+    Timer::Stop("tree_loading");
+
+    Log::Info << "Loaded reference tree from '" << referenceTreeIn << "' ("
+        << referenceSet->n_rows << " x " << referenceSet->n_cols << ")."
+        << endl;
+  }
+  else
+  {
+    data::Load(referenceFile, referenceData, true);
 
-  Log::Info << "Loaded reference data from '" << referenceFile << "' ("
-      << referenceData.n_rows << " x " << referenceData.n_cols << ")." << endl;
+    Log::Info << "Loaded reference data from '" << referenceFile << "' ("
+        << referenceData.n_rows << " x " << referenceData.n_cols << ")."
+        << endl;
+  }
 
   if (queryFile != "")
   {
@@ -104,11 +253,11 @@ int main(int argc, char *argv[])
 
   // Sanity check on k value: must be greater than 0, must be less than the
   // number of reference points.  Since it is unsigned, we only test the upper bound.
-  if (k > referenceData.n_cols)
+  if (k > referenceSet->n_cols)
   {
     Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less ";
     Log::Fatal << "than or equal to the number of reference points (";
-    Log::Fatal << referenceData.n_cols << ")." << endl;
+    Log::Fatal << referenceSet->n_cols << ")." << endl;
   }
 
   // Sanity check on leaf size.
@@ -124,7 +273,30 @@ int main(int argc, char *argv[])
   {
     Log::Warn << "--single_mode ignored because --naive is present." << endl;
   }
+
+  // Sanity check on epsilon.
+  if (epsilon < 0)
+  {
+    Log::Fatal << "Invalid epsilon: " << epsilon << ".  Must be non-negative."
+        << endl;
+  }
+
+  // A loaded tree is used as it was built.
+  if (naive && referenceTreeIn != "")
+  {
+    Log::Warn << "--naive ignored because --reference_tree_in is present."
+        << endl;
+    naive = false;
+  }
  
+  // Sanity check on the R tree construction algorithm.
+  const string rTreeBuild = CLI::GetParam<string>("r_tree_build");
+  if (rTreeBuild != "insert" && rTreeBuild != "str" && rTreeBuild != "hilbert")
+  {
+    Log::Fatal << "Invalid R tree construction algorithm '" << rTreeBuild
+        << "'; must be 'insert', 'str', or 'hilbert'." << endl;
+  }
+
    // cover_tree overrides r_tree.
   if (CLI::HasParam("cover_tree") && CLI::HasParam("r_tree"))
   {
@@ -186,17 +358,25 @@ int main(int argc, char *argv[])
 
       // Build trees by hand, so we can save memory: if we pass a tree to
       // NeighborSearch, it does not copy the matrix.
-      Log::Info << "Building reference tree..." << endl;
-      Timer::Start("tree_building");
+      KDTreeType* refTree = NULL;
+      if (kdTreeIn)
+      {
+        refTree = &kdTreeIn->Tree();
+        oldFromNewRefs = kdTreeIn->OldFromNew();
+      }
+      else
+      {
+        Log::Info << "Building reference tree..." << endl;
+        Timer::Start("tree_building");
 
-      BinarySpaceTree<bound::HRectBound<2>,
-	  NeighborSearchStat<NearestNeighborSort> >
-	  refTree(referenceData, oldFromNewRefs, leafSize);
-      BinarySpaceTree<bound::HRectBound<2>,
-	  NeighborSearchStat<NearestNeighborSort> >*
-	  queryTree = NULL; // Empty for now.
+        refTree = new KDTreeType(referenceData, oldFromNewRefs, leafSize);
 
-      Timer::Stop("tree_building");
+        Timer::Stop("tree_building");
+      }
+
+      SaveReferenceTree(*refTree, oldFromNewRefs);
+
+      KDTreeType* queryTree = NULL; // Empty for now.
 
       std::vector<size_t> oldFromNewQueries;
 
@@ -223,14 +403,14 @@ int main(int argc, char *argv[])
 	  Timer::Stop("tree_building");
 	}
 
-	allknn = new AllkNN(&refTree, queryTree, referenceData, queryData,
+	allknn = new AllkNN(refTree, queryTree, *referenceSet, queryData,
 	    singleMode);
 
 	Log::Info << "Tree built." << endl;
       }
       else
       {
-	allknn = new AllkNN(&refTree, referenceData, singleMode);
+	allknn = new AllkNN(refTree, *referenceSet, singleMode);
 
 	Log::Info << "Trees built." << endl;
       }
@@ -239,6 +419,8 @@ int main(int argc, char *argv[])
       arma::Mat<size_t> neighborsOut;
 
       Log::Info << "Computing " << k << " nearest neighbors..." << endl;
+      allknn->Epsilon() = epsilon;
+      allknn->BlockBaseCases() = CLI::HasParam("block_base_cases");
       allknn->Search(k, neighborsOut, distancesOut);
 
       Log::Info << "Neighbors computed." << endl;
@@ -260,79 +442,68 @@ int main(int argc, char *argv[])
       // Clean up.
       if (queryTree)
 	delete queryTree;
+      if (!kdTreeIn)
+	delete refTree;
 
       delete allknn;
     } else { // R tree.
       // Make sure to notify the user that they are using an r tree.
       Log::Info << "Using R tree for nearest-neighbor calculation." << endl;
-      
+
       // Because we may construct it differently, we need a pointer.
       NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>,
-      RectangleTree<tree::RStarTreeSplit<tree::RStarTreeDescentHeuristic, NeighborSearchStat<NearestNeighborSort>, arma::mat>,
-         tree::RStarTreeDescentHeuristic,
-         NeighborSearchStat<NearestNeighborSort>,
-         arma::mat> >* allknn = NULL;
+          RStarTreeType>* allknn = NULL;
 
       // Build trees by hand, so we can save memory: if we pass a tree to
       // NeighborSearch, it does not copy the matrix.
-      Log::Info << "Building reference tree..." << endl;
-      Timer::Start("tree_building");
+      RStarTreeType* refTree = NULL;
+      if (rTreeIn)
+      {
+        refTree = &rTreeIn->Tree();
+      }
+      else
+      {
+        Log::Info << "Building reference tree..." << endl;
+        Timer::Start("tree_building");
 
-      RectangleTree<tree::RStarTreeSplit<tree::RStarTreeDescentHeuristic, NeighborSearchStat<NearestNeighborSort>, arma::mat>,
-         tree::RStarTreeDescentHeuristic,
-         NeighborSearchStat<NearestNeighborSort>,
-         arma::mat>
-      refTree(referenceData, leafSize, leafSize * 0.4, 5, 2, 0);
+        refTree = BuildRTree(referenceData, rTreeBuild, leafSize);
 
-      RectangleTree<tree::RStarTreeSplit<tree::RStarTreeDescentHeuristic, NeighborSearchStat<NearestNeighborSort>, arma::mat>,
-         tree::RStarTreeDescentHeuristic,
-         NeighborSearchStat<NearestNeighborSort>,
-         arma::mat>*
-      queryTree = NULL; // Empty for now.
+        Timer::Stop("tree_building");
+      }
+
+      SaveReferenceTree(*refTree);
+
+      RStarTreeType* queryTree = NULL; // Empty for now.
 
-      Timer::Stop("tree_building");
-      
       if (CLI::GetParam<string>("query_file") != "")
       {
         Log::Info << "Loaded query data from '" << queryFile << "' ("
           << queryData.n_rows << " x " << queryData.n_cols << ")." << endl;
-          
+
         // Build trees by hand, so we can save memory: if we pass a tree to
         // NeighborSearch, it does not copy the matrix.
         if (!singleMode)
         {
           Timer::Start("tree_building");
 
-          queryTree = new RectangleTree<tree::RStarTreeSplit<tree::RStarTreeDescentHeuristic, NeighborSearchStat<NearestNeighborSort>, arma::mat>,
-          tree::RStarTreeDescentHeuristic,
-          NeighborSearchStat<NearestNeighborSort>,
-          arma::mat>(queryData, leafSize, leafSize * 0.4, 5, 2, 0);
+          queryTree = BuildRTree(queryData, rTreeBuild, leafSize);
 
           Timer::Stop("tree_building");
         }
-          
-
-        allknn = new NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>,
-        RectangleTree<tree::RStarTreeSplit<tree::RStarTreeDescentHeuristic, NeighborSearchStat<NearestNeighborSort>, arma::mat>,
-          tree::RStarTreeDescentHeuristic,
-          NeighborSearchStat<NearestNeighborSort>,
-          arma::mat> >(&refTree, queryTree,
-          referenceData, queryData, singleMode);
+
+        allknn = new NeighborSearch<NearestNeighborSort,
+            metric::LMetric<2, true>, RStarTreeType>(refTree, queryTree,
+            *referenceSet, queryData, singleMode);
       } else
       {
-        allknn = new NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>,
-        RectangleTree<tree::RStarTreeSplit<tree::RStarTreeDescentHeuristic, NeighborSearchStat<NearestNeighborSort>, arma::mat>,
-          tree::RStarTreeDescentHeuristic,
-          NeighborSearchStat<NearestNeighborSort>,
-          arma::mat> >(&refTree,
-          referenceData, singleMode);
+        allknn = new NeighborSearch<NearestNeighborSort,
+            metric::LMetric<2, true>, RStarTreeType>(refTree, *referenceSet,
+            singleMode);
       }
       Log::Info << "Tree built." << endl;
-      
-      //arma::mat distancesOut;
-      //arma::Mat<size_t> neighborsOut;
 
       Log::Info << "Computing " << k << " nearest neighbors..." << endl;
+      allknn->Epsilon() = epsilon;
       allknn->Search(k, neighbors, distances);
 
       Log::Info << "Neighbors computed." << endl;
@@ -340,6 +511,8 @@ int main(int argc, char *argv[])
       if(queryTree)
         delete queryTree;
       delete allknn;
+      if (!rTreeIn)
+        delete refTree;
     }
   }
   else // Cover trees.
@@ -347,19 +520,26 @@ int main(int argc, char *argv[])
     // Make sure to notify the user that they are using cover trees.
     Log::Info << "Using cover trees for nearest-neighbor calculation." << endl;
 
-    // Build our reference tree.
-    Log::Info << "Building reference tree..." << endl;
-    Timer::Start("tree_building");
-    CoverTree<metric::LMetric<2, true>, tree::FirstPointIsRoot,
-        NeighborSearchStat<NearestNeighborSort> > referenceTree(referenceData,
-        1.3);
-    CoverTree<metric::LMetric<2, true>, tree::FirstPointIsRoot,
-        NeighborSearchStat<NearestNeighborSort> >* queryTree = NULL;
-    Timer::Stop("tree_building");
+    // Build our reference tree, unless it was loaded.
+    CoverTreeType* referenceTree = NULL;
+    if (coverTreeIn)
+    {
+      referenceTree = &coverTreeIn->Tree();
+    }
+    else
+    {
+      Log::Info << "Building reference tree..." << endl;
+      Timer::Start("tree_building");
+      referenceTree = new CoverTreeType(referenceData, 1.3);
+      Timer::Stop("tree_building");
+    }
+
+    SaveReferenceTree(*referenceTree);
+
+    CoverTreeType* queryTree = NULL;
 
     NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>,
-        CoverTree<metric::LMetric<2, true>, tree::FirstPointIsRoot,
-        NeighborSearchStat<NearestNeighborSort> > >* allknn = NULL;
+        CoverTreeType>* allknn = NULL;
 
     // See if we have query data.
     if (CLI::HasParam("query_file"))
@@ -369,26 +549,22 @@ int main(int argc, char *argv[])
       {
         Log::Info << "Building query tree..." << endl;
         Timer::Start("tree_building");
-        queryTree = new CoverTree<metric::LMetric<2, true>,
-            tree::FirstPointIsRoot, NeighborSearchStat<NearestNeighborSort> >(
-            queryData, 1.3);
+        queryTree = new CoverTreeType(queryData, 1.3);
         Timer::Stop("tree_building");
       }
 
       allknn = new NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>,
-          CoverTree<metric::LMetric<2, true>, tree::FirstPointIsRoot,
-          NeighborSearchStat<NearestNeighborSort> > >(&referenceTree, queryTree,
-          referenceData, queryData, singleMode);
+          CoverTreeType>(referenceTree, queryTree, *referenceSet, queryData,
+          singleMode);
     }
     else
     {
       allknn = new NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>,
-          CoverTree<metric::LMetric<2, true>, tree::FirstPointIsRoot,
-          NeighborSearchStat<NearestNeighborSort> > >(&referenceTree,
-          referenceData, singleMode);
+          CoverTreeType>(referenceTree, *referenceSet, singleMode);
     }
 
     Log::Info << "Computing " << k << " nearest neighbors..." << endl;
+    allknn->Epsilon() = epsilon;
     allknn->Search(k, neighbors, distances);
 
     Log::Info << "Neighbors computed." << endl;
@@ -397,6 +573,32 @@ int main(int argc, char *argv[])
 
     if (queryTree)
       delete queryTree;
+    if (!coverTreeIn)
+      delete referenceTree;
+  }
+
+  // The loaded trees hold the reference set, so they are deleted last.
+  delete kdTreeIn;
+  delete rTreeIn;
+  delete coverTreeIn;
+
+  // Compare with the results of exact search, if they were given.
+  const string trueNeighborsFile = CLI::GetParam<string>("true_neighbors_file");
+  if (trueNeighborsFile != "")
+  {
+    arma::Mat<size_t> trueNeighbors;
+    data::Load(trueNeighborsFile, trueNeighbors, true);
+    Log::Info << "Recall: " << AllkNN::Recall(neighbors, trueNeighbors) << "."
+        << endl;
+  }
+
+  const string trueDistancesFile = CLI::GetParam<string>("true_distances_file");
+  if (trueDistancesFile != "")
+  {
+    arma::mat trueDistances;
+    data::Load(trueDistancesFile, trueDistances, true);
+    Log::Info << "Effective error: "
+        << AllkNN::EffectiveError(distances, trueDistances) << "." << endl;
   }
 
   // Save put.
@@ -68,12 +68,14 @@ class NeighborSearch
    *      dual-tree search).
    * @param leafSize Leaf size for tree construction (ignored if tree is given).
    * @param metric An optional instance of the MetricType class.
+   * @param epsilon Relative error allowed in the results (see Epsilon()).
    */
   NeighborSearch(const typename TreeType::Mat& referenceSet,
                  const typename TreeType::Mat& querySet,
                  const bool naive = false,
                  const bool singleMode = false,
-                 const MetricType metric = MetricType());
+                 const MetricType metric = MetricType(),
+                 const double epsilon = 0.0);
 
   /**
    * Initialize the NeighborSearch object, passing only one dataset, which is
@@ -95,11 +97,13 @@ class NeighborSearch
    *      dual-tree search).
    * @param leafSize Leaf size for tree construction (ignored if tree is given).
    * @param metric An optional instance of the MetricType class.
+   * @param epsilon Relative error allowed in the results (see Epsilon()).
    */
   NeighborSearch(const typename TreeType::Mat& referenceSet,
                  const bool naive = false,
                  const bool singleMode = false,
-                 const MetricType metric = MetricType());
+                 const MetricType metric = MetricType(),
+                 const double epsilon = 0.0);
 
   /**
    * Initialize the NeighborSearch object with the given datasets and
@@ -129,13 +133,15 @@ class NeighborSearch
    * @param singleMode Whether single-tree computation should be used (as
    *      opposed to dual-tree computation).
    * @param metric Instantiated distance metric.
+   * @param epsilon Relative error allowed in the results (see Epsilon()).
    */
   NeighborSearch(TreeType* referenceTree,
                  TreeType* queryTree,
                  const typename TreeType::Mat& referenceSet,
                  const typename TreeType::Mat& querySet,
                  const bool singleMode = false,
-                 const MetricType metric = MetricType());
+                 const MetricType metric = MetricType(),
+                 const double epsilon = 0.0);
 
   /**
    * Initialize the NeighborSearch object with the given reference dataset and
@@ -163,11 +169,13 @@ class NeighborSearch
    * @param singleMode Whether single-tree computation should be used (as
    *      opposed to dual-tree computation).
    * @param metric Instantiated distance metric.
+   * @param epsilon Relative error allowed in the results (see Epsilon()).
    */
   NeighborSearch(TreeType* referenceTree,
                  const typename TreeType::Mat& referenceSet,
                  const bool singleMode = false,
-                 const MetricType metric = MetricType());
+                 const MetricType metric = MetricType(),
+                 const double epsilon = 0.0);
 
 
   /**
@@ -192,6 +200,68 @@ class NeighborSearch
               arma::Mat<size_t>& resultingNeighbors,
               arma::mat& distances);
 
+  /**
+   * Compute the nearest neighbors with a budget for each query point, for
+   * applications where the time of each query matters more than exact results.
+   * The reference tree is searched best-first (the node which may hold the
+   * closest point is visited next), and the search for a query point stops
+   * when it has calculated maxBaseCases distances or visited maxVisits nodes;
+   * the neighbors are then the best found so far.  If fewer than k points were
+   * looked at, the remaining neighbors have index (size_t() - 1) and the worst
+   * possible distance.
+   *
+   * For each query point, exact is set to whether the results are provably the
+   * true neighbors: whether every node which was not visited could be pruned
+   * (and epsilon is 0).  The given budget is used regardless of the search mode
+   * given to the constructor, but naive search is not supported.  This is only
+   * available for trees with a BestFirstSingleTreeTraverser (BinarySpaceTree).
+   *
+   * @param k Number of neighbors to search for.
+   * @param maxBaseCases Maximum number of distance calculations for each query
+   *     point (0 means no limit).
+   * @param maxVisits Maximum number of tree nodes visited for each query point
+   *     (0 means no limit).
+   * @param resultingNeighbors Matrix storing lists of neighbors for each query
+   *     point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   * @param exact Vector storing, for each query point, whether its results are
+   *     exact.
+   */
+  void BudgetedSearch(const size_t k,
+                      const size_t maxBaseCases,
+                      const size_t maxVisits,
+                      arma::Mat<size_t>& resultingNeighbors,
+                      arma::mat& distances,
+                      std::vector<bool>& exact);
+
+  /**
+   * Calculate the recall of approximate search results: the fraction of the
+   * true neighbors of each query point which were found, averaged over all
+   * query points.  The order of the neighbors of each point does not matter.
+   * The matrices must have the same size.
+   *
+   * @param foundNeighbors Neighbors found by approximate search.
+   * @param realNeighbors True neighbors (from exact search).
+   * @return Recall, between 0 and 1.
+   */
+  static double Recall(const arma::Mat<size_t>& foundNeighbors,
+                       const arma::Mat<size_t>& realNeighbors);
+
+  /**
+   * Calculate the effective error of approximate search results: the average
+   * relative difference between the distance to each neighbor that was found
+   * and the true distance for that rank, |found - real| / real.  Neighbors
+   * whose true distance is zero are not counted.  The matrices must have the
+   * same size.
+   *
+   * @param foundDistances Distances found by approximate search.
+   * @param realDistances True distances (from exact search).
+   * @return Effective error.
+   */
+  static double EffectiveError(const arma::mat& foundDistances,
+                               const arma::mat& realDistances);
+
   //! Returns a string representation of this object.
   std::string ToString() const;
 
@@ -206,6 +276,31 @@ class NeighborSearch
   //! Modify the number of node combination scores.
   size_t& Scores() { return scores; }
 
+  /**
+   * Get the relative error allowed in the results.  If this is 0 (the
+   * default), the search is exact.  Otherwise, nodes are pruned when they can't
+   * improve a neighbor candidate by more than a factor of (1 + epsilon), so for
+   * nearest neighbor search, the distance to each neighbor which is found is at
+   * most (1 + epsilon) times the distance to the true neighbor of the same
+   * rank.  This applies to the value of the metric, so for the squared
+   * Euclidean distance the bound on the Euclidean distance is
+   * sqrt(1 + epsilon).  Naive search is always exact.
+   */
+  double Epsilon() const { return epsilon; }
+  //! Modify the relative error allowed in the results (see Epsilon()).
+  double& Epsilon() { return epsilon; }
+
+  /**
+   * Get whether dual-tree search computes the distances between the points of
+   * two leaves at once, with a matrix multiplication, when the rules support it
+   * (see tree::RuleTraits; this is the case for BinarySpaceTree and the
+   * Euclidean distance).  This is false by default; distances which are
+   * estimated this way have a relative error of at most 1e-10.
+   */
+  bool BlockBaseCases() const { return blockBaseCases; }
+  //! Modify whether block base cases are used (see BlockBaseCases()).
+  bool& BlockBaseCases() { return blockBaseCases; }
+
  private:
   //! Copy of reference dataset (if we need it, because tree building modifies
   //! it).
@@ -233,6 +328,11 @@ class NeighborSearch
   //! Indicates if single-tree search is being used (opposed to dual-tree).
   bool singleMode;
 
+  //! The relative error allowed in the results.
+  double epsilon;
+  //! If true, dual-tree search computes the base cases of two leaves at once.
+  bool blockBaseCases;
+
   //! Instantiation of metric.
   MetricType metric;
 
@@ -46,7 +46,8 @@ NeighborSearch(const typename TreeType::Mat& referenceSetIn,
                const typename TreeType::Mat& querySetIn,
                const bool naive,
                const bool singleMode,
-               const MetricType metric) :
+               const MetricType metric,
+               const double epsilon) :
     referenceSet(tree::TreeTraits<TreeType>::RearrangesDataset ? referenceCopy
         : referenceSetIn),
     querySet(tree::TreeTraits<TreeType>::RearrangesDataset ? queryCopy
@@ -57,6 +58,8 @@ NeighborSearch(const typename TreeType::Mat& referenceSetIn,
     hasQuerySet(true),
     naive(naive),
     singleMode(!naive && singleMode), // No single mode if naive.
+    epsilon(epsilon),
+    blockBaseCases(false),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -99,7 +102,8 @@ NeighborSearch<SortPolicy, MetricType, TreeType>::
 NeighborSearch(const typename TreeType::Mat& referenceSetIn,
                const bool naive,
                const bool singleMode,
-               const MetricType metric) :
+               const MetricType metric,
+               const double epsilon) :
     referenceSet(tree::TreeTraits<TreeType>::RearrangesDataset ? referenceCopy
         : referenceSetIn),
     querySet(tree::TreeTraits<TreeType>::RearrangesDataset ? referenceCopy
@@ -110,6 +114,8 @@ NeighborSearch(const typename TreeType::Mat& referenceSetIn,
     hasQuerySet(false),
     naive(naive),
     singleMode(!naive && singleMode), // No single mode if naive.
+    epsilon(epsilon),
+    blockBaseCases(false),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -147,7 +153,8 @@ NeighborSearch<SortPolicy, MetricType, TreeType>::NeighborSearch(
     const typename TreeType::Mat& referenceSet,
     const typename TreeType::Mat& querySet,
     const bool singleMode,
-    const MetricType metric) :
+    const MetricType metric,
+    const double epsilon) :
     referenceSet(referenceSet),
     querySet(querySet),
     referenceTree(referenceTree),
@@ -156,6 +163,8 @@ NeighborSearch<SortPolicy, MetricType, TreeType>::NeighborSearch(
     hasQuerySet(true),
     naive(false),
     singleMode(singleMode),
+    epsilon(epsilon),
+    blockBaseCases(false),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -169,7 +178,8 @@ NeighborSearch<SortPolicy, MetricType, TreeType>::NeighborSearch(
     TreeType* referenceTree,
     const typename TreeType::Mat& referenceSet,
     const bool singleMode,
-    const MetricType metric) :
+    const MetricType metric,
+    const double epsilon) :
     referenceSet(referenceSet),
     querySet(referenceSet),
     referenceTree(referenceTree),
@@ -178,6 +188,8 @@ NeighborSearch<SortPolicy, MetricType, TreeType>::NeighborSearch(
     hasQuerySet(false), // In this case we will own a tree, if singleMode.
     naive(false),
     singleMode(singleMode),
+    epsilon(epsilon),
+    blockBaseCases(false),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -222,6 +234,12 @@ void NeighborSearch<SortPolicy, MetricType, TreeType>::Search(
     arma::Mat<size_t>& resultingNeighbors,
     arma::mat& distances)
 {
+  if (epsilon < 0)
+  {
+    Log::Fatal << "NeighborSearch::Search(): epsilon must be non-negative "
+        << "(got " << epsilon << ")!" << std::endl;
+  }
+
   Timer::Start("computing_neighbors");
 
   // If we have built the trees ourselves, then we will have to map all the
@@ -249,7 +267,8 @@ void NeighborSearch<SortPolicy, MetricType, TreeType>::Search(
 
   // Create the helper object for the tree traversal.
   typedef NeighborSearchRules<SortPolicy, MetricType, TreeType> RuleType;
-  RuleType rules(referenceSet, querySet, *neighborPtr, *distancePtr, metric);
+  RuleType rules(referenceSet, querySet, *neighborPtr, *distancePtr, metric,
+      epsilon, blockBaseCases);
 
   if (naive)
   {
@@ -365,6 +384,157 @@ void NeighborSearch<SortPolicy, MetricType, TreeType>::Search(
   }
 } // Search
 
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearch<SortPolicy, MetricType, TreeType>::BudgetedSearch(
+    const size_t k,
+    const size_t maxBaseCases,
+    const size_t maxVisits,
+    arma::Mat<size_t>& resultingNeighbors,
+    arma::mat& distances,
+    std::vector<bool>& exact)
+{
+  if (naive)
+  {
+    Log::Fatal << "NeighborSearch::BudgetedSearch(): naive search is not "
+        << "supported!" << std::endl;
+  }
+
+  if (epsilon < 0)
+  {
+    Log::Fatal << "NeighborSearch::BudgetedSearch(): epsilon must be "
+        << "non-negative (got " << epsilon << ")!" << std::endl;
+  }
+
+  Timer::Start("computing_neighbors");
+
+  // The results are found in the order of the tree-building, and mapped
+  // afterwards if necessary.
+  arma::Mat<size_t> neighbors(k, querySet.n_cols);
+  neighbors.fill(size_t() - 1);
+  arma::mat newDistances(k, querySet.n_cols);
+  newDistances.fill(SortPolicy::WorstDistance());
+  std::vector<bool> newExact(querySet.n_cols);
+
+  typedef NeighborSearchRules<SortPolicy, MetricType, TreeType> RuleType;
+  RuleType rules(referenceSet, querySet, neighbors, newDistances, metric,
+      epsilon);
+
+  typename TreeType::template BestFirstSingleTreeTraverser<RuleType>
+      traverser(rules, maxBaseCases, maxVisits);
+
+  size_t numExact = 0;
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    traverser.Traverse(i, *referenceTree);
+
+    // With approximation, even a finished traversal is not exact.
+    newExact[i] = traverser.Exact() && (epsilon == 0.0);
+    if (newExact[i])
+      ++numExact;
+  }
+
+  scores += rules.Scores();
+  baseCases += rules.BaseCases();
+
+  Log::Info << rules.Scores() << " node combinations were scored.\n";
+  Log::Info << rules.BaseCases() << " base cases were calculated.\n";
+  Log::Info << numExact << " of " << querySet.n_cols << " query points have "
+      << "exact results.\n";
+
+  Timer::Stop("computing_neighbors");
+
+  // The references are reordered if we built the reference tree; the queries
+  // are too, unless they were not used to build a tree.
+  const bool mapReferences = treeOwner &&
+      tree::TreeTraits<TreeType>::RearrangesDataset;
+  const bool mapQueries = mapReferences && !(hasQuerySet && singleMode);
+
+  resultingNeighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+  exact.resize(querySet.n_cols);
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    size_t query = i;
+    if (mapQueries)
+      query = hasQuerySet ? oldFromNewQueries[i] : oldFromNewReferences[i];
+
+    distances.col(query) = newDistances.col(i);
+    exact[query] = newExact[i];
+
+    for (size_t j = 0; j < k; ++j)
+    {
+      const size_t neighbor = neighbors(j, i);
+      resultingNeighbors(j, query) = (mapReferences &&
+          neighbor != size_t() - 1) ? oldFromNewReferences[neighbor] :
+          neighbor;
+    }
+  }
+} // BudgetedSearch
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+double NeighborSearch<SortPolicy, MetricType, TreeType>::Recall(
+    const arma::Mat<size_t>& foundNeighbors,
+    const arma::Mat<size_t>& realNeighbors)
+{
+  if (foundNeighbors.n_rows != realNeighbors.n_rows ||
+      foundNeighbors.n_cols != realNeighbors.n_cols)
+  {
+    Log::Fatal << "NeighborSearch::Recall(): matrices have different sizes ("
+        << foundNeighbors.n_rows << "x" << foundNeighbors.n_cols << " and "
+        << realNeighbors.n_rows << "x" << realNeighbors.n_cols << ")!"
+        << std::endl;
+  }
+
+  if (realNeighbors.n_elem == 0)
+    return 1.0;
+
+  size_t found = 0;
+  for (size_t i = 0; i < realNeighbors.n_cols; ++i)
+  {
+    for (size_t j = 0; j < realNeighbors.n_rows; ++j)
+    {
+      for (size_t l = 0; l < foundNeighbors.n_rows; ++l)
+      {
+        if (foundNeighbors(l, i) == realNeighbors(j, i))
+        {
+          ++found;
+          break;
+        }
+      }
+    }
+  }
+
+  return (double) found / realNeighbors.n_elem;
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+double NeighborSearch<SortPolicy, MetricType, TreeType>::EffectiveError(
+    const arma::mat& foundDistances,
+    const arma::mat& realDistances)
+{
+  if (foundDistances.n_rows != realDistances.n_rows ||
+      foundDistances.n_cols != realDistances.n_cols)
+  {
+    Log::Fatal << "NeighborSearch::EffectiveError(): matrices have different "
+        << "sizes (" << foundDistances.n_rows << "x" << foundDistances.n_cols
+        << " and " << realDistances.n_rows << "x" << realDistances.n_cols
+        << ")!" << std::endl;
+  }
+
+  double error = 0.0;
+  size_t count = 0;
+  for (size_t i = 0; i < realDistances.n_elem; ++i)
+  {
+    if (realDistances[i] != 0.0)
+    {
+      error += std::abs(foundDistances[i] - realDistances[i]) /
+          realDistances[i];
+      ++count;
+    }
+  }
+
+  return (count == 0) ? 0.0 : error / count;
+}
 
 //Return a String of the Object.
 template<typename SortPolicy, typename MetricType, typename TreeType>
@@ -382,6 +552,7 @@ std::string NeighborSearch<SortPolicy, MetricType, TreeType>::ToString() const
     convert << "  QueryTree: " << queryTree << std::endl;
   convert << "  Tree Owner: " << treeOwner << std::endl;
   convert << "  Naive: " << naive << std::endl;
+  convert << "  Epsilon: " << epsilon << std::endl;
   convert << "  Metric: " << std::endl;
   convert << mlpack::util::Indent(metric.ToString(),2);
   return convert.str();
@@ -8,6 +8,8 @@
 #ifndef __MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_RULES_HPP
 #define __MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_RULES_HPP
 
+#include <mlpack/core/tree/tree_traits.hpp>
+#include <mlpack/core/metrics/block_distance_bounds.hpp>
 #include "ns_traversal_info.hpp"
 
 namespace mlpack {
@@ -21,7 +23,9 @@ class NeighborSearchRules
                       const typename TreeType::Mat& querySet,
                       arma::Mat<size_t>& neighbors,
                       arma::mat& distances,
-                      MetricType& metric);
+                      MetricType& metric,
+                      const double epsilon = 0.0,
+                      const bool blockBaseCases = false);
   /**
    * Get the distance from the query point to the reference point.
    * This will update the "neighbor" matrix with the new point if appropriate
@@ -32,6 +36,24 @@ class NeighborSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Run the base cases between each of the given query points and each of the
+   * given reference points, as if BaseCase() were called for each pair.  If
+   * BlockBaseCases() is set, bounds on all of the distances are computed at
+   * once (see metric::BlockDistanceBounds), and only the pairs which might give
+   * a better candidate and whose bounds are not tight are evaluated with the
+   * metric; otherwise, BaseCase() is called for each pair.  This is only
+   * available for the Euclidean and squared Euclidean distances on dense data
+   * (see tree::RuleTraits).
+   *
+   * @param queryIndices Indices of query points.
+   * @param referenceBegin Index of first reference point.
+   * @param referenceCount Number of reference points.
+   */
+  void BlockBaseCase(const std::vector<size_t>& queryIndices,
+                     const size_t referenceBegin,
+                     const size_t referenceCount);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -92,6 +114,11 @@ class NeighborSearchRules
   //! Modify the number of scores that have been performed.
   size_t& Scores() { return scores; }
 
+  //! Get whether BlockBaseCase() computes the distances of a block at once.
+  bool BlockBaseCases() const { return blockBaseCases; }
+  //! Modify whether BlockBaseCase() computes the distances of a block at once.
+  bool& BlockBaseCases() { return blockBaseCases; }
+
   //! Convenience typedef.
   typedef NeighborSearchTraversalInfo<TreeType> TraversalInfoType;
 
@@ -116,6 +143,10 @@ class NeighborSearchRules
   //! The instantiated metric.
   MetricType& metric;
 
+  //! The relative error allowed in the results; nodes are pruned if they
+  //! can't improve a candidate by more than a factor of (1 + epsilon).
+  double epsilon;
+
   //! The last query point BaseCase() was called with.
   size_t lastQueryIndex;
   //! The last reference point BaseCase() was called with.
@@ -128,6 +159,18 @@ class NeighborSearchRules
   //! The number of scores that have been performed.
   size_t scores;
 
+  //! If true, BlockBaseCase() computes the distances of a block at once.
+  bool blockBaseCases;
+  //! The squared norms of the query points (only calculated, once, by
+  //! BlockBaseCase()).
+  arma::vec queryNorms;
+  //! The squared norms of the reference points (only calculated, once, by
+  //! BlockBaseCase()).
+  arma::vec referenceNorms;
+  //! The bounds computed by BlockBaseCase(), whose memory is reused for each
+  //! block.
+  metric::BlockDistanceBounds<typename TreeType::Mat::elem_type> blockBounds;
+
   //! Traversal info for the parent combination; this is updated by the
   //! traversal before each call to Score().
   TraversalInfoType traversalInfo;
@@ -137,6 +180,18 @@ class NeighborSearchRules
    */
   double CalculateBound(TreeType& queryNode) const;
 
+  /**
+   * Add the given reference point to the candidates of the given query point,
+   * if the distance is better than that of the worst candidate.
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceIndex Index of reference point.
+   * @param distance Distance from query point to reference point.
+   */
+  void AddCandidate(const size_t queryIndex,
+                    const size_t referenceIndex,
+                    const double distance);
+
   /**
    * Insert a point into the neighbors and distances matrices; this is a helper
    * function.
@@ -153,6 +208,23 @@ class NeighborSearchRules
 };
 
 }; // namespace neighbor
+
+namespace tree {
+
+/**
+ * NeighborSearchRules can run many base cases at once when the distance is the
+ * Euclidean or squared Euclidean distance and the data is dense.
+ */
+template<typename SortPolicy, bool TakeRoot, typename TreeType>
+class RuleTraits<neighbor::NeighborSearchRules<SortPolicy,
+    metric::LMetric<2, TakeRoot>, TreeType> >
+{
+ public:
+  static const bool HasBlockBaseCase =
+      !arma::is_SpMat<typename TreeType::Mat>::value;
+};
+
+}; // namespace tree
 }; // namespace mlpack
 
 // Include implementation.
@@ -19,16 +19,20 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
     const typename TreeType::Mat& querySet,
     arma::Mat<size_t>& neighbors,
     arma::mat& distances,
-    MetricType& metric) :
+    MetricType& metric,
+    const double epsilon,
+    const bool blockBaseCases) :
     referenceSet(referenceSet),
     querySet(querySet),
     neighbors(neighbors),
     distances(distances),
     metric(metric),
+    epsilon(epsilon),
     lastQueryIndex(querySet.n_cols),
     lastReferenceIndex(referenceSet.n_cols),
     baseCases(0),
-    scores(0)
+    scores(0),
+    blockBaseCases(blockBaseCases)
 {
   // We must set the traversal info last query and reference node pointers to
   // something that is both invalid (i.e. not a tree node) and not NULL.  We'll
@@ -55,6 +59,18 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
                                     referenceSet.col(referenceIndex));
   ++baseCases;
 
+  AddCandidate(queryIndex, referenceIndex, distance);
+
+  return distance;
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+inline force_inline
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::AddCandidate(
+    const size_t queryIndex,
+    const size_t referenceIndex,
+    const double distance)
+{
   // If this distance is better than any of the current candidates, the
   // SortDistance() function will give us the position to insert it into.
   arma::vec queryDist = distances.unsafe_col(queryIndex);
@@ -70,8 +86,69 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
   lastQueryIndex = queryIndex;
   lastReferenceIndex = referenceIndex;
   lastBaseCase = distance;
+}
 
-  return distance;
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::BlockBaseCase(
+    const std::vector<size_t>& queryIndices,
+    const size_t referenceBegin,
+    const size_t referenceCount)
+{
+  if (!blockBaseCases)
+  {
+    for (size_t i = 0; i < queryIndices.size(); ++i)
+      for (size_t ref = referenceBegin; ref < referenceBegin + referenceCount;
+           ++ref)
+        BaseCase(queryIndices[i], ref);
+
+    return;
+  }
+
+  // The squared norms of all of the points are calculated the first time.
+  if (referenceNorms.n_elem == 0)
+    metric::SquaredNorms(referenceSet, referenceNorms);
+  if (queryNorms.n_elem == 0)
+  {
+    if (&querySet == &referenceSet)
+      queryNorms = referenceNorms;
+    else
+      metric::SquaredNorms(querySet, queryNorms);
+  }
+
+  blockBounds.Compute(metric, querySet, queryNorms, queryIndices, referenceSet,
+      referenceNorms, referenceBegin, referenceCount);
+
+  // Each pair counts as one base case, whether it is pruned, estimated, or
+  // evaluated with the metric.
+  for (size_t i = 0; i < queryIndices.size(); ++i)
+  {
+    const size_t queryIndex = queryIndices[i];
+    for (size_t j = 0; j < referenceCount; ++j)
+    {
+      const size_t referenceIndex = referenceBegin + j;
+
+      // A pair can only give a new candidate if some distance within its
+      // bounds is better than the worst candidate; otherwise, BaseCase() would
+      // not change anything either.
+      const double worstDistance = distances(distances.n_rows - 1, queryIndex);
+      if (!SortPolicy::IsBetter(blockBounds.Lower(i, j), worstDistance) &&
+          !SortPolicy::IsBetter(blockBounds.Upper(i, j), worstDistance))
+      {
+        ++baseCases;
+      }
+      else if (!blockBounds.Tight(i, j))
+      {
+        BaseCase(queryIndex, referenceIndex);
+      }
+      else if ((&querySet != &referenceSet) || (queryIndex != referenceIndex))
+      {
+        // The bounds are within a relative 1e-10 of each other, so the metric
+        // is not evaluated.
+        ++baseCases;
+        AddCandidate(queryIndex, referenceIndex, blockBounds.Distance(i, j));
+      }
+    }
+  }
 }
 
 template<typename SortPolicy, typename MetricType, typename TreeType>
@@ -109,8 +186,10 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
         &referenceNode);
   }
 
-  // Compare against the best k'th distance for this query point so far.
-  const double bestDistance = distances(distances.n_rows - 1, queryIndex);
+  // Compare against the best k'th distance for this query point so far
+  // (relaxed, for approximate search).
+  const double bestDistance = SortPolicy::Relax(
+      distances(distances.n_rows - 1, queryIndex), epsilon);
 
   return (SortPolicy::IsBetter(distance, bestDistance)) ? distance : DBL_MAX;
 }
@@ -126,7 +205,8 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Rescore(
     return oldScore;
 
   // Just check the score again against the distances.
-  const double bestDistance = distances(distances.n_rows - 1, queryIndex);
+  const double bestDistance = SortPolicy::Relax(
+      distances(distances.n_rows - 1, queryIndex), epsilon);
 
   return (SortPolicy::IsBetter(oldScore, bestDistance)) ? oldScore : DBL_MAX;
 }
@@ -398,8 +478,15 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::
   queryNode.Stat().FirstBound() = worstDistance;
   queryNode.Stat().SecondBound() = bestDistance;
 
-  if (SortPolicy::IsBetter(worstDistance, bestDistance))
-    return worstDistance;
+  // For approximate search, the first bound is relaxed.  Pruning with it only
+  // misses points which can't improve the current candidates of any descendant
+  // by more than a factor of (1 + epsilon).  The second bound is not relaxed:
+  // it comes from the candidates of other points, which may themselves be
+  // approximate.  The cached bounds are not relaxed, since they are used to
+  // build the bounds of other nodes.
+  const double relaxedDistance = SortPolicy::Relax(worstDistance, epsilon);
+  if (SortPolicy::IsBetter(relaxedDistance, bestDistance))
+    return relaxedDistance;
   else
     return bestDistance;
 }
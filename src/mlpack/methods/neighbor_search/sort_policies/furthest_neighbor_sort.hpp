@@ -145,6 +145,19 @@ class FurthestNeighborSort
    */
   static inline double CombineWorst(const double a, const double b)
   { return std::max(a - b, 0.0); }
+
+  /**
+   * Return the given pruning bound relaxed for (1 + epsilon)-approximate
+   * search: a candidate only has to be better than this to be considered, so
+   * any neighbor which is missed is at most (1 + epsilon) times further than
+   * the neighbor which is found instead.
+   */
+  static inline double Relax(const double value, const double epsilon)
+  {
+    if (value >= DBL_MAX / (1 + epsilon))
+      return DBL_MAX;
+    return value * (1 + epsilon);
+  }
 };
 
 }; // namespace neighbor
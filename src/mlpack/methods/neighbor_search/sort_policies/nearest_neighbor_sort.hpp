@@ -150,6 +150,19 @@ class NearestNeighborSort
       return DBL_MAX;
     return a + b;
   }
+
+  /**
+   * Return the given pruning bound relaxed for (1 + epsilon)-approximate
+   * search: a candidate only has to be better than this to be considered, so
+   * any neighbor which is missed is at most (1 + epsilon) times closer than the
+   * neighbor which is found instead.
+   */
+  static inline double Relax(const double value, const double epsilon)
+  {
+    if (value == DBL_MAX)
+      return DBL_MAX;
+    return value / (1 + epsilon);
+  }
 };
 
 }; // namespace neighbor
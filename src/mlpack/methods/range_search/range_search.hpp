@@ -12,6 +12,11 @@
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include "range_search_stat.hpp"
+#include "visitors/vector_range_visitor.hpp"
+#include "visitors/csr_range_visitor.hpp"
+#include "visitors/mapped_range_visitor.hpp"
+#include "visitors/count_range_visitor.hpp"
+#include "visitors/aggregate_range_visitor.hpp"
 
 namespace mlpack {
 namespace range /** Range-search routines. */ {
@@ -21,6 +26,13 @@ namespace range /** Range-search routines. */ {
  * is implemented in the style of a generalized tree-independent dual-tree
  * algorithm; for more details on the actual algorithm, see the RangeSearchRules
  * class.
+ *
+ * If mlpack is compiled with OpenMP, searches are done in parallel, with the
+ * number of threads given by OmpGetMaxThreads() (which can be controlled by
+ * the OMP_NUM_THREADS environment variable or OmpSetNumThreads()).  In
+ * dual-tree mode, disjoint subtrees of the query tree are handed out to the
+ * threads; otherwise, query points are.  Each thread stores its results
+ * separately.
  */
 template<typename MetricType = mlpack::metric::EuclideanDistance,
          typename TreeType = tree::BinarySpaceTree<bound::HRectBound<2>,
@@ -181,6 +193,109 @@ class RangeSearch
               std::vector<std::vector<size_t> >& neighbors,
               std::vector<std::vector<double> >& distances);
 
+  /**
+   * Search for all points in the given range, returning the results in
+   * compressed sparse row (CSR) format.  This is far more compact than the
+   * vector-of-vectors format, because results are not stored in a separate
+   * allocation for each query point.
+   *
+   * That is:
+   *
+   * - offsets.n_elem is equal to the number of query points plus one.
+   *
+   * - The indices of the reference points in the range of query point i are
+   *   neighbors[offsets[i]] through neighbors[offsets[i + 1] - 1].
+   *
+   * - distances[j] is the distance corresponding to neighbors[j].
+   *
+   * - The neighbors of each query point are not sorted in any particular
+   *   order.
+   *
+   * @param range Range of distances in which to search.
+   * @param offsets Object which will hold the offset of the first neighbor of
+   *      each query point (and the total number of neighbors at the end).
+   * @param neighbors Object which will hold the indices of all the neighbors.
+   * @param distances Object which will hold the distances of all the
+   *      neighbors.
+   */
+  void Search(const math::Range& range,
+              arma::Col<size_t>& offsets,
+              arma::Col<size_t>& neighbors,
+              arma::vec& distances);
+
+  /**
+   * Search for all points in the given range, passing each result to the given
+   * visitor as it is found, instead of storing the results.  The visitor must
+   * implement the function
+   *
+   * @code
+   * void Visit(const size_t queryIndex,
+   *            const size_t referenceIndex,
+   *            const double distance);
+   * @endcode
+   *
+   * which is called once for each reference point in the range of each query
+   * point.  Indices are mapped back to the original indices of the datasets
+   * (if the trees were built by this object).  Results are not passed in any
+   * particular order.
+   *
+   * If RangeVisitorTraits<VisitorType>::ParallelQueries is true, the search is
+   * done in parallel, and the visitor is copied for each thread.
+   *
+   * @param range Range of distances in which to search.
+   * @param visitor Visitor which will receive the results.
+   */
+  template<typename VisitorType>
+  void Search(const math::Range& range, VisitorType& visitor);
+
+  /**
+   * Count the number of reference points in the given range of each query
+   * point, without storing the points themselves.  When every point in a
+   * reference node is known to be in range of a query point, the whole node is
+   * counted at once, so the cost of the search depends on the number of nodes
+   * visited, not the number of results.
+   *
+   * @param range Range of distances in which to search.
+   * @param counts Object which will hold the number of reference points in
+   *      range of each query point.
+   */
+  void Count(const math::Range& range, arma::Col<size_t>& counts);
+
+  /**
+   * For each query point, count the number of reference points in the given
+   * range, and calculate the sum and mean of the values associated with those
+   * reference points (for instance, to compute density features).  As with
+   * Count(), whole reference nodes are added at once when possible.  The values
+   * should be given in the order of the original reference set.
+   *
+   * If no reference points are in range of a query point, its mean is 0.
+   *
+   * @param range Range of distances in which to search.
+   * @param values Value associated with each reference point.
+   * @param counts Object which will hold the number of reference points in
+   *      range of each query point.
+   * @param sums Object which will hold the sum of the values of the reference
+   *      points in range of each query point.
+   * @param means Object which will hold the mean of the values of the reference
+   *      points in range of each query point.
+   */
+  void Aggregate(const math::Range& range,
+                 const arma::vec& values,
+                 arma::Col<size_t>& counts,
+                 arma::vec& sums,
+                 arma::vec& means);
+
+  /**
+   * Get whether dual-tree search computes the distances between the points of
+   * two leaves at once, with a matrix multiplication, when the rules support it
+   * (see tree::RuleTraits; this is the case for BinarySpaceTree and the
+   * Euclidean distance).  This is false by default; distances which are
+   * estimated this way have a relative error of at most 1e-10.
+   */
+  bool BlockBaseCases() const { return blockBaseCases; }
+  //! Modify whether block base cases are used (see BlockBaseCases()).
+  bool& BlockBaseCases() { return blockBaseCases; }
+
   // Returns a string representation of this object. 
   std::string ToString() const;
 
@@ -221,6 +336,37 @@ class RangeSearch
 
   //! The number of pruned nodes during computation.
   size_t numPrunes;
+
+  //! If true, dual-tree search computes the base cases of two leaves at once.
+  bool blockBaseCases;
+
+  /**
+   * Perform the search, without mapping any indices.  If there is more than one
+   * visitor, the search is done in parallel with (at most) one thread for each
+   * visitor; thread i passes its results to visitors[i], and each query point
+   * is handled by only one thread.
+   */
+  template<typename VisitorType>
+  void Traverse(const math::Range& range, std::vector<VisitorType>& visitors);
+
+  /**
+   * Get the mapping from query indices used during the traversal to original
+   * query indices, or NULL if no mapping is necessary.
+   */
+  const std::vector<size_t>* QueryMap() const;
+
+  /**
+   * Get the mapping from reference indices used during the traversal to
+   * original reference indices, or NULL if no mapping is necessary.
+   */
+  const std::vector<size_t>* ReferenceMap() const;
+
+  /**
+   * Map a vector with one element per query point from the order used during
+   * the traversal back to the original order of the query points.
+   */
+  template<typename VecType>
+  void UnmapQueries(const VecType& in, VecType& out) const;
 };
 
 }; // namespace range
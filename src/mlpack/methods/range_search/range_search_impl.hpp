@@ -13,6 +13,8 @@
 // The rules for traversal.
 #include "range_search_rules.hpp"
 
+#include <mlpack/core/tree/split_query_tree.hpp>
+
 namespace mlpack {
 namespace range {
 
@@ -55,7 +57,8 @@ RangeSearch<MetricType, TreeType>::RangeSearch(
     naive(naive),
     singleMode(!naive && singleMode), // Naive overrides single mode.
     metric(metric),
-    numPrunes(0)
+    numPrunes(0),
+    blockBaseCases(false)
 {
   // Build the trees.
   Timer::Start("range_search/tree_building");
@@ -101,7 +104,8 @@ RangeSearch<MetricType, TreeType>::RangeSearch(
     naive(naive),
     singleMode(!naive && singleMode), // Naive overrides single mode.
     metric(metric),
-    numPrunes(0)
+    numPrunes(0),
+    blockBaseCases(false)
 {
   // Build the trees.
   Timer::Start("range_search/tree_building");
@@ -143,7 +147,8 @@ RangeSearch<MetricType, TreeType>::RangeSearch(
     naive(false),
     singleMode(singleMode),
     metric(metric),
-    numPrunes(0)
+    numPrunes(0),
+    blockBaseCases(false)
 {
   // Nothing else to initialize.
 }
@@ -163,7 +168,8 @@ RangeSearch<MetricType, TreeType>::RangeSearch(
     naive(false),
     singleMode(singleMode),
     metric(metric),
-    numPrunes(0)
+    numPrunes(0),
+    blockBaseCases(false)
 {
   // If doing dual-tree range search, we must clone the reference tree.
   if (!singleMode)
@@ -192,65 +198,224 @@ void RangeSearch<MetricType, TreeType>::Search(
     std::vector<std::vector<size_t> >& neighbors,
     std::vector<std::vector<double> >& distances)
 {
-  Timer::Start("range_search/computing_neighbors");
+  // Resize each vector.
+  neighbors.clear(); // Just in case there was anything in it.
+  neighbors.resize(querySet.n_cols);
+  distances.clear();
+  distances.resize(querySet.n_cols);
+
+  // Results are mapped back to the original indices as they are found.
+  VectorRangeVisitor visitor(neighbors, distances);
+  Search(range, visitor);
+}
 
-  // Set size of prunes to 0.
-  numPrunes = 0;
+template<typename MetricType, typename TreeType>
+void RangeSearch<MetricType, TreeType>::Search(
+    const math::Range& range,
+    arma::Col<size_t>& offsets,
+    arma::Col<size_t>& neighbors,
+    arma::vec& distances)
+{
+  // Each thread collects its results in its own buffers, and the buffers are
+  // merged at the end.
+  std::vector<CSRRangeVisitor> buffers(OmpGetMaxThreads());
+  std::vector<MappedRangeVisitor<CSRRangeVisitor> > visitors;
+  for (size_t i = 0; i < buffers.size(); ++i)
+  {
+    visitors.push_back(MappedRangeVisitor<CSRRangeVisitor>(buffers[i],
+        QueryMap(), ReferenceMap()));
+  }
 
-  // If we have built the trees ourselves, then we will have to map all the
-  // indices back to their original indices when this computation is finished.
-  // To avoid extra copies, we will store the unmapped neighbors and distances
-  // in a separate object.
-  std::vector<std::vector<size_t> >* neighborPtr = &neighbors;
-  std::vector<std::vector<double> >* distancePtr = &distances;
+  Traverse(range, visitors);
 
-  // Mapping is only necessary if the tree rearranges points.
-  if (tree::TreeTraits<TreeType>::RearrangesDataset)
+  for (size_t i = 1; i < buffers.size(); ++i)
+    buffers[0].Merge(buffers[i]);
+
+  buffers[0].Finalize(querySet.n_cols, offsets, neighbors, distances);
+}
+
+template<typename MetricType, typename TreeType>
+template<typename VisitorType>
+void RangeSearch<MetricType, TreeType>::Search(const math::Range& range,
+                                               VisitorType& visitor)
+{
+  // Indices are mapped back to the original indices (if necessary) as results
+  // are found.  If the visitor allows it, the search is done in parallel, and
+  // each thread gets its own copy of the visitor.
+  const size_t numThreads = RangeVisitorTraits<VisitorType>::ParallelQueries ?
+      OmpGetMaxThreads() : 1;
+  std::vector<MappedRangeVisitor<VisitorType> > visitors(numThreads,
+      MappedRangeVisitor<VisitorType>(visitor, QueryMap(), ReferenceMap()));
+
+  Traverse(range, visitors);
+}
+
+template<typename MetricType, typename TreeType>
+void RangeSearch<MetricType, TreeType>::Count(const math::Range& range,
+                                              arma::Col<size_t>& counts)
+{
+  // The counts are calculated in the order of the query set held by this
+  // object, and mapped back afterwards.
+  arma::Col<size_t> treeCounts(querySet.n_cols);
+  treeCounts.zeros();
+
+  // Each thread gets its own copy of the visitor.
+  std::vector<CountRangeVisitor> visitors(OmpGetMaxThreads(),
+      CountRangeVisitor(treeCounts));
+  Traverse(range, visitors);
+
+  UnmapQueries(treeCounts, counts);
+}
+
+template<typename MetricType, typename TreeType>
+void RangeSearch<MetricType, TreeType>::Aggregate(const math::Range& range,
+                                                  const arma::vec& values,
+                                                  arma::Col<size_t>& counts,
+                                                  arma::vec& sums,
+                                                  arma::vec& means)
+{
+  if (values.n_elem != referenceSet.n_cols)
   {
-    if (treeOwner && !(singleMode && hasQuerySet))
-      distancePtr = new std::vector<std::vector<double> >; // Query indices need to be mapped.
+    Log::Fatal << "RangeSearch::Aggregate(): number of values ("
+        << values.n_elem << ") must be equal to the number of reference "
+        << "points (" << referenceSet.n_cols << ")!" << std::endl;
+  }
 
-    if (treeOwner)
-      neighborPtr = new std::vector<std::vector<size_t> >; // All indices need mapping.
+  // The visitor needs the values in the order of the reference tree.
+  arma::vec treeValues;
+  const std::vector<size_t>* referenceMap = ReferenceMap();
+  if (referenceMap != NULL)
+  {
+    treeValues.set_size(values.n_elem);
+    for (size_t i = 0; i < values.n_elem; ++i)
+      treeValues[i] = values[(*referenceMap)[i]];
   }
 
-  // Resize each vector.
-  neighborPtr->clear(); // Just in case there was anything in it.
-  neighborPtr->resize(querySet.n_cols);
-  distancePtr->clear();
-  distancePtr->resize(querySet.n_cols);
+  arma::Col<size_t> treeCounts(querySet.n_cols);
+  treeCounts.zeros();
+  arma::vec treeSums(querySet.n_cols);
+  treeSums.zeros();
+
+  // Each thread gets its own copy of the visitor.
+  std::vector<AggregateRangeVisitor> visitors(OmpGetMaxThreads(),
+      AggregateRangeVisitor((referenceMap == NULL) ? values : treeValues,
+      treeCounts, treeSums));
+  Traverse(range, visitors);
 
-  // Create the helper object for the traversal.
-  typedef RangeSearchRules<MetricType, TreeType> RuleType;
-  RuleType rules(referenceSet, querySet, range, *neighborPtr, *distancePtr,
-      metric);
+  UnmapQueries(treeCounts, counts);
+  UnmapQueries(treeSums, sums);
+
+  means.zeros(sums.n_elem);
+  for (size_t i = 0; i < sums.n_elem; ++i)
+    if (counts[i] > 0)
+      means[i] = sums[i] / counts[i];
+}
+
+template<typename MetricType, typename TreeType>
+template<typename VisitorType>
+void RangeSearch<MetricType, TreeType>::Traverse(
+    const math::Range& range,
+    std::vector<VisitorType>& visitors)
+{
+  Timer::Start("range_search/computing_neighbors");
+
+  // Set size of prunes to 0.
+  numPrunes = 0;
+
+  typedef RangeSearchRules<MetricType, TreeType, VisitorType> RuleType;
+
+  // During single-tree traversal, trees with self-children cache base case
+  // results in the statistics of the reference nodes, so the reference tree
+  // can't be shared between threads.
+  const bool parallel = (visitors.size() > 1) && (naive || !singleMode ||
+      !tree::TreeTraits<TreeType>::HasSelfChildren);
+  const int numThreads = parallel ? (int) visitors.size() : 1;
+
+  size_t baseCases = 0;
 
   if (naive)
   {
-    // The naive brute-force solution.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      for (size_t j = 0; j < referenceSet.n_cols; ++j)
-        rules.BaseCase(i, j);
+    // The naive brute-force solution.  Each thread has its own rules, so that
+    // the last base case of each thread is tracked separately.
+    #pragma omp parallel num_threads(numThreads) reduction(+:baseCases)
+    {
+      RuleType rules(referenceSet, querySet, range,
+          visitors[OmpGetThreadNum()], metric);
+
+      #pragma omp for schedule(dynamic, 16)
+      for (size_t i = 0; i < querySet.n_cols; ++i)
+        for (size_t j = 0; j < referenceSet.n_cols; ++j)
+          rules.BaseCase(i, j);
+
+      baseCases += rules.BaseCases();
+    }
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
+    size_t prunes = 0;
 
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    #pragma omp parallel num_threads(numThreads) reduction(+:prunes, baseCases)
+    {
+      // Create the helper object and the traverser for this thread.
+      RuleType rules(referenceSet, querySet, range,
+          visitors[OmpGetThreadNum()], metric);
+      typename TreeType::template SingleTreeTraverser<RuleType>
+          traverser(rules);
+
+      // Now have it traverse for each point.
+      #pragma omp for schedule(dynamic, 16)
+      for (size_t i = 0; i < querySet.n_cols; ++i)
+        traverser.Traverse(i, *referenceTree);
+
+      prunes += traverser.NumPrunes();
+      baseCases += rules.BaseCases();
+    }
 
-    numPrunes = traverser.NumPrunes();
+    numPrunes = prunes;
   }
   else // Dual-tree recursion.
   {
-    // Create the traverser.
-    typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
+    // Split the query tree into disjoint subtrees, which are handed out to the
+    // threads.  There are a few subtrees for each thread, so that the work is
+    // balanced even if some subtrees take longer than others.
+    std::vector<TreeType*> queryNodes;
+    tree::SplitQueryTree(*queryTree, (numThreads == 1) ? 1 : 4 * numThreads,
+        queryNodes);
+
+    // The squared norms used by block base cases are calculated once here,
+    // instead of by the rules of each thread.
+    arma::vec queryNorms, referenceNorms;
+    const bool useNorms = blockBaseCases &&
+        tree::RuleTraits<RuleType>::HasBlockBaseCase;
+    if (useNorms)
+    {
+      metric::SquaredNorms(referenceSet, referenceNorms);
+      if (&querySet != &referenceSet)
+        metric::SquaredNorms(querySet, queryNorms);
+    }
+    const arma::vec* queryNormsPtr = !useNorms ? NULL :
+        (&querySet == &referenceSet) ? &referenceNorms : &queryNorms;
+    const arma::vec* referenceNormsPtr = useNorms ? &referenceNorms : NULL;
 
-    traverser.Traverse(*queryTree, *referenceTree);
+    size_t prunes = 0;
 
-    numPrunes = traverser.NumPrunes();
+    #pragma omp parallel num_threads(numThreads) reduction(+:prunes, baseCases)
+    {
+      // Create the helper object and the traverser for this thread.
+      RuleType rules(referenceSet, querySet, range,
+          visitors[OmpGetThreadNum()], metric, blockBaseCases, queryNormsPtr,
+          referenceNormsPtr);
+      typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
+
+      #pragma omp for schedule(dynamic, 1)
+      for (size_t i = 0; i < queryNodes.size(); ++i)
+        traverser.Traverse(*queryNodes[i], *referenceTree);
+
+      prunes += traverser.NumPrunes();
+      baseCases += rules.BaseCases();
+    }
+
+    numPrunes = prunes;
   }
 
   Timer::Stop("range_search/computing_neighbors");
@@ -258,82 +423,48 @@ void RangeSearch<MetricType, TreeType>::Search(
   // Output number of prunes.
   Log::Info << "Number of pruned nodes during computation: " << numPrunes
       << "." << std::endl;
+  Log::Info << baseCases << " base cases were calculated." << std::endl;
+}
 
-  // Map points back to original indices, if necessary.
+template<typename MetricType, typename TreeType>
+const std::vector<size_t>* RangeSearch<MetricType, TreeType>::QueryMap() const
+{
+  if (!treeOwner || !tree::TreeTraits<TreeType>::RearrangesDataset)
+    return NULL;
+
+  // If there is a separate query set but we are in single-tree mode, no query
+  // tree was built, so the query points were not rearranged.
+  if (hasQuerySet)
+    return singleMode ? NULL : &oldFromNewQueries;
+  else
+    return &oldFromNewReferences;
+}
 
+template<typename MetricType, typename TreeType>
+const std::vector<size_t>*
+RangeSearch<MetricType, TreeType>::ReferenceMap() const
+{
   if (!treeOwner || !tree::TreeTraits<TreeType>::RearrangesDataset)
-  {
-    // No mapping needed.  We are done.
-    return;
-  }
-  else if (treeOwner && hasQuerySet && !singleMode) // Map both sets.
-  {
-    neighbors.clear();
-    neighbors.resize(querySet.n_cols);
-    distances.clear();
-    distances.resize(querySet.n_cols);
+    return NULL;
 
-    for (size_t i = 0; i < distances.size(); i++)
-    {
-      // Map distances (copy a column).
-      size_t queryMapping = oldFromNewQueries[i];
-      distances[queryMapping] = (*distancePtr)[i];
-
-      // Copy each neighbor individually, because we need to map it.
-      neighbors[queryMapping].resize(distances[queryMapping].size());
-      for (size_t j = 0; j < distances[queryMapping].size(); j++)
-      {
-        neighbors[queryMapping][j] = oldFromNewReferences[(*neighborPtr)[i][j]];
-      }
-    }
+  return &oldFromNewReferences;
+}
 
-    // Finished with temporary objects.
-    delete neighborPtr;
-    delete distancePtr;
-  }
-  else if (treeOwner && !hasQuerySet)
+template<typename MetricType, typename TreeType>
+template<typename VecType>
+void RangeSearch<MetricType, TreeType>::UnmapQueries(const VecType& in,
+                                                     VecType& out) const
+{
+  const std::vector<size_t>* queryMap = QueryMap();
+  if (queryMap == NULL)
   {
-    neighbors.clear();
-    neighbors.resize(querySet.n_cols);
-    distances.clear();
-    distances.resize(querySet.n_cols);
-
-    for (size_t i = 0; i < distances.size(); i++)
-    {
-      // Map distances (copy a column).
-      size_t refMapping = oldFromNewReferences[i];
-      distances[refMapping] = (*distancePtr)[i];
-
-      // Copy each neighbor individually, because we need to map it.
-      neighbors[refMapping].resize(distances[refMapping].size());
-      for (size_t j = 0; j < distances[refMapping].size(); j++)
-      {
-        neighbors[refMapping][j] = oldFromNewReferences[(*neighborPtr)[i][j]];
-      }
-    }
-
-    // Finished with temporary objects.
-    delete neighborPtr;
-    delete distancePtr;
+    out = in;
+    return;
   }
-  else if (treeOwner && hasQuerySet && singleMode) // Map only references.
-  {
-    neighbors.clear();
-    neighbors.resize(querySet.n_cols);
 
-    // Map indices of neighbors.
-    for (size_t i = 0; i < neighbors.size(); i++)
-    {
-      neighbors[i].resize((*neighborPtr)[i].size());
-      for (size_t j = 0; j < neighbors[i].size(); j++)
-      {
-        neighbors[i][j] = oldFromNewReferences[(*neighborPtr)[i][j]];
-      }
-    }
-
-    // Finished with temporary object.
-    delete neighborPtr;
-  }
+  out.set_size(in.n_elem);
+  for (size_t i = 0; i < in.n_elem; ++i)
+    out[(*queryMap)[i]] = in[i];
 }
 
 template<typename MetricType, typename TreeType>
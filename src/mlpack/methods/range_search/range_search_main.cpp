@@ -45,13 +45,53 @@ PROGRAM_INFO("Range Search",
     " resultant CSV-like files may not be loadable by many programs.  However, "
     "at this time a better way to store this non-square result is not known.  "
     "As a result, any output files will be written as CSVs in this manner, "
-    "regardless of the given extension.");
+    "regardless of the given extension."
+    "\n\n"
+    "If only the number of points in range of each query point is needed, it "
+    "can be saved with --counts_file, and if --values_file is given (a file "
+    "with one value for each reference point), the sum and mean of the values "
+    "of the points in range of each query point can be saved with --sums_file "
+    "and --means_file.  These are much faster to calculate than the full "
+    "results, and if --neighbors_file and --distances_file are not given, the "
+    "full results are not calculated.  For example, the following will save the"
+    " number of points within distance 2 of each point in 'input.csv' to "
+    "'counts.csv':"
+    "\n\n"
+    "$ range_search --max=2 --reference_file=input.csv --counts_file=counts.csv"
+    "\n\n"
+    "If mlpack was compiled with OpenMP, the search is done in parallel; the "
+    "number of threads can be set with --threads."
+    "\n\n"
+    "With --block_base_cases, dual-tree search with kd-trees computes the "
+    "distances between the points of two leaves at once, with a matrix "
+    "multiplication; compare the 'range_search/computing_neighbors' timer (with"
+    " -v) with and without it to see whether it is faster for a dataset."
+    "\n\n"
+    "The reference tree can be saved with --reference_tree_out and loaded in a "
+    "later run with --reference_tree_in (instead of --reference_file), so that "
+    "it does not have to be built again.  A saved tree is mapped into memory "
+    "when it is loaded, so loading is almost instant even for large trees.  "
+    "--cover_tree must be given when a cover tree is loaded.");
 
 // Define our input parameters that this program will take.
-PARAM_STRING_REQ("reference_file", "File containing the reference dataset.",
-    "r");
-PARAM_STRING_REQ("distances_file", "File to output distances into.", "d");
-PARAM_STRING_REQ("neighbors_file", "File to output neighbors into.", "n");
+PARAM_STRING("reference_file", "File containing the reference dataset.", "r",
+    "");
+PARAM_STRING("reference_tree_in", "File containing a reference tree saved with "
+    "--reference_tree_out, to use instead of --reference_file.", "i", "");
+PARAM_STRING("reference_tree_out", "File to save the reference tree to.", "o",
+    "");
+PARAM_STRING("distances_file", "File to output distances into.", "d", "");
+PARAM_STRING("neighbors_file", "File to output neighbors into.", "n", "");
+
+PARAM_STRING("counts_file", "File to output the number of points in range of "
+    "each query point into.", "C", "");
+PARAM_STRING("values_file", "File containing a value for each reference point,"
+    " to be aggregated over the points in range of each query point.", "a", "");
+PARAM_STRING("sums_file", "File to output the sum of the values of the points "
+    "in range of each query point into (requires --values_file).", "S", "");
+PARAM_STRING("means_file", "File to output the mean of the values of the "
+    "points in range of each query point into (requires --values_file).", "E",
+    "");
 
 PARAM_DOUBLE_REQ("max", "Upper bound in range.", "M");
 PARAM_DOUBLE("min", "Lower bound in range.", "m", 0.0);
@@ -64,12 +104,66 @@ PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
     "dual-tree search).", "s");
 PARAM_FLAG("cover_tree", "If true, use a cover tree for range searching "
     "(instead of a kd-tree).", "c");
+PARAM_FLAG("block_base_cases", "If true, the distances between the points of "
+    "two leaves are computed at once in dual-tree search with kd-trees.", "B");
+PARAM_INT("threads", "Number of threads to use for the search.  If 0, the "
+    "OpenMP default is used (which can be set with the OMP_NUM_THREADS "
+    "environment variable).", "t", 0);
 
+typedef BinarySpaceTree<bound::HRectBound<2>, RangeSearchStat> KDTreeType;
 typedef RangeSearch<> RSType;
 typedef CoverTree<metric::EuclideanDistance, tree::FirstPointIsRoot,
     RangeSearchStat> CoverTreeType;
 typedef RangeSearch<metric::EuclideanDistance, CoverTreeType> RSCoverType;
 
+/**
+ * Save the reference tree to the file given with --reference_tree_out, if one
+ * was given.
+ */
+template<typename TreeType>
+void SaveReferenceTree(const TreeType& tree,
+                       const vector<size_t>& oldFromNew = vector<size_t>())
+{
+  const string filename = CLI::GetParam<string>("reference_tree_out");
+  if (filename != "")
+  {
+    Log::Info << "Saving reference tree to '" << filename << "'..." << endl;
+    Timer::Start("tree_saving");
+    SaveTree(filename, tree, oldFromNew);
+    Timer::Stop("tree_saving");
+  }
+}
+
+/**
+ * Run each of the requested searches with the given RangeSearch object.  The
+ * values must be in the order of the reference set held by the object, and the
+ * results are in the order of the query set held by the object.
+ */
+template<typename RangeSearchType>
+void RunSearches(RangeSearchType& rangeSearch,
+                 const math::Range& r,
+                 const bool fullSearch,
+                 const arma::vec& values,
+                 arma::Col<size_t>& offsets,
+                 arma::Col<size_t>& neighbors,
+                 arma::vec& distances,
+                 arma::Col<size_t>& counts,
+                 arma::vec& sums,
+                 arma::vec& means)
+{
+  if (fullSearch)
+    rangeSearch.Search(r, offsets, neighbors, distances);
+
+  if (values.n_elem > 0)
+  {
+    rangeSearch.Aggregate(r, values, counts, sums, means);
+  }
+  else if (CLI::GetParam<string>("counts_file") != "")
+  {
+    rangeSearch.Count(r, counts);
+  }
+}
+
 int main(int argc, char *argv[])
 {
   // Give CLI the command line parameters the user passed in.
@@ -77,25 +171,100 @@ int main(int argc, char *argv[])
 
   // Get all the parameters.
   string referenceFile = CLI::GetParam<string>("reference_file");
+  const string referenceTreeIn = CLI::GetParam<string>("reference_tree_in");
 
   string distancesFile = CLI::GetParam<string>("distances_file");
   string neighborsFile = CLI::GetParam<string>("neighbors_file");
+  const string countsFile = CLI::GetParam<string>("counts_file");
+  const string valuesFile = CLI::GetParam<string>("values_file");
+  const string sumsFile = CLI::GetParam<string>("sums_file");
+  const string meansFile = CLI::GetParam<string>("means_file");
+
+  // The full results are only calculated if they are going to be saved.
+  const bool fullSearch = (distancesFile != "") || (neighborsFile != "");
 
   int lsInt = CLI::GetParam<int>("leaf_size");
 
   double max = CLI::GetParam<double>("max");
   double min = CLI::GetParam<double>("min");
 
-  const bool naive = CLI::HasParam("naive");
+  bool naive = CLI::HasParam("naive");
   const bool singleMode = CLI::HasParam("single_mode");
   bool coverTree = CLI::HasParam("cover_tree");
 
+  if (referenceFile == "" && referenceTreeIn == "")
+  {
+    Log::Fatal << "Either --reference_file or --reference_tree_in must be "
+        << "specified." << endl;
+  }
+
+  if (referenceFile != "" && referenceTreeIn != "")
+  {
+    Log::Warn << "--reference_file ignored because --reference_tree_in is "
+        << "present." << endl;
+  }
+
+  // A loaded reference tree holds the reference set.  Only the tree of the type
+  // being used is loaded.
+  LoadedTree<KDTreeType>* kdTreeIn = NULL;
+  LoadedTree<CoverTreeType>* coverTreeIn = NULL;
+
   arma::mat referenceData;
   arma::mat queryData; // So it doesn't go out of scope.
-  if (!data::Load(referenceFile, referenceData))
-    Log::Fatal << "Reference file " << referenceFile << "not found." << endl;
+  arma::mat* referenceSet = &referenceData;
+  if (referenceTreeIn != "")
+  {
+    Timer::Start("tree_loading");
+    if (coverTree)
+    {
+      coverTreeIn = new LoadedTree<CoverTreeType>(referenceTreeIn);
+      referenceSet = &coverTreeIn->Dataset();
+    }
+    else
+    {
+      kdTreeIn = new LoadedTree<KDTreeType>(referenceTreeIn);
+      referenceSet = &kdTreeIn->Dataset();
+    }
+    Timer::Stop("tree_loading");
 
-  Log::Info << "Loaded reference data from '" << referenceFile << "'." << endl;
+    Log::Info << "Loaded reference tree from '" << referenceTreeIn << "'."
+        << endl;
+  }
+  else
+  {
+    if (!data::Load(referenceFile, referenceData))
+      Log::Fatal << "Reference file " << referenceFile << "not found." << endl;
+
+    Log::Info << "Loaded reference data from '" << referenceFile << "'."
+        << endl;
+  }
+
+  if (!fullSearch && countsFile == "" && sumsFile == "" && meansFile == "")
+  {
+    Log::Warn << "None of --neighbors_file, --distances_file, --counts_file, "
+        << "--sums_file, or --means_file are specified; no results will be "
+        << "saved." << endl;
+  }
+
+  arma::vec values;
+  if (valuesFile != "")
+  {
+    arma::mat valuesMat;
+    data::Load(valuesFile, valuesMat, true);
+    values = arma::vectorise(valuesMat);
+
+    if (values.n_elem != referenceSet->n_cols)
+    {
+      Log::Fatal << "Number of values in '" << valuesFile << "' ("
+          << values.n_elem << ") must be equal to the number of reference "
+          << "points (" << referenceSet->n_cols << ")!" << endl;
+    }
+  }
+  else if (sumsFile != "" || meansFile != "")
+  {
+    Log::Fatal << "--values_file must be specified if --sums_file or "
+        << "--means_file are specified." << endl;
+  }
 
   // Sanity check on range value: max must be greater than min.
   if (max <= min)
@@ -104,6 +273,26 @@ int main(int argc, char *argv[])
         << "minimum (" << min << ")." << endl;
   }
 
+  // Sanity check on the number of threads.
+  const int threads = CLI::GetParam<int>("threads");
+  if (threads < 0)
+  {
+    Log::Fatal << "Invalid number of threads: " << threads << ".  Must be "
+        << "greater than or equal to 0." << endl;
+  }
+  else if (threads > 0)
+  {
+    OmpSetNumThreads(threads);
+  }
+
+#ifndef HAS_OPENMP
+  if (threads > 1)
+  {
+    Log::Warn << "--threads ignored because mlpack was compiled without "
+        << "OpenMP; only one thread will be used." << endl;
+  }
+#endif
+
   // Sanity check on leaf size.
   if (lsInt < 0)
   {
@@ -118,6 +307,14 @@ int main(int argc, char *argv[])
     Log::Warn << "--single_mode ignored because --naive is present." << endl;
   }
 
+  // A loaded tree is used as it was built.
+  if (naive && referenceTreeIn != "")
+  {
+    Log::Warn << "--naive ignored because --reference_tree_in is present."
+        << endl;
+    naive = false;
+  }
+
   if (naive)
     leafSize = referenceData.n_cols;
 
@@ -127,8 +324,22 @@ int main(int argc, char *argv[])
     coverTree = false;
   }
 
-  vector<vector<size_t> > neighbors;
-  vector<vector<double> > distances;
+  // The results are stored in compressed sparse row format: the neighbors of
+  // query point i (in the order of the query set held by the RangeSearch
+  // object) are neighbors[offsets[i]] to neighbors[offsets[i + 1] - 1].
+  arma::Col<size_t> offsets;
+  arma::Col<size_t> neighbors;
+  arma::vec distances;
+
+  // The aggregate results, for each query point (in the same order).
+  arma::Col<size_t> counts;
+  arma::vec sums;
+  arma::vec means;
+
+  // If we build kd-trees, these will be filled with the mappings we need to get
+  // back to the original indices.
+  vector<size_t> oldFromNewRefs;
+  vector<size_t> newFromOldQueries;
 
   // The cover tree implies different types, so we must split this section.
   if (coverTree)
@@ -138,13 +349,16 @@ int main(int argc, char *argv[])
     // This is significantly simpler than kd-tree construction because the data
     // matrix is not modified.
     RSCoverType* rangeSearch = NULL;
-    CoverTreeType referenceTree(referenceData);
+    CoverTreeType* referenceTree = coverTreeIn ? &coverTreeIn->Tree() :
+        new CoverTreeType(referenceData);
     CoverTreeType* queryTree = NULL;
 
+    SaveReferenceTree(*referenceTree);
+
     if (CLI::GetParam<string>("query_file") == "")
     {
       // Single dataset.
-      rangeSearch = new RSCoverType(&referenceTree, referenceData, singleMode);
+      rangeSearch = new RSCoverType(referenceTree, *referenceSet, singleMode);
     }
     else
     {
@@ -153,17 +367,20 @@ int main(int argc, char *argv[])
       data::Load(queryFile, queryData, true);
       queryTree = new CoverTreeType(queryData);
 
-      rangeSearch = new RSCoverType(&referenceTree, queryTree, referenceData,
+      rangeSearch = new RSCoverType(referenceTree, queryTree, *referenceSet,
           queryData, singleMode);
     }
 
     Log::Info << "Trees built." << endl;
 
     const math::Range r(min, max);
-    rangeSearch->Search(r, neighbors, distances);
+    RunSearches(*rangeSearch, r, fullSearch, values, offsets, neighbors,
+        distances, counts, sums, means);
 
     if (queryTree)
       delete queryTree;
+    if (!coverTreeIn)
+      delete referenceTree;
     delete rangeSearch;
   }
   else
@@ -171,22 +388,32 @@ int main(int argc, char *argv[])
     // Because we may construct it differently, we need a pointer.
     RSType* rangeSearch = NULL;
 
-    // Mappings for when we build the tree.
-    vector<size_t> oldFromNewRefs;
-
     // Build trees by hand, so we can save memory: if we pass a tree to
     // NeighborSearch, it does not copy the matrix.
-    Log::Info << "Building reference tree..." << endl;
-    Timer::Start("tree_building");
+    vector<size_t> newFromOldRefs;
+    KDTreeType* refTree = NULL;
+    if (kdTreeIn)
+    {
+      refTree = &kdTreeIn->Tree();
+      oldFromNewRefs = kdTreeIn->OldFromNew();
+      newFromOldRefs.resize(oldFromNewRefs.size());
+      for (size_t i = 0; i < oldFromNewRefs.size(); ++i)
+        newFromOldRefs[oldFromNewRefs[i]] = i;
+    }
+    else
+    {
+      Log::Info << "Building reference tree..." << endl;
+      Timer::Start("tree_building");
 
-    BinarySpaceTree<bound::HRectBound<2>, RangeSearchStat>
-        refTree(referenceData, oldFromNewRefs, leafSize);
-    BinarySpaceTree<bound::HRectBound<2>, RangeSearchStat>*
-        queryTree = NULL; // Empty for now.
+      refTree = new KDTreeType(referenceData, oldFromNewRefs, newFromOldRefs,
+          leafSize);
 
-    Timer::Stop("tree_building");
+      Timer::Stop("tree_building");
+    }
+
+    SaveReferenceTree(*refTree, oldFromNewRefs);
 
-    vector<size_t> oldFromNewQueries;
+    KDTreeType* queryTree = NULL; // Empty for now.
 
     if (CLI::GetParam<string>("query_file") != "")
     {
@@ -204,19 +431,21 @@ int main(int argc, char *argv[])
       // NeighborSearch, it does not copy the matrix.
       Timer::Start("tree_building");
 
-      queryTree = new BinarySpaceTree<bound::HRectBound<2>,
-          RangeSearchStat>(queryData, oldFromNewQueries, leafSize);
+      vector<size_t> oldFromNewQueries;
+      queryTree = new KDTreeType(queryData, oldFromNewQueries,
+          newFromOldQueries, leafSize);
 
       Timer::Stop("tree_building");
 
-      rangeSearch = new RSType(&refTree, queryTree, referenceData, queryData,
+      rangeSearch = new RSType(refTree, queryTree, *referenceSet, queryData,
           singleMode);
 
       Log::Info << "Tree built." << endl;
     }
     else
     {
-      rangeSearch = new RSType(&refTree, referenceData, singleMode);
+      rangeSearch = new RSType(refTree, *referenceSet, singleMode);
+      newFromOldQueries = newFromOldRefs;
 
       Log::Info << "Trees built." << endl;
     }
@@ -224,113 +453,137 @@ int main(int argc, char *argv[])
     Log::Info << "Computing neighbors within range [" << min << ", " << max
         << "]." << endl;
 
-    // Collect the results in these vectors before remapping.
-    vector<vector<double> > distancesOut;
-    vector<vector<size_t> > neighborsOut;
+    // The values must be given in the order of the reference tree.
+    arma::vec treeValues(values.n_elem);
+    for (size_t i = 0; i < values.n_elem; ++i)
+      treeValues[i] = values[oldFromNewRefs[i]];
 
     const math::Range r(min, max);
-    rangeSearch->Search(r, neighborsOut, distancesOut);
+    rangeSearch->BlockBaseCases() = CLI::HasParam("block_base_cases");
+    RunSearches(*rangeSearch, r, fullSearch, treeValues, offsets, neighbors,
+        distances, counts, sums, means);
 
     Log::Info << "Neighbors computed." << endl;
 
-    // We have to map back to the original indices from before the tree
-    // construction.
-    Log::Info << "Re-mapping indices..." << endl;
+    // Clean up.
+    if (queryTree)
+      delete queryTree;
+    if (!kdTreeIn)
+      delete refTree;
+    delete rangeSearch;
+  }
 
-    distances.resize(distancesOut.size());
-    neighbors.resize(neighborsOut.size());
+  // Save output.  We have to do this by hand.  The indices are mapped back to
+  // the original indices as we go.
+  const size_t numQueries = queryData.n_cols > 0 ? queryData.n_cols :
+      referenceSet->n_cols;
 
-    // Do the actual remapping.
-    if (CLI::GetParam<string>("query_file") != "")
+  if (distancesFile != "")
+  {
+    fstream distancesStr(distancesFile.c_str(), fstream::out);
+    if (!distancesStr.is_open())
     {
-      for (size_t i = 0; i < distances.size(); ++i)
+      Log::Warn << "Cannot open file '" << distancesFile << "' to save output "
+          << "distances to!" << endl;
+    }
+    else
+    {
+      // Loop over each point.
+      for (size_t i = 0; i < numQueries; ++i)
       {
-        // Map distances (copy a column).
-        distances[oldFromNewQueries[i]] = distancesOut[i];
+        const size_t query = newFromOldQueries.empty() ? i :
+            newFromOldQueries[i];
 
-        // Map indices of neighbors.
-        neighbors[oldFromNewQueries[i]].resize(neighborsOut[i].size());
-        for (size_t j = 0; j < distancesOut[i].size(); ++j)
+        // Store the distances of each point.  We may have 0 points to store,
+        // so we must account for that possibility.
+        for (size_t j = offsets[query]; j < offsets[query + 1]; ++j)
         {
-          neighbors[oldFromNewQueries[i]][j] =
-              oldFromNewRefs[neighborsOut[i][j]];
+          if (j != offsets[query])
+            distancesStr << ", ";
+          distancesStr << distances[j];
         }
+
+        distancesStr << endl;
       }
+
+      distancesStr.close();
+    }
+  }
+
+  if (neighborsFile != "")
+  {
+    fstream neighborsStr(neighborsFile.c_str(), fstream::out);
+    if (!neighborsStr.is_open())
+    {
+      Log::Warn << "Cannot open file '" << neighborsFile << "' to save output "
+          << "neighbor indices to!" << endl;
     }
     else
     {
-      for (size_t i = 0; i < distances.size(); ++i)
+      // Loop over each point.
+      for (size_t i = 0; i < numQueries; ++i)
       {
-        // Map distances (copy a column).
-        distances[oldFromNewRefs[i]] = distancesOut[i];
+        const size_t query = newFromOldQueries.empty() ? i :
+            newFromOldQueries[i];
 
-        // Map indices of neighbors.
-        neighbors[oldFromNewRefs[i]].resize(neighborsOut[i].size());
-        for (size_t j = 0; j < distancesOut[i].size(); ++j)
+        // Store the neighbors of each point.  We may have 0 points to store,
+        // so we must account for that possibility.
+        for (size_t j = offsets[query]; j < offsets[query + 1]; ++j)
         {
-          neighbors[oldFromNewRefs[i]][j] = oldFromNewRefs[neighborsOut[i][j]];
+          if (j != offsets[query])
+            neighborsStr << ", ";
+          neighborsStr << (oldFromNewRefs.empty() ? neighbors[j] :
+              oldFromNewRefs[neighbors[j]]);
         }
+
+        neighborsStr << endl;
       }
-    }
 
-    // Clean up.
-    if (queryTree)
-      delete queryTree;
-    delete rangeSearch;
+      neighborsStr.close();
+    }
   }
 
-  // Save output.  We have to do this by hand.
-  fstream distancesStr(distancesFile.c_str(), fstream::out);
-  if (!distancesStr.is_open())
-  {
-    Log::Warn << "Cannot open file '" << distancesFile << "' to save output "
-        << "distances to!" << endl;
-  }
-  else
+  // Map the aggregate results back to the original order of the query points.
+  if (!newFromOldQueries.empty() && counts.n_elem > 0)
   {
-    // Loop over each point.
-    for (size_t i = 0; i < distances.size(); ++i)
+    arma::Col<size_t> oldCounts(numQueries);
+    arma::vec oldSums(sums.n_elem);
+    arma::vec oldMeans(means.n_elem);
+    for (size_t i = 0; i < numQueries; ++i)
     {
-      // Store the distances of each point.  We may have 0 points to store, so
-      // we must account for that possibility.
-      for (size_t j = 0; j + 1 < distances[i].size(); ++j)
+      oldCounts[i] = counts[newFromOldQueries[i]];
+      if (sums.n_elem > 0)
       {
-        distancesStr << distances[i][j] << ", ";
+        oldSums[i] = sums[newFromOldQueries[i]];
+        oldMeans[i] = means[newFromOldQueries[i]];
       }
-
-      if (distances[i].size() > 0)
-        distancesStr << distances[i][distances[i].size() - 1];
-
-      distancesStr << endl;
     }
 
-    distancesStr.close();
+    counts = oldCounts;
+    sums = oldSums;
+    means = oldMeans;
   }
 
-  fstream neighborsStr(neighborsFile.c_str(), fstream::out);
-  if (!neighborsStr.is_open())
+  // Each result goes on its own line, so the vectors must be transposed.
+  if (countsFile != "")
   {
-    Log::Warn << "Cannot open file '" << neighborsFile << "' to save output "
-        << "neighbor indices to!" << endl;
+    arma::Mat<size_t> countsOut = trans(counts);
+    data::Save(countsFile, countsOut);
   }
-  else
-  {
-    // Loop over each point.
-    for (size_t i = 0; i < neighbors.size(); ++i)
-    {
-      // Store the neighbors of each point.  We may have 0 points to store, so
-      // we must account for that possibility.
-      for (size_t j = 0; j + 1 < neighbors[i].size(); ++j)
-      {
-        neighborsStr << neighbors[i][j] << ", ";
-      }
-
-      if (neighbors[i].size() > 0)
-        neighborsStr << neighbors[i][neighbors[i].size() - 1];
 
-      neighborsStr << endl;
-    }
+  if (sumsFile != "")
+  {
+    arma::mat sumsOut = trans(sums);
+    data::Save(sumsFile, sumsOut);
+  }
 
-    neighborsStr.close();
+  if (meansFile != "")
+  {
+    arma::mat meansOut = trans(means);
+    data::Save(meansFile, meansOut);
   }
+
+  // The loaded trees hold the reference set, so they are deleted last.
+  delete kdTreeIn;
+  delete coverTreeIn;
 }
@@ -7,13 +7,32 @@
 #ifndef __MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RULES_HPP
 #define __MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RULES_HPP
 
+#include <mlpack/core/tree/tree_traits.hpp>
+#include <mlpack/core/metrics/block_distance_bounds.hpp>
 #include "../neighbor_search/ns_traversal_info.hpp"
+#include "visitors/vector_range_visitor.hpp"
+#include "visitors/range_visitor_traits.hpp"
 
 namespace mlpack {
 namespace range {
 
+/**
+ * The rules for range search.  Each reference point found to be in the range
+ * of a query point is passed to the visitor with
+ * visitor.Visit(queryIndex, referenceIndex, distance); see VectorRangeVisitor
+ * for an example visitor.  If the visitor accepts whole nodes (see
+ * RangeVisitorTraits), then reference nodes which lie entirely within the range
+ * of a query point are passed to the visitor at once, without calculating the
+ * distance to each point in the node.
+ *
+ * @tparam MetricType Metric to use for range search.
+ * @tparam TreeType Type of tree to traverse.
+ * @tparam VisitorType Type of visitor which receives the results.
+ */
+template<typename MetricType,
+         typename TreeType,
+         typename VisitorType = VectorRangeVisitor>
 
-template<typename MetricType, typename TreeType>
 class RangeSearchRules
 {
  public:
@@ -24,16 +43,24 @@ class RangeSearchRules
    * @param referenceSet Set of reference data.
    * @param querySet Set of query data.
    * @param range Range to search for.
-   * @param neighbors Vector to store resulting neighbors in.
-   * @param distances Vector to store resulting distances in.
+   * @param visitor Visitor which receives the results.
    * @param metric Instantiated metric.
+   * @param blockBaseCases If true, BlockBaseCase() computes the distances of a
+   *     block at once.
+   * @param queryNorms Squared norms of the query points for BlockBaseCase()
+   *     (see metric::SquaredNorms()), so that rules for different threads can
+   *     share them; if NULL, they are calculated when they are first needed.
+   * @param referenceNorms Squared norms of the reference points for
+   *     BlockBaseCase(); if NULL, they are calculated when first needed.
    */
-  RangeSearchRules(const arma::mat& referenceSet,
-                   const arma::mat& querySet,
+  RangeSearchRules(const typename TreeType::Mat& referenceSet,
+                   const typename TreeType::Mat& querySet,
                    const math::Range& range,
-                   std::vector<std::vector<size_t> >& neighbors,
-                   std::vector<std::vector<double> >& distances,
-                   MetricType& metric);
+                   VisitorType& visitor,
+                   MetricType& metric,
+                   const bool blockBaseCases = false,
+                   const arma::vec* queryNorms = NULL,
+                   const arma::vec* referenceNorms = NULL);
 
   /**
    * Compute the base case between the given query point and reference point.
@@ -43,6 +70,24 @@ class RangeSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Run the base cases between each of the given query points and each of the
+   * given reference points, as if BaseCase() were called for each pair.  If
+   * BlockBaseCases() is set, bounds on all of the distances are computed at
+   * once (see metric::BlockDistanceBounds), and only the pairs which might be
+   * in the range are evaluated with the metric, unless they are certainly in
+   * the range and their bounds are tight; otherwise, BaseCase() is called for
+   * each pair.  This is only available for the Euclidean and squared Euclidean
+   * distances on dense data (see tree::RuleTraits).
+   *
+   * @param queryIndices Indices of query points.
+   * @param referenceBegin Index of first reference point.
+   * @param referenceCount Number of reference points.
+   */
+  void BlockBaseCase(const std::vector<size_t>& queryIndices,
+                     const size_t referenceBegin,
+                     const size_t referenceCount);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -93,6 +138,16 @@ class RangeSearchRules
                  TreeType& referenceNode,
                  const double oldScore) const;
 
+  //! Get the number of base cases that have been performed.
+  size_t BaseCases() const { return baseCases; }
+  //! Modify the number of base cases that have been performed.
+  size_t& BaseCases() { return baseCases; }
+
+  //! Get whether BlockBaseCase() computes the distances of a block at once.
+  bool BlockBaseCases() const { return blockBaseCases; }
+  //! Modify whether BlockBaseCase() computes the distances of a block at once.
+  bool& BlockBaseCases() { return blockBaseCases; }
+
   typedef neighbor::NeighborSearchTraversalInfo<TreeType> TraversalInfoType;
 
   const TraversalInfoType& TraversalInfo() const { return traversalInfo; }
@@ -100,19 +155,16 @@ class RangeSearchRules
 
  private:
   //! The reference set.
-  const arma::mat& referenceSet;
+  const typename TreeType::Mat& referenceSet;
 
   //! The query set.
-  const arma::mat& querySet;
+  const typename TreeType::Mat& querySet;
 
   //! The range of distances for which we are searching.
   const math::Range& range;
 
-  //! The vector the resultant neighbor indices should be stored in.
-  std::vector<std::vector<size_t> >& neighbors;
-
-  //! The vector the resultant neighbor distances should be stored in.
-  std::vector<std::vector<double> >& distances;
+  //! The visitor which receives the results.
+  VisitorType& visitor;
 
   //! The instantiated metric.
   MetricType& metric;
@@ -122,16 +174,71 @@ class RangeSearchRules
   //! The last reference index.
   size_t lastReferenceIndex;
 
+  //! The number of base cases that have been performed.
+  size_t baseCases;
+
+  //! If true, BlockBaseCase() computes the distances of a block at once.
+  bool blockBaseCases;
+  //! The squared norms of the query points used by BlockBaseCase().
+  const arma::vec* queryNorms;
+  //! The squared norms of the reference points used by BlockBaseCase().
+  const arma::vec* referenceNorms;
+  //! The squared norms of the query points, if they were not given (only
+  //! calculated, once, by BlockBaseCase()).
+  arma::vec localQueryNorms;
+  //! The squared norms of the reference points, if they were not given (only
+  //! calculated, once, by BlockBaseCase()).
+  arma::vec localReferenceNorms;
+  //! The bounds computed by BlockBaseCase(), whose memory is reused for each
+  //! block.
+  metric::BlockDistanceBounds<typename TreeType::Mat::elem_type> blockBounds;
+
   //! Add all the points in the given node to the results for the given query
   //! point.  If the base case has already been calculated, we make sure to not
   //! add that to the results twice.
   void AddResult(const size_t queryIndex,
                  TreeType& referenceNode);
 
+  //! Pass each descendant of the reference node, starting with
+  //! firstDescendant, to the visitor, along with its distance.
+  template<typename Visitor>
+  void AddDescendants(
+      const size_t queryIndex,
+      TreeType& referenceNode,
+      const size_t firstDescendant,
+      const typename boost::enable_if_c<
+          !RangeVisitorTraits<Visitor>::VisitsNodes>::type* = 0);
+
+  //! Pass the whole reference node to the visitor at once.
+  template<typename Visitor>
+  void AddDescendants(
+      const size_t queryIndex,
+      TreeType& referenceNode,
+      const size_t firstDescendant,
+      const typename boost::enable_if_c<
+          RangeVisitorTraits<Visitor>::VisitsNodes>::type* = 0);
+
   TraversalInfoType traversalInfo;
 };
 
 }; // namespace range
+
+namespace tree {
+
+/**
+ * RangeSearchRules can run many base cases at once when the distance is the
+ * Euclidean or squared Euclidean distance and the data is dense.
+ */
+template<bool TakeRoot, typename TreeType, typename VisitorType>
+class RuleTraits<range::RangeSearchRules<metric::LMetric<2, TakeRoot>,
+    TreeType, VisitorType> >
+{
+ public:
+  static const bool HasBlockBaseCase =
+      !arma::is_SpMat<typename TreeType::Mat>::value;
+};
+
+}; // namespace tree
 }; // namespace mlpack
 
 // Include implementation.
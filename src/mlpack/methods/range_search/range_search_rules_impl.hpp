@@ -10,34 +10,66 @@
 // In case it hasn't been included yet.
 #include "range_search_rules.hpp"
 
+#include <mlpack/core/tree/binary_space_tree.hpp>
+
 namespace mlpack {
 namespace range {
 
-template<typename MetricType, typename TreeType>
-RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
-    const arma::mat& referenceSet,
-    const arma::mat& querySet,
+//! Determine whether the given point is a descendant of the given node.  This
+//! takes time linear in the number of descendants of the node.
+template<typename TreeType>
+bool IsDescendant(const TreeType& node, const size_t index)
+{
+  for (size_t i = 0; i < node.NumDescendants(); ++i)
+    if (node.Descendant(i) == index)
+      return true;
+
+  return false;
+}
+
+//! The descendants of a BinarySpaceTree node are contiguous, so this is easy.
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+bool IsDescendant(
+    const tree::BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>&
+        node,
+    const size_t index)
+{
+  return (index >= node.Begin()) && (index < node.Begin() + node.Count());
+}
+
+template<typename MetricType, typename TreeType, typename VisitorType>
+RangeSearchRules<MetricType, TreeType, VisitorType>::RangeSearchRules(
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
     const math::Range& range,
-    std::vector<std::vector<size_t> >& neighbors,
-    std::vector<std::vector<double> >& distances,
-    MetricType& metric) :
+    VisitorType& visitor,
+    MetricType& metric,
+    const bool blockBaseCases,
+    const arma::vec* queryNorms,
+    const arma::vec* referenceNorms) :
     referenceSet(referenceSet),
     querySet(querySet),
     range(range),
-    neighbors(neighbors),
-    distances(distances),
+    visitor(visitor),
     metric(metric),
     lastQueryIndex(querySet.n_cols),
-    lastReferenceIndex(referenceSet.n_cols)
+    lastReferenceIndex(referenceSet.n_cols),
+    baseCases(0),
+    blockBaseCases(blockBaseCases),
+    queryNorms(queryNorms),
+    referenceNorms(referenceNorms)
 {
   // Nothing to do.
 }
 
 //! The base case.  Evaluate the distance between the two points and add to the
 //! results if necessary.
-template<typename MetricType, typename TreeType>
+template<typename MetricType, typename TreeType, typename VisitorType>
 inline force_inline
-double RangeSearchRules<MetricType, TreeType>::BaseCase(
+double RangeSearchRules<MetricType, TreeType, VisitorType>::BaseCase(
     const size_t queryIndex,
     const size_t referenceIndex)
 {
@@ -51,24 +83,95 @@ double RangeSearchRules<MetricType, TreeType>::BaseCase(
 
   const double distance = metric.Evaluate(querySet.unsafe_col(queryIndex),
       referenceSet.unsafe_col(referenceIndex));
+  ++baseCases;
 
   // Update last indices, so we don't accidentally perform a base case twice.
   lastQueryIndex = queryIndex;
   lastReferenceIndex = referenceIndex;
 
   if (range.Contains(distance))
+    visitor.Visit(queryIndex, referenceIndex, distance);
+
+  return distance;
+}
+
+template<typename MetricType, typename TreeType, typename VisitorType>
+void RangeSearchRules<MetricType, TreeType, VisitorType>::BlockBaseCase(
+    const std::vector<size_t>& queryIndices,
+    const size_t referenceBegin,
+    const size_t referenceCount)
+{
+  if (!blockBaseCases)
   {
-    neighbors[queryIndex].push_back(referenceIndex);
-    distances[queryIndex].push_back(distance);
+    for (size_t i = 0; i < queryIndices.size(); ++i)
+      for (size_t ref = referenceBegin; ref < referenceBegin + referenceCount;
+           ++ref)
+        BaseCase(queryIndices[i], ref);
+
+    return;
   }
 
-  return distance;
+  // If the squared norms were not given, they are calculated the first time.
+  if (referenceNorms == NULL)
+  {
+    metric::SquaredNorms(referenceSet, localReferenceNorms);
+    referenceNorms = &localReferenceNorms;
+  }
+  if (queryNorms == NULL)
+  {
+    if (&querySet == &referenceSet)
+    {
+      queryNorms = referenceNorms;
+    }
+    else
+    {
+      metric::SquaredNorms(querySet, localQueryNorms);
+      queryNorms = &localQueryNorms;
+    }
+  }
+
+  blockBounds.Compute(metric, querySet, *queryNorms, queryIndices,
+      referenceSet, *referenceNorms, referenceBegin, referenceCount);
+
+  // Each pair counts as one base case, whether it is pruned, estimated, or
+  // evaluated with the metric.
+  for (size_t i = 0; i < queryIndices.size(); ++i)
+  {
+    const size_t queryIndex = queryIndices[i];
+    for (size_t j = 0; j < referenceCount; ++j)
+    {
+      const size_t referenceIndex = referenceBegin + j;
+      const double lower = blockBounds.Lower(i, j);
+      const double upper = blockBounds.Upper(i, j);
+
+      // Only the pairs whose bounds overlap the range can be in it.  If the
+      // bounds are tight and inside the range, the pair is certainly in it,
+      // and the metric is not evaluated.
+      if (upper < range.Lo() || lower > range.Hi())
+      {
+        ++baseCases;
+      }
+      else if (!blockBounds.Tight(i, j) || lower < range.Lo() ||
+          upper > range.Hi())
+      {
+        BaseCase(queryIndex, referenceIndex);
+      }
+      else if ((&querySet != &referenceSet) || (queryIndex != referenceIndex))
+      {
+        ++baseCases;
+        lastQueryIndex = queryIndex;
+        lastReferenceIndex = referenceIndex;
+        visitor.Visit(queryIndex, referenceIndex, blockBounds.Distance(i, j));
+      }
+    }
+  }
 }
 
 //! Single-tree scoring function.
-template<typename MetricType, typename TreeType>
-double RangeSearchRules<MetricType, TreeType>::Score(const size_t queryIndex,
-                                                     TreeType& referenceNode)
+template<typename MetricType, typename TreeType, typename VisitorType>
+double RangeSearchRules<MetricType, TreeType, VisitorType>::Score(
+    const size_t queryIndex,
+    TreeType& referenceNode)
 {
   // We must get the minimum and maximum distances and store them in this
   // object.
@@ -125,8 +228,8 @@ double RangeSearchRules<MetricType, TreeType>::Score(const size_t queryIndex,
 }
 
 //! Single-tree rescoring function.
-template<typename MetricType, typename TreeType>
-double RangeSearchRules<MetricType, TreeType>::Rescore(
+template<typename MetricType, typename TreeType, typename VisitorType>
+double RangeSearchRules<MetricType, TreeType, VisitorType>::Rescore(
     const size_t /* queryIndex */,
     TreeType& /* referenceNode */,
     const double oldScore) const
@@ -136,9 +239,10 @@ double RangeSearchRules<MetricType, TreeType>::Rescore(
 }
 
 //! Dual-tree scoring function.
-template<typename MetricType, typename TreeType>
-double RangeSearchRules<MetricType, TreeType>::Score(TreeType& queryNode,
-                                                     TreeType& referenceNode)
+template<typename MetricType, typename TreeType, typename VisitorType>
+double RangeSearchRules<MetricType, TreeType, VisitorType>::Score(
+    TreeType& queryNode,
+    TreeType& referenceNode)
 {
   math::Range distances;
   if (tree::TreeTraits<TreeType>::FirstPointIsCentroid)
@@ -197,8 +301,8 @@ double RangeSearchRules<MetricType, TreeType>::Score(TreeType& queryNode,
 }
 
 //! Dual-tree rescoring function.
-template<typename MetricType, typename TreeType>
-double RangeSearchRules<MetricType, TreeType>::Rescore(
+template<typename MetricType, typename TreeType, typename VisitorType>
+double RangeSearchRules<MetricType, TreeType, VisitorType>::Rescore(
     TreeType& /* queryNode */,
     TreeType& /* referenceNode */,
     const double oldScore) const
@@ -209,9 +313,10 @@ double RangeSearchRules<MetricType, TreeType>::Rescore(
 
 //! Add all the points in the given node to the results for the given query
 //! point.
-template<typename MetricType, typename TreeType>
-void RangeSearchRules<MetricType, TreeType>::AddResult(const size_t queryIndex,
-                                                       TreeType& referenceNode)
+template<typename MetricType, typename TreeType, typename VisitorType>
+void RangeSearchRules<MetricType, TreeType, VisitorType>::AddResult(
+    const size_t queryIndex,
+    TreeType& referenceNode)
 {
   // Some types of trees calculate the base case evaluation before Score() is
   // called, so if the base case has already been calculated, then we must avoid
@@ -224,16 +329,19 @@ void RangeSearchRules<MetricType, TreeType>::AddResult(const size_t queryIndex,
     baseCaseMod = 1;
   }
 
-  // Resize distances and neighbors vectors appropriately.  We have to use
-  // reserve() and not resize(), because we don't know if we will encounter the
-  // case where the datasets and points are the same (and we skip in that case).
-  const size_t oldSize = neighbors[queryIndex].size();
-  neighbors[queryIndex].reserve(oldSize + referenceNode.NumDescendants() -
-      baseCaseMod);
-  distances[queryIndex].reserve(oldSize + referenceNode.NumDescendants() -
-      baseCaseMod);
+  AddDescendants<VisitorType>(queryIndex, referenceNode, baseCaseMod);
+}
 
-  for (size_t i = baseCaseMod; i < referenceNode.NumDescendants(); ++i)
+template<typename MetricType, typename TreeType, typename VisitorType>
+template<typename Visitor>
+void RangeSearchRules<MetricType, TreeType, VisitorType>::AddDescendants(
+    const size_t queryIndex,
+    TreeType& referenceNode,
+    const size_t firstDescendant,
+    const typename boost::enable_if_c<
+        !RangeVisitorTraits<Visitor>::VisitsNodes>::type*)
+{
+  for (size_t i = firstDescendant; i < referenceNode.NumDescendants(); ++i)
   {
     if ((&referenceSet == &querySet) &&
         (queryIndex == referenceNode.Descendant(i)))
@@ -242,11 +350,30 @@ void RangeSearchRules<MetricType, TreeType>::AddResult(const size_t queryIndex,
     const double distance = metric.Evaluate(querySet.unsafe_col(queryIndex),
         referenceNode.Dataset().unsafe_col(referenceNode.Descendant(i)));
 
-    neighbors[queryIndex].push_back(referenceNode.Descendant(i));
-    distances[queryIndex].push_back(distance);
+    visitor.Visit(queryIndex, referenceNode.Descendant(i), distance);
   }
 }
 
+template<typename MetricType, typename TreeType, typename VisitorType>
+template<typename Visitor>
+void RangeSearchRules<MetricType, TreeType, VisitorType>::AddDescendants(
+    const size_t queryIndex,
+    TreeType& referenceNode,
+    const size_t firstDescendant,
+    const typename boost::enable_if_c<
+        RangeVisitorTraits<Visitor>::VisitsNodes>::type*)
+{
+  // If the datasets are the same, the query point must not be counted as in its
+  // own range.  Every point in the node is in range, so the query point can
+  // only be in the node if the range contains zero.  (The skipped first
+  // descendant can't be the query point, because BaseCase() never records a
+  // query point with itself.)
+  const bool excludeQuery = (&referenceSet == &querySet) &&
+      (range.Lo() <= 0.0) && IsDescendant(referenceNode, queryIndex);
+
+  visitor.VisitNode(queryIndex, referenceNode, firstDescendant, excludeQuery);
+}
+
 }; // namespace range
 }; // namespace mlpack
 
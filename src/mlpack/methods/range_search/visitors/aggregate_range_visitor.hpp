@@ -0,0 +1,115 @@
+/**
+ * @file aggregate_range_visitor.hpp
+ *
+ * A range search visitor which sums a value associated with each reference
+ * point over all reference points in range of each query point.
+ */
+#ifndef __MLPACK_METHODS_RANGE_SEARCH_VISITORS_AGGREGATE_RANGE_VISITOR_HPP
+#define __MLPACK_METHODS_RANGE_SEARCH_VISITORS_AGGREGATE_RANGE_VISITOR_HPP
+
+#include <mlpack/core.hpp>
+#include <map>
+#include "range_visitor_traits.hpp"
+
+namespace mlpack {
+namespace range {
+
+/**
+ * A visitor for RangeSearchRules which, for each query point, counts the
+ * reference points in range and sums the values associated with them.  Whole
+ * reference nodes are added at once: the sum of the values held in a node is
+ * calculated the first time the node is visited and cached, so each node's sum
+ * is only calculated once, no matter how many query points it is added to.
+ *
+ * The values must be given in the order of the reference set the tree was
+ * built on.
+ */
+class AggregateRangeVisitor
+{
+ public:
+  /**
+   * Create the visitor.  The counts and sums vectors should be the size of the
+   * query set and filled with zeros.
+   *
+   * @param values Value associated with each reference point.
+   * @param counts Vector to accumulate the counts of each query point in.
+   * @param sums Vector to accumulate the sums of each query point in.
+   */
+  AggregateRangeVisitor(const arma::vec& values,
+                        arma::Col<size_t>& counts,
+                        arma::vec& sums) :
+      values(values),
+      counts(counts),
+      sums(sums)
+  { /* Nothing to do. */ }
+
+  //! Add the given result.
+  void Visit(const size_t queryIndex,
+             const size_t referenceIndex,
+             const double /* distance */)
+  {
+    ++counts[queryIndex];
+    sums[queryIndex] += values[referenceIndex];
+  }
+
+  //! Add all of the points in the given node; see RangeVisitorTraits.
+  template<typename TreeType>
+  void VisitNode(const size_t queryIndex,
+                 const TreeType& referenceNode,
+                 const size_t firstDescendant,
+                 const bool excludeQuery)
+  {
+    double sum = NodeSum(referenceNode);
+    if (firstDescendant > 0)
+      sum -= values[referenceNode.Descendant(0)];
+    if (excludeQuery)
+      sum -= values[queryIndex];
+
+    counts[queryIndex] += referenceNode.NumDescendants() - firstDescendant -
+        (excludeQuery ? 1 : 0);
+    sums[queryIndex] += sum;
+  }
+
+ private:
+  //! The value associated with each reference point.
+  const arma::vec& values;
+  //! The counts for each query point.
+  arma::Col<size_t>& counts;
+  //! The sums for each query point.
+  arma::vec& sums;
+
+  //! The cached sums of the values in each visited reference node.
+  std::map<const void*, double> nodeSums;
+
+  //! Get the sum of the values of all descendants of the given node.
+  template<typename TreeType>
+  double NodeSum(const TreeType& node)
+  {
+    std::map<const void*, double>::const_iterator it =
+        nodeSums.find(&node);
+    if (it != nodeSums.end())
+      return it->second;
+
+    double sum = 0.0;
+    for (size_t i = 0; i < node.NumDescendants(); ++i)
+      sum += values[node.Descendant(i)];
+
+    nodeSums[&node] = sum;
+    return sum;
+  }
+};
+
+//! AggregateRangeVisitor can add whole nodes at once, and its copies share the
+//! counts and sums (but each has its own cache of node sums).
+template<>
+class RangeVisitorTraits<AggregateRangeVisitor>
+{
+ public:
+  static const bool VisitsNodes = true;
+  static const bool ParallelQueries = true;
+};
+
+}; // namespace range
+}; // namespace mlpack
+
+#endif
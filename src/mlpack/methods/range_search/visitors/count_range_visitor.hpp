@@ -0,0 +1,70 @@
+/**
+ * @file count_range_visitor.hpp
+ *
+ * A range search visitor which only counts the number of reference points in
+ * range of each query point.
+ */
+#ifndef __MLPACK_METHODS_RANGE_SEARCH_VISITORS_COUNT_RANGE_VISITOR_HPP
+#define __MLPACK_METHODS_RANGE_SEARCH_VISITORS_COUNT_RANGE_VISITOR_HPP
+
+#include <mlpack/core.hpp>
+#include "range_visitor_traits.hpp"
+
+namespace mlpack {
+namespace range {
+
+/**
+ * A visitor for RangeSearchRules which counts the number of reference points in
+ * range of each query point, without storing the points themselves.  Because
+ * whole reference nodes can be counted at once, a count-only search does not
+ * need to evaluate the distance to each point in range.
+ */
+class CountRangeVisitor
+{
+ public:
+  /**
+   * Create the visitor.  The counts vector should be the size of the query set
+   * and filled with zeros.
+   *
+   * @param counts Vector to accumulate the counts of each query point in.
+   */
+  CountRangeVisitor(arma::Col<size_t>& counts) : counts(counts) { }
+
+  //! Count the given result.
+  void Visit(const size_t queryIndex,
+             const size_t /* referenceIndex */,
+             const double /* distance */)
+  {
+    ++counts[queryIndex];
+  }
+
+  //! Count all of the points in the given node; see RangeVisitorTraits.
+  template<typename TreeType>
+  void VisitNode(const size_t queryIndex,
+                 const TreeType& referenceNode,
+                 const size_t firstDescendant,
+                 const bool excludeQuery)
+  {
+    counts[queryIndex] += referenceNode.NumDescendants() - firstDescendant -
+        (excludeQuery ? 1 : 0);
+  }
+
+ private:
+  //! The counts for each query point.
+  arma::Col<size_t>& counts;
+};
+
+//! CountRangeVisitor can count whole nodes at once, and its copies share the
+//! counts, each of which is only modified for its own query point.
+template<>
+class RangeVisitorTraits<CountRangeVisitor>
+{
+ public:
+  static const bool VisitsNodes = true;
+  static const bool ParallelQueries = true;
+};
+
+}; // namespace range
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,129 @@
+/**
+ * @file csr_range_visitor.hpp
+ *
+ * A range search visitor which collects results into flat buffers, and can
+ * then produce a compact compressed sparse row (CSR) representation of the
+ * results.
+ */
+#ifndef __MLPACK_METHODS_RANGE_SEARCH_VISITORS_CSR_RANGE_VISITOR_HPP
+#define __MLPACK_METHODS_RANGE_SEARCH_VISITORS_CSR_RANGE_VISITOR_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace range {
+
+/**
+ * A visitor for RangeSearchRules which appends each result to three flat,
+ * growable buffers (query indices, reference indices, and distances).  Unlike
+ * storing results in a std::vector for each query point, this performs only a
+ * logarithmic number of allocations in the total number of results, and
+ * results are stored contiguously.
+ *
+ * When the search is finished, Finalize() sorts the results by query point
+ * with a counting sort (which takes linear time) and produces the CSR
+ * representation: the neighbors of query point i are neighbors[offsets[i]]
+ * through neighbors[offsets[i + 1] - 1], with the corresponding distances in
+ * the same positions in the distances vector.
+ */
+class CSRRangeVisitor
+{
+ public:
+  //! Create the visitor with empty buffers.
+  CSRRangeVisitor() { /* Nothing to do. */ }
+
+  /**
+   * Store the given result in the buffers.
+   *
+   * @param queryIndex Index of the query point.
+   * @param referenceIndex Index of the reference point in range.
+   * @param distance Distance between the query and reference points.
+   */
+  void Visit(const size_t queryIndex,
+             const size_t referenceIndex,
+             const double distance)
+  {
+    queryIndices.push_back(queryIndex);
+    referenceIndices.push_back(referenceIndex);
+    distances.push_back(distance);
+  }
+
+  /**
+   * Append the results held in another visitor to this one.  The other visitor
+   * is emptied.
+   *
+   * @param other Visitor to take results from.
+   */
+  void Merge(CSRRangeVisitor& other)
+  {
+    queryIndices.insert(queryIndices.end(), other.queryIndices.begin(),
+        other.queryIndices.end());
+    referenceIndices.insert(referenceIndices.end(),
+        other.referenceIndices.begin(), other.referenceIndices.end());
+    distances.insert(distances.end(), other.distances.begin(),
+        other.distances.end());
+
+    other.Clear();
+  }
+
+  /**
+   * Turn the buffered results into the CSR representation, and empty the
+   * buffers.  Within each query point, results are kept in the order they were
+   * found.
+   *
+   * @param numQueries Number of query points.
+   * @param offsets Vector of offsets (of length numQueries + 1) to fill.
+   * @param neighborsOut Vector of neighbor indices to fill.
+   * @param distancesOut Vector of neighbor distances to fill.
+   */
+  void Finalize(const size_t numQueries,
+                arma::Col<size_t>& offsets,
+                arma::Col<size_t>& neighborsOut,
+                arma::vec& distancesOut)
+  {
+    // Count the results for each query point.
+    offsets.zeros(numQueries + 1);
+    for (size_t i = 0; i < queryIndices.size(); ++i)
+      ++offsets[queryIndices[i] + 1];
+
+    for (size_t i = 1; i <= numQueries; ++i)
+      offsets[i] += offsets[i - 1];
+
+    // Now scatter the results into place.
+    neighborsOut.set_size(queryIndices.size());
+    distancesOut.set_size(queryIndices.size());
+    arma::Col<size_t> positions(offsets.memptr(), numQueries);
+    for (size_t i = 0; i < queryIndices.size(); ++i)
+    {
+      const size_t position = positions[queryIndices[i]]++;
+      neighborsOut[position] = referenceIndices[i];
+      distancesOut[position] = distances[i];
+    }
+
+    Clear();
+  }
+
+  //! Get the number of results held by the visitor.
+  size_t Size() const { return queryIndices.size(); }
+
+  //! Empty the buffers and release their memory.
+  void Clear()
+  {
+    std::vector<size_t>().swap(queryIndices);
+    std::vector<size_t>().swap(referenceIndices);
+    std::vector<double>().swap(distances);
+  }
+
+ private:
+  //! The query index of each result.
+  std::vector<size_t> queryIndices;
+  //! The reference index of each result.
+  std::vector<size_t> referenceIndices;
+  //! The distance of each result.
+  std::vector<double> distances;
+};
+
+}; // namespace range
+}; // namespace mlpack
+
+#endif
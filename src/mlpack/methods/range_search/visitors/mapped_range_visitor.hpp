@@ -0,0 +1,88 @@
+/**
+ * @file mapped_range_visitor.hpp
+ *
+ * A range search visitor which maps the indices of results back to their
+ * original indices before tree construction, then passes them on to another
+ * visitor.
+ */
+#ifndef __MLPACK_METHODS_RANGE_SEARCH_VISITORS_MAPPED_RANGE_VISITOR_HPP
+#define __MLPACK_METHODS_RANGE_SEARCH_VISITORS_MAPPED_RANGE_VISITOR_HPP
+
+#include <mlpack/core.hpp>
+#include "range_visitor_traits.hpp"
+
+namespace mlpack {
+namespace range {
+
+/**
+ * A visitor for RangeSearchRules which wraps another visitor, and maps query
+ * and reference indices through the given oldFromNew mappings (produced by
+ * tree construction) before passing each result along.  If a mapping is NULL,
+ * the corresponding indices are passed through unchanged.
+ *
+ * @tparam VisitorType Type of the visitor to pass mapped results to.
+ */
+template<typename VisitorType>
+class MappedRangeVisitor
+{
+ public:
+  /**
+   * Create the visitor.
+   *
+   * @param visitor Visitor to pass mapped results to.
+   * @param queryMap Mapping for query indices (may be NULL).
+   * @param referenceMap Mapping for reference indices (may be NULL).
+   */
+  MappedRangeVisitor(VisitorType& visitor,
+                     const std::vector<size_t>* queryMap,
+                     const std::vector<size_t>* referenceMap) :
+      visitor(visitor),
+      queryMap(queryMap),
+      referenceMap(referenceMap)
+  { /* Nothing to do. */ }
+
+  /**
+   * Map the given result and pass it to the wrapped visitor.
+   *
+   * @param queryIndex Index of the query point.
+   * @param referenceIndex Index of the reference point in range.
+   * @param distance Distance between the query and reference points.
+   */
+  void Visit(const size_t queryIndex,
+             const size_t referenceIndex,
+             const double distance)
+  {
+    visitor.Visit((queryMap == NULL) ? queryIndex : (*queryMap)[queryIndex],
+        (referenceMap == NULL) ? referenceIndex :
+        (*referenceMap)[referenceIndex], distance);
+  }
+
+ private:
+  //! The visitor to pass results to.
+  VisitorType& visitor;
+  //! The mapping for query indices.
+  const std::vector<size_t>* queryMap;
+  //! The mapping for reference indices.
+  const std::vector<size_t>* referenceMap;
+};
+
+/**
+ * Copies of a MappedRangeVisitor share the wrapped visitor.  Query indices are
+ * mapped one-to-one, so results for different query points still go to
+ * different query points of the wrapped visitor; the search can therefore be
+ * run in parallel if the wrapped visitor allows it.  Whole nodes are not passed
+ * on, because their indices would need to be mapped one by one anyway.
+ */
+template<typename VisitorType>
+class RangeVisitorTraits<MappedRangeVisitor<VisitorType> >
+{
+ public:
+  static const bool VisitsNodes = false;
+  static const bool ParallelQueries =
+      RangeVisitorTraits<VisitorType>::ParallelQueries;
+};
+
+}; // namespace range
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * @file range_visitor_traits.hpp
+ *
+ * This file contains the RangeVisitorTraits class, which describes the
+ * capabilities of a range search visitor, so that RangeSearchRules can take
+ * shortcuts when the visitor allows them.
+ */
+#ifndef __MLPACK_METHODS_RANGE_SEARCH_VISITORS_RANGE_VISITOR_TRAITS_HPP
+#define __MLPACK_METHODS_RANGE_SEARCH_VISITORS_RANGE_VISITOR_TRAITS_HPP
+
+namespace mlpack {
+namespace range {
+
+/**
+ * The RangeVisitorTraits class provides compile-time information about a range
+ * search visitor.  By default, a visitor is only given results one point at a
+ * time through Visit().  Visitors which only need aggregate information (such
+ * as a count of the points in range) can specialize this class and set
+ * VisitsNodes to true; then, when every descendant of a reference node is
+ * known to be in range of a query point, RangeSearchRules will call
+ *
+ * @code
+ * template<typename TreeType>
+ * void VisitNode(const size_t queryIndex,
+ *                const TreeType& referenceNode,
+ *                const size_t firstDescendant,
+ *                const bool excludeQuery);
+ * @endcode
+ *
+ * instead of calculating the distance to each descendant.  All descendants of
+ * referenceNode starting with index firstDescendant are in range, except that
+ * if excludeQuery is true, the reference point with index queryIndex (which is
+ * a descendant of referenceNode) must not be counted.  Reference indices in
+ * the node are not mapped back to the original dataset.
+ *
+ * The search may also be run in parallel, if the visitor allows it, by setting
+ * ParallelQueries to true.  Then each thread is given its own copy of the
+ * visitor, and each query point is only handled by one thread; the copies must
+ * store their results in the same place, and Visit() calls for different query
+ * points from different threads must not interfere with each other.
+ *
+ * An example specialization is given below:
+ *
+ * @code
+ * template<>
+ * class RangeVisitorTraits<MyVisitor>
+ * {
+ *  public:
+ *   static const bool VisitsNodes = true;
+ *   static const bool ParallelQueries = false;
+ * };
+ * @endcode
+ */
+template<typename VisitorType>
+class RangeVisitorTraits
+{
+ public:
+  /**
+   * If true, the visitor accepts whole reference nodes through VisitNode().
+   */
+  static const bool VisitsNodes = false;
+
+  /**
+   * If true, copies of the visitor may be used by different threads at once,
+   * as long as each thread handles different query points.
+   */
+  static const bool ParallelQueries = false;
+};
+
+}; // namespace range
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * @file vector_range_visitor.hpp
+ *
+ * A range search visitor which stores the results of the search in a vector of
+ * vectors, with one vector for each query point.
+ */
+#ifndef __MLPACK_METHODS_RANGE_SEARCH_VISITORS_VECTOR_RANGE_VISITOR_HPP
+#define __MLPACK_METHODS_RANGE_SEARCH_VISITORS_VECTOR_RANGE_VISITOR_HPP
+
+#include <mlpack/core.hpp>
+#include "range_visitor_traits.hpp"
+
+namespace mlpack {
+namespace range {
+
+/**
+ * A visitor for RangeSearchRules which stores each result in the vector of
+ * neighbors and the vector of distances for the corresponding query point.
+ * Both outer vectors must already have one entry for each query point.
+ *
+ * Every visitor passed to RangeSearch::Search() must implement the
+ * Visit(queryIndex, referenceIndex, distance) function, which is called once
+ * for each reference point that falls in the range of each query point.
+ */
+class VectorRangeVisitor
+{
+ public:
+  /**
+   * Create the visitor, which will store results in the given vectors.
+   *
+   * @param neighbors Vector to store neighbor indices in.
+   * @param distances Vector to store neighbor distances in.
+   */
+  VectorRangeVisitor(std::vector<std::vector<size_t> >& neighbors,
+                     std::vector<std::vector<double> >& distances) :
+      neighbors(neighbors),
+      distances(distances)
+  { /* Nothing to do. */ }
+
+  /**
+   * Store the given result.
+   *
+   * @param queryIndex Index of the query point.
+   * @param referenceIndex Index of the reference point in range.
+   * @param distance Distance between the query and reference points.
+   */
+  void Visit(const size_t queryIndex,
+             const size_t referenceIndex,
+             const double distance)
+  {
+    neighbors[queryIndex].push_back(referenceIndex);
+    distances[queryIndex].push_back(distance);
+  }
+
+ private:
+  //! The vector the resultant neighbor indices should be stored in.
+  std::vector<std::vector<size_t> >& neighbors;
+  //! The vector the resultant neighbor distances should be stored in.
+  std::vector<std::vector<double> >& distances;
+};
+
+//! Copies of VectorRangeVisitor share the result vectors, and each query
+//! point's results are held separately, so the search can be run in parallel.
+template<>
+class RangeVisitorTraits<VectorRangeVisitor>
+{
+ public:
+  static const bool VisitsNodes = false;
+  static const bool ParallelQueries = true;
+};
+
+}; // namespace range
+}; // namespace mlpack
+
+#endif
@@ -9,6 +9,7 @@
 
 #include <mlpack/core.hpp>
 #include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
+#include <mlpack/core/optimizers/data_parallel/data_parallel_function.hpp>
 
 #include "softmax_regression_function.hpp"
 
@@ -46,6 +47,12 @@ namespace regression {
  * L_BFGS<SoftmaxRegressionFunction> optimizer(srf, numBasis, numIterations);
  * SoftmaxRegression<L_BFGS> regressor2(optimizer);
  *
+ * // Train with the objective evaluated in parallel shards.
+ * DataParallelFunction<SoftmaxRegressionFunction> parallelSrf(srf);
+ * L_BFGS<DataParallelFunction<SoftmaxRegressionFunction> > parallelOptimizer(
+ *     parallelSrf);
+ * SoftmaxRegression<L_BFGS> regressor3(parallelOptimizer);
+ *
  * arma::mat test_data; // Test data matrix.
  * arma::vec predictions1, predictions2; // Vectors to store predictions in.
  *
@@ -90,6 +97,19 @@ class SoftmaxRegression
    * @param optimizer Instantiated optimizer with instantiated error function.
    */
   SoftmaxRegression(OptimizerType<SoftmaxRegressionFunction>& optimizer);
+
+  /**
+   * Construct the softmax regression model, and train it with the given
+   * optimizer, whose error function is a SoftmaxRegressionFunction wrapped in
+   * an optimization::DataParallelFunction, so that a full-batch optimizer (such
+   * as L-BFGS) evaluates the objective and gradient over the data in parallel
+   * shards.
+   *
+   * @param optimizer Instantiated optimizer with instantiated parallel error
+   *     function.
+   */
+  SoftmaxRegression(OptimizerType<optimization::DataParallelFunction<
+      SoftmaxRegressionFunction> >& optimizer);
   
   /**
    * Predict the class labels for the provided feature points. The function
@@ -146,6 +166,12 @@ class SoftmaxRegression
   {
     return lambda;
   }
+
+  //! Gets the trained model parameters.
+  const arma::mat& Parameters() const
+  {
+    return parameters;
+  }
                     
  private:
   //! Parameters after optimization.
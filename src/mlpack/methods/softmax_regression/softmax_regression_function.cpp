@@ -18,13 +18,11 @@ SoftmaxRegressionFunction::SoftmaxRegressionFunction(const arma::mat& data,
     labels(labels),
     inputSize(inputSize),
     numClasses(numClasses),
-    lambda(lambda)
+    lambda(lambda),
+    blockSize(1000)
 {
   // Intialize the parameters to suitable values.
   initialPoint = InitializeWeights();
-  
-  // Calculate the label matrix.
-  GetGroundTruthMatrix(labels, groundTruth);
 }
 
 /**
@@ -78,9 +76,64 @@ void SoftmaxRegressionFunction::GetGroundTruthMatrix(const arma::vec& labels,
 }
 
 /**
- * Evaluates the objective function given the parameters.
+ * Calculates the class probabilities for a range of training examples, and the
+ * negative log likelihood of their labels.
  */
-double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters) const
+double SoftmaxRegressionFunction::GetProbabilitiesMatrix(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize,
+    arma::mat& probabilities) const
+{
+  // Calculate the class probabilities for each training example. The
+  // probabilities for each of the classes are given by:
+  // p_j = exp(theta_j' * x_i) / sum(exp(theta_k' * x_i))
+  // The sum is calculated over all the classes.
+  // x_i is the input vector for a particular training example.
+  // theta_j is the parameter vector associated with a particular class.
+  // Subtracting m = max(theta_k' * x_i) from every score does not change the
+  // probabilities, but keeps exp() from overflowing.  The log probability of
+  // the label y_i is then
+  // log(p_y) = theta_y' * x_i - m - log(sum(exp(theta_k' * x_i - m))),
+  // so only the label's score is needed for the log likelihood.
+  probabilities = parameters * data.cols(begin, begin + batchSize - 1);
+
+  double negativeLogLikelihood = 0.0;
+  for (size_t i = 0; i < batchSize; i++)
+  {
+    double* scores = probabilities.colptr(i);
+    const double labelScore = scores[(size_t) labels(begin + i)];
+
+    double maxScore = scores[0];
+    for (size_t j = 1; j < numClasses; j++)
+      maxScore = std::max(maxScore, scores[j]);
+
+    double sum = 0.0;
+    for (size_t j = 0; j < numClasses; j++)
+    {
+      scores[j] = std::exp(scores[j] - maxScore);
+      sum += scores[j];
+    }
+
+    for (size_t j = 0; j < numClasses; j++)
+      scores[j] /= sum;
+
+    negativeLogLikelihood += maxScore + std::log(sum) - labelScore;
+  }
+
+  return negativeLogLikelihood;
+}
+
+/**
+ * Calculates the objective function, and optionally its gradient, for a range
+ * of training examples, a block of examples at a time.
+ */
+double SoftmaxRegressionFunction::EvaluateBlocks(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize,
+    const bool computeGradient,
+    arma::mat& gradient) const
 {
   // The objective function is the negative log likelihood of the model
   // calculated over all the training examples. Mathematically it is as follows:
@@ -90,32 +143,78 @@ double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters) const
   // value is 1 only when 'x' is satisfied, otherwise it is 0.
   // 'm' is the number of training examples.
   // The cost also takes into account the regularization to control the
-  // parameter weights.
-  
-  // Calculate the class probabilities for each training example. The
-  // probabilities for each of the classes are given by:
-  // p_j = exp(theta_j' * x_i) / sum(exp(theta_k' * x_i))
-  // The sum is calculated over all the classes.
-  // x_i is the input vector for a particular training example.
-  // theta_j is the parameter vector associated with a particular class.
-  arma::mat hypothesis, probabilities;
-  
-  hypothesis = arma::exp(parameters * data);
-  probabilities = hypothesis / arma::repmat(arma::sum(hypothesis, 0),
-                                            numClasses, 1);
-                                            
-  // Calculate the log likelihood and regularization terms.
-  double logLikelihood, weightDecay, cost;
-  
-  logLikelihood = arma::accu(groundTruth % arma::log(probabilities)) /
-      data.n_cols;
-  weightDecay = 0.5 * lambda * arma::accu(parameters % parameters);
-  
+  // parameter weights.  For a batch of the examples, the regularization is
+  // scaled by the fraction of the examples in the batch.
+  // The gradient of the log likelihood term is (P - 1{y}) * X' / m, where P
+  // holds the class probabilities of the examples X.
+
+  // The blocks are split as evenly as possible into one contiguous shard per
+  // thread, and the shards' results are summed in order.  When called from a
+  // parallel region (as by DataParallelFunction), the blocks are processed by
+  // the calling thread only.
+  const size_t numBlocks = (batchSize + blockSize - 1) / blockSize;
+  const size_t numShards = (OmpInParallel() || numBlocks == 0) ? 1 :
+      std::min((size_t) OmpGetMaxThreads(), numBlocks);
+
+  arma::vec negativeLogLikelihoods(numShards);
+  std::vector<arma::mat> gradients(computeGradient ? numShards : 0);
+  #pragma omp parallel for schedule(static)
+  for (size_t s = 0; s < numShards; s++)
+  {
+    arma::mat probabilities;
+    negativeLogLikelihoods[s] = 0.0;
+    if (computeGradient)
+      gradients[s].zeros(parameters.n_rows, parameters.n_cols);
+
+    const size_t firstBlock = (s * numBlocks) / numShards;
+    const size_t lastBlock = ((s + 1) * numBlocks) / numShards;
+    for (size_t b = firstBlock; b < lastBlock; b++)
+    {
+      const size_t blockBegin = begin + b * blockSize;
+      const size_t blockExamples = std::min(blockSize,
+          batchSize - b * blockSize);
+
+      negativeLogLikelihoods[s] += GetProbabilitiesMatrix(parameters,
+          blockBegin, blockExamples, probabilities);
+
+      if (computeGradient)
+      {
+        // Subtract the indicator of the label from the probabilities.
+        for (size_t i = 0; i < blockExamples; i++)
+          probabilities((size_t) labels(blockBegin + i), i) -= 1.0;
+
+        gradients[s] += probabilities *
+            data.cols(blockBegin, blockBegin + blockExamples - 1).t();
+      }
+    }
+  }
+
+  double negativeLogLikelihood = 0.0;
+  for (size_t s = 0; s < numShards; s++)
+    negativeLogLikelihood += negativeLogLikelihoods[s];
+
+  const double batchFraction = double(batchSize) / data.n_cols;
+  if (computeGradient)
+  {
+    gradient = gradients[0];
+    for (size_t s = 1; s < numShards; s++)
+      gradient += gradients[s];
+
+    gradient = gradient / data.n_cols + lambda * batchFraction * parameters;
+  }
+
   // The cost is the sum of the negative log likelihood and the regularization
-  // terms. 
-  cost = -logLikelihood + weightDecay;
-      
-  return cost;
+  // terms.
+  return negativeLogLikelihood / data.n_cols +
+      0.5 * lambda * batchFraction * arma::accu(parameters % parameters);
+}
+
+/**
+ * Evaluates the objective function given the parameters.
+ */
+double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters) const
+{
+  return Evaluate(parameters, 0, data.n_cols);
 }
 
 /**
@@ -124,19 +223,51 @@ double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters) const
 void SoftmaxRegressionFunction::Gradient(const arma::mat& parameters,
                                          arma::mat& gradient) const
 {
-  // Calculate the class probabilities for each training example. The
-  // probabilities for each of the classes are given by:
-  // p_j = exp(theta_j' * x_i) / sum(exp(theta_k' * x_i))
-  // The sum is calculated over all the classes.
-  // x_i is the input vector for a particular training example.
-  // theta_j is the parameter vector associated with a particular class.
-  arma::mat hypothesis, probabilities;
-  
-  hypothesis = arma::exp(parameters * data);
-  probabilities = hypothesis / arma::repmat(arma::sum(hypothesis, 0),
-                                            numClasses, 1);
-                                            
-  // Calculate the parameter gradients.
-  gradient = (probabilities - groundTruth) * data.t() / data.n_cols +
-      lambda * parameters;
+  Gradient(parameters, 0, data.n_cols, gradient);
+}
+
+/**
+ * Evaluates the objective function and stores the gradient values given a set
+ * of parameters, calculating the class probabilities only once.
+ */
+double SoftmaxRegressionFunction::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  return EvaluateWithGradient(parameters, 0, data.n_cols, gradient);
+}
+
+/**
+ * Evaluates the objective function over a batch of training examples.
+ */
+double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters,
+                                           const size_t begin,
+                                           const size_t batchSize) const
+{
+  arma::mat gradient;
+  return EvaluateBlocks(parameters, begin, batchSize, false, gradient);
+}
+
+/**
+ * Calculates the gradient over a batch of training examples.
+ */
+void SoftmaxRegressionFunction::Gradient(const arma::mat& parameters,
+                                         const size_t begin,
+                                         const size_t batchSize,
+                                         arma::mat& gradient) const
+{
+  EvaluateBlocks(parameters, begin, batchSize, true, gradient);
+}
+
+/**
+ * Evaluates the objective function and the gradient over a batch of training
+ * examples, calculating the class probabilities only once.
+ */
+double SoftmaxRegressionFunction::EvaluateWithGradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize,
+    arma::mat& gradient) const
+{
+  return EvaluateBlocks(parameters, begin, batchSize, true, gradient);
 }
@@ -64,6 +64,66 @@ class SoftmaxRegressionFunction
    * @param gradient Matrix where gradient values will be stored.
    */
   void Gradient(const arma::mat& parameters, arma::mat& gradient) const;
+
+  /**
+   * Evaluates the objective function and its gradient given the current set of
+   * parameters.  The class probabilities are calculated once and used for
+   * both, so this is cheaper than calling Evaluate() and Gradient().
+   *
+   * @param parameters Current values of the model parameters.
+   * @param gradient Matrix where gradient values will be stored.
+   * @return The value of the objective function.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient) const;
+
+  /**
+   * Evaluates the objective function using only the training examples begin
+   * to (begin + batchSize - 1); the regularization term is scaled by the
+   * fraction of the examples in the batch, so the sum over batches that cover
+   * the data is Evaluate(parameters).
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first example of the batch.
+   * @param batchSize Number of examples in the batch.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize) const;
+
+  /**
+   * Evaluates the gradient of the objective function using only the training
+   * examples begin to (begin + batchSize - 1), in the same way as the batch
+   * Evaluate().
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first example of the batch.
+   * @param batchSize Number of examples in the batch.
+   * @param gradient Matrix where gradient values will be stored.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                const size_t batchSize,
+                arma::mat& gradient) const;
+
+  /**
+   * Evaluates the objective function and its gradient using only the training
+   * examples begin to (begin + batchSize - 1), calculating the class
+   * probabilities only once.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first example of the batch.
+   * @param batchSize Number of examples in the batch.
+   * @param gradient Matrix where gradient values will be stored.
+   * @return The value of the objective function for the batch.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t begin,
+                              const size_t batchSize,
+                              arma::mat& gradient) const;
+
+  //! Return the number of training examples.
+  size_t NumFunctions() const { return data.n_cols; }
   
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
@@ -103,14 +163,26 @@ class SoftmaxRegressionFunction
   {
     return lambda;
   }
+
+  //! Sets the number of examples whose class probabilities are computed at
+  //! once (per thread); this must be positive.
+  void BlockSize(const size_t size)
+  {
+    this->blockSize = size;
+  }
+
+  //! Gets the number of examples whose class probabilities are computed at
+  //! once (per thread).
+  size_t BlockSize() const
+  {
+    return blockSize;
+  }
                             
  private:
   //! Training data matrix.
   const arma::mat& data;
   //! Labels associated with the training data.
   const arma::vec& labels;
-  //! Label matrix for the provided data.
-  arma::sp_mat groundTruth;
   //! Initial parameter point.
   arma::mat initialPoint;
   //! Size of input feature vector.
@@ -119,6 +191,48 @@ class SoftmaxRegressionFunction
   size_t numClasses;
   //! L2-regularization constant.
   double lambda;
+  //! Maximum number of examples whose probabilities are computed at once.
+  size_t blockSize;
+
+  /**
+   * Calculates the probabilities of each class for the training examples begin
+   * to (begin + batchSize - 1), given the parameters, and returns the negative
+   * log likelihood of their labels.  The largest score of each example is
+   * subtracted before exponentiating, so that exp() cannot overflow, and the
+   * log likelihood is taken from the label's entry of each example only.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first training example.
+   * @param batchSize Number of training examples.
+   * @param probabilities Matrix where the probabilities will be stored
+   *     (numClasses x batchSize).
+   * @return The negative log likelihood of the labels of the examples.
+   */
+  double GetProbabilitiesMatrix(const arma::mat& parameters,
+                                const size_t begin,
+                                const size_t batchSize,
+                                arma::mat& probabilities) const;
+
+  /**
+   * Calculates the objective function, and its gradient if computeGradient is
+   * true, for the training examples begin to (begin + batchSize - 1).  The
+   * examples are processed in blocks of at most blockSize examples, so the
+   * class probabilities are never held for more than a block at once per
+   * thread; the blocks are split among the OpenMP threads.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first training example.
+   * @param batchSize Number of training examples.
+   * @param computeGradient Whether to calculate the gradient.
+   * @param gradient Matrix where the gradient will be stored (if
+   *     computeGradient is true).
+   * @return The value of the objective function for the examples.
+   */
+  double EvaluateBlocks(const arma::mat& parameters,
+                        const size_t begin,
+                        const size_t batchSize,
+                        const bool computeGradient,
+                        arma::mat& gradient) const;
 };
 
 }; // namespace regression
@@ -55,37 +55,52 @@ SoftmaxRegression<OptimizerType>::SoftmaxRegression(
       << "trained model is " << out << "." << std::endl;
 }
 
+template<template<typename> class OptimizerType>
+SoftmaxRegression<OptimizerType>::SoftmaxRegression(
+    OptimizerType<optimization::DataParallelFunction<
+        SoftmaxRegressionFunction> >& optimizer) :
+    parameters(optimizer.Function().GetInitialPoint()),
+    inputSize(optimizer.Function().Function().InputSize()),
+    numClasses(optimizer.Function().Function().NumClasses()),
+    lambda(optimizer.Function().Function().Lambda())
+{
+  // Train the model.
+  Timer::Start("softmax_regression_optimization");
+  const double out = optimizer.Optimize(parameters);
+  Timer::Stop("softmax_regression_optimization");
+
+  Log::Info << "SoftmaxRegression::SoftmaxRegression(): final objective of "
+      << "trained model is " << out << "." << std::endl;
+}
+
 template<template<typename> class OptimizerType>
 void SoftmaxRegression<OptimizerType>::Predict(const arma::mat& testData,
                                                arma::vec& predictions)
 {
-  // Calculate the probabilities for each test input.
-  arma::mat hypothesis, probabilities;
-  
-  hypothesis = arma::exp(parameters * testData);
-  probabilities = hypothesis / arma::repmat(arma::sum(hypothesis, 0),
-                                            numClasses, 1);
+  // Calculate the scores of each class for each test input.  The class
+  // probabilities are exp(score) normalized over the classes, so the class
+  // with the highest score is the most probable; computing the probabilities
+  // themselves is not needed (and exp() could overflow).
+  arma::mat scores = parameters * testData;
   
   // Prepare necessary data.
   predictions.zeros(testData.n_cols);
-  double maxProbability = 0;
   
   // For each test input.
   for(size_t i = 0; i < testData.n_cols; i++)
   {
+    double maxScore = scores(0, i);
+
     // For each class.
-    for(size_t j = 0; j < numClasses; j++)
+    for(size_t j = 1; j < numClasses; j++)
     {
-      // If a higher class probability is encountered, change prediction.
-      if(probabilities(j, i) > maxProbability)
+      // If a higher class score is encountered, change prediction.
+      if(scores(j, i) > maxScore)
       {
-        maxProbability = probabilities(j, i);
+        maxScore = scores(j, i);
         predictions(i) = j;
       }
     }
-    
-    // Set maximum probability to zero for the next input.
-    maxProbability = 0;
   }
 }
 
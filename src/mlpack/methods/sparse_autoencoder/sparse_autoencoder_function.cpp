@@ -66,18 +66,12 @@ const arma::mat SparseAutoencoderFunction::InitializeWeights()
   return parameters;
 }
 
-/** Evaluates the objective function given the parameters.
+/** Performs a feedforward pass and stores the activations of the layers.
   */
-double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters) const
+void SparseAutoencoderFunction::FeedForward(const arma::mat& parameters,
+                                            arma::mat& hiddenLayer,
+                                            arma::mat& outputLayer) const
 {
-  // The objective function is the average squared reconstruction error of the
-  // network. w1 and b1 are the weights and biases associated with the hidden
-  // layer, whereas w2 and b2 are associated with the output layer.
-  // f(w1,w2,b1,b2) = sum((data - sigmoid(w2*sigmoid(w1data + b1) + b2))^2) / 2m
-  // 'm' is the number of training examples.
-  // The cost also takes into account the regularization and KL divergence terms
-  // to control the parameter weights and sparsity of the model respectively.
-
   // Compute the limits for the parameters w1, w2, b1 and b2.
   const size_t l1 = hiddenSize;
   const size_t l2 = visibleSize;
@@ -91,8 +85,6 @@ double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters) const
   // b1 <- parameters.submat(0, l2, l1-1, l2)
   // b2 <- parameters.submat(l3, 0, l3, l2-1).t()
 
-  arma::mat hiddenLayer, outputLayer;
-
   // Compute activations of the hidden and output layers.
   Sigmoid(parameters.submat(0, 0, l1 - 1, l2 - 1) * data +
       arma::repmat(parameters.submat(0, l2, l1 - 1, l2), 1, data.n_cols),
@@ -101,6 +93,23 @@ double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters) const
   Sigmoid(parameters.submat(l1, 0, l3 - 1, l2 - 1).t() * hiddenLayer +
       arma::repmat(parameters.submat(l3, 0, l3, l2 - 1).t(), 1, data.n_cols),
       outputLayer);
+}
+
+/** Calculates the objective function from the activations of the layers.
+  */
+double SparseAutoencoderFunction::Cost(const arma::mat& parameters,
+                                       const arma::mat& hiddenLayer,
+                                       const arma::mat& outputLayer) const
+{
+  // The objective function is the average squared reconstruction error of the
+  // network. w1 and b1 are the weights and biases associated with the hidden
+  // layer, whereas w2 and b2 are associated with the output layer.
+  // f(w1,w2,b1,b2) = sum((data - sigmoid(w2*sigmoid(w1data + b1) + b2))^2) / 2m
+  // 'm' is the number of training examples.
+  // The cost also takes into account the regularization and KL divergence terms
+  // to control the parameter weights and sparsity of the model respectively.
+  const size_t l2 = visibleSize;
+  const size_t l3 = 2 * hiddenSize;
 
   arma::mat rhoCap, diff;
 
@@ -134,41 +143,20 @@ double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters) const
   return cost;
 }
 
-/** Calculates and stores the gradient values given a set of parameters.
+/** Calculates the gradient values from the activations of the layers.
   */
-void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
-                                         arma::mat& gradient) const
+void SparseAutoencoderFunction::Backpropagate(const arma::mat& parameters,
+                                              const arma::mat& hiddenLayer,
+                                              const arma::mat& outputLayer,
+                                              arma::mat& gradient) const
 {
-  // Performs a feedforward pass of the neural network, and computes the
-  // activations of the output layer as in the Evaluate() method. It uses the
-  // Backpropagation algorithm to calculate the delta values at each layer,
-  // except for the input layer. The delta values are then used with input layer
-  // and hidden layer activations to get the parameter gradients.
-
-  // Compute the limits for the parameters w1, w2, b1 and b2.
+  // Uses the Backpropagation algorithm to calculate the delta values at each
+  // layer, except for the input layer. The delta values are then used with
+  // input layer and hidden layer activations to get the parameter gradients.
   const size_t l1 = hiddenSize;
   const size_t l2 = visibleSize;
   const size_t l3 = 2 * hiddenSize;
 
-  // w1, w2, b1 and b2 are not extracted separately, 'parameters' is directly
-  // used in their place to avoid copying data. The following representations
-  // are used:
-  // w1 <- parameters.submat(0, 0, l1-1, l2-1)
-  // w2 <- parameters.submat(l1, 0, l3-1, l2-1).t()
-  // b1 <- parameters.submat(0, l2, l1-1, l2)
-  // b2 <- parameters.submat(l3, 0, l3, l2-1).t()
-
-  arma::mat hiddenLayer, outputLayer;
-
-  // Compute activations of the hidden and output layers.
-  Sigmoid(parameters.submat(0, 0, l1 - 1, l2 - 1) * data +
-      arma::repmat(parameters.submat(0, l2, l1 - 1, l2), 1, data.n_cols),
-      hiddenLayer);
-
-  Sigmoid(parameters.submat(l1, 0, l3 - 1, l2 - 1).t() * hiddenLayer +
-      arma::repmat(parameters.submat(l3, 0, l3, l2 - 1).t(), 1, data.n_cols),
-      outputLayer);
-
   arma::mat rhoCap, diff;
 
   // Average activations of the hidden layer.
@@ -203,3 +191,42 @@ void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
   gradient.submat(0, l2, l1 - 1, l2) = arma::sum(delHid, 1) / data.n_cols;
   gradient.submat(l3, 0, l3, l2 - 1) = (arma::sum(delOut, 1) / data.n_cols).t();
 }
+
+/** Evaluates the objective function given the parameters.
+  */
+double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters) const
+{
+  arma::mat hiddenLayer, outputLayer;
+  FeedForward(parameters, hiddenLayer, outputLayer);
+
+  return Cost(parameters, hiddenLayer, outputLayer);
+}
+
+/** Calculates and stores the gradient values given a set of parameters.
+  */
+void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
+                                         arma::mat& gradient) const
+{
+  // Performs a feedforward pass of the neural network, and computes the
+  // activations of the output layer as in the Evaluate() method, then
+  // backpropagates the error.
+  arma::mat hiddenLayer, outputLayer;
+  FeedForward(parameters, hiddenLayer, outputLayer);
+
+  Backpropagate(parameters, hiddenLayer, outputLayer, gradient);
+}
+
+/** Evaluates the objective function and stores the gradient values given a set
+  * of parameters, with a single feedforward pass.
+  */
+double SparseAutoencoderFunction::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  arma::mat hiddenLayer, outputLayer;
+  FeedForward(parameters, hiddenLayer, outputLayer);
+
+  Backpropagate(parameters, hiddenLayer, outputLayer, gradient);
+
+  return Cost(parameters, hiddenLayer, outputLayer);
+}
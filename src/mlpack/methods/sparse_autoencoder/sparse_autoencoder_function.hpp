@@ -65,6 +65,18 @@ class SparseAutoencoderFunction
    */
   void Gradient(const arma::mat& parameters, arma::mat& gradient) const;
 
+  /**
+   * Evaluates the objective function and its gradient given the current set of
+   * parameters.  The feedforward pass is performed once and used for both, so
+   * this is cheaper than calling Evaluate() and Gradient().
+   *
+   * @param parameters Current values of the model parameters.
+   * @param gradient Matrix where gradient values will be stored.
+   * @return The value of the objective function.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient) const;
+
   /**
    * Returns the elementwise sigmoid of the passed matrix, where the sigmoid
    * function of a real number 'x' is [1 / (1 + exp(-x))].
@@ -154,6 +166,26 @@ class SparseAutoencoderFunction
   double beta;
   //! Sparsity parameter.
   double rho;
+
+  /**
+   * Performs a feedforward pass of the network over the data, and stores the
+   * activations of the hidden and output layers.
+   */
+  void FeedForward(const arma::mat& parameters,
+                   arma::mat& hiddenLayer,
+                   arma::mat& outputLayer) const;
+
+  //! Calculates the objective function from the activations of the layers.
+  double Cost(const arma::mat& parameters,
+              const arma::mat& hiddenLayer,
+              const arma::mat& outputLayer) const;
+
+  //! Calculates the gradient from the activations of the layers, with the
+  //! backpropagation algorithm.
+  void Backpropagate(const arma::mat& parameters,
+                     const arma::mat& hiddenLayer,
+                     const arma::mat& outputLayer,
+                     arma::mat& gradient) const;
 };
 
 }; // namespace nn
@@ -45,6 +45,72 @@ problems.  It should only be necessary to include <mlpack/core.hpp> and not\
   #define force_inline __forceinline
 #endif
 
+// Use OpenMP if it is available.
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+
+/**
+ * Wrappers around the few OpenMP runtime functions that mlpack uses.  When
+ * mlpack is built without OpenMP, these behave as if there were only one
+ * thread, so parallel code still compiles and runs serially.  They live in the
+ * mlpack namespace so that they can never clash with the declarations in
+ * <omp.h> in code that includes mlpack.
+ */
+inline int OmpGetMaxThreads()
+{
+#ifdef HAS_OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+//! Get the number of threads in the current team (see OmpGetMaxThreads()).
+inline int OmpGetNumThreads()
+{
+#ifdef HAS_OPENMP
+  return omp_get_num_threads();
+#else
+  return 1;
+#endif
+}
+
+//! Get the index of the calling thread (see OmpGetMaxThreads()).
+inline int OmpGetThreadNum()
+{
+#ifdef HAS_OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
+//! Return whether we are inside a parallel region (see OmpGetMaxThreads()).
+inline bool OmpInParallel()
+{
+#ifdef HAS_OPENMP
+  return omp_in_parallel();
+#else
+  return false;
+#endif
+}
+
+//! Set the number of threads for later parallel regions (see
+//! OmpGetMaxThreads()).
+inline void OmpSetNumThreads(const int numThreads)
+{
+#ifdef HAS_OPENMP
+  omp_set_num_threads(numThreads);
+#else
+  (void) numThreads;
+#endif
+}
+
+}; // namespace mlpack
+
 // Now include Armadillo through the special mlpack extensions.
 #include <mlpack/core/arma_extend/arma_extend.hpp>
 
@@ -777,6 +777,273 @@ BOOST_AUTO_TEST_CASE(SparseAllkNNKDTreeTest)
   }
 }
 
+/**
+ * Make sure single-precision nearest neighbors search with the given tree type
+ * gives the same results as naive single-precision search, and distances close
+ * to those of double-precision search.
+ */
+template<typename TreeType>
+void CheckFloatAllkNN(const bool singleMode)
+{
+  arma::fmat dataset;
+  dataset.randu(4, 1000);
+  arma::mat doubleDataset = arma::conv_to<arma::mat>::from(dataset);
+
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, TreeType>
+      FloatAllkNN;
+
+  FloatAllkNN allknn(dataset, false, singleMode);
+  FloatAllkNN naive(dataset, true);
+  NeighborSearch<NearestNeighborSort, EuclideanDistance>
+      doubleNaive(doubleDataset, true);
+
+  arma::Mat<size_t> neighbors, naiveNeighbors, doubleNeighbors;
+  arma::mat distances, naiveDistances, doubleDistances;
+  allknn.Search(5, neighbors, distances);
+  naive.Search(5, naiveNeighbors, naiveDistances);
+  doubleNaive.Search(5, doubleNeighbors, doubleDistances);
+
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], naiveNeighbors[i]);
+    BOOST_REQUIRE_EQUAL(distances[i], naiveDistances[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], doubleDistances[i], 1e-3);
+  }
+}
+
+// Make sure nearest neighbors works with kd-trees on single-precision data.
+BOOST_AUTO_TEST_CASE(FloatAllkNNKDTreeTest)
+{
+  typedef BinarySpaceTree<HRectBound<2>,
+      NeighborSearchStat<NearestNeighborSort>, arma::fmat> FloatKDTree;
+
+  CheckFloatAllkNN<FloatKDTree>(false);
+  CheckFloatAllkNN<FloatKDTree>(true);
+}
+
+// Make sure nearest neighbors works with ball trees on single-precision data.
+BOOST_AUTO_TEST_CASE(FloatAllkNNBallTreeTest)
+{
+  typedef BinarySpaceTree<BallBound<arma::fvec>,
+      NeighborSearchStat<NearestNeighborSort>, arma::fmat> FloatBallTree;
+
+  CheckFloatAllkNN<FloatBallTree>(false);
+  CheckFloatAllkNN<FloatBallTree>(true);
+}
+
+// Make sure nearest neighbors works with cover trees on single-precision data.
+BOOST_AUTO_TEST_CASE(FloatAllkNNCoverTreeTest)
+{
+  typedef CoverTree<LMetric<2, true>, FirstPointIsRoot,
+      NeighborSearchStat<NearestNeighborSort>, arma::fmat> FloatCoverTree;
+
+  CheckFloatAllkNN<FloatCoverTree>(false);
+  CheckFloatAllkNN<FloatCoverTree>(true);
+}
+
+/**
+ * Make sure that the dual-tree search, when it runs the base cases of pairs of
+ * leaves all at once for the Euclidean distance, gives the same results as the
+ * naive search when the points are far from the origin relative to the
+ * distances between them (so the distances can't be computed accurately from
+ * the norms), and when some points are duplicated.
+ */
+BOOST_AUTO_TEST_CASE(BlockBaseCaseTest)
+{
+  typedef NeighborSearchRules<NearestNeighborSort, EuclideanDistance,
+      BinarySpaceTree<HRectBound<2>, NeighborSearchStat<NearestNeighborSort> > >
+      RuleType;
+  typedef NeighborSearchRules<NearestNeighborSort, ManhattanDistance,
+      BinarySpaceTree<HRectBound<1>, NeighborSearchStat<NearestNeighborSort> > >
+      ManhattanRuleType;
+  BOOST_REQUIRE(RuleTraits<RuleType>::HasBlockBaseCase == true);
+  BOOST_REQUIRE(RuleTraits<ManhattanRuleType>::HasBlockBaseCase == false);
+
+  arma::mat dataset = arma::randu<arma::mat>(3, 800) * 1e-3 + 1000.0;
+  dataset.cols(400, 499) = dataset.cols(0, 99);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    arma::mat treeQuery(dataset);
+    arma::mat naiveQuery(dataset);
+
+    AllkNN allknn(treeQuery);
+    AllkNN naive(naiveQuery, true);
+    allknn.BlockBaseCases() = true;
+
+    arma::Mat<size_t> treeNeighbors, naiveNeighbors;
+    arma::mat treeDistances, naiveDistances;
+    allknn.Search(5, treeNeighbors, treeDistances);
+    naive.Search(5, naiveNeighbors, naiveDistances);
+
+    for (size_t i = 0; i < treeDistances.n_elem; ++i)
+    {
+      if (naiveDistances[i] == 0.0)
+        BOOST_REQUIRE_SMALL(treeDistances[i], 1e-10);
+      else
+        BOOST_REQUIRE_CLOSE(treeDistances[i], naiveDistances[i], 1e-5);
+    }
+
+    // Now points close to the origin.
+    dataset -= 1000.0;
+  }
+}
+
+/**
+ * Make sure that approximate search only returns neighbors within a factor of
+ * (1 + epsilon) of the true neighbors of the same rank, with kd-trees and cover
+ * trees, in dual-tree and single-tree mode.
+ */
+BOOST_AUTO_TEST_CASE(ApproximateAllkNNTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1500);
+  const double epsilon = 0.5;
+
+  AllkNN naive(dataset, true);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  naive.Search(10, trueNeighbors, trueDistances);
+
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance,
+      CoverTree<EuclideanDistance, FirstPointIsRoot,
+      NeighborSearchStat<NearestNeighborSort> > > CoverTreeAllkNN;
+
+  for (size_t mode = 0; mode < 4; ++mode)
+  {
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    if (mode < 2)
+    {
+      AllkNN allknn(dataset, false, (mode == 1),
+          EuclideanDistance(), epsilon);
+      allknn.Search(10, neighbors, distances);
+    }
+    else
+    {
+      CoverTreeAllkNN allknn(dataset, false, (mode == 3),
+          EuclideanDistance(), epsilon);
+      allknn.Search(10, neighbors, distances);
+    }
+
+    for (size_t i = 0; i < distances.n_elem; ++i)
+      BOOST_REQUIRE_LE(distances[i], (1 + epsilon) * trueDistances[i] + 1e-10);
+
+    const double recall = AllkNN::Recall(neighbors, trueNeighbors);
+    BOOST_REQUIRE_GE(recall, 0.0);
+    BOOST_REQUIRE_LE(recall, 1.0);
+    BOOST_REQUIRE_LE(AllkNN::EffectiveError(distances, trueDistances),
+        epsilon);
+  }
+}
+
+/**
+ * Make sure that exact search has a recall of 1 and an effective error of 0,
+ * and check Recall() and EffectiveError() on a small hand-made example.
+ */
+BOOST_AUTO_TEST_CASE(RecallEffectiveErrorTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 500);
+
+  AllkNN naive(dataset, true);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  naive.Search(5, trueNeighbors, trueDistances);
+
+  AllkNN allknn(dataset);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  allknn.Search(5, neighbors, distances);
+
+  BOOST_REQUIRE_CLOSE(AllkNN::Recall(neighbors, trueNeighbors), 1.0, 1e-5);
+  BOOST_REQUIRE_SMALL(AllkNN::EffectiveError(distances, trueDistances), 1e-5);
+
+  // Two query points with two neighbors each; three of the four true neighbors
+  // are found (in a different order for the first point).
+  arma::Mat<size_t> found("1 4; 0 5");
+  arma::Mat<size_t> real("0 4; 1 3");
+  BOOST_REQUIRE_CLOSE(AllkNN::Recall(found, real), 0.75, 1e-5);
+
+  arma::mat foundDistances("1.0 3.0; 2.0 4.0");
+  arma::mat realDistances("1.0 2.0; 0.0 4.0");
+  BOOST_REQUIRE_CLOSE(AllkNN::EffectiveError(foundDistances, realDistances),
+      1.0 / 6.0, 1e-5);
+}
+
+/**
+ * Make sure that budgeted search without a budget gives exact results, and that
+ * with a budget, the results are no better than the true neighbors, the budget
+ * is kept, and the results which are reported exact are.
+ */
+BOOST_AUTO_TEST_CASE(BudgetedAllkNNTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1500);
+  arma::mat querySet = arma::randu<arma::mat>(5, 300);
+
+  // Monochromatic search, then search with a query set in dual-tree mode and in
+  // single-tree mode, since these map the results differently.
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    AllkNN* naive = (mode == 0) ? new AllkNN(dataset, true) :
+        new AllkNN(dataset, querySet, true);
+    arma::Mat<size_t> trueNeighbors;
+    arma::mat trueDistances;
+    naive->Search(10, trueNeighbors, trueDistances);
+    delete naive;
+
+    AllkNN* allknn = (mode == 0) ? new AllkNN(dataset) :
+        new AllkNN(dataset, querySet, false, (mode == 2));
+    const size_t numQueries = trueNeighbors.n_cols;
+
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    std::vector<bool> exact;
+    allknn->BudgetedSearch(10, 0, 0, neighbors, distances, exact);
+
+    BOOST_REQUIRE_EQUAL(exact.size(), numQueries);
+    for (size_t i = 0; i < numQueries; ++i)
+    {
+      BOOST_REQUIRE(exact[i] == true);
+      for (size_t j = 0; j < 10; ++j)
+      {
+        BOOST_REQUIRE_EQUAL(neighbors(j, i), trueNeighbors(j, i));
+        BOOST_REQUIRE_CLOSE(distances(j, i), trueDistances(j, i), 1e-5);
+      }
+    }
+
+    // Now with a budget of 40 base cases for each query point.
+    allknn->BaseCases() = 0;
+    allknn->BudgetedSearch(10, 40, 0, neighbors, distances, exact);
+    BOOST_REQUIRE_LE(allknn->BaseCases(), 40 * numQueries);
+
+    size_t numExact = 0;
+    for (size_t i = 0; i < numQueries; ++i)
+    {
+      for (size_t j = 0; j < 10; ++j)
+        BOOST_REQUIRE_GE(distances(j, i), trueDistances(j, i) - 1e-10);
+
+      if (exact[i])
+      {
+        ++numExact;
+        for (size_t j = 0; j < 10; ++j)
+          BOOST_REQUIRE_EQUAL(neighbors(j, i), trueNeighbors(j, i));
+      }
+    }
+
+    BOOST_REQUIRE_LT(numExact, numQueries);
+
+    // A budget of one visited node is spent on the root, so nothing is found.
+    allknn->BudgetedSearch(10, 0, 1, neighbors, distances, exact);
+    for (size_t i = 0; i < numQueries; ++i)
+    {
+      BOOST_REQUIRE(exact[i] == false);
+      BOOST_REQUIRE_EQUAL(neighbors(0, i), size_t() - 1);
+      BOOST_REQUIRE_EQUAL(distances(0, i), DBL_MAX);
+    }
+
+    delete allknn;
+  }
+}
+
 /*
 BOOST_AUTO_TEST_CASE(SparseAllkNNCoverTreeTest)
 {
@@ -61,5 +61,44 @@ BOOST_AUTO_TEST_CASE(GockenbachFunctionTest)
   BOOST_REQUIRE_CLOSE(coords[2], 0.015099932, 1e-3);
 }
 
+/**
+ * Make sure that an optimization resumed from its state takes the same steps
+ * as an uninterrupted optimization.
+ */
+BOOST_AUTO_TEST_CASE(AugLagrangianResumeTest)
+{
+  // Four iterations at once.
+  AugLagrangianTestFunction f;
+  AugLagrangian<AugLagrangianTestFunction> aug(f);
+  arma::mat coords = f.GetInitialPoint();
+  aug.Optimize(coords, 5);
+
+  // Four iterations in two runs, with another optimizer for the second run.
+  AugLagrangianState state;
+  arma::mat resumedCoords = f.GetInitialPoint();
+  AugLagrangian<AugLagrangianTestFunction> firstAug(f);
+  firstAug.Optimize(resumedCoords, state, 3);
+
+  util::SaveRestoreUtility sr;
+  state.Save(sr);
+  AugLagrangianState loadedState;
+  loadedState.Load(sr);
+  BOOST_REQUIRE_EQUAL(loadedState.Iteration(), (size_t) 2);
+  BOOST_REQUIRE_CLOSE(loadedState.Sigma(), state.Sigma(), 1e-10);
+  BOOST_REQUIRE_CLOSE(loadedState.PenaltyThreshold(),
+      state.PenaltyThreshold(), 1e-10);
+  BOOST_REQUIRE_EQUAL(loadedState.Lambda().n_elem, state.Lambda().n_elem);
+
+  AugLagrangian<AugLagrangianTestFunction> secondAug(f);
+  secondAug.Optimize(resumedCoords, state, 3);
+
+  BOOST_REQUIRE_EQUAL(state.Iteration(), (size_t) 4);
+  BOOST_REQUIRE_CLOSE(secondAug.Sigma(), aug.Sigma(), 1e-10);
+  for (size_t i = 0; i < aug.Lambda().n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(secondAug.Lambda()[i], aug.Lambda()[i], 1e-10);
+  for (size_t i = 0; i < coords.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(resumedCoords[i], coords[i], 1e-10);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
 
@@ -121,4 +121,115 @@ BOOST_AUTO_TEST_CASE(DualTreeVsSingleTree)
   }
 }
 
+/**
+ * Make sure that naive search (which evaluates the kernel in blocks) gives the
+ * right kernel values, and that parallel tree searches agree with it, also when
+ * the same FastMKS object is used for a second search.
+ */
+BOOST_AUTO_TEST_CASE(ParallelSearchTest)
+{
+  arma::mat data;
+  data.randn(5, 2000);
+  PolynomialKernel pk(2.0, 1.0);
+
+  FastMKS<PolynomialKernel> naive(data, pk, false, true);
+
+  arma::Mat<size_t> naiveIndices;
+  arma::mat naiveProducts;
+  naive.Search(10, naiveIndices, naiveProducts);
+
+  for (size_t q = 0; q < naiveIndices.n_cols; ++q)
+  {
+    for (size_t r = 0; r < naiveIndices.n_rows; ++r)
+    {
+      BOOST_REQUIRE_NE(naiveIndices(r, q), q);
+      BOOST_REQUIRE_CLOSE(naiveProducts(r, q), pk.Evaluate(data.unsafe_col(q),
+          data.unsafe_col(naiveIndices(r, q))), 1e-5);
+    }
+  }
+
+  // (If OpenMP is not available, the searches use one thread.)
+  const int oldThreads = OmpGetMaxThreads();
+  OmpSetNumThreads(4);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    FastMKS<PolynomialKernel> tree(data, pk, (mode == 1));
+
+    arma::Mat<size_t> treeIndices;
+    arma::mat treeProducts;
+    tree.Search(5, treeIndices, treeProducts);
+    tree.Search(10, treeIndices, treeProducts);
+
+    for (size_t q = 0; q < treeIndices.n_cols; ++q)
+    {
+      for (size_t r = 0; r < treeIndices.n_rows; ++r)
+      {
+        BOOST_REQUIRE_EQUAL(treeIndices(r, q), naiveIndices(r, q));
+        BOOST_REQUIRE_CLOSE(treeProducts(r, q), naiveProducts(r, q), 1e-5);
+      }
+    }
+  }
+
+  OmpSetNumThreads(oldThreads);
+}
+
+/**
+ * Make sure that an index searched with batches of queries gives the same
+ * results as naive search, both before and after it is saved and loaded.
+ */
+BOOST_AUTO_TEST_CASE(IndexBatchSearchTest)
+{
+  arma::mat referenceData;
+  referenceData.randn(5, 1000);
+  arma::mat queryData;
+  queryData.randn(5, 200);
+  LinearKernel lk;
+
+  FastMKS<LinearKernel> naive(referenceData, queryData, lk, false, true);
+
+  arma::Mat<size_t> naiveIndices;
+  arma::mat naiveProducts;
+  naive.Search(10, naiveIndices, naiveProducts);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    FastMKS<LinearKernel> index(referenceData, lk, (mode == 1));
+    // (The filename must be a std::string, or it may be taken as a matrix.)
+    const std::string filename = "test-fastmks-index.bin";
+    index.Save(filename);
+    FastMKS<LinearKernel> loaded(filename, lk, (mode == 1));
+
+    BOOST_REQUIRE_EQUAL(loaded.ReferenceSet().n_cols, referenceData.n_cols);
+
+    // Search in two batches each time.
+    for (size_t i = 0; i < 2; ++i)
+    {
+      FastMKS<LinearKernel>& search = (i == 0) ? index : loaded;
+
+      arma::Mat<size_t> indices;
+      arma::mat products;
+      search.Search(queryData.cols(0, 99), 10, indices, products);
+
+      arma::Mat<size_t> moreIndices;
+      arma::mat moreProducts;
+      search.Search(queryData.cols(100, 199), 10, moreIndices, moreProducts);
+
+      indices = arma::join_rows(indices, moreIndices);
+      products = arma::join_rows(products, moreProducts);
+
+      for (size_t q = 0; q < indices.n_cols; ++q)
+      {
+        for (size_t r = 0; r < indices.n_rows; ++r)
+        {
+          BOOST_REQUIRE_EQUAL(indices(r, q), naiveIndices(r, q));
+          BOOST_REQUIRE_CLOSE(products(r, q), naiveProducts(r, q), 1e-5);
+        }
+      }
+    }
+  }
+
+  remove("test-fastmks-index.bin");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,226 @@
+/**
+ * @file hdbscan_test.cpp
+ *
+ * Tests for HDBSCAN and the mutual reachability minimum spanning tree.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/hdbscan/hdbscan.hpp>
+#include <mlpack/methods/emst/dtb.hpp>
+#include <boost/test/unit_test.hpp>
+#include "old_boost_test_definitions.hpp"
+
+using namespace mlpack;
+using namespace mlpack::hdbscan;
+using namespace mlpack::emst;
+
+BOOST_AUTO_TEST_SUITE(HDBSCANTest);
+
+/**
+ * Make sure a small hand-built spanning tree gives the right dendrogram.
+ */
+BOOST_AUTO_TEST_CASE(SingleLinkageTest)
+{
+  // Points 0 and 1 merge first, then 2 and 3, then everything.
+  arma::mat mst(3, 3);
+  mst.col(0) = arma::vec("0 1 0.5");
+  mst.col(1) = arma::vec("2 3 1.0");
+  mst.col(2) = arma::vec("1 2 3.0");
+
+  arma::mat dendrogram;
+  SingleLinkage(mst, dendrogram);
+
+  BOOST_REQUIRE_EQUAL(dendrogram.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(dendrogram.n_cols, 3);
+
+  BOOST_REQUIRE_EQUAL(dendrogram(0, 0), 0);
+  BOOST_REQUIRE_EQUAL(dendrogram(1, 0), 1);
+  BOOST_REQUIRE_CLOSE(dendrogram(2, 0), 0.5, 1e-5);
+  BOOST_REQUIRE_EQUAL(dendrogram(3, 0), 2);
+
+  BOOST_REQUIRE_EQUAL(dendrogram(0, 1), 2);
+  BOOST_REQUIRE_EQUAL(dendrogram(1, 1), 3);
+  BOOST_REQUIRE_CLOSE(dendrogram(2, 1), 1.0, 1e-5);
+  BOOST_REQUIRE_EQUAL(dendrogram(3, 1), 2);
+
+  // The last merge joins cluster 4 (points 0 and 1) and cluster 5 (points 2
+  // and 3).
+  BOOST_REQUIRE_EQUAL(dendrogram(0, 2), 4);
+  BOOST_REQUIRE_EQUAL(dendrogram(1, 2), 5);
+  BOOST_REQUIRE_CLOSE(dendrogram(2, 2), 3.0, 1e-5);
+  BOOST_REQUIRE_EQUAL(dendrogram(3, 2), 4);
+}
+
+/**
+ * With all core distances equal to zero, the mutual reachability MST should be
+ * the same as the Euclidean MST.
+ */
+BOOST_AUTO_TEST_CASE(ZeroCoreDistanceTest)
+{
+  arma::mat inputData;
+  if (!data::Load("test_data_3_1000.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  DualTreeBoruvka<> dtb(inputData);
+  DualTreeBoruvka<> mrDtb(inputData);
+
+  arma::vec coreDistances(inputData.n_cols);
+  coreDistances.zeros();
+
+  arma::mat results;
+  arma::mat mrResults;
+  dtb.ComputeMST(results);
+  mrDtb.ComputeMST(mrResults, coreDistances);
+
+  BOOST_REQUIRE_EQUAL(results.n_cols, mrResults.n_cols);
+  for (size_t i = 0; i < results.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(results(0, i), mrResults(0, i));
+    BOOST_REQUIRE_EQUAL(results(1, i), mrResults(1, i));
+    BOOST_REQUIRE_CLOSE(results(2, i), mrResults(2, i), 1e-5);
+  }
+}
+
+/**
+ * Make sure the dual-tree mutual reachability MST has the same edge weights as
+ * the naive one.  Mutual reachability distance has lots of ties, so the edges
+ * themselves may differ.
+ */
+BOOST_AUTO_TEST_CASE(MutualReachabilityDualTreeVsNaive)
+{
+  arma::mat inputData;
+  if (!data::Load("test_data_3_1000.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  HDBSCAN<> h(5, 5);
+  arma::vec coreDistances;
+  h.CoreDistances(inputData, coreDistances);
+
+  HDBSCAN<> naive(5, 5, true);
+  arma::vec naiveCoreDistances;
+  naive.CoreDistances(inputData, naiveCoreDistances);
+
+  BOOST_REQUIRE_EQUAL(coreDistances.n_elem, naiveCoreDistances.n_elem);
+  for (size_t i = 0; i < coreDistances.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(coreDistances[i], naiveCoreDistances[i], 1e-5);
+
+  arma::mat mst;
+  arma::mat naiveMst;
+  h.MutualReachabilityMST(inputData, coreDistances, mst);
+  naive.MutualReachabilityMST(inputData, coreDistances, naiveMst);
+
+  BOOST_REQUIRE_EQUAL(mst.n_cols, inputData.n_cols - 1);
+  BOOST_REQUIRE_EQUAL(naiveMst.n_cols, inputData.n_cols - 1);
+  for (size_t i = 0; i < mst.n_cols; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(mst(2, i), naiveMst(2, i), 1e-5);
+
+    // No edge can be shorter than the core distances of its endpoints.
+    BOOST_REQUIRE_GE(mst(2, i) + 1e-10, coreDistances[(size_t) mst(0, i)]);
+    BOOST_REQUIRE_GE(mst(2, i) + 1e-10, coreDistances[(size_t) mst(1, i)]);
+  }
+}
+
+/**
+ * Two well-separated blobs with a few far-away outliers should give two
+ * clusters, with the outliers labeled as noise.
+ */
+BOOST_AUTO_TEST_CASE(TwoClusterTest)
+{
+  arma::mat data(2, 410);
+  data.cols(0, 199) = arma::randn<arma::mat>(2, 200);
+  data.cols(200, 399) = arma::randn<arma::mat>(2, 200);
+  data.cols(200, 399) += 50.0;
+  for (size_t i = 400; i < 410; ++i)
+  {
+    data(0, i) = 1000.0 * (i - 399.0);
+    data(1, i) = -1000.0 * (i - 399.0);
+  }
+
+  HDBSCAN<> h(15, 5);
+  arma::Col<size_t> assignments;
+  const size_t clusters = h.Cluster(data, assignments);
+
+  BOOST_REQUIRE_EQUAL(clusters, 2);
+  BOOST_REQUIRE_EQUAL(assignments.n_elem, 410);
+
+  // Every outlier is noise.
+  for (size_t i = 400; i < 410; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], size_t() - 1);
+
+  // Each blob must be (mostly) in its own cluster; some points on the edge of
+  // a blob may be noise.
+  size_t zeros = 0;
+  for (size_t i = 0; i < 200; ++i)
+    if (assignments[i] == 0)
+      ++zeros;
+  const size_t firstLabel = (zeros > 100) ? 0 : 1;
+  const size_t secondLabel = 1 - firstLabel;
+
+  size_t firstMatches = 0;
+  size_t secondMatches = 0;
+  for (size_t i = 0; i < 200; ++i)
+  {
+    if (assignments[i] == firstLabel)
+      ++firstMatches;
+    if (assignments[200 + i] == secondLabel)
+      ++secondMatches;
+
+    BOOST_REQUIRE_NE(assignments[i], secondLabel);
+    BOOST_REQUIRE_NE(assignments[200 + i], firstLabel);
+  }
+
+  BOOST_REQUIRE_GT(firstMatches, 180);
+  BOOST_REQUIRE_GT(secondMatches, 180);
+
+  // The naive computation should find the same clusters.
+  HDBSCAN<> naive(15, 5, true);
+  arma::Col<size_t> naiveAssignments;
+  BOOST_REQUIRE_EQUAL(naive.Cluster(data, naiveAssignments), 2);
+  for (size_t i = 400; i < 410; ++i)
+    BOOST_REQUIRE_EQUAL(naiveAssignments[i], size_t() - 1);
+}
+
+/**
+ * Check the condensed tree on a tiny dendrogram where every split sheds too few
+ * points, so there is only the root cluster.
+ */
+BOOST_AUTO_TEST_CASE(CondensedTreeNoSplitTest)
+{
+  arma::mat mst(3, 3);
+  mst.col(0) = arma::vec("0 1 0.5");
+  mst.col(1) = arma::vec("1 2 1.0");
+  mst.col(2) = arma::vec("2 3 2.0");
+
+  arma::mat dendrogram;
+  SingleLinkage(mst, dendrogram);
+
+  CondensedTree tree(dendrogram, 3);
+
+  BOOST_REQUIRE_EQUAL(tree.NumPoints(), 4);
+  BOOST_REQUIRE_EQUAL(tree.NumClusters(), 1);
+  BOOST_REQUIRE_EQUAL(tree.Parents().size(), 4);
+
+  // Point 3 falls out at lambda 1 / 2; the rest fall out at lambda 1 / 1 when
+  // the cluster shrinks below three points.
+  for (size_t i = 0; i < tree.Parents().size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(tree.Parents()[i], 4);
+    if (tree.Children()[i] == 3)
+      BOOST_REQUIRE_CLOSE(tree.Lambdas()[i], 0.5, 1e-5);
+    else
+      BOOST_REQUIRE_CLOSE(tree.Lambdas()[i], 1.0, 1e-5);
+  }
+
+  // Without a single cluster, everything is noise.
+  arma::Col<size_t> assignments;
+  BOOST_REQUIRE_EQUAL(tree.ExtractClusters(assignments), 0);
+  for (size_t i = 0; i < 4; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], size_t() - 1);
+
+  // Allowing a single cluster puts everything in it.
+  BOOST_REQUIRE_EQUAL(tree.ExtractClusters(assignments, true), 1);
+  for (size_t i = 0; i < 4; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -112,4 +112,109 @@ BOOST_AUTO_TEST_CASE(RosenbrockWoodFunctionTest)
   }
 }
 
+/**
+ * Make sure that an optimization resumed from its state takes the same steps
+ * as an uninterrupted optimization, and that a saved and loaded state can be
+ * resumed.
+ */
+BOOST_AUTO_TEST_CASE(LBFGSResumeTest)
+{
+  RosenbrockFunction f;
+  L_BFGS<RosenbrockFunction> lbfgs(f);
+
+  arma::mat coords = f.GetInitialPoint();
+  lbfgs.Optimize(coords, 15);
+
+  // Now do the same iterations in three runs.
+  LBFGSState state;
+  arma::mat resumedCoords = f.GetInitialPoint();
+  for (size_t run = 0; run < 3; ++run)
+    lbfgs.Optimize(resumedCoords, 5, state);
+
+  BOOST_REQUIRE_EQUAL(state.Iteration(), (size_t) 15);
+  BOOST_REQUIRE_CLOSE(resumedCoords[0], coords[0], 1e-10);
+  BOOST_REQUIRE_CLOSE(resumedCoords[1], coords[1], 1e-10);
+
+  // Save the state, load it, and finish the optimization with another
+  // optimizer.
+  mlpack::util::SaveRestoreUtility sr;
+  state.Save(sr);
+
+  LBFGSState loadedState;
+  loadedState.Load(sr);
+  BOOST_REQUIRE_EQUAL(loadedState.Iteration(), (size_t) 15);
+  BOOST_REQUIRE_EQUAL(loadedState.S().n_slices, state.S().n_slices);
+  for (size_t i = 0; i < state.S().n_elem; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(loadedState.S()[i], state.S()[i], 1e-10);
+    BOOST_REQUIRE_CLOSE(loadedState.Y()[i], state.Y()[i], 1e-10);
+  }
+
+  L_BFGS<RosenbrockFunction> otherLbfgs(f);
+  otherLbfgs.Optimize(resumedCoords, 10000, loadedState);
+
+  BOOST_REQUIRE_SMALL(f.Evaluate(resumedCoords), 1e-5);
+  BOOST_REQUIRE_CLOSE(resumedCoords[0], 1.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(resumedCoords[1], 1.0, 1e-5);
+}
+
+/**
+ * Make sure that the statistics of an optimization add up: every line search
+ * trial evaluates the function and its gradient once, and only the starting
+ * and finishing points are evaluated outside of the iterations.
+ */
+BOOST_AUTO_TEST_CASE(LBFGSStatisticsTest)
+{
+  RosenbrockFunction f;
+  L_BFGS<RosenbrockFunction> lbfgs(f);
+
+  arma::mat coords = f.GetInitialPoint();
+  const double before = LBFGSStatistics::Seconds(
+      mlpack::Timer::Get("lbfgs_objective"));
+  lbfgs.Optimize(coords, 10000);
+  const LBFGSStatistics& statistics = lbfgs.Statistics();
+
+  BOOST_REQUIRE_GT(statistics.Iterations(), (size_t) 0);
+  BOOST_REQUIRE_EQUAL(statistics.IterationLineSearchTrials().size(),
+      statistics.Iterations());
+  BOOST_REQUIRE_EQUAL(statistics.IterationStepSizes().size(),
+      statistics.Iterations());
+
+  size_t trials = 0;
+  for (size_t i = 0; i < statistics.Iterations(); ++i)
+  {
+    const size_t iterationTrials = statistics.IterationLineSearchTrials()[i];
+    BOOST_REQUIRE_GT(iterationTrials, (size_t) 0);
+    BOOST_REQUIRE_EQUAL(statistics.IterationFunctionEvaluations()[i],
+        iterationTrials);
+    BOOST_REQUIRE_EQUAL(statistics.IterationGradientEvaluations()[i],
+        iterationTrials);
+    BOOST_REQUIRE_GE(statistics.IterationStepSizes()[i], 0.0);
+    BOOST_REQUIRE_GE(statistics.IterationObjectiveTimes()[i], 0.0);
+    BOOST_REQUIRE_GE(statistics.IterationSearchDirectionTimes()[i], 0.0);
+    BOOST_REQUIRE_GE(statistics.IterationUpdateBasisSetTimes()[i], 0.0);
+    trials += iterationTrials;
+  }
+
+  // The first line search succeeds.
+  BOOST_REQUIRE_GT(statistics.IterationStepSizes()[0], 0.0);
+  BOOST_REQUIRE_EQUAL(statistics.LineSearchTrials(), trials);
+  BOOST_REQUIRE_EQUAL(statistics.FunctionEvaluations(), trials + 2);
+  BOOST_REQUIRE_EQUAL(statistics.GradientEvaluations(), trials + 1);
+
+  // The time is also accumulated in the timer.
+  const double after = LBFGSStatistics::Seconds(
+      mlpack::Timer::Get("lbfgs_objective"));
+  BOOST_REQUIRE_GE(statistics.ObjectiveTime(), 0.0);
+  BOOST_REQUIRE_CLOSE(after - before + 1.0, statistics.ObjectiveTime() + 1.0,
+      1e-5);
+
+  // A new optimization resets the statistics.
+  coords = f.GetInitialPoint();
+  lbfgs.Optimize(coords, 1);
+  BOOST_REQUIRE_EQUAL(lbfgs.Statistics().Iterations(), (size_t) 1);
+  BOOST_REQUIRE_EQUAL(lbfgs.Statistics().FunctionEvaluations(),
+      lbfgs.Statistics().LineSearchTrials() + 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
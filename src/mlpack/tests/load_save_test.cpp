@@ -299,6 +299,42 @@ BOOST_AUTO_TEST_CASE(SaveArmaBinaryTest)
   remove("test_file.bin");
 }
 
+/**
+ * Make sure Armadillo binary data saved with one element type can be loaded
+ * into a matrix of the other element type.
+ */
+BOOST_AUTO_TEST_CASE(ConvertArmaBinaryTest)
+{
+  arma::fmat test = "1 5;"
+                    "2 6;"
+                    "3 7;"
+                    "4.5 8;";
+
+  BOOST_REQUIRE(data::Save("test_file.bin", test) == true);
+
+  arma::mat converted;
+  BOOST_REQUIRE(data::Load("test_file.bin", converted) == true);
+
+  BOOST_REQUIRE_EQUAL(converted.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(converted.n_cols, 2);
+  for (size_t i = 0; i < 8; ++i)
+    BOOST_REQUIRE_CLOSE(converted[i], (double) test[i], 1e-5);
+
+  // Now the other way around.
+  BOOST_REQUIRE(data::Save("test_file.bin", converted) == true);
+
+  arma::fmat floatTest;
+  BOOST_REQUIRE(data::Load("test_file.bin", floatTest) == true);
+
+  BOOST_REQUIRE_EQUAL(floatTest.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(floatTest.n_cols, 2);
+  for (size_t i = 0; i < 8; ++i)
+    BOOST_REQUIRE_CLOSE(floatTest[i], test[i], 1e-5);
+
+  // Remove the file.
+  remove("test_file.bin");
+}
+
 /**
  * Make sure raw_binary is loaded correctly.
  */
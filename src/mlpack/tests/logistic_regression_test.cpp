@@ -7,6 +7,9 @@
 #include <mlpack/core.hpp>
 #include <mlpack/methods/logistic_regression/logistic_regression.hpp>
 #include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
+#include <mlpack/core/optimizers/parallel_sgd/parallel_sgd.hpp>
+#include <mlpack/core/optimizers/data_parallel/data_parallel_function.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
@@ -29,7 +32,7 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionEvaluate)
   arma::vec responses("1 1 0");
 
   // Create a LogisticRegressionFunction.
-  LogisticRegressionFunction lrf(data, responses, 0.0 /* no regularization */);
+  LogisticRegressionFunction<> lrf(data, responses, 0.0 /* no reg. */);
 
   // These were hand-calculated using Octave.
   BOOST_REQUIRE_CLOSE(lrf.Evaluate(arma::vec("1 1 1")), 7.0562141665, 1e-5);
@@ -57,7 +60,7 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRandomEvaluate)
   for (size_t i = 0; i < points; ++i)
     responses[i] = math::RandInt(0, 2);
 
-  LogisticRegressionFunction lrf(data, responses, 0.0 /* no regularization */);
+  LogisticRegressionFunction<> lrf(data, responses, 0.0 /* no reg. */);
 
   // Run a bunch of trials.
   for (size_t i = 0; i < trials; ++i)
@@ -99,9 +102,9 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationEvaluate)
   for (size_t i = 0; i < points; ++i)
     responses[i] = math::RandInt(0, 2);
 
-  LogisticRegressionFunction lrfNoReg(data, responses, 0.0);
-  LogisticRegressionFunction lrfSmallReg(data, responses, 0.5);
-  LogisticRegressionFunction lrfBigReg(data, responses, 20.0);
+  LogisticRegressionFunction<> lrfNoReg(data, responses, 0.0);
+  LogisticRegressionFunction<> lrfSmallReg(data, responses, 0.5);
+  LogisticRegressionFunction<> lrfBigReg(data, responses, 20.0);
 
   for (size_t i = 0; i < trials; ++i)
   {
@@ -133,7 +136,7 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionGradient)
   arma::vec responses("1 1 0");
 
   // Create a LogisticRegressionFunction.
-  LogisticRegressionFunction lrf(data, responses, 0.0 /* no regularization */);
+  LogisticRegressionFunction<> lrf(data, responses, 0.0 /* no reg. */);
   arma::vec gradient;
 
   // If the model is at the optimum, then the gradient should be zero.
@@ -182,7 +185,7 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionSeparableEvaluate)
   arma::vec responses("1 1 0");
 
   // Create a LogisticRegressionFunction.
-  LogisticRegressionFunction lrf(data, responses, 0.0 /* no regularization */);
+  LogisticRegressionFunction<> lrf(data, responses, 0.0 /* no reg. */);
 
   // These were hand-calculated using Octave.
   BOOST_REQUIRE_CLOSE(lrf.Evaluate(arma::vec("1 1 1"), 0), 4.85873516e-2, 1e-5);
@@ -231,9 +234,9 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationSeparableEvaluate)
   for (size_t i = 0; i < points; ++i)
     responses[i] = math::RandInt(0, 2);
 
-  LogisticRegressionFunction lrfNoReg(data, responses, 0.0);
-  LogisticRegressionFunction lrfSmallReg(data, responses, 0.5);
-  LogisticRegressionFunction lrfBigReg(data, responses, 20.0);
+  LogisticRegressionFunction<> lrfNoReg(data, responses, 0.0);
+  LogisticRegressionFunction<> lrfSmallReg(data, responses, 0.5);
+  LogisticRegressionFunction<> lrfBigReg(data, responses, 20.0);
 
   // Check that the number of functions is correct.
   BOOST_REQUIRE_EQUAL(lrfNoReg.NumFunctions(), points);
@@ -273,7 +276,7 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionSeparableGradient)
   arma::vec responses("1 1 0");
 
   // Create a LogisticRegressionFunction.
-  LogisticRegressionFunction lrf(data, responses, 0.0 /* no regularization */);
+  LogisticRegressionFunction<> lrf(data, responses, 0.0 /* no reg. */);
   arma::vec gradient;
 
   // If the model is at the optimum, then the gradient should be zero.
@@ -354,9 +357,9 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationGradient)
   for (size_t i = 0; i < points; ++i)
     responses[i] = math::RandInt(0, 2);
 
-  LogisticRegressionFunction lrfNoReg(data, responses, 0.0);
-  LogisticRegressionFunction lrfSmallReg(data, responses, 0.5);
-  LogisticRegressionFunction lrfBigReg(data, responses, 20.0);
+  LogisticRegressionFunction<> lrfNoReg(data, responses, 0.0);
+  LogisticRegressionFunction<> lrfSmallReg(data, responses, 0.5);
+  LogisticRegressionFunction<> lrfBigReg(data, responses, 20.0);
 
   for (size_t i = 0; i < trials; ++i)
   {
@@ -416,9 +419,9 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationSeparableGradient)
   for (size_t i = 0; i < points; ++i)
     responses[i] = math::RandInt(0, 2);
 
-  LogisticRegressionFunction lrfNoReg(data, responses, 0.0);
-  LogisticRegressionFunction lrfSmallReg(data, responses, 0.5);
-  LogisticRegressionFunction lrfBigReg(data, responses, 20.0);
+  LogisticRegressionFunction<> lrfNoReg(data, responses, 0.0);
+  LogisticRegressionFunction<> lrfSmallReg(data, responses, 0.5);
+  LogisticRegressionFunction<> lrfBigReg(data, responses, 20.0);
 
   for (size_t i = 0; i < trials; ++i)
   {
@@ -465,6 +468,57 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationSeparableGradient)
   }
 }
 
+/**
+ * Test that EvaluateWithGradient() gives the same results as Evaluate() and
+ * Gradient(), for both the full and the separable objective function, and that
+ * the optimizers detect it.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionEvaluateWithGradient)
+{
+  const size_t points = 500;
+  const size_t dimension = 10;
+
+  arma::mat data;
+  data.randu(dimension, points);
+  arma::vec responses(points);
+  for (size_t i = 0; i < points; ++i)
+    responses[i] = math::RandInt(0, 2);
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+
+  // (The traits are copied, because they have no definition.)
+  const bool hasFull =
+      HasEvaluateWithGradient<LogisticRegressionFunction<> >::value;
+  const bool hasSeparable =
+      HasDecomposableEvaluateWithGradient<LogisticRegressionFunction<> >::value;
+  BOOST_REQUIRE_EQUAL(hasFull, true);
+  BOOST_REQUIRE_EQUAL(hasSeparable, true);
+
+  arma::vec parameters(dimension + 1);
+  parameters.randu();
+
+  arma::mat gradient, fusedGradient;
+  lrf.Gradient(parameters, gradient);
+  const double objective = lrf.EvaluateWithGradient(parameters, fusedGradient);
+
+  BOOST_REQUIRE_CLOSE(objective, lrf.Evaluate(parameters), 1e-5);
+  BOOST_REQUIRE_EQUAL(fusedGradient.n_elem, gradient.n_elem);
+  for (size_t j = 0; j < gradient.n_elem; ++j)
+    BOOST_REQUIRE_CLOSE(fusedGradient[j], gradient[j], 1e-5);
+
+  for (size_t i = 0; i < points; i += 25)
+  {
+    lrf.Gradient(parameters, i, gradient);
+    const double pointObjective = lrf.EvaluateWithGradient(parameters, i,
+        fusedGradient);
+
+    BOOST_REQUIRE_CLOSE(pointObjective, lrf.Evaluate(parameters, i), 1e-5);
+    BOOST_REQUIRE_EQUAL(fusedGradient.n_elem, gradient.n_elem);
+    for (size_t j = 0; j < gradient.n_elem; ++j)
+      BOOST_REQUIRE_CLOSE(fusedGradient[j], gradient[j], 1e-5);
+  }
+}
+
 // Test training of logistic regression on a simple dataset.
 BOOST_AUTO_TEST_CASE(LogisticRegressionLBFGSSimpleTest)
 {
@@ -497,8 +551,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionSGDSimpleTest)
 
   // Create a logistic regression object using a custom SGD object with a much
   // smaller tolerance.
-  LogisticRegressionFunction lrf(data, responses, 0.001);
-  SGD<LogisticRegressionFunction> sgd(lrf, 0.005, 500000, 1e-10);
+  LogisticRegressionFunction<> lrf(data, responses, 0.001);
+  SGD<LogisticRegressionFunction<> > sgd(lrf, 0.005, 500000, 1e-10);
   LogisticRegression<SGD> lr(sgd);
 
   // Test sigmoid function.
@@ -546,8 +600,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionSGDRegularizationSimpleTest)
 
   // Create a logistic regression object using custom SGD with a much smaller
   // tolerance.
-  LogisticRegressionFunction lrf(data, responses, 0.001);
-  SGD<LogisticRegressionFunction> sgd(lrf, 0.005, 500000, 1e-10);
+  LogisticRegressionFunction<> lrf(data, responses, 0.001);
+  SGD<LogisticRegressionFunction<> > sgd(lrf, 0.005, 500000, 1e-10);
   LogisticRegression<SGD> lr(sgd);
 
   // Test sigmoid function.
@@ -655,6 +709,351 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionSGDGaussianTest)
   BOOST_REQUIRE_CLOSE(testAcc, 100.0, 0.6); // 0.6% error tolerance.
 }
 
+/**
+ * Test that the batch objective and gradient are the sums of the separable
+ * ones, and that the sparse separable gradient is the same as the dense one.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionBatchAndSparseGradient)
+{
+  const size_t points = 200;
+  const size_t dimension = 10;
+
+  // Create a random dataset with some zeros in it.
+  arma::mat data;
+  data.randu(dimension, points);
+  data.elem(arma::find(data < 0.3)).zeros();
+  arma::vec responses(points);
+  for (size_t i = 0; i < points; ++i)
+    responses[i] = math::RandInt(0, 2);
+
+  for (size_t r = 0; r < 2; ++r)
+  {
+    LogisticRegressionFunction<> lrf(data, responses, (r == 0) ? 0.0 : 0.5);
+
+    arma::vec parameters(dimension + 1);
+    parameters.randu();
+
+    // A batch in the middle of the dataset.
+    const size_t begin = 37;
+    const size_t batchSize = 50;
+
+    double objective = 0.0;
+    arma::mat gradientSum = arma::zeros<arma::mat>(dimension + 1, 1);
+    arma::mat gradient;
+    arma::sp_mat sparseGradient;
+    for (size_t i = begin; i < begin + batchSize; ++i)
+    {
+      objective += lrf.Evaluate(parameters, i);
+      lrf.Gradient(parameters, i, gradient);
+      gradientSum += gradient;
+
+      lrf.Gradient(parameters, i, sparseGradient);
+      BOOST_REQUIRE_EQUAL(sparseGradient.n_rows, gradient.n_rows);
+      BOOST_REQUIRE_EQUAL(sparseGradient.n_cols, gradient.n_cols);
+      for (size_t j = 0; j < gradient.n_elem; ++j)
+      {
+        if (std::abs(gradient[j]) < 1e-10)
+          BOOST_REQUIRE_SMALL((double) sparseGradient(j, 0), 1e-10);
+        else
+          BOOST_REQUIRE_CLOSE((double) sparseGradient(j, 0), gradient[j],
+              1e-5);
+      }
+    }
+
+    BOOST_REQUIRE_CLOSE(lrf.Evaluate(parameters, begin, batchSize), objective,
+        1e-5);
+
+    lrf.Gradient(parameters, begin, batchSize, gradient);
+    BOOST_REQUIRE_EQUAL(gradient.n_elem, dimension + 1);
+    for (size_t j = 0; j < gradient.n_elem; ++j)
+      BOOST_REQUIRE_CLOSE(gradient[j], gradientSum[j], 1e-5);
+  }
+}
+
+// Test training of logistic regression on two Gaussians with mini-batch SGD
+// and with parallel SGD.
+BOOST_AUTO_TEST_CASE(LogisticRegressionSGDVariantsGaussianTest)
+{
+  // Generate a two-Gaussian dataset.
+  GaussianDistribution g1(arma::vec("1.0 1.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("9.0 9.0 9.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat data(3, 1000);
+  arma::vec responses(1000);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) = g1.Random();
+    responses[i] = 0;
+  }
+  for (size_t i = 500; i < 1000; ++i)
+  {
+    data.col(i) = g2.Random();
+    responses[i] = 1;
+  }
+
+  // Train a logistic regression object with each optimizer.
+  LogisticRegression<MiniBatchSGD> lr(data, responses, 0.5);
+  const double acc = lr.ComputeAccuracy(data, responses);
+  BOOST_REQUIRE_CLOSE(acc, 100.0, 0.3); // 0.3% error tolerance.
+
+  LogisticRegression<ParallelSGD> lr2(data, responses, 0.5);
+  const double acc2 = lr2.ComputeAccuracy(data, responses);
+  BOOST_REQUIRE_CLOSE(acc2, 100.0, 0.3); // 0.3% error tolerance.
+}
+
+/**
+ * Test that LogisticRegressionFunction gives the same results for sparse
+ * predictors as for dense predictors, and that the unregularized sparse
+ * gradient and the regularization weights make up the full gradient.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionSparsePredictors)
+{
+  const size_t points = 200;
+  const size_t dimension = 10;
+
+  // Create a random dataset with many zeros in it.
+  arma::mat data;
+  data.randu(dimension, points);
+  data.elem(arma::find(data < 0.7)).zeros();
+  const arma::sp_mat sparseData(data);
+  arma::vec responses(points);
+  for (size_t i = 0; i < points; ++i)
+    responses[i] = math::RandInt(0, 2);
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+  LogisticRegressionFunction<arma::sp_mat> sparseLrf(sparseData, responses,
+      0.5);
+
+  arma::mat parameters(dimension + 1, 1);
+  parameters.randu();
+
+  BOOST_REQUIRE_CLOSE(sparseLrf.Evaluate(parameters), lrf.Evaluate(parameters),
+      1e-5);
+  BOOST_REQUIRE_CLOSE(sparseLrf.Evaluate(parameters, 50, 60),
+      lrf.Evaluate(parameters, 50, 60), 1e-5);
+
+  arma::mat gradient, sparseGradient;
+  lrf.Gradient(parameters, gradient);
+  sparseLrf.Gradient(parameters, sparseGradient);
+  for (size_t j = 0; j < gradient.n_elem; ++j)
+    BOOST_REQUIRE_CLOSE(sparseGradient[j], gradient[j], 1e-5);
+
+  arma::mat weights;
+  lrf.L2Regularization(weights);
+  BOOST_REQUIRE_EQUAL(weights.n_elem, dimension + 1);
+  BOOST_REQUIRE_SMALL(weights[0], 1e-10);
+  for (size_t j = 1; j < weights.n_elem; ++j)
+    BOOST_REQUIRE_CLOSE(weights[j], 0.5 / points, 1e-5);
+
+  arma::uvec support;
+  arma::sp_mat unregularizedGradient;
+  for (size_t i = 0; i < points; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(sparseLrf.Evaluate(parameters, i),
+        lrf.Evaluate(parameters, i), 1e-5);
+
+    lrf.Gradient(parameters, i, gradient);
+    sparseLrf.Gradient(parameters, i, sparseGradient);
+    for (size_t j = 0; j < gradient.n_elem; ++j)
+      BOOST_REQUIRE_CLOSE(sparseGradient[j], gradient[j], 1e-5);
+
+    // The support is the intercept and the nonzero dimensions of the point.
+    sparseLrf.Support(i, support);
+    const arma::uvec nonzeros = arma::find(data.col(i));
+    BOOST_REQUIRE_EQUAL(support.n_elem, nonzeros.n_elem + 1);
+    BOOST_REQUIRE_EQUAL(support[0], (arma::uword) 0);
+    for (size_t j = 0; j < nonzeros.n_elem; ++j)
+      BOOST_REQUIRE_EQUAL(support[j + 1], nonzeros[j] + 1);
+
+    // The unregularized gradient plus the regularization is the gradient.
+    sparseLrf.UnregularizedGradient(parameters, i, unregularizedGradient);
+    BOOST_REQUIRE_LE(unregularizedGradient.n_nonzero, support.n_elem);
+    for (size_t j = 0; j < gradient.n_elem; ++j)
+      BOOST_REQUIRE_CLOSE((double) unregularizedGradient(j, 0) +
+          weights[j] * parameters[j], gradient[j], 1e-5);
+  }
+}
+
+/**
+ * Make sure that SGD with sparse steps and lazy L2-regularization takes the
+ * same steps as SGD with dense steps.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionLazyRegularizationSGDTest)
+{
+  const size_t points = 100;
+  const size_t dimension = 20;
+
+  arma::mat data;
+  data.randu(dimension, points);
+  data.elem(arma::find(data < 0.8)).zeros();
+  arma::vec responses(points);
+  for (size_t i = 0; i < points; ++i)
+    responses[i] = math::RandInt(0, 2);
+
+  // Only sparse predictors use sparse steps.
+  BOOST_REQUIRE(HasUnregularizedGradient<
+      LogisticRegressionFunction<arma::sp_mat> >::value);
+  BOOST_REQUIRE(!HasUnregularizedGradient<
+      LogisticRegressionFunction<arma::mat> >::value);
+
+  // The optimizers visit the points in the same (linear) order, and the
+  // tolerance is small enough that both take the same number of steps.
+  LogisticRegressionFunction<> lrf(data, responses, 2.0);
+  arma::sp_mat sparseData(data);
+  LogisticRegressionFunction<arma::sp_mat> sparseLrf(sparseData, responses,
+      lrf.GetInitialPoint(), 2.0);
+  SGD<LogisticRegressionFunction<arma::sp_mat> > lazySgd(sparseLrf, 0.05,
+      1234, 1e-75, false);
+  arma::mat lazyParameters = lrf.GetInitialPoint();
+  const double lazyObjective = lazySgd.Optimize(lazyParameters);
+
+  SGD<LogisticRegressionFunction<> > denseSgd(lrf, 0.05, 1234, 1e-75, false);
+  arma::mat denseParameters = lrf.GetInitialPoint();
+  denseSgd.Optimize(denseParameters);
+
+  BOOST_REQUIRE_CLOSE(lazyObjective, lrf.Evaluate(denseParameters), 1e-5);
+  for (size_t j = 0; j < denseParameters.n_elem; ++j)
+  {
+    if (std::abs(denseParameters[j]) < 1e-8)
+      BOOST_REQUIRE_SMALL(lazyParameters[j], 1e-8);
+    else
+      BOOST_REQUIRE_CLOSE(lazyParameters[j], denseParameters[j], 1e-5);
+  }
+}
+
+/**
+ * Train logistic regression with SGD on sparse, high-dimensional data, where
+ * the points of each class use a different set of features.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionSparseSGDTest)
+{
+  const size_t points = 1000;
+  const size_t dimension = 1000;
+
+  arma::sp_mat data(dimension, points);
+  arma::vec responses(points);
+  for (size_t i = 0; i < points; ++i)
+  {
+    responses[i] = (i < points / 2) ? 0 : 1;
+    const size_t offset = (i < points / 2) ? 0 : dimension / 2;
+    for (size_t j = 0; j < 5; ++j)
+      data(offset + math::RandInt(dimension / 2), i) = 1.0;
+  }
+
+  LogisticRegression<SGD, arma::sp_mat> lr(data, responses, 0.5);
+  const double acc = lr.ComputeAccuracy(data, responses);
+  BOOST_REQUIRE_CLOSE(acc, 100.0, 0.3); // 0.3% error tolerance.
+}
+
+/**
+ * Make sure that parallel SGD with sparse steps and lazy L2-regularization
+ * takes the same steps as parallel SGD with dense steps when there is one
+ * thread, and that it trains logistic regression on sparse data with several
+ * threads.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionLazyRegularizationParallelSGDTest)
+{
+  const size_t points = 100;
+  const size_t dimension = 20;
+
+  arma::mat data;
+  data.randu(dimension, points);
+  data.elem(arma::find(data < 0.8)).zeros();
+  arma::vec responses(points);
+  for (size_t i = 0; i < points; ++i)
+    responses[i] = math::RandInt(0, 2);
+
+  // With one thread, the steps are taken in the same (linear) order.
+  const int oldThreads = OmpGetMaxThreads();
+  OmpSetNumThreads(1);
+
+  LogisticRegressionFunction<> lrf(data, responses, 2.0);
+  arma::sp_mat sparseData(data);
+  LogisticRegressionFunction<arma::sp_mat> sparseLrf(sparseData, responses,
+      lrf.GetInitialPoint(), 2.0);
+  ParallelSGD<LogisticRegressionFunction<arma::sp_mat> > lazySgd(sparseLrf,
+      0.05, 1234, 1e-75, false);
+  arma::mat lazyParameters = lrf.GetInitialPoint();
+  const double lazyObjective = lazySgd.Optimize(lazyParameters);
+
+  ParallelSGD<LogisticRegressionFunction<> > denseSgd(lrf, 0.05, 1234, 1e-75,
+      false);
+  arma::mat denseParameters = lrf.GetInitialPoint();
+  denseSgd.Optimize(denseParameters);
+
+  OmpSetNumThreads(oldThreads);
+
+  BOOST_REQUIRE_CLOSE(lazyObjective, lrf.Evaluate(denseParameters), 1e-5);
+  for (size_t j = 0; j < denseParameters.n_elem; ++j)
+  {
+    if (std::abs(denseParameters[j]) < 1e-8)
+      BOOST_REQUIRE_SMALL(lazyParameters[j], 1e-8);
+    else
+      BOOST_REQUIRE_CLOSE(lazyParameters[j], denseParameters[j], 1e-5);
+  }
+
+  // Now train on sparse, high-dimensional data with all of the threads.
+  const size_t sparsePoints = 1000;
+  const size_t sparseDimension = 1000;
+  arma::sp_mat trainData(sparseDimension, sparsePoints);
+  arma::vec trainResponses(sparsePoints);
+  for (size_t i = 0; i < sparsePoints; ++i)
+  {
+    trainResponses[i] = (i < sparsePoints / 2) ? 0 : 1;
+    const size_t offset = (i < sparsePoints / 2) ? 0 : sparseDimension / 2;
+    for (size_t j = 0; j < 5; ++j)
+      trainData(offset + math::RandInt(sparseDimension / 2), i) = 1.0;
+  }
+
+  LogisticRegression<ParallelSGD, arma::sp_mat> lr(trainData, trainResponses,
+      0.5);
+  const double acc = lr.ComputeAccuracy(trainData, trainResponses);
+  BOOST_REQUIRE_CLOSE(acc, 100.0, 0.3); // 0.3% error tolerance.
+}
+
+/**
+ * Train logistic regression with L-BFGS, evaluating the objective and gradient
+ * in parallel, and make sure the model is the same as without the wrapper.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionDataParallelLBFGSTest)
+{
+  // Generate a two-Gaussian dataset.
+  GaussianDistribution g1(arma::vec("1.0 1.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("9.0 9.0 9.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat data(3, 1000);
+  arma::vec responses(1000);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) = g1.Random();
+    responses[i] = 0;
+  }
+  for (size_t i = 500; i < 1000; ++i)
+  {
+    data.col(i) = g2.Random();
+    responses[i] = 1;
+  }
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+  LogisticRegression<> lr(data, responses, 0.5);
+
+  DataParallelFunction<LogisticRegressionFunction<> > parallelLrf(lrf, 4);
+  BOOST_REQUIRE_CLOSE(parallelLrf.Evaluate(lr.Parameters()),
+      lrf.Evaluate(lr.Parameters()), 1e-5);
+
+  L_BFGS<DataParallelFunction<LogisticRegressionFunction<> > > lbfgs(
+      parallelLrf);
+  LogisticRegression<> lr2(lbfgs);
+  BOOST_REQUIRE_EQUAL(lr2.Lambda(), 0.5);
+
+  const double acc = lr2.ComputeAccuracy(data, responses);
+  BOOST_REQUIRE_CLOSE(acc, 100.0, 0.3); // 0.3% error tolerance.
+
+  BOOST_REQUIRE_EQUAL(lr2.Parameters().n_elem, lr.Parameters().n_elem);
+  for (size_t j = 0; j < lr.Parameters().n_elem; ++j)
+    BOOST_REQUIRE_CLOSE(lr2.Parameters()[j], lr.Parameters()[j], 0.1);
+}
+
 /**
  * Test constructor that takes an already-instantiated optimizer.
  */
@@ -666,8 +1065,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionInstantiatedOptimizer)
   arma::vec responses("1 1 0");
 
   // Create an optimizer and function.
-  LogisticRegressionFunction lrf(data, responses, 0.0005);
-  L_BFGS<LogisticRegressionFunction> lbfgsOpt(lrf);
+  LogisticRegressionFunction<> lrf(data, responses, 0.0005);
+  L_BFGS<LogisticRegressionFunction<> > lbfgsOpt(lrf);
   lbfgsOpt.MinGradientNorm() = 1e-50;
   LogisticRegression<L_BFGS> lr(lbfgsOpt);
 
@@ -681,7 +1080,7 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionInstantiatedOptimizer)
   BOOST_REQUIRE_SMALL(sigmoids[2], 0.1);
 
   // Now do the same with SGD.
-  SGD<LogisticRegressionFunction> sgdOpt(lrf);
+  SGD<LogisticRegressionFunction<> > sgdOpt(lrf);
   sgdOpt.StepSize() = 0.15;
   sgdOpt.Tolerance() = 1e-75;
   LogisticRegression<SGD> lr2(sgdOpt);
@@ -131,6 +131,106 @@ BOOST_AUTO_TEST_CASE(Johnson844LovaszThetaSDP)
   }
 }
 
+/**
+ * Make sure that the augmented Lagrangian of an LRSDP with dense, sparse, and
+ * entry-list matrices (which is computed without R R^T) matches the direct
+ * calculation with R R^T.
+ */
+BOOST_AUTO_TEST_CASE(LRSDPSparseMatricesEvaluation)
+{
+  const size_t n = 20;
+  const size_t r = 3;
+
+  arma::mat coordinates;
+  coordinates.randu(n, r);
+
+  LRSDPFunction function(5, coordinates);
+
+  // C is the sum of a dense and a sparse symmetric matrix.
+  function.C().randu(n, n);
+  function.C() += trans(function.C());
+  arma::mat sparseC;
+  sparseC.randu(n, n);
+  sparseC.elem(arma::find(sparseC < 0.9)).zeros();
+  function.SparseC() = arma::sp_mat(sparseC + trans(sparseC));
+
+  // A_0 is dense, A_1 and A_3 are lists of entries, A_2 is sparse, and A_4 is
+  // rank-one.
+  function.AModes() = "0 1 2 1 3";
+  function.A()[0].randu(n, n);
+  function.A()[0] += trans(function.A()[0]);
+
+  function.A()[1] = "1 3 5;"
+                    "3 1 5;"
+                    "2 2 -1";
+
+  arma::mat sparseA;
+  sparseA.randu(n, n);
+  sparseA.elem(arma::find(sparseA < 0.9)).zeros();
+  function.SparseA()[2] = arma::sp_mat(sparseA + trans(sparseA));
+
+  function.A()[3] = "0 19 7;"
+                    "19 0 7;"
+                    "-3 -3 0.5";
+
+  function.A()[4] = "4 11 17;"
+                    "1.5 -2 0.5";
+
+  function.B() = "1 2 3 4 5";
+
+  // The dense versions of the matrices.
+  const arma::mat c = function.C() + arma::mat(function.SparseC());
+  std::vector<arma::mat> a(5);
+  a[0] = function.A()[0];
+  a[2] = arma::mat(function.SparseA()[2]);
+  for (size_t i = 1; i < 4; i += 2)
+  {
+    a[i].zeros(n, n);
+    for (size_t j = 0; j < function.A()[i].n_cols; ++j)
+      a[i](function.A()[i](0, j), function.A()[i](1, j)) +=
+          function.A()[i](2, j);
+  }
+  arma::vec rankOne = arma::zeros<arma::vec>(n);
+  for (size_t j = 0; j < function.A()[4].n_cols; ++j)
+    rankOne[function.A()[4](0, j)] = function.A()[4](1, j);
+  a[4] = rankOne * trans(rankOne);
+
+  const arma::vec lambda("0.5 -1.0 2.0 0.25 -0.5");
+  const double sigma = 3.0;
+  AugLagrangianFunction<LRSDPFunction> augLag(function, lambda, sigma);
+
+  // Calculate everything directly.
+  const arma::mat rrt = coordinates * trans(coordinates);
+  double objective = trace(c * rrt);
+  arma::mat s = c;
+  for (size_t i = 0; i < 5; ++i)
+  {
+    const double constraint = trace(a[i] * rrt) - function.B()[i];
+    BOOST_REQUIRE_CLOSE(function.EvaluateConstraint(i, coordinates),
+        constraint, 1e-5);
+
+    objective += -lambda[i] * constraint + (sigma / 2) * constraint *
+        constraint;
+    s -= (lambda[i] - sigma * constraint) * a[i];
+  }
+  const arma::mat gradient = 2 * s * coordinates;
+
+  BOOST_REQUIRE_CLOSE(function.Evaluate(coordinates), trace(c * rrt), 1e-5);
+  BOOST_REQUIRE_CLOSE(augLag.Evaluate(coordinates), objective, 1e-5);
+
+  arma::mat augLagGradient;
+  augLag.Gradient(coordinates, augLagGradient);
+  BOOST_REQUIRE_EQUAL(augLagGradient.n_rows, n);
+  BOOST_REQUIRE_EQUAL(augLagGradient.n_cols, r);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+  {
+    if (std::abs(gradient[i]) < 1e-8)
+      BOOST_REQUIRE_SMALL(augLagGradient[i], 1e-8);
+    else
+      BOOST_REQUIRE_CLOSE(augLagGradient[i], gradient[i], 1e-5);
+  }
+}
+
 /**
  * keller4.co test case for Lovasz-Theta LRSDP.
  * This is commented out because it takes a long time to run.
@@ -0,0 +1,148 @@
+/**
+ * @file mvu_test.cpp
+ *
+ * Tests for Maximum Variance Unfolding (methods/mvu/), with and without
+ * landmarks.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/mvu/mvu.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "old_boost_test_definitions.hpp"
+
+using namespace mlpack;
+using namespace mlpack::mvu;
+using namespace mlpack::neighbor;
+using namespace mlpack::metric;
+
+BOOST_AUTO_TEST_SUITE(MVUTest);
+
+/**
+ * Create points evenly spaced along a piece of a helix, which is a
+ * one-dimensional manifold in three dimensions.
+ */
+void CreateHelix(const size_t points, arma::mat& data)
+{
+  data.set_size(3, points);
+  for (size_t i = 0; i < points; ++i)
+  {
+    const double t = M_PI * i / (points - 1);
+    data(0, i) = cos(t);
+    data(1, i) = sin(t);
+    data(2, i) = 0.5 * t;
+  }
+}
+
+/**
+ * Unfold a helix, and make sure that the embedding has the requested size, is
+ * centered, and keeps the distances between each point and its nearest
+ * neighbors.
+ */
+BOOST_AUTO_TEST_CASE(MVUHelixTest)
+{
+  const size_t points = 30;
+  const size_t numNeighbors = 4;
+
+  arma::mat data;
+  CreateHelix(points, data);
+
+  MVU mvu(data);
+  arma::mat output;
+  mvu.Unfold(2, numNeighbors, output);
+
+  BOOST_REQUIRE_EQUAL(output.n_rows, (arma::uword) 2);
+  BOOST_REQUIRE_EQUAL(output.n_cols, (arma::uword) points);
+
+  // The embedding is centered.
+  const arma::vec mean = arma::mean(output, 1);
+  BOOST_REQUIRE_SMALL(mean[0], 1e-3);
+  BOOST_REQUIRE_SMALL(mean[1], 1e-3);
+
+  // The distance constraints hold.
+  AllkNN allknn(data);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  allknn.Search(numNeighbors, neighbors, distances);
+
+  for (size_t i = 0; i < points; ++i)
+  {
+    for (size_t j = 0; j < numNeighbors; ++j)
+    {
+      const size_t neighbor = neighbors(j, i);
+      BOOST_REQUIRE_CLOSE(SquaredEuclideanDistance::Evaluate(output.col(i),
+          output.col(neighbor)), SquaredEuclideanDistance::Evaluate(
+          data.col(i), data.col(neighbor)), 2.0);
+    }
+  }
+}
+
+/**
+ * Unfold a helix with landmarks, and make sure that the embedding has the
+ * requested size, is centered, and places each point at the combination of the
+ * landmarks given by its LLE reconstruction weights.
+ */
+BOOST_AUTO_TEST_CASE(LandmarkMVUHelixTest)
+{
+  const size_t points = 60;
+  const size_t numNeighbors = 4;
+
+  arma::mat data;
+  CreateHelix(points, data);
+
+  // Every fourth point is a landmark.
+  arma::uvec landmarks(points / 4);
+  for (size_t i = 0; i < landmarks.n_elem; ++i)
+    landmarks[i] = 4 * i;
+
+  MVU mvu(data);
+  arma::mat output;
+  mvu.Unfold(2, numNeighbors, landmarks, output);
+
+  BOOST_REQUIRE_EQUAL(output.n_rows, (arma::uword) 2);
+  BOOST_REQUIRE_EQUAL(output.n_cols, (arma::uword) points);
+
+  const arma::vec mean = arma::mean(output, 1);
+  BOOST_REQUIRE_SMALL(mean[0], 1e-3);
+  BOOST_REQUIRE_SMALL(mean[1], 1e-3);
+
+  arma::sp_mat weights;
+  mvu.ReconstructionWeights(landmarks, numNeighbors, weights);
+  BOOST_REQUIRE_EQUAL(weights.n_rows, landmarks.n_elem);
+  BOOST_REQUIRE_EQUAL(weights.n_cols, (arma::uword) points);
+
+  for (size_t i = 0; i < points; ++i)
+  {
+    // The squared distances from the point to the landmarks.
+    arma::vec landmarkDistances(landmarks.n_elem);
+    for (size_t j = 0; j < landmarks.n_elem; ++j)
+      landmarkDistances[j] = SquaredEuclideanDistance::Evaluate(data.col(i),
+          data.col(landmarks[j]));
+    const arma::vec sortedDistances = arma::sort(landmarkDistances);
+
+    double weightSum = 0.0;
+    arma::vec embedded = arma::zeros<arma::vec>(2);
+    arma::vec reconstructed = arma::zeros<arma::vec>(3);
+    for (arma::sp_mat::const_iterator it = weights.begin_col(i);
+        it != weights.end_col(i); ++it)
+    {
+      weightSum += (*it);
+      embedded += (*it) * output.col(landmarks[it.row()]);
+      reconstructed += (*it) * data.col(landmarks[it.row()]);
+    }
+
+    // The point is embedded at the combination of the embedded landmarks.
+    BOOST_REQUIRE_CLOSE(weightSum, 1.0, 1e-5);
+    BOOST_REQUIRE_SMALL(arma::norm(output.col(i) - embedded, 2), 1e-5);
+
+    // The weights reconstruct the point at least about as well as its nearest
+    // landmark alone (the weights are regularized by 1e-3 times the sum of
+    // the squared distances to the nearest landmarks).
+    const double bound = sortedDistances[0] + 1e-3 *
+        arma::accu(sortedDistances.subvec(0, numNeighbors - 1));
+    BOOST_REQUIRE_LE(SquaredEuclideanDistance::Evaluate(data.col(i),
+        reconstructed), bound + 1e-10);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -6,6 +6,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/range_search/range_search.hpp>
+#include <mlpack/methods/range_search/range_search_rules.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
@@ -1060,4 +1061,494 @@ BOOST_AUTO_TEST_CASE(DualBallTreeTest2)
   }
 }
 
+/**
+ * Make sure the CSR results are the same as the vector-of-vectors results, for
+ * dual-tree, single-tree, and naive search with separate query sets.
+ */
+BOOST_AUTO_TEST_CASE(CSRResultsTest)
+{
+  arma::mat queries = arma::randu<arma::mat>(3, 300);
+  arma::mat references = arma::randu<arma::mat>(3, 500);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RangeSearch<> rs(references, queries, (mode == 2), (mode == 1));
+
+    vector<vector<size_t> > neighbors;
+    vector<vector<double> > distances;
+    rs.Search(Range(0.1, 0.3), neighbors, distances);
+    vector<vector<pair<double, size_t> > > sorted;
+    SortResults(neighbors, distances, sorted);
+
+    arma::Col<size_t> offsets;
+    arma::Col<size_t> csrNeighbors;
+    arma::vec csrDistances;
+    rs.Search(Range(0.1, 0.3), offsets, csrNeighbors, csrDistances);
+
+    BOOST_REQUIRE_EQUAL(offsets.n_elem, queries.n_cols + 1);
+    BOOST_REQUIRE_EQUAL(offsets[0], 0);
+    BOOST_REQUIRE_EQUAL(offsets[queries.n_cols], csrNeighbors.n_elem);
+    BOOST_REQUIRE_EQUAL(csrDistances.n_elem, csrNeighbors.n_elem);
+
+    for (size_t i = 0; i < queries.n_cols; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(offsets[i + 1] - offsets[i], sorted[i].size());
+
+      vector<pair<double, size_t> > csrSorted;
+      for (size_t j = offsets[i]; j < offsets[i + 1]; ++j)
+        csrSorted.push_back(make_pair(csrDistances[j], csrNeighbors[j]));
+      sort(csrSorted.begin(), csrSorted.end());
+
+      for (size_t j = 0; j < csrSorted.size(); ++j)
+      {
+        BOOST_REQUIRE_EQUAL(csrSorted[j].second, sorted[i][j].second);
+        BOOST_REQUIRE_CLOSE(csrSorted[j].first, sorted[i][j].first, 1e-5);
+      }
+    }
+  }
+}
+
+// A visitor which only counts results and sums distances, for the streaming
+// test.
+class CountingVisitor
+{
+ public:
+  CountingVisitor(const size_t numQueries) :
+      counts(numQueries, 0), sums(numQueries, 0.0) { }
+
+  void Visit(const size_t queryIndex,
+             const size_t /* referenceIndex */,
+             const double distance)
+  {
+    ++counts[queryIndex];
+    sums[queryIndex] += distance;
+  }
+
+  vector<size_t> counts;
+  vector<double> sums;
+};
+
+/**
+ * Make sure a streaming visitor sees every result (with the original indices)
+ * when only one dataset is used.
+ */
+BOOST_AUTO_TEST_CASE(StreamingVisitorTest)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 500);
+
+  RangeSearch<> rs(data);
+
+  vector<vector<size_t> > neighbors;
+  vector<vector<double> > distances;
+  rs.Search(Range(0.0, 0.4), neighbors, distances);
+
+  CountingVisitor visitor(data.n_cols);
+  rs.Search(Range(0.0, 0.4), visitor);
+
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(visitor.counts[i], neighbors[i].size());
+
+    double sum = 0.0;
+    for (size_t j = 0; j < distances[i].size(); ++j)
+      sum += distances[i][j];
+
+    if (sum == 0.0)
+      BOOST_REQUIRE_SMALL(visitor.sums[i], 1e-5);
+    else
+      BOOST_REQUIRE_CLOSE(visitor.sums[i], sum, 1e-5);
+  }
+}
+
+/**
+ * Make sure counting the points in range gives the same results as the full
+ * search, with one and two datasets, in each search mode.  The range includes
+ * zero, so whole nodes containing the query point are counted too.
+ */
+BOOST_AUTO_TEST_CASE(CountTest)
+{
+  arma::mat queries = arma::randu<arma::mat>(3, 300);
+  arma::mat references = arma::randu<arma::mat>(3, 500);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RangeSearch<> rs(references, (mode == 2), (mode == 1));
+
+    vector<vector<size_t> > neighbors;
+    vector<vector<double> > distances;
+    rs.Search(Range(0.0, 0.3), neighbors, distances);
+
+    arma::Col<size_t> counts;
+    rs.Count(Range(0.0, 0.3), counts);
+
+    BOOST_REQUIRE_EQUAL(counts.n_elem, references.n_cols);
+    for (size_t i = 0; i < references.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(counts[i], neighbors[i].size());
+
+    RangeSearch<> rs2(references, queries, (mode == 2), (mode == 1));
+
+    rs2.Search(Range(0.1, 0.4), neighbors, distances);
+    rs2.Count(Range(0.1, 0.4), counts);
+
+    BOOST_REQUIRE_EQUAL(counts.n_elem, queries.n_cols);
+    for (size_t i = 0; i < queries.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(counts[i], neighbors[i].size());
+  }
+}
+
+/**
+ * Make sure counting with cover trees (where the first point of each node is
+ * its centroid) gives the same results as the full search.
+ */
+BOOST_AUTO_TEST_CASE(CoverTreeCountTest)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 500);
+
+  typedef tree::CoverTree<metric::EuclideanDistance, tree::FirstPointIsRoot,
+      RangeSearchStat> TreeType;
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    TreeType tree(data);
+    RangeSearch<metric::EuclideanDistance, TreeType> rs(&tree, data,
+        (mode == 1));
+
+    vector<vector<size_t> > neighbors;
+    vector<vector<double> > distances;
+    rs.Search(Range(0.0, 0.3), neighbors, distances);
+
+    arma::Col<size_t> counts;
+    rs.Count(Range(0.0, 0.3), counts);
+
+    BOOST_REQUIRE_EQUAL(counts.n_elem, data.n_cols);
+    for (size_t i = 0; i < data.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(counts[i], neighbors[i].size());
+  }
+}
+
+/**
+ * Make sure the sums and means of values over the points in range are the same
+ * as those calculated from the full search results.
+ */
+BOOST_AUTO_TEST_CASE(AggregateTest)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 500);
+  arma::vec values = arma::randu<arma::vec>(500);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RangeSearch<> rs(data, (mode == 2), (mode == 1));
+
+    vector<vector<size_t> > neighbors;
+    vector<vector<double> > distances;
+    rs.Search(Range(0.0, 0.35), neighbors, distances);
+
+    arma::Col<size_t> counts;
+    arma::vec sums;
+    arma::vec means;
+    rs.Aggregate(Range(0.0, 0.35), values, counts, sums, means);
+
+    BOOST_REQUIRE_EQUAL(counts.n_elem, data.n_cols);
+    BOOST_REQUIRE_EQUAL(sums.n_elem, data.n_cols);
+    BOOST_REQUIRE_EQUAL(means.n_elem, data.n_cols);
+
+    for (size_t i = 0; i < data.n_cols; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(counts[i], neighbors[i].size());
+
+      double sum = 0.0;
+      for (size_t j = 0; j < neighbors[i].size(); ++j)
+        sum += values[neighbors[i][j]];
+
+      if (neighbors[i].size() == 0)
+      {
+        BOOST_REQUIRE_SMALL(sums[i], 1e-5);
+        BOOST_REQUIRE_SMALL(means[i], 1e-5);
+      }
+      else
+      {
+        BOOST_REQUIRE_CLOSE(sums[i], sum, 1e-5);
+        BOOST_REQUIRE_CLOSE(means[i], sum / neighbors[i].size(), 1e-5);
+      }
+    }
+  }
+}
+
+/**
+ * Make sure that range search works with single-precision data, in each search
+ * mode, by comparing against the naive search on the same data.
+ */
+BOOST_AUTO_TEST_CASE(FloatRangeSearchTest)
+{
+  arma::fmat queries = arma::randu<arma::fmat>(3, 200);
+  arma::fmat references = arma::randu<arma::fmat>(3, 400);
+
+  typedef BinarySpaceTree<HRectBound<2>, RangeSearchStat, arma::fmat>
+      TreeType;
+
+  RangeSearch<metric::EuclideanDistance, TreeType> naive(references, queries,
+      true);
+  vector<vector<size_t> > naiveNeighbors;
+  vector<vector<double> > naiveDistances;
+  naive.Search(Range(0.1, 0.4), naiveNeighbors, naiveDistances);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    RangeSearch<metric::EuclideanDistance, TreeType> rs(references, queries,
+        false, (mode == 1));
+    vector<vector<size_t> > neighbors;
+    vector<vector<double> > distances;
+    rs.Search(Range(0.1, 0.4), neighbors, distances);
+
+    BOOST_REQUIRE_EQUAL(neighbors.size(), queries.n_cols);
+    for (size_t i = 0; i < queries.n_cols; ++i)
+    {
+      vector<size_t> sorted(neighbors[i]);
+      vector<size_t> naiveSorted(naiveNeighbors[i]);
+      sort(sorted.begin(), sorted.end());
+      sort(naiveSorted.begin(), naiveSorted.end());
+
+      BOOST_REQUIRE_EQUAL(sorted.size(), naiveSorted.size());
+      for (size_t j = 0; j < sorted.size(); ++j)
+        BOOST_REQUIRE_EQUAL(sorted[j], naiveSorted[j]);
+    }
+  }
+}
+
+/**
+ * Make sure the results of a search with several threads are the same as the
+ * results with one thread, for each type of result and in each search mode.
+ * (If OpenMP is not available, both searches use one thread.)
+ */
+BOOST_AUTO_TEST_CASE(ParallelSearchTest)
+{
+  arma::mat queries = arma::randu<arma::mat>(3, 400);
+  arma::mat references = arma::randu<arma::mat>(3, 600);
+
+  const int oldThreads = OmpGetMaxThreads();
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RangeSearch<> rs(references, queries, (mode == 2), (mode == 1));
+
+    OmpSetNumThreads(1);
+    vector<vector<size_t> > neighbors;
+    vector<vector<double> > distances;
+    rs.Search(Range(0.1, 0.3), neighbors, distances);
+    vector<vector<pair<double, size_t> > > sorted;
+    SortResults(neighbors, distances, sorted);
+
+    OmpSetNumThreads(4);
+    vector<vector<size_t> > parallelNeighbors;
+    vector<vector<double> > parallelDistances;
+    rs.Search(Range(0.1, 0.3), parallelNeighbors, parallelDistances);
+    vector<vector<pair<double, size_t> > > parallelSorted;
+    SortResults(parallelNeighbors, parallelDistances, parallelSorted);
+
+    arma::Col<size_t> offsets;
+    arma::Col<size_t> csrNeighbors;
+    arma::vec csrDistances;
+    rs.Search(Range(0.1, 0.3), offsets, csrNeighbors, csrDistances);
+
+    arma::Col<size_t> counts;
+    rs.Count(Range(0.1, 0.3), counts);
+
+    BOOST_REQUIRE_EQUAL(parallelSorted.size(), queries.n_cols);
+    BOOST_REQUIRE_EQUAL(offsets.n_elem, queries.n_cols + 1);
+    BOOST_REQUIRE_EQUAL(counts.n_elem, queries.n_cols);
+    for (size_t i = 0; i < queries.n_cols; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(parallelSorted[i].size(), sorted[i].size());
+      BOOST_REQUIRE_EQUAL(offsets[i + 1] - offsets[i], sorted[i].size());
+      BOOST_REQUIRE_EQUAL(counts[i], sorted[i].size());
+
+      vector<size_t> csrSorted;
+      for (size_t j = offsets[i]; j < offsets[i + 1]; ++j)
+        csrSorted.push_back(csrNeighbors[j]);
+      sort(csrSorted.begin(), csrSorted.end());
+
+      vector<size_t> expected;
+      for (size_t j = 0; j < sorted[i].size(); ++j)
+      {
+        BOOST_REQUIRE_EQUAL(parallelSorted[i][j].second, sorted[i][j].second);
+        BOOST_REQUIRE_CLOSE(parallelSorted[i][j].first, sorted[i][j].first,
+            1e-5);
+        expected.push_back(sorted[i][j].second);
+      }
+      sort(expected.begin(), expected.end());
+
+      for (size_t j = 0; j < expected.size(); ++j)
+        BOOST_REQUIRE_EQUAL(csrSorted[j], expected[j]);
+    }
+  }
+
+  OmpSetNumThreads(oldThreads);
+}
+
+/**
+ * Make sure that the block base cases (see RangeSearchRules::BlockBaseCase())
+ * find the same results as the naive base cases, including the pairs whose
+ * distance is exactly one of the range bounds, and count the same number of
+ * base cases.  The points are far from the origin, so the block distance
+ * bounds suffer from cancellation and must rely on their rounding error margins
+ * to keep those pairs.
+ */
+BOOST_AUTO_TEST_CASE(BlockBaseCaseBoundaryTest)
+{
+  typedef BinarySpaceTree<HRectBound<2>, RangeSearchStat> TreeType;
+  typedef RangeSearchRules<metric::EuclideanDistance, TreeType,
+      VectorRangeVisitor> RuleType;
+  BOOST_REQUIRE(RuleTraits<RuleType>::HasBlockBaseCase);
+
+  arma::mat queries = 1000.0 + arma::randu<arma::mat>(3, 50);
+  arma::mat references = 1000.0 + arma::randu<arma::mat>(3, 80);
+  metric::EuclideanDistance metric;
+
+  std::vector<size_t> queryIndices;
+  for (size_t i = 0; i < queries.n_cols; ++i)
+    queryIndices.push_back(i);
+
+  // The bounds of each range are distances between pairs of points; the last
+  // range contains only one distance.
+  const double d1 = metric.Evaluate(queries.col(0), references.col(0));
+  const double d2 = metric.Evaluate(queries.col(1), references.col(1));
+  const double d3 = metric.Evaluate(queries.col(2), references.col(2));
+  vector<Range> ranges;
+  ranges.push_back(Range(std::min(d1, d2), std::max(d1, d2)));
+  ranges.push_back(Range(0.0, d3));
+  ranges.push_back(Range(d3, d3));
+
+  for (size_t r = 0; r < ranges.size(); ++r)
+  {
+    vector<vector<size_t> > blockNeighbors(queries.n_cols);
+    vector<vector<double> > blockDistances(queries.n_cols);
+    VectorRangeVisitor blockVisitor(blockNeighbors, blockDistances);
+    RuleType blockRules(references, queries, ranges[r], blockVisitor, metric,
+        true);
+    blockRules.BlockBaseCase(queryIndices, 0, references.n_cols);
+
+    vector<vector<size_t> > naiveNeighbors(queries.n_cols);
+    vector<vector<double> > naiveDistances(queries.n_cols);
+    VectorRangeVisitor naiveVisitor(naiveNeighbors, naiveDistances);
+    RuleType naiveRules(references, queries, ranges[r], naiveVisitor, metric);
+    for (size_t i = 0; i < queries.n_cols; ++i)
+      for (size_t j = 0; j < references.n_cols; ++j)
+        naiveRules.BaseCase(i, j);
+
+    BOOST_REQUIRE_EQUAL(blockRules.BaseCases(), naiveRules.BaseCases());
+
+    // The pairs that define the bounds are found.
+    for (size_t i = 0; i < 3; ++i)
+    {
+      const double distance = metric.Evaluate(queries.col(i),
+          references.col(i));
+      if (distance == ranges[r].Lo() || distance == ranges[r].Hi())
+        BOOST_REQUIRE(std::find(blockNeighbors[i].begin(),
+            blockNeighbors[i].end(), i) != blockNeighbors[i].end());
+    }
+
+    vector<vector<pair<double, size_t> > > blockSorted, naiveSorted;
+    SortResults(blockNeighbors, blockDistances, blockSorted);
+    SortResults(naiveNeighbors, naiveDistances, naiveSorted);
+    for (size_t i = 0; i < queries.n_cols; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(blockSorted[i].size(), naiveSorted[i].size());
+      for (size_t j = 0; j < blockSorted[i].size(); ++j)
+      {
+        BOOST_REQUIRE_EQUAL(blockSorted[i][j].second,
+            naiveSorted[i][j].second);
+        BOOST_REQUIRE_EQUAL(blockSorted[i][j].first, naiveSorted[i][j].first);
+      }
+    }
+  }
+}
+
+/**
+ * Compare dual-tree range search, which uses the block base cases, with naive
+ * search on a grid far from the origin, where many distances are exactly the
+ * range bounds.
+ */
+BOOST_AUTO_TEST_CASE(BlockRangeSearchGridTest)
+{
+  arma::mat data(3, 216);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    data(0, i) = 1000.0 + (i % 6);
+    data(1, i) = 1000.0 + ((i / 6) % 6);
+    data(2, i) = 1000.0 + (i / 36);
+  }
+
+  arma::mat dualData(data);
+  arma::mat naiveData(data);
+  RangeSearch<> rs(dualData);
+  RangeSearch<> naive(naiveData, true);
+  rs.BlockBaseCases() = true;
+
+  vector<vector<size_t> > neighbors;
+  vector<vector<double> > distances;
+  rs.Search(Range(1.0, 2.0), neighbors, distances);
+  vector<vector<pair<double, size_t> > > sorted;
+  SortResults(neighbors, distances, sorted);
+
+  vector<vector<size_t> > naiveNeighbors;
+  vector<vector<double> > naiveDistances;
+  naive.Search(Range(1.0, 2.0), naiveNeighbors, naiveDistances);
+  vector<vector<pair<double, size_t> > > naiveSorted;
+  SortResults(naiveNeighbors, naiveDistances, naiveSorted);
+
+  BOOST_REQUIRE_EQUAL(sorted.size(), data.n_cols);
+  for (size_t i = 0; i < sorted.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(sorted[i].size(), naiveSorted[i].size());
+    for (size_t j = 0; j < sorted[i].size(); ++j)
+    {
+      BOOST_REQUIRE_EQUAL(sorted[i][j].second, naiveSorted[i][j].second);
+      BOOST_REQUIRE_CLOSE(sorted[i][j].first, naiveSorted[i][j].first, 1e-5);
+    }
+  }
+
+  // The point in the corner of the grid has three neighbors at distance 1,
+  // three at distance sqrt(2), one at distance sqrt(3), and three at distance
+  // 2.
+  BOOST_REQUIRE_EQUAL(sorted[0].size(), (size_t) 10);
+}
+
+/**
+ * Make sure that dual-tree range search gives the same results with and without
+ * block base cases for points near the origin, where most of the distances of
+ * the block base cases are estimated without evaluating the metric.
+ */
+BOOST_AUTO_TEST_CASE(BlockBaseCaseOptionTest)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 1000);
+
+  arma::mat blockData(data);
+  arma::mat scalarData(data);
+  RangeSearch<> block(blockData);
+  RangeSearch<> scalar(scalarData);
+  block.BlockBaseCases() = true;
+  BOOST_REQUIRE_EQUAL(scalar.BlockBaseCases(), false);
+
+  vector<vector<size_t> > blockNeighbors, scalarNeighbors;
+  vector<vector<double> > blockDistances, scalarDistances;
+  block.Search(Range(0.05, 0.2), blockNeighbors, blockDistances);
+  scalar.Search(Range(0.05, 0.2), scalarNeighbors, scalarDistances);
+
+  vector<vector<pair<double, size_t> > > blockSorted, scalarSorted;
+  SortResults(blockNeighbors, blockDistances, blockSorted);
+  SortResults(scalarNeighbors, scalarDistances, scalarSorted);
+
+  BOOST_REQUIRE_EQUAL(blockSorted.size(), scalarSorted.size());
+  for (size_t i = 0; i < blockSorted.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(blockSorted[i].size(), scalarSorted[i].size());
+    for (size_t j = 0; j < blockSorted[i].size(); ++j)
+    {
+      BOOST_REQUIRE_EQUAL(blockSorted[i][j].second, scalarSorted[i][j].second);
+      BOOST_REQUIRE_CLOSE(blockSorted[i][j].first, scalarSorted[i][j].first,
+          1e-5);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -182,10 +182,10 @@ void CheckExactContainment(const TreeType& tree)
       double max = -1.0 * DBL_MAX;
       for(size_t j = 0; j < tree.Count(); j++)
       {
-        if (tree.LocalDataset().col(j)[i] < min)
-          min = tree.LocalDataset().col(j)[i];
-        if (tree.LocalDataset().col(j)[i] > max)
-          max = tree.LocalDataset().col(j)[i];
+        if (tree.Dataset().col(tree.Points()[j])[i] < min)
+          min = tree.Dataset().col(tree.Points()[j])[i];
+        if (tree.Dataset().col(tree.Points()[j])[i] > max)
+          max = tree.Dataset().col(tree.Points()[j])[i];
       }
       BOOST_REQUIRE_EQUAL(max, tree.Bound()[i].Hi());
       BOOST_REQUIRE_EQUAL(min, tree.Bound()[i].Lo());
@@ -248,23 +248,20 @@ BOOST_AUTO_TEST_CASE(RectangleTreeContainmentTest)
 }
 
 /**
- * A function to ensure that the dataset for the tree, and the datasets stored
- * in each leaf node are in sync.
+ * A function to ensure that every node of the tree refers to the same dataset,
+ * and that every point index held in a leaf is valid.
  * @param tree The tree to check.
  */
 template<typename TreeType>
 void CheckSync(const TreeType& tree)
 {
+  if (tree.Parent() != NULL)
+    BOOST_REQUIRE_EQUAL(&tree.Dataset(), &tree.Parent()->Dataset());
+
   if (tree.IsLeaf())
   {
     for (size_t i = 0; i < tree.Count(); i++)
-    {
-      for (size_t j = 0; j < tree.LocalDataset().n_rows; j++)
-      {
-        BOOST_REQUIRE_EQUAL(tree.LocalDataset().col(i)[j],
-                            tree.Dataset().col(tree.Points()[i])[j]);
-      }
-    }
+      BOOST_REQUIRE_LT(tree.Points()[i], tree.Dataset().n_cols);
   }
   else
   {
@@ -273,9 +270,9 @@ void CheckSync(const TreeType& tree)
   }
 }
 
-// Test to ensure that the dataset used by the whole tree (and the traversers)
-// is in sync with the datasets stored in each leaf node.
-BOOST_AUTO_TEST_CASE(TreeLocalDatasetInSync)
+// Test to ensure that the nodes of the tree share the dataset, rather than
+// holding copies of their points.
+BOOST_AUTO_TEST_CASE(TreeDatasetInSync)
 {
   arma::mat dataset;
   dataset.randu(8, 1000); // 1000 points in 8 dimensions.
@@ -289,7 +286,17 @@ BOOST_AUTO_TEST_CASE(TreeLocalDatasetInSync)
       arma::mat> TreeType;
 
   TreeType tree(dataset, 20, 6, 5, 2, 0);
+  BOOST_REQUIRE_EQUAL(&tree.Dataset(), &dataset);
   CheckSync(tree);
+
+  // A copy of the tree must refer to the same dataset, and have the right
+  // hierarchy.
+  TreeType copy(tree);
+  BOOST_REQUIRE_EQUAL(&copy.Dataset(), &dataset);
+  BOOST_REQUIRE_EQUAL(copy.NumDescendants(), 1000);
+  CheckSync(copy);
+  CheckHierarchy(copy);
+  CheckExactContainment(copy);
 }
 
 /**
@@ -674,6 +681,124 @@ BOOST_AUTO_TEST_CASE(XTreeTraverserTest)
 }
 */
 
+// Make sure that bulk-loaded trees are valid: they contain every point once,
+// their bounds are tight, they are balanced and filled, and searches with them
+// give the same results as a naive search.
+template<typename BulkLoadType>
+void CheckBulkLoad(const size_t numPoints)
+{
+  arma::mat dataset;
+  dataset.randu(5, numPoints);
+  arma::Mat<size_t> neighbors1;
+  arma::mat distances1;
+  arma::Mat<size_t> neighbors2;
+  arma::mat distances2;
+
+  typedef RectangleTree<
+      RStarTreeSplit<RStarTreeDescentHeuristic,
+                     NeighborSearchStat<NearestNeighborSort>,
+                     arma::mat>,
+      RStarTreeDescentHeuristic,
+      NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  TreeType tree(dataset, BulkLoadType(), 20, 6, 5, 2);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), numPoints);
+
+  std::vector<arma::vec*> v = GetAllPointsInTree(tree);
+  BOOST_REQUIRE_EQUAL(v.size(), numPoints);
+  for (size_t i = 0; i < v.size(); i++)
+  {
+    for (size_t j = i + 1; j < v.size(); j++)
+    {
+      arma::vec v1 = *(v[i]);
+      arma::vec v2 = *(v[j]);
+      bool same = true;
+      for (size_t k = 0; k < v1.n_rows; k++)
+        same &= (v1[k] == v2[k]);
+
+      BOOST_REQUIRE_NE(same, true);
+    }
+  }
+
+  for (size_t i = 0; i < v.size(); i++)
+    delete v[i];
+
+  CheckSync(tree);
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckFills(tree);
+  BOOST_REQUIRE_EQUAL(GetMinLevel(tree), GetMaxLevel(tree));
+
+  // Dual-tree search with the bulk-loaded tree.
+  NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, TreeType>
+      allknn1(&tree, dataset);
+  allknn1.Search(5, neighbors1, distances1);
+
+  AllkNN allknn2(dataset, true, true);
+  allknn2.Search(5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors1.size(); i++)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors1[i], neighbors2[i]);
+    BOOST_REQUIRE_EQUAL(distances1[i], distances2[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(STRBulkLoadTest)
+{
+  CheckBulkLoad<STRBulkLoad>(1000);
+  CheckBulkLoad<STRBulkLoad>(1003);
+  CheckBulkLoad<STRBulkLoad>(15);
+}
+
+BOOST_AUTO_TEST_CASE(HilbertBulkLoadTest)
+{
+  CheckBulkLoad<HilbertBulkLoad>(1000);
+  CheckBulkLoad<HilbertBulkLoad>(1003);
+  CheckBulkLoad<HilbertBulkLoad>(15);
+}
+
+// Ordering the cells of a coarse two-dimensional grid by their Hilbert index
+// must give a path where consecutive cells are adjacent.
+BOOST_AUTO_TEST_CASE(HilbertIndexTest)
+{
+  // Use a 16x16 grid: the low bits of each coordinate are zero.
+  const size_t cellBits = HilbertBulkLoad::Bits - 4;
+  arma::mat cells(2, 256);
+  std::vector<uint64_t> indices(256);
+  arma::Col<uint32_t> c(2);
+  for (size_t x = 0; x < 16; ++x)
+  {
+    for (size_t y = 0; y < 16; ++y)
+    {
+      c[0] = x << cellBits;
+      c[1] = y << cellBits;
+      HilbertBulkLoad::HilbertIndex(c, &indices[16 * x + y]);
+      cells(0, 16 * x + y) = x;
+      cells(1, 16 * x + y) = y;
+    }
+  }
+
+  // Two dimensions of 16 bits fit in one word.
+  std::vector<std::pair<uint64_t, size_t> > order(256);
+  for (size_t i = 0; i < 256; ++i)
+    order[i] = std::make_pair(indices[i], i);
+  std::sort(order.begin(), order.end());
+
+  BOOST_REQUIRE_EQUAL(order[0].first, (uint64_t) 0);
+  for (size_t i = 1; i < order.size(); ++i)
+  {
+    BOOST_REQUIRE_GT(order[i].first, order[i - 1].first);
+    const size_t a = order[i].second;
+    const size_t b = order[i - 1].second;
+    const double distance = std::abs(cells(0, a) - cells(0, b)) +
+        std::abs(cells(1, a) - cells(1, b));
+    BOOST_REQUIRE_CLOSE(distance, 1.0, 1e-5);
+  }
+}
+
 // Test the tree splitting.  We set MaxLeafSize and MaxNumChildren rather low
 // to allow us to test by hand without adding hundreds of points.
 BOOST_AUTO_TEST_CASE(RTreeSplitTest)
@@ -884,4 +1009,78 @@ BOOST_AUTO_TEST_CASE(RStarTreeSplitTest)
       0.9, 1e-15);
 }
 
+/**
+ * Check that two rectangle trees have the same structure.
+ */
+template<typename TreeType>
+void CheckSameRectangleTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Count(), b.Count());
+  BOOST_REQUIRE_EQUAL(a.MaxLeafSize(), b.MaxLeafSize());
+  BOOST_REQUIRE_EQUAL(a.MinLeafSize(), b.MinLeafSize());
+  BOOST_REQUIRE_EQUAL(a.MaxNumChildren(), b.MaxNumChildren());
+  BOOST_REQUIRE_EQUAL(a.MinNumChildren(), b.MinNumChildren());
+  BOOST_REQUIRE_EQUAL(a.ParentDistance(), b.ParentDistance());
+  for (size_t i = 0; i < a.Bound().Dim(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(a.Bound()[i].Lo(), b.Bound()[i].Lo());
+    BOOST_REQUIRE_EQUAL(a.Bound()[i].Hi(), b.Bound()[i].Hi());
+  }
+
+  for (size_t i = 0; i < a.Count(); ++i)
+    BOOST_REQUIRE_EQUAL(a.Points()[i], b.Points()[i]);
+
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(b.Children()[i]->Parent(), &b);
+    CheckSameRectangleTree(*a.Children()[i], *b.Children()[i]);
+  }
+}
+
+/**
+ * Save an R* tree to a file, load it, and make sure that the loaded tree is the
+ * same and gives the same nearest neighbors.
+ */
+BOOST_AUTO_TEST_CASE(RectangleTreeSaveLoadTest)
+{
+  arma::mat dataset;
+  dataset.randu(4, 1000);
+
+  typedef RectangleTree<
+      RStarTreeSplit<RStarTreeDescentHeuristic,
+                     NeighborSearchStat<NearestNeighborSort>,
+                     arma::mat>,
+      RStarTreeDescentHeuristic,
+      NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+
+  TreeType tree(dataset, 20, 6, 5, 2, 0);
+  SaveTree("test-rectangle-tree-save.bin", tree);
+
+  {
+    LoadedTree<TreeType> loaded("test-rectangle-tree-save.bin");
+    CheckSameRectangleTree(tree, loaded.Tree());
+    BOOST_REQUIRE_EQUAL(loaded.Tree().NumDescendants(), 1000);
+
+    NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, TreeType>
+        allknn1(&tree, dataset, true);
+    NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, TreeType>
+        allknn2(&loaded.Tree(), loaded.Dataset(), true);
+
+    arma::Mat<size_t> neighbors1, neighbors2;
+    arma::mat distances1, distances2;
+    allknn1.Search(5, neighbors1, distances1);
+    allknn2.Search(5, neighbors2, distances2);
+
+    for (size_t i = 0; i < neighbors1.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors1[i], neighbors2[i]);
+      BOOST_REQUIRE_EQUAL(distances1[i], distances2[i]);
+    }
+  }
+
+  remove("test-rectangle-tree-save.bin");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
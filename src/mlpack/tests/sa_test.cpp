@@ -7,6 +7,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/core/optimizers/sa/sa.hpp>
 #include <mlpack/core/optimizers/sa/exponential_schedule.hpp>
+#include <mlpack/core/optimizers/sa/parallel_tempering_sa.hpp>
 #include <mlpack/core/optimizers/lbfgs/test_functions.hpp>
 
 #include <mlpack/core/metrics/ip_metric.hpp>
@@ -125,4 +126,31 @@ BOOST_AUTO_TEST_CASE(RastrigrinFunctionTest)
   BOOST_REQUIRE_GE(successes, 1);
 }
 
+/**
+ * Parallel tempering should escape from the local minima of the Rastrigrin
+ * function too, with fewer iterations for each chain than SA uses above.
+ */
+BOOST_AUTO_TEST_CASE(ParallelTemperingRastrigrinFunctionTest)
+{
+  size_t successes = 0;
+
+  for (size_t trial = 0; trial < 5; ++trial)
+  {
+    RastrigrinFunction f;
+    ExponentialSchedule schedule(3e-6);
+    ParallelTemperingSA<RastrigrinFunction> sa(f, schedule, 5000000, 100, 50,
+        1000, 1e-12, 2, 0.2, 0.01, 0.1, 4, 2.0, 100);
+    arma::mat coordinates = f.GetInitialPoint();
+
+    const double result = sa.Optimize(coordinates);
+
+    if ((std::abs(result) < 1e-3) &&
+        (std::abs(coordinates[0]) < 1e-3) &&
+        (std::abs(coordinates[1]) < 1e-3))
+      ++successes;
+  }
+
+  BOOST_REQUIRE_GE(successes, 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -58,4 +58,49 @@ BOOST_AUTO_TEST_CASE(GeneralizedRosenbrockTest)
   }
 }
 
+/**
+ * Make sure that an optimization resumed from its state (in the middle of an
+ * epoch) takes the same steps as an uninterrupted optimization.
+ */
+BOOST_AUTO_TEST_CASE(SGDResumeTest)
+{
+  SGDTestFunction f;
+
+  // 300 steps at once.
+  math::RandomSeed(42);
+  SGD<SGDTestFunction> s(f, 0.0003, 301, 1e-9, true);
+  arma::mat coordinates = f.GetInitialPoint();
+  s.Optimize(coordinates);
+
+  // 300 steps in three runs; each run stops in the middle of an epoch.
+  math::RandomSeed(42);
+  SGD<SGDTestFunction> resumedS(f, 0.0003, 101, 1e-9, true);
+  SGDState state;
+  arma::mat resumedCoordinates = f.GetInitialPoint();
+  for (size_t run = 0; run < 3; ++run)
+    resumedS.Optimize(resumedCoordinates, state);
+
+  BOOST_REQUIRE_EQUAL(state.Epoch(), (size_t) 100);
+  BOOST_REQUIRE_EQUAL(state.CurrentFunction(), (size_t) 3);
+  for (size_t i = 0; i < coordinates.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(resumedCoordinates[i], coordinates[i], 1e-10);
+
+  // Save and load the state.
+  util::SaveRestoreUtility sr;
+  state.Save(sr);
+
+  SGDState loadedState;
+  loadedState.Load(sr);
+  BOOST_REQUIRE_EQUAL(loadedState.Epoch(), state.Epoch());
+  BOOST_REQUIRE_EQUAL(loadedState.CurrentFunction(), state.CurrentFunction());
+  BOOST_REQUIRE_CLOSE(loadedState.OverallObjective(), state.OverallObjective(),
+      1e-10);
+  BOOST_REQUIRE_CLOSE(loadedState.LastObjective(), state.LastObjective(),
+      1e-10);
+  BOOST_REQUIRE_EQUAL(loadedState.VisitationOrder().n_elem, (arma::uword) 3);
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_EQUAL(loadedState.VisitationOrder()[i],
+        state.VisitationOrder()[i]);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -6,6 +6,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/softmax_regression/softmax_regression.hpp>
+#include <mlpack/core/optimizers/data_parallel/data_parallel_function.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
@@ -13,6 +14,7 @@
 using namespace mlpack;
 using namespace mlpack::regression;
 using namespace mlpack::distribution;
+using namespace mlpack::optimization;
 
 BOOST_AUTO_TEST_SUITE(SoftmaxRegressionTest);
 
@@ -166,6 +168,197 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionGradient)
   }
 }
 
+/**
+ * Test that EvaluateWithGradient() gives the same results as Evaluate() and
+ * Gradient().
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionEvaluateWithGradient)
+{
+  const size_t points = 1000;
+  const size_t inputSize = 10;
+  const size_t numClasses = 5;
+
+  arma::mat data;
+  data.randu(inputSize, points);
+
+  arma::vec labels(points);
+  for (size_t i = 0; i < points; i++)
+    labels(i) = math::RandInt(0, numClasses);
+
+  SoftmaxRegressionFunction srf(data, labels, inputSize, numClasses, 10);
+
+  arma::mat parameters;
+  parameters.randu(numClasses, inputSize);
+
+  arma::mat gradient, fusedGradient;
+  srf.Gradient(parameters, gradient);
+  const double cost = srf.EvaluateWithGradient(parameters, fusedGradient);
+
+  BOOST_REQUIRE_CLOSE(cost, srf.Evaluate(parameters), 1e-5);
+  BOOST_REQUIRE_EQUAL(fusedGradient.n_rows, gradient.n_rows);
+  BOOST_REQUIRE_EQUAL(fusedGradient.n_cols, gradient.n_cols);
+  for (size_t i = 0; i < gradient.n_elem; i++)
+    BOOST_REQUIRE_CLOSE(fusedGradient[i], gradient[i], 1e-5);
+}
+
+/**
+ * Test that the objective and gradient do not depend on the number of examples
+ * processed at once, and that they stay finite when the class scores are too
+ * large to exponentiate.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionBlocks)
+{
+  const size_t points = 1000;
+  const size_t inputSize = 10;
+  const size_t numClasses = 5;
+
+  arma::mat data;
+  data.randu(inputSize, points);
+
+  arma::vec labels(points);
+  for (size_t i = 0; i < points; i++)
+    labels(i) = math::RandInt(0, numClasses);
+
+  SoftmaxRegressionFunction srf(data, labels, inputSize, numClasses, 10);
+
+  arma::mat parameters;
+  parameters.randu(numClasses, inputSize);
+
+  arma::mat gradient;
+  const double cost = srf.EvaluateWithGradient(parameters, gradient);
+
+  const size_t blockSizes[] = { 1, 7, 999, 5000 };
+  for (size_t b = 0; b < 4; b++)
+  {
+    srf.BlockSize(blockSizes[b]);
+
+    arma::mat blockGradient;
+    const double blockCost = srf.EvaluateWithGradient(parameters,
+        blockGradient);
+
+    BOOST_REQUIRE_CLOSE(blockCost, cost, 1e-5);
+    BOOST_REQUIRE_CLOSE(srf.Evaluate(parameters), cost, 1e-5);
+    BOOST_REQUIRE_EQUAL(blockGradient.n_rows, gradient.n_rows);
+    BOOST_REQUIRE_EQUAL(blockGradient.n_cols, gradient.n_cols);
+    for (size_t i = 0; i < gradient.n_elem; i++)
+      BOOST_REQUIRE_CLOSE(blockGradient[i], gradient[i], 1e-5);
+  }
+
+  // With these parameters, exp() of the class scores overflows.
+  parameters *= 1000;
+  srf.Lambda(0);
+
+  double logLikelihood = 0;
+  for (size_t j = 0; j < points; j++)
+  {
+    const arma::vec scores = parameters * data.col(j);
+    const double maxScore = arma::max(scores);
+    logLikelihood += scores(labels(j)) - maxScore -
+        log(arma::accu(arma::exp(scores - maxScore)));
+  }
+  logLikelihood /= points;
+
+  srf.Gradient(parameters, gradient);
+  BOOST_REQUIRE_CLOSE(srf.Evaluate(parameters), -logLikelihood, 1e-5);
+  BOOST_REQUIRE(gradient.is_finite());
+}
+
+/**
+ * Test that evaluating the objective and gradient in shards, in parallel, gives
+ * the same results as evaluating them over the whole dataset.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionDataParallel)
+{
+  const size_t points = 1000;
+  const size_t inputSize = 10;
+  const size_t numClasses = 5;
+
+  arma::mat data;
+  data.randu(inputSize, points);
+
+  arma::vec labels(points);
+  for (size_t i = 0; i < points; i++)
+    labels(i) = math::RandInt(0, numClasses);
+
+  SoftmaxRegressionFunction srf(data, labels, inputSize, numClasses, 10);
+
+  arma::mat parameters;
+  parameters.randu(numClasses, inputSize);
+
+  arma::mat gradient;
+  srf.Gradient(parameters, gradient);
+  const double cost = srf.Evaluate(parameters);
+
+  const size_t shards[] = { 0, 1, 4, 13 };
+  for (size_t s = 0; s < 4; s++)
+  {
+    DataParallelFunction<SoftmaxRegressionFunction> parallelSrf(srf,
+        shards[s]);
+
+    arma::mat parallelGradient, fusedGradient;
+    parallelSrf.Gradient(parameters, parallelGradient);
+    const double fusedCost = parallelSrf.EvaluateWithGradient(parameters,
+        fusedGradient);
+
+    BOOST_REQUIRE_CLOSE(parallelSrf.Evaluate(parameters), cost, 1e-5);
+    BOOST_REQUIRE_CLOSE(fusedCost, cost, 1e-5);
+    BOOST_REQUIRE_EQUAL(parallelGradient.n_rows, gradient.n_rows);
+    BOOST_REQUIRE_EQUAL(parallelGradient.n_cols, gradient.n_cols);
+    BOOST_REQUIRE_EQUAL(fusedGradient.n_rows, gradient.n_rows);
+    BOOST_REQUIRE_EQUAL(fusedGradient.n_cols, gradient.n_cols);
+    for (size_t i = 0; i < gradient.n_elem; i++)
+    {
+      BOOST_REQUIRE_CLOSE(parallelGradient[i], gradient[i], 1e-5);
+      BOOST_REQUIRE_CLOSE(fusedGradient[i], gradient[i], 1e-5);
+    }
+  }
+}
+
+/**
+ * Train softmax regression with L-BFGS on the DataParallelFunction wrapper, and
+ * make sure the model is the same as the one trained on the function itself.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionDataParallelTraining)
+{
+  const size_t points = 1000;
+  const size_t inputSize = 3;
+  const size_t numClasses = 2;
+  const double lambda = 0.5;
+
+  GaussianDistribution g1(arma::vec("1.0 9.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("4.0 3.0 4.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat data(inputSize, points);
+  arma::vec labels(points);
+  for (size_t i = 0; i < points / 2; i++)
+  {
+    data.col(i) = g1.Random();
+    labels(i) = 0;
+  }
+  for (size_t i = points / 2; i < points; i++)
+  {
+    data.col(i) = g2.Random();
+    labels(i) = 1;
+  }
+
+  SoftmaxRegression<> sr(data, labels, inputSize, numClasses, lambda);
+
+  SoftmaxRegressionFunction srf(data, labels, inputSize, numClasses, lambda);
+  DataParallelFunction<SoftmaxRegressionFunction> parallelSrf(srf, 4);
+  L_BFGS<DataParallelFunction<SoftmaxRegressionFunction> > lbfgs(parallelSrf);
+  SoftmaxRegression<> parallelSr(lbfgs);
+
+  BOOST_REQUIRE_EQUAL(parallelSr.InputSize(), inputSize);
+  BOOST_REQUIRE_EQUAL(parallelSr.NumClasses(), numClasses);
+  BOOST_REQUIRE_CLOSE(parallelSr.Lambda(), lambda, 1e-5);
+  BOOST_REQUIRE_CLOSE(parallelSr.ComputeAccuracy(data, labels),
+      sr.ComputeAccuracy(data, labels), 0.5);
+
+  BOOST_REQUIRE_EQUAL(parallelSr.Parameters().n_elem, sr.Parameters().n_elem);
+  for (size_t i = 0; i < sr.Parameters().n_elem; i++)
+    BOOST_REQUIRE_CLOSE(parallelSr.Parameters()[i], sr.Parameters()[i], 0.1);
+}
+
 BOOST_AUTO_TEST_CASE(SoftmaxRegressionTwoClasses)
 {
   const size_t points = 1000;
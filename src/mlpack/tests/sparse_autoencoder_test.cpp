@@ -263,4 +263,33 @@ BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionGradient)
   }
 }
 
+/**
+ * Test that EvaluateWithGradient() gives the same results as Evaluate() and
+ * Gradient().
+ */
+BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionEvaluateWithGradient)
+{
+  const size_t points = 1000;
+  const size_t vSize = 20;
+  const size_t hSize = 10;
+
+  arma::mat data;
+  data.randu(vSize, points);
+
+  SparseAutoencoderFunction saf(data, vSize, hSize, 20, 20);
+
+  arma::mat parameters;
+  parameters.randu(2 * hSize + 1, vSize + 1);
+
+  arma::mat gradient, fusedGradient;
+  saf.Gradient(parameters, gradient);
+  const double cost = saf.EvaluateWithGradient(parameters, fusedGradient);
+
+  BOOST_REQUIRE_CLOSE(cost, saf.Evaluate(parameters), 1e-5);
+  BOOST_REQUIRE_EQUAL(fusedGradient.n_rows, gradient.n_rows);
+  BOOST_REQUIRE_EQUAL(fusedGradient.n_cols, gradient.n_cols);
+  for (size_t i = 0; i < gradient.n_elem; i++)
+    BOOST_REQUIRE_CLOSE(fusedGradient[i], gradient[i], 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
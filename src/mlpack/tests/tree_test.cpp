@@ -1981,6 +1981,79 @@ void CheckDescendants(TreeType* node)
     CheckDescendants(&node->Child(i));
 }
 
+/**
+ * Make sure that two binary space trees have the same structure and bounds.
+ */
+template<typename TreeType>
+void CheckSameTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Begin(), b.Begin());
+  BOOST_REQUIRE_EQUAL(a.Count(), b.Count());
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  for (size_t i = 0; i < a.Bound().Dim(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(a.Bound()[i].Lo(), b.Bound()[i].Lo());
+    BOOST_REQUIRE_EQUAL(a.Bound()[i].Hi(), b.Bound()[i].Hi());
+  }
+  BOOST_REQUIRE_EQUAL(a.ParentDistance(), b.ParentDistance());
+
+  // The points of each leaf must be inside its bound.
+  if (a.NumChildren() == 0)
+    for (size_t i = a.Begin(); i < a.End(); ++i)
+      BOOST_REQUIRE(a.Bound().Contains(a.Dataset().col(i)));
+
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+    CheckSameTree(a.Child(i), b.Child(i));
+}
+
+/**
+ * Build a large kd-tree (large enough that it is built in parallel, if OpenMP
+ * is available) with one thread and with all threads, and make sure that the
+ * trees and the mappings are exactly the same.
+ */
+BOOST_AUTO_TEST_CASE(ParallelBinarySpaceTreeTest)
+{
+  arma::mat dataset;
+  dataset.randu(4, 100000);
+  // Add some duplicate points, which must not cause problems for the
+  // partitioning.
+  dataset.cols(50000, 50999) = dataset.cols(0, 999);
+
+  typedef BinarySpaceTree<HRectBound<2> > TreeType;
+
+  const int numThreads = OmpGetMaxThreads();
+
+  arma::mat serialData(dataset);
+  std::vector<size_t> serialOldFromNew;
+  OmpSetNumThreads(1);
+  TreeType serialTree(serialData, serialOldFromNew, 20);
+  OmpSetNumThreads(numThreads);
+
+  arma::mat parallelData(dataset);
+  std::vector<size_t> parallelOldFromNew;
+  TreeType parallelTree(parallelData, parallelOldFromNew, 20);
+
+  BOOST_REQUIRE_EQUAL(serialOldFromNew.size(), dataset.n_cols);
+  BOOST_REQUIRE_EQUAL(parallelOldFromNew.size(), dataset.n_cols);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(serialOldFromNew[i], parallelOldFromNew[i]);
+    for (size_t d = 0; d < dataset.n_rows; ++d)
+    {
+      BOOST_REQUIRE_EQUAL(serialData(d, i), parallelData(d, i));
+      BOOST_REQUIRE_EQUAL(parallelData(d, i),
+          dataset(d, parallelOldFromNew[i]));
+    }
+  }
+
+  CheckSameTree(serialTree, parallelTree);
+
+  // The tree built without a mapping must be the same too.
+  arma::mat unmappedData(dataset);
+  TreeType unmappedTree(unmappedData, 20);
+  CheckSameTree(serialTree, unmappedTree);
+}
+
 /**
  * Make sure Descendant() and NumDescendants() works properly for the cover
  * tree.
@@ -1997,4 +2070,189 @@ BOOST_AUTO_TEST_CASE(CoverTreeDescendantTest)
   CheckDescendants(&tree);
 }
 
+/**
+ * Make sure every descendant of each cover tree node is within the furthest
+ * descendant distance of the node.
+ */
+template<typename TreeType>
+void CheckFurthestDescendant(const TreeType& node)
+{
+  for (size_t i = 0; i < node.NumDescendants(); ++i)
+  {
+    const double distance = LMetric<2, true>::Evaluate(
+        node.Dataset().col(node.Point()),
+        node.Dataset().col(node.Descendant(i)));
+    BOOST_REQUIRE_LE(distance, node.FurthestDescendantDistance() + 1e-10);
+  }
+
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    CheckFurthestDescendant(node.Child(i));
+}
+
+/**
+ * Insert points into a cover tree after it is built, and make sure it is still
+ * a valid cover tree holding every point once.
+ */
+BOOST_AUTO_TEST_CASE(CoverTreeInsertTest)
+{
+  arma::mat dataset;
+  dataset.randu(3, 300);
+
+  CoverTree<> tree(dataset);
+
+  // Add some nearby points, some far away points, and a duplicate.
+  arma::mat newPoints;
+  newPoints.randu(3, 200);
+  newPoints.cols(150, 189) *= 10.0;
+  newPoints.col(199) = dataset.col(17);
+  dataset.insert_cols(300, newPoints);
+
+  for (size_t i = 300; i < 500; ++i)
+    tree.Insert(i);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 500);
+
+  arma::vec counts;
+  counts.zeros(500);
+  RecurseTreeCountLeaves(tree, counts);
+  for (size_t i = 0; i < 500; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], 1);
+
+  CheckSelfChild<CoverTree<> >(tree);
+  CheckCovering<CoverTree<>, LMetric<2, true> >(tree);
+  CheckDescendants(&tree);
+  CheckFurthestDescendant(tree);
+
+  // Now grow a tree from a single point.
+  arma::mat single = dataset.cols(0, 0);
+  CoverTree<> singleTree(single);
+  single.insert_cols(1, dataset.cols(1, 99));
+  for (size_t i = 1; i < 100; ++i)
+    singleTree.Insert(i);
+
+  BOOST_REQUIRE_EQUAL(singleTree.NumDescendants(), 100);
+
+  counts.zeros(100);
+  RecurseTreeCountLeaves(singleTree, counts);
+  for (size_t i = 0; i < 100; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], 1);
+
+  CheckSelfChild<CoverTree<> >(singleTree);
+  CheckCovering<CoverTree<>, LMetric<2, true> >(singleTree);
+  CheckDescendants(&singleTree);
+  CheckFurthestDescendant(singleTree);
+}
+
+/**
+ * Check that two binary space trees have the same structure.
+ */
+template<typename TreeType>
+void CheckSameBinarySpaceTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Begin(), b.Begin());
+  BOOST_REQUIRE_EQUAL(a.Count(), b.Count());
+  BOOST_REQUIRE_EQUAL(a.MaxLeafSize(), b.MaxLeafSize());
+  BOOST_REQUIRE_EQUAL(a.SplitDimension(), b.SplitDimension());
+  BOOST_REQUIRE_EQUAL(a.ParentDistance(), b.ParentDistance());
+  BOOST_REQUIRE_EQUAL(a.FurthestDescendantDistance(),
+                      b.FurthestDescendantDistance());
+  BOOST_REQUIRE_EQUAL(a.Bound().Dim(), b.Bound().Dim());
+  for (size_t i = 0; i < a.Bound().Dim(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(a.Bound()[i].Lo(), b.Bound()[i].Lo());
+    BOOST_REQUIRE_EQUAL(a.Bound()[i].Hi(), b.Bound()[i].Hi());
+  }
+
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(b.Child(i).Parent(), &b);
+    CheckSameBinarySpaceTree(a.Child(i), b.Child(i));
+  }
+}
+
+/**
+ * Save a kd-tree to a file and make sure that the loaded tree is the same.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeSaveLoadTest)
+{
+  typedef BinarySpaceTree<HRectBound<2> > TreeType;
+
+  arma::mat dataset;
+  dataset.randu(5, 1000);
+
+  std::vector<size_t> oldFromNew;
+  TreeType tree(dataset, oldFromNew, 10);
+
+  SaveTree("test-tree-save.bin", tree, oldFromNew);
+
+  {
+    LoadedTree<TreeType> loaded("test-tree-save.bin");
+
+    BOOST_REQUIRE_EQUAL(loaded.Tree().Parent(), (TreeType*) NULL);
+    BOOST_REQUIRE_EQUAL(&loaded.Tree().Dataset(), &loaded.Dataset());
+    BOOST_REQUIRE_EQUAL(loaded.Dataset().n_rows, dataset.n_rows);
+    BOOST_REQUIRE_EQUAL(loaded.Dataset().n_cols, dataset.n_cols);
+    for (size_t i = 0; i < dataset.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(loaded.Dataset()[i], dataset[i]);
+
+    BOOST_REQUIRE_EQUAL(loaded.OldFromNew().size(), oldFromNew.size());
+    for (size_t i = 0; i < oldFromNew.size(); ++i)
+      BOOST_REQUIRE_EQUAL(loaded.OldFromNew()[i], oldFromNew[i]);
+
+    CheckSameBinarySpaceTree(tree, loaded.Tree());
+  }
+
+  remove("test-tree-save.bin");
+}
+
+/**
+ * Check that two cover trees have the same structure.
+ */
+template<typename TreeType>
+void CheckSameCoverTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Point(), b.Point());
+  BOOST_REQUIRE_EQUAL(a.Scale(), b.Scale());
+  BOOST_REQUIRE_EQUAL(a.Base(), b.Base());
+  BOOST_REQUIRE_EQUAL(a.NumDescendants(), b.NumDescendants());
+  BOOST_REQUIRE_EQUAL(a.ParentDistance(), b.ParentDistance());
+  BOOST_REQUIRE_EQUAL(a.FurthestDescendantDistance(),
+                      b.FurthestDescendantDistance());
+
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(b.Child(i).Parent(), &b);
+    CheckSameCoverTree(a.Child(i), b.Child(i));
+  }
+}
+
+/**
+ * Save a cover tree to a file and make sure that the loaded tree is the same.
+ */
+BOOST_AUTO_TEST_CASE(CoverTreeSaveLoadTest)
+{
+  arma::mat dataset;
+  dataset.randu(5, 500);
+
+  CoverTree<> tree(dataset, 1.3);
+
+  SaveTree("test-tree-save.bin", tree);
+
+  {
+    LoadedTree<CoverTree<> > loaded("test-tree-save.bin");
+
+    BOOST_REQUIRE_EQUAL(loaded.Tree().Parent(), (CoverTree<>*) NULL);
+    BOOST_REQUIRE_EQUAL(loaded.OldFromNew().size(), 0);
+    for (size_t i = 0; i < dataset.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(loaded.Dataset()[i], dataset[i]);
+
+    CheckSameCoverTree(tree, loaded.Tree());
+    CheckCovering<CoverTree<>, LMetric<2, true> >(loaded.Tree());
+  }
+
+  remove("test-tree-save.bin");
+}
+
 BOOST_AUTO_TEST_SUITE_END();